@@ -14,12 +14,18 @@
  * limitations under the License.
  */
 #include <assert.h>
+#include <fcntl.h>
 #include <png.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <string>
+#include <thread>
 #include <vector>
 
 /// This is an example demonstrating how to use auto-generated bundles and
@@ -34,6 +40,9 @@
 //===----------------------------------------------------------------------===//
 std::vector<std::string> inputImageFilenames;
 
+/// The number of threads used to run the network.
+unsigned numThreads = 1;
+
 /// \returns the index of the element at x,y,z,w.
 size_t getXYZW(const size_t *dims, size_t x, size_t y, size_t z, size_t w) {
   return (x * dims[1] * dims[2] * dims[3]) + (y * dims[2] * dims[3]) +
@@ -200,10 +209,16 @@ static void loadImagesAndPreprocess(const std::vector<std::string> &filenames,
   printf("Loaded images size in bytes is: %lu\n", resultSizeInBytes);
 }
 
-/// Parse images file names into a vector.
+/// Parse images file names into a vector, and the optional -threads=<N>
+/// option into numThreads.
 void parseCommandLineOptions(int argc, char **argv) {
   int arg = 1;
   while (arg < argc) {
+    if (!strncmp(argv[arg], "-threads=", strlen("-threads="))) {
+      numThreads = atoi(argv[arg++] + strlen("-threads="));
+      assert(numThreads > 0 && "Expected a positive number of threads");
+      continue;
+    }
     inputImageFilenames.push_back(argv[arg++]);
   }
 }
@@ -240,10 +255,41 @@ struct BundleConfig {
   const SymbolTableEntry *symbolTable;
 };
 
-// These two external symbols are auto-generated by means of the -bundle option.
+/// Type of the body of a parallel loop run by the bundle.
+typedef void (*ParallelBody)(void *ctx, size_t begin, size_t end);
+
+/// Type of the parallel-for that the bundle uses to split its kernels.
+typedef void (*ParallelFor)(void *runtimeCtx, size_t numIters,
+                            ParallelBody body, void *bodyCtx);
+
+// These external symbols are auto-generated by means of the -bundle option.
 extern "C" void resnet50(uint8_t *constantWeightVars,
                          uint8_t *mutableWeightVars, uint8_t *activations);
 extern "C" BundleConfig resnet50_config;
+extern "C" void resnet50_set_parallel_for(ParallelFor parallelFor,
+                                          void *runtimeCtx);
+
+/// A simple parallel-for for the bundle, which splits the \p numIters
+/// iterations evenly across the number of threads pointed by \p runtimeCtx.
+/// The calling thread runs the first chunk. A real application would rather
+/// reuse the threads of a thread pool.
+static void threadsParallelFor(void *runtimeCtx, size_t numIters,
+                               ParallelBody body, void *bodyCtx) {
+  size_t threads = *static_cast<unsigned *>(runtimeCtx);
+  if (threads > numIters) {
+    threads = numIters;
+  }
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++) {
+    workers.emplace_back([=]() {
+      body(bodyCtx, numIters * t / threads, numIters * (t + 1) / threads);
+    });
+  }
+  body(bodyCtx, 0, numIters / threads);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
 
 /// Find in the bundle's symbol table a weight variable whose name starts with
 /// \p name.
@@ -283,34 +329,49 @@ void *alignedAlloc(const BundleConfig &config, size_t size) {
   return ptr;
 }
 
-/// Initialize the constant weights memory block by loading the weights from the
-/// weights file.
+/// Initialize the constant weights memory block by mapping the weights file
+/// into memory. The constant weights are only read by the bundle, so the file
+/// does not need to be copied, and its pages are only loaded when they are
+/// first used.
 static uint8_t *initConstantWeights(const char *weightsFileName,
                                     const BundleConfig &config) {
-  // Load weights.
-  FILE *weightsFile = fopen(weightsFileName, "rb");
-  if (!weightsFile) {
+  int fd = open(weightsFileName, O_RDONLY);
+  if (fd < 0) {
     fprintf(stderr, "Could not open the weights file: %s\n", weightsFileName);
     exit(1);
   }
-  fseek(weightsFile, 0, SEEK_END);
-  size_t fileSize = ftell(weightsFile);
-  fseek(weightsFile, 0, SEEK_SET);
-  uint8_t *baseConstantWeightVarsAddr =
-      static_cast<uint8_t *>(alignedAlloc(config, fileSize));
-  printf("Allocated weights of size: %lu\n", fileSize);
+  struct stat st;
+  if (fstat(fd, &st)) {
+    perror("Could not get the size of the weights file");
+    exit(1);
+  }
+  size_t fileSize = st.st_size;
   printf("Expected weights of size: %lu\n", config.constantWeightVarsMemSize);
   assert(fileSize == config.constantWeightVarsMemSize &&
          "Wrong weights file size");
-  int result = fread(baseConstantWeightVarsAddr, fileSize, 1, weightsFile);
-  if (result != 1) {
-    perror("Could not read the weights file");
-  } else {
-    printf("Loaded weights of size: %lu from the file %s\n", fileSize,
-           weightsFileName);
+  // The mapping is page aligned, which satisfies the bundle alignment.
+  void *baseConstantWeightVarsAddr =
+      mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (baseConstantWeightVarsAddr == MAP_FAILED) {
+    perror("Could not map the weights file");
+    exit(1);
   }
-  fclose(weightsFile);
-  return baseConstantWeightVarsAddr;
+  printf("Mapped weights of size: %lu from the file %s\n", fileSize,
+         weightsFileName);
+  return static_cast<uint8_t *>(baseConstantWeightVarsAddr);
+}
+
+/// Print the sizes of the memory areas of the bundle described by \p config,
+/// and the peak resident set size of the process.
+static void dumpMemoryUsage(const BundleConfig &config) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  printf("Constant weights size: %lu bytes\n",
+         config.constantWeightVarsMemSize);
+  printf("Mutable weights size: %lu bytes\n", config.mutableWeightVarsMemSize);
+  printf("Activations size: %lu bytes\n", config.activationsMemSize);
+  printf("Peak RSS: %ld KB\n", usage.ru_maxrss);
 }
 
 /// The assumed layout of the area for mutable WeightVars is:
@@ -374,14 +435,20 @@ int main(int argc, char **argv) {
   uint8_t *mutableWeightVarsAddr = initMutableWeightVars(resnet50_config);
   uint8_t *activationsAddr = initActivations(resnet50_config);
 
+  // Split the heavy kernels of the network across threads.
+  if (numThreads > 1) {
+    resnet50_set_parallel_for(threadsParallelFor, &numThreads);
+  }
+
   // Perform the computation.
   resnet50(constantWeightVarsAddr, mutableWeightVarsAddr, activationsAddr);
 
   // Report the results.
   dumpInferenceResults(resnet50_config, mutableWeightVarsAddr);
+  dumpMemoryUsage(resnet50_config);
 
   // Free all resources.
   free(activationsAddr);
-  free(constantWeightVarsAddr);
+  munmap(constantWeightVarsAddr, resnet50_config.constantWeightVarsMemSize);
   free(mutableWeightVarsAddr);
 }
@@ -13,10 +13,12 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "glow/ExecutionEngine/DataParallelTrainer.h"
 #include "glow/ExecutionEngine/ExecutionEngine.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Support/Support.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -48,6 +50,12 @@ llvm::cl::opt<ModelKind>
                            clEnumValN(ModelKind::MODEL_VGG, "model-vgg",
                                       "model similar to vgg11")),
           llvm::cl::init(ModelKind::MODEL_SIMPLE), llvm::cl::cat(cifarCat));
+
+llvm::cl::opt<unsigned> numDevices(
+    "num-devices",
+    llvm::cl::desc("Number of devices to train on data-parallel. Every device "
+                   "trains on its own minibatch."),
+    llvm::cl::init(1), llvm::cl::cat(cifarCat));
 } // namespace
 
 /// The CIFAR file format is structured as one byte label in the range 0..9.
@@ -185,8 +193,19 @@ void testCIFAR10() {
   auto *resultPH = createModel(bindings, F, A, E);
   auto *result = bindings.allocate(resultPH);
 
-  Function *TF = glow::differentiate(F, TC);
-  EE.compile(CompilationMode::Train, TF);
+  // With several devices, every training step consumes one minibatch per
+  // device. The replicas update the weights in bindings, which the inference
+  // Function then reads to score the model.
+  std::unique_ptr<DataParallelTrainer> trainer;
+  if (numDevices > 1) {
+    trainer = llvm::make_unique<DataParallelTrainer>(executionBackend,
+                                                     numDevices);
+    trainer->compile(F, TC, bindings);
+    EE.compile(CompilationMode::Infer, F);
+  } else {
+    Function *TF = glow::differentiate(F, TC);
+    EE.compile(CompilationMode::Train, TF);
+  }
 
   // Report progress every this number of training iterations.
   // Report less often for fast models.
@@ -208,8 +227,13 @@ void testCIFAR10() {
 
     // Bind the images tensor to the input array A, and the labels tensor
     // to the softmax node SM.
-    runBatch(EE, bindings, reportRate, sampleCounter, {A, E},
-             {&images, &labels});
+    if (trainer) {
+      runBatch(*trainer, reportRate / numDevices, sampleCounter, {A, E},
+               {&images, &labels});
+    } else {
+      runBatch(EE, bindings, reportRate, sampleCounter, {A, E},
+               {&images, &labels});
+    }
 
     unsigned score = 0;
 
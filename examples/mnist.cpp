@@ -13,10 +13,12 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "glow/ExecutionEngine/DataParallelTrainer.h"
 #include "glow/ExecutionEngine/ExecutionEngine.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Support/Support.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -37,6 +39,12 @@ llvm::cl::opt<BackendKind> executionBackend(
                      clEnumValN(BackendKind::CPU, "cpu", "Use CPU"),
                      clEnumValN(BackendKind::OpenCL, "opencl", "Use OpenCL")),
     llvm::cl::init(BackendKind::Interpreter), llvm::cl::cat(mnistCat));
+
+llvm::cl::opt<unsigned> numDevices(
+    "num-devices",
+    llvm::cl::desc("Number of devices to train on data-parallel. Every device "
+                   "trains on its own minibatch."),
+    llvm::cl::init(1), llvm::cl::cat(mnistCat));
 } // namespace
 
 unsigned loadMNIST(Tensor &imageInputs, Tensor &labelInputs) {
@@ -132,9 +140,17 @@ void testMNIST() {
   Tensor *resultTensor = bindings.allocate(result->getPlaceholder());
   bindings.allocate(selected);
 
-  Function *TF = glow::differentiate(F, TC);
-
-  EE.compile(CompilationMode::Train, TF);
+  // With several devices, every training step consumes one minibatch per
+  // device.
+  std::unique_ptr<DataParallelTrainer> trainer;
+  if (numDevices > 1) {
+    trainer = llvm::make_unique<DataParallelTrainer>(executionBackend,
+                                                     numDevices);
+    trainer->compile(F, TC, bindings);
+  } else {
+    Function *TF = glow::differentiate(F, TC);
+    EE.compile(CompilationMode::Train, TF);
+  }
 
   const int numIterations = 30;
 
@@ -152,8 +168,13 @@ void testMNIST() {
     // On each training iteration take a slice of imageInputs and labelInputs
     // and put them into variables A and B, then run forward and backward passes
     // and update weights.
-    runBatch(EE, bindings, numIterations, sampleCounter, {A, selected},
-             {&imageInputs, &labelInputs});
+    if (trainer) {
+      runBatch(*trainer, numIterations / numDevices, sampleCounter,
+               {A, selected}, {&imageInputs, &labelInputs});
+    } else {
+      runBatch(EE, bindings, numIterations, sampleCounter, {A, selected},
+               {&imageInputs, &labelInputs});
+    }
 
     timer.stopTimer();
   }
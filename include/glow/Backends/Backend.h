@@ -51,16 +51,13 @@ public:
 
   /// Generate code for a vector of functions, \p functions. All compilations
   /// use the same settings provided by \p opts. This allows the compiler to
-  /// support shared constants between functions.
+  /// support shared constants between functions. The functions are compiled
+  /// in parallel on up to opts.maxCompileThreads threads, so the functions
+  /// must have been optimized already. \returns the compiled functions in the
+  /// order of \p functions.
   virtual std::vector<std::unique_ptr<CompiledFunction>>
   compileFunctions(llvm::ArrayRef<Function *> functions,
-                   CompilationOptions &opts) const {
-    std::vector<std::unique_ptr<CompiledFunction>> compiledFunctions;
-    for (auto &function : functions) {
-      compiledFunctions.push_back(compile(function, opts));
-    }
-    return compiledFunctions;
-  }
+                   const CompilationOptions &opts) const;
 
   virtual std::unique_ptr<CompiledFunction> compile(Function *F) const {
     CompilationOptions opts;
@@ -19,6 +19,10 @@
 #include "glow/CodeGen/MemoryAllocator.h"
 #include "glow/IR/IR.h"
 
+#include <memory>
+#include <tuple>
+#include <vector>
+
 namespace glow {
 namespace runtime {
 
@@ -54,8 +58,9 @@ using SymbolTableTy = std::unordered_map<std::string, RuntimeSymbolInfo>;
 class RuntimeBundle {
   /// Map from symbol name to a RuntimeSymbolInfo.
   SymbolTableTy symbolTable_;
-  /// Pointer to memory containing the weights for execution.
-  uint8_t *constants_{nullptr};
+  /// Memory containing the weights for execution. It may be shared with the
+  /// bundles of other functions that use the same weights.
+  std::shared_ptr<uint8_t> constants_;
   /// Amount of memory needed for weights.
   size_t constantWeightVarsMemSize_{0};
   /// Amount of memory needed for mutable vars.
@@ -70,10 +75,22 @@ public:
   size_t getMutableWeightSize() const { return mutableWeightVarsMemSize_; }
   /// Get Activations Weights memory size.
   size_t getActivationsSize() const { return activationsMemSize_; }
+  /// Get the memory size allocated by a run, the mutable weights and the
+  /// activations.
+  size_t getRunMemorySize() const {
+    return mutableWeightVarsMemSize_ + activationsMemSize_;
+  }
   /// Get pointer to memory block of constants.
-  uint8_t *getConstants() const { return constants_; }
-  /// Set pointer to memory block of constants.
-  void setConstants(uint8_t *constants) { constants_ = constants; }
+  uint8_t *getConstants() const { return constants_.get(); }
+  /// Get the shared memory block of constants.
+  const std::shared_ptr<uint8_t> &getSharedConstants() const {
+    return constants_;
+  }
+  /// Set the memory block of constants to \p constants, which may be shared
+  /// with other bundles.
+  void setConstants(std::shared_ptr<uint8_t> constants) {
+    constants_ = std::move(constants);
+  }
   /// Helper function, gets offset of \p v.
   size_t getValueOffset(const Named *v) const;
   /// Helper function, gets symbol info for \p v.
@@ -87,7 +104,7 @@ public:
   /// by offsets contained in symbolTable_.
   void collectConstants(const IRFunction *F);
   void collectConstants(const Module *M);
-  /// Free constants.
+  /// Free constants. The memory is released when no other bundle shares it.
   void freeConstants();
 
   /// Sets the input and output flags for each symbol in the symbolBundle.
@@ -113,11 +130,64 @@ public:
   // Constructor.
   RuntimeBundle(SymbolTableTy &symbolTable, size_t constWeight,
                 size_t mutableWeight, size_t activations)
-      : symbolTable_(std::move(symbolTable)), constants_(nullptr),
+      : symbolTable_(std::move(symbolTable)),
         constantWeightVarsMemSize_(constWeight),
         mutableWeightVarsMemSize_(mutableWeight),
         activationsMemSize_(activations) {}
 };
+
+/// Holds the constant weights of the functions loaded on one device. The
+/// functions that use the same Constants, like the replicas of a network or
+/// its variants for other batch sizes, share one block of constants, which
+/// is counted once. A block is identified by its layout (the name, offset and
+/// size of each Constant) and by its contents. The store is not thread safe,
+/// it is meant to be used by the thread of the device.
+class ConstantStore {
+  /// The name, offset and size of each Constant in a block.
+  using LayoutTy = std::vector<std::tuple<std::string, size_t, size_t>>;
+
+  /// A block of constants and the bundles that use it.
+  struct Entry {
+    /// The Constants in the block, sorted by offset.
+    LayoutTy layout;
+    /// The size of the block in bytes.
+    size_t size;
+    /// The block.
+    std::shared_ptr<uint8_t> constants;
+    /// The bundles that use the block, once per acquire.
+    std::vector<const RuntimeBundle *> users;
+  };
+
+  /// The blocks on the device.
+  std::vector<Entry> entries_;
+
+  /// Total size in bytes of the blocks.
+  uint64_t size_{0};
+
+  /// \returns the layout of the constants of \p bundle.
+  static LayoutTy getLayout(const RuntimeBundle &bundle);
+
+  /// \returns true if the constants of \p bundle, which are read from the
+  /// Module \p M if \p bundle has not collected them, are equal to the
+  /// block of \p entry.
+  static bool isSameContents(const Entry &entry, const RuntimeBundle &bundle,
+                             const Module *M);
+
+public:
+  /// Points \p bundle to a block with the same constants, if there is one,
+  /// otherwise adds its constants to the store, collecting them from \p M
+  /// if needed. This must be called before the function of \p bundle runs.
+  /// \returns the number of bytes that the store grew by.
+  uint64_t acquire(RuntimeBundle &bundle, const Module *M);
+
+  /// Drops one use of the block of \p bundle. \returns the number of bytes
+  /// that the store shrank by, which is the size of the block when \p bundle
+  /// was its last user.
+  uint64_t release(const RuntimeBundle &bundle);
+
+  /// \returns the total size in bytes of the blocks in the store.
+  uint64_t getSize() const { return size_; }
+};
 } // namespace runtime
 
 } // end namespace glow
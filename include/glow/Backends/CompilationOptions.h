@@ -18,6 +18,8 @@
 
 namespace glow {
 
+class Backend;
+
 enum class CompilationMode {
   Train, /// Compile the graph in preperation for training.
   Infer, /// Compile the graph for inference. Notice that this operation
@@ -33,6 +35,18 @@ struct CompilationOptions {
 
   /// Insert TraceEvents between all instructions for profiling.
   bool autoInstrument{false};
+
+  /// Evaluate the subgraphs that only depend on Constants at compile time.
+  bool enableConstantFolding{true};
+
+  /// The backend that evaluates the subgraphs that only depend on Constants.
+  /// It must run the Functions it compiles on the host. Constants are not
+  /// folded if it is null.
+  const Backend *constantFoldingBackend{nullptr};
+
+  /// The maximum number of threads that Backend::compileFunctions uses to
+  /// compile Functions in parallel. 0 uses one thread per hardware thread.
+  unsigned maxCompileThreads{0};
 };
 
 }; // namespace glow
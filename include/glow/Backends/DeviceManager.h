@@ -23,6 +23,8 @@
 #include "glow/Runtime/RuntimeTypes.h"
 #include "glow/Support/Error.h"
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <string>
@@ -50,6 +52,31 @@ protected:
   /// Configuration object for the device.
   std::unique_ptr<DeviceConfig> config_;
 
+  /// Number of runFunction requests accepted by the device whose result
+  /// callback has not been called yet.
+  std::atomic<unsigned> outstandingRequests_{0};
+
+  /// Exponential moving average of the execution time of a request on the
+  /// device in microseconds, not counting time spent waiting in the queue.
+  /// Zero until the first request completes.
+  std::atomic<uint64_t> avgExecutionTimeUs_{0};
+
+  /// Record that a runFunction request was accepted by the device. Every call
+  /// must be matched by a call to requestFinished().
+  void requestStarted() { outstandingRequests_++; }
+
+  /// Record that a request finished after executing for \p execTimeUs
+  /// microseconds. Must be called before the result callback of the request.
+  void requestFinished(uint64_t execTimeUs);
+
+  /// \returns a callback for a request that was submitted at \p submitTime and
+  /// starts executing now, which records the request as finished and adds its
+  /// queue wait and execution time to its ExecutionContext before calling
+  /// \p resultCB.
+  ResultCBTy
+  wrapResultCallback(std::chrono::steady_clock::time_point submitTime,
+                     ResultCBTy resultCB);
+
 public:
   DeviceManager(BackendKind backend,
                 std::unique_ptr<DeviceConfig> config = nullptr)
@@ -108,6 +135,21 @@ public:
   /// fit on the device.
   virtual bool isMemoryAvailable(uint64_t estimate) const = 0;
 
+  /// \returns the number of requests submitted to the device which have not
+  /// completed yet.
+  unsigned getOutstandingRequests() const { return outstandingRequests_; }
+
+  /// \returns the moving average of the execution time of a request on the
+  /// device in microseconds, or zero if no request completed yet.
+  uint64_t getAverageExecutionTimeUs() const { return avgExecutionTimeUs_; }
+
+  /// \returns the expected time in microseconds until a request submitted now
+  /// would complete: the requests ahead of it in the queue plus itself, at the
+  /// average execution time.
+  uint64_t getExpectedLatencyUs() const {
+    return (getOutstandingRequests() + 1) * getAverageExecutionTimeUs();
+  }
+
   /// \returns the DeviceConfig which initialized this device.
   const DeviceConfig *getDeviceConfig() { return config_.get(); }
 };
@@ -51,6 +51,14 @@ class ExecutionContext {
   std::unique_ptr<DeviceBindings> deviceBindings_;
   std::unique_ptr<TraceContext> traceContext_;
 
+  /// Time in microseconds this run spent waiting in DeviceManager queues,
+  /// summed over all the devices it ran on.
+  uint64_t deviceQueueWaitUs_{0};
+
+  /// Time in microseconds this run spent executing on devices, summed over all
+  /// the devices it ran on.
+  uint64_t deviceExecutionTimeUs_{0};
+
   /// Trace Events recorded during this run.
 
 public:
@@ -108,6 +116,19 @@ public:
     return traceContext;
   }
 
+  /// Add \p queueWaitUs and \p executionTimeUs microseconds to the time this
+  /// run spent waiting for and executing on devices.
+  void addDeviceTime(uint64_t queueWaitUs, uint64_t executionTimeUs) {
+    deviceQueueWaitUs_ += queueWaitUs;
+    deviceExecutionTimeUs_ += executionTimeUs;
+  }
+
+  /// \returns the time in microseconds this run waited in device queues.
+  uint64_t getDeviceQueueWaitUs() const { return deviceQueueWaitUs_; }
+
+  /// \returns the time in microseconds this run executed on devices.
+  uint64_t getDeviceExecutionTimeUs() const { return deviceExecutionTimeUs_; }
+
   /// Clones this ExecutionContext, but does not clone underlying Tensors.
   ExecutionContext clone() {
     if (deviceBindings_) {
@@ -20,13 +20,45 @@
 #include "glow/Runtime/RuntimeTypes.h"
 #include "glow/Support/ThreadPool.h"
 
+#include "llvm/Support/raw_ostream.h"
+
 #include <atomic>
+#include <chrono>
 
 namespace glow {
 namespace runtime {
 class QueueBackedDeviceManager : public DeviceManager {
+  /// \returns a function that moves the calling thread to the host cores and
+  /// NUMA node of \p config, or nullptr if \p config does not place the
+  /// device.
+  static std::function<void()> getHostPlacement(const DeviceConfig *config) {
+    if (!config) {
+      return nullptr;
+    }
+    std::vector<unsigned> cores = config->getCores();
+    if (cores.empty() && config->hasNUMANode()) {
+      cores = getNUMANodeCores(config->getNUMANode());
+    }
+    int node = config->hasNUMANode() ? config->getNUMANode() : -1;
+    if (cores.empty() && node < 0) {
+      return nullptr;
+    }
+    return [cores, node]() {
+      if (!cores.empty() && !pinCurrentThread(cores)) {
+        llvm::errs() << "Could not pin the device thread to its cores\n";
+      }
+      if (node >= 0 && !setCurrentThreadNUMANode(node)) {
+        llvm::errs() << "Could not allocate the device memory on NUMA node "
+                     << node << "\n";
+      }
+    };
+  }
+
 protected:
-  /// Thread which interfaces with the device.
+  /// Thread which interfaces with the device. It is placed on the cores and
+  /// NUMA node of the DeviceConfig, and the memory it allocates and touches
+  /// first, like the constants and activations of the CPU, comes from that
+  /// node.
   ThreadPool workThread_;
 
   /// Identifier for next run.
@@ -35,7 +67,8 @@ protected:
 public:
   QueueBackedDeviceManager(BackendKind backend,
                            std::unique_ptr<DeviceConfig> config)
-      : DeviceManager(backend, std::move(config)), workThread_(1) {}
+      : DeviceManager(backend, std::move(config)),
+        workThread_(1, getHostPlacement(config_.get())) {}
 
   virtual ~QueueBackedDeviceManager() {
     llvm::toString(stop(true)); // will join workThread_
@@ -72,11 +105,14 @@ public:
                               std::unique_ptr<ExecutionContext> context,
                               ResultCBTy callback) override {
     RunIdentifierTy id = nextIdentifier_++;
-    workThread_.submit([this, id, functionName = std::move(functionName),
+    requestStarted();
+    auto submitTime = std::chrono::steady_clock::now();
+    workThread_.submit([this, id, submitTime,
+                        functionName = std::move(functionName),
                         context = std::move(context),
                         callback = std::move(callback)]() mutable {
       runFunctionImpl(id, std::move(functionName), std::move(context),
-                      std::move(callback));
+                      wrapResultCallback(submitTime, std::move(callback)));
     });
     return id;
   }
@@ -19,7 +19,9 @@
 #include "glow/Graph/Nodes.h"
 #include "llvm/ADT/DenseMap.h"
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -118,9 +120,55 @@ enum class TraceLevel {
 
 /// A context for storing TraceEvents throughout a run (ie. between partitioned
 /// CompiledFunctions).
+///
+/// Events without arguments are logged into a fixed-size binary ring buffer
+/// without taking a lock or allocating: names are interned, timestamps are
+/// stored relative to the creation of the context, and a writer only claims a
+/// slot with an atomic increment. They are converted into TraceEvents when the
+/// events are read. If more than kRingSize events are logged between two
+/// reads, the oldest ones are dropped and counted in getDroppedEvents().
 class TraceContext {
+public:
+  /// Number of events the ring buffer holds.
+  static constexpr size_t kRingSize = 1024;
+
+private:
+  /// A TraceEvent without arguments as stored in the ring buffer. The fields
+  /// are atomic so that a reader can detect a record being overwritten while
+  /// it reads it.
+  struct TraceRecord {
+    /// One plus the index of the record once it is completely written, zero
+    /// while it is being written.
+    std::atomic<uint64_t> seq{0};
+    /// Timestamp relative to baseTimestamp_ (upper 32 bits), interned name
+    /// (next 24 bits) and type character (lowest 8 bits).
+    std::atomic<uint64_t> data{0};
+    /// Thread id of the event.
+    std::atomic<int> tid{0};
+  };
+
+  /// The ring buffer. Allocated by the first event logged into it.
+  std::unique_ptr<TraceRecord[]> ring_;
+
+  /// Guards the allocation of ring_.
+  std::once_flag ringInit_;
+
+  /// Number of records ever claimed in ring_.
+  std::atomic<uint64_t> ringHead_{0};
+
+  /// Number of records ever converted into traceEvents_ or dropped. Guarded
+  /// by lock_.
+  mutable uint64_t ringFlushed_{0};
+
+  /// Number of events dropped because the ring buffer was full. Guarded by
+  /// lock_.
+  mutable uint64_t droppedEvents_{0};
+
+  /// Time that the timestamps in ring_ are relative to.
+  uint64_t baseTimestamp_;
+
   /// The list of materialized Events filled out with timestamp and metadata.
-  std::vector<TraceEvent> traceEvents_;
+  mutable std::vector<TraceEvent> traceEvents_;
 
   /// Human readable name mapping for traceThreads_.
   std::map<int, std::string> threadNames_;
@@ -133,17 +181,29 @@ class TraceContext {
   int traceThread_{-1};
 
   /// Lock around traceEvents_.
-  std::mutex lock_;
+  mutable std::mutex lock_;
+
+  /// Try to log an event with \p name, \p type and \p timestamp into the ring
+  /// buffer. \returns false if it cannot be represented there.
+  bool logToRing(llvm::StringRef name, llvm::StringRef type,
+                 uint64_t timestamp);
+
+  /// Convert the completed records in the ring buffer into traceEvents_. Must
+  /// be called with lock_ held.
+  void flushRing() const;
 
 public:
-  TraceContext(TraceLevel level, int thread)
-      : traceLevel_(level), traceThread_(thread) {}
+  TraceContext(TraceLevel level, int thread);
 
   /// \returns TraceEvents for the last run.
-  std::vector<TraceEvent> &getTraceEvents() { return traceEvents_; }
+  std::vector<TraceEvent> &getTraceEvents();
 
   /// \returns TraceEvents for the last run.
-  llvm::ArrayRef<TraceEvent> getTraceEvents() const { return traceEvents_; }
+  llvm::ArrayRef<TraceEvent> getTraceEvents() const;
+
+  /// \returns the number of events dropped because too many events were logged
+  /// between two reads of the events.
+  uint64_t getDroppedEvents() const;
 
   /// \returns the integer thread id used for logged events in this context.
   int getTraceThread() const { return traceThread_; }
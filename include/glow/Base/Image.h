@@ -29,6 +29,8 @@
 
 namespace glow {
 
+class ThreadPool;
+
 /// Pixel value ranges.
 enum class ImageNormalizationMode {
   kneg1to1,     // Values are in the range: -1 and 1.
@@ -114,11 +116,14 @@ Tensor readPngImageAndPreprocess(llvm::StringRef filename,
 /// \param imageNormMode normalize values to this range.
 /// \param imageChannelOrder the order of color channels.
 /// \param imageLayout the order of dimensions (channel, height, and width).
+/// \param pool if not null, the images are decoded and preprocessed
+/// concurrently on this thread pool.
 void loadImagesAndPreprocess(const llvm::ArrayRef<std::string> &filenames,
                              Tensor *inputImageData,
                              ImageNormalizationMode imageNormMode,
                              ImageChannelOrder imageChannelOrder,
-                             ImageLayout imageLayout);
+                             ImageLayout imageLayout,
+                             ThreadPool *pool = nullptr);
 } // namespace glow
 
 #endif // GLOW_BASE_IMAGE_H
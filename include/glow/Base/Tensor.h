@@ -140,6 +140,34 @@ public:
         std::fill(&data[i * width], scaleOffsetPtr, static_cast<uint8_t>(zero));
       }
     } break;
+    case ElemKind::UInt4FusedQTy: {
+      assert(dims().size() == 2 && "Fused tensor must be 2-dimensional.");
+      assert(dims()[1] > 8 && "Fused tensor must have more than 8 columns.");
+      const size_t width = dims()[1];
+      auto *data = reinterpret_cast<uint8_t *>(getData());
+      for (size_t i = 0, e = dims()[0]; i < e; i++) {
+        uint8_t *scaleOffsetPtr = &data[(i + 1) * width] - 2 * sizeof(float);
+        float scale, offset;
+        if (resetFusedScalesOffsets) {
+          scale = 1.0;
+          offset = 0.0;
+          memcpy(scaleOffsetPtr, &scale, sizeof(float));
+          memcpy(scaleOffsetPtr + sizeof(float), &offset, sizeof(float));
+        } else {
+          memcpy(&scale, scaleOffsetPtr, sizeof(float));
+          memcpy(&offset, scaleOffsetPtr + sizeof(float), sizeof(float));
+        }
+        assert(scale != 0.0 &&
+               "Disallow scale = 0.0 for UInt4FusedQTy; causes div by zero.");
+        // Every byte holds two 4-bit values, so replicate the zero point into
+        // both nibbles.
+        float zero = nearbyintf(-offset / scale);
+        uint8_t packed =
+            static_cast<uint8_t>(std::max(0.0f, std::min(15.0f, zero)));
+        std::fill(&data[i * width], scaleOffsetPtr,
+                  static_cast<uint8_t>(packed | (packed << 4)));
+      }
+    } break;
     default:
       // Non-quantized tensors are set to 0.
       std::fill(&getData()[0], &getData()[0] + size() * type_.getElementSize(),
@@ -208,8 +236,8 @@ public:
 
   /// Initialize the content of the tensor using the \p init method. The value
   /// \p val is the initialization parameter. \p PRNG is used to generate random
-  /// numbers. Note that if the tensor's kind is UInt8FusedQTy, then the fused
-  /// scaled/offsets will not be modified.
+  /// numbers. Note that if the tensor's kind is UInt8FusedQTy or
+  /// UInt4FusedQTy, then the fused scaled/offsets will not be modified.
   void init(InitKind init, float val, PseudoRNG &PRNG);
 
   /// \returns unowned tensor using the same data buffer as the current tensor
@@ -291,7 +319,7 @@ public:
     assert(size() > 0 && "Tensors must always have positive size.");
     size_t count = size() * type_.getElementSize();
     data_ = reinterpret_cast<char *>(alignedAlloc(count, TensorAlignment));
-    zero(getElementType() == ElemKind::UInt8FusedQTy);
+    zero(isFusedQuantizedElemKind(getElementType()));
   }
 
   ~Tensor() {
@@ -326,12 +354,18 @@ public:
     // UInt8FusedQTy. While it is possible for an Int8QTy tensor to equal a
     // UInt8FusedQTy tensor if the UInt8FusedQTy tensor has the same
     // scale/offset on all of its rows, and that scale/offset match that of the
-    // Int8QTy, we do not support checking this for now.
+    // Int8QTy, we do not support checking this for now. The same holds for
+    // UInt4FusedQTy.
     assert(((getElementType() == ElemKind::UInt8FusedQTy &&
              other.getElementType() == ElemKind::UInt8FusedQTy) ||
             (getElementType() != ElemKind::UInt8FusedQTy &&
              other.getElementType() != ElemKind::UInt8FusedQTy)) &&
            "UInt8FusedQTy only supports comparing against same ElemKind.");
+    assert(((getElementType() == ElemKind::UInt4FusedQTy &&
+             other.getElementType() == ElemKind::UInt4FusedQTy) ||
+            (getElementType() != ElemKind::UInt4FusedQTy &&
+             other.getElementType() != ElemKind::UInt4FusedQTy)) &&
+           "UInt4FusedQTy only supports comparing against same ElemKind.");
 
     switch (getElementType()) {
     case ElemKind::FloatTy:
@@ -365,6 +399,8 @@ public:
       // scale/offset do not match.
     case ElemKind::UInt8FusedQTy:
       return isEqualImpl<uint8_t>(other, allowedError);
+    case ElemKind::UInt4FusedQTy:
+      return isEqualImpl<uint8_t>(other, allowedError);
     case ElemKind::BoolTy:
       return isEqualImpl<bool>(other, allowedError);
     }
@@ -742,9 +778,10 @@ public:
   /// \p allowedError represents the delta from zero that is allowed before
   /// returning false.
   bool isZero(float allowedError = 0.0) const {
-    if (getElementType() == ElemKind::UInt8FusedQTy) {
+    if (isFusedQuantizedElemKind(getElementType())) {
       assert(dims().size() == 2 && "Fused tensor must be 2-dimensional.");
       assert(dims()[1] > 8 && "Fused tensor must have more than 8 columns.");
+      const bool is4Bit = getElementType() == ElemKind::UInt4FusedQTy;
       const size_t width = dims()[1];
       auto *data = reinterpret_cast<uint8_t *>(tensor_->getUnsafePtr());
       for (size_t i = 0, e = dims()[0]; i < e; i++) {
@@ -753,8 +790,10 @@ public:
         memcpy(&scale, scaleOffsetPtr, sizeof(float));
         memcpy(&offset, scaleOffsetPtr + sizeof(float), sizeof(float));
         for (size_t j = 0, e = width - 2 * sizeof(float); j < e; j++) {
-          float currVal = (at({i, j}) * scale) + offset;
-          if (std::abs(currVal) > allowedError) {
+          uint8_t byte = at({i, j});
+          float lo = ((is4Bit ? (byte & 0x0F) : byte) * scale) + offset;
+          float hi = is4Bit ? ((byte >> 4) * scale) + offset : 0.0f;
+          if (std::abs(lo) > allowedError || std::abs(hi) > allowedError) {
             return false;
           }
         }
@@ -830,6 +869,17 @@ public:
       }
       return;
     }
+    case ElemKind::UInt4FusedQTy: {
+      assert(dims().size() == 2 && "Fused tensor must be 2-dimensional.");
+      assert(dims()[1] > 8 && "Fused tensor must have more than 8 columns.");
+      assert(low >= 0 && high <= 15 && "4-bit values must be in [0, 15].");
+      for (size_t i = 0, e = dims()[0]; i < e; i++) {
+        for (size_t j = 0, f = dims()[1] - 8; j < f; j++) {
+          at({i, j}) = dist(PRNG) | (dist(PRNG) << 4);
+        }
+      }
+      return;
+    }
     }
   }
 
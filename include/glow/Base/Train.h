@@ -26,13 +26,28 @@ namespace glow {
 
 class Tensor;
 
+/// The algorithms that update the weights of the network during training.
+enum class OptimizerKind {
+  /// Stochastic gradient descent, with momentum when the momentum is not zero.
+  SGD,
+  /// Adam, as described in: Kingma and Ba [2014]
+  /// "Adam: A Method for Stochastic Optimization".
+  Adam,
+};
+
 /// This is a list of parameters that the network trainers (such as sgd and
 /// adam) use for training the network.
 struct TrainingConfig {
+  OptimizerKind optimizer{OptimizerKind::SGD};
   float L1Decay{0};
   float L2Decay{0};
   float learningRate{0.01f};
   float momentum{0.0};
+  /// The decay rates of the first and second moment estimates of Adam.
+  float beta1{0.9f};
+  float beta2{0.999f};
+  /// The term that Adam adds to the denominator for numerical stability.
+  float epsilon{1e-8f};
   unsigned batchSize{1};
 };
 
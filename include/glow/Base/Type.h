@@ -266,13 +266,21 @@ enum class ElemKind : unsigned char {
   Int32ITy,      // 32-bit index type (int32_t)
   Int64ITy,      // 64-bit index type (int64_t)
   UInt8FusedQTy, // 8-bit quantized type with fused scale/offset (uint8_t)
+  UInt4FusedQTy, // 4-bit quantized type with fused scale/offset (uint8_t)
   BoolTy,        // Bool type (bool)
 };
 
 /// \returns whether \p e is a quantized ElemKind.
 inline bool isQuantizedElemKind(ElemKind e) {
   return e == ElemKind::Int8QTy || e == ElemKind::Int16QTy ||
-         e == ElemKind::Int32QTy || e == ElemKind::UInt8FusedQTy;
+         e == ElemKind::Int32QTy || e == ElemKind::UInt8FusedQTy ||
+         e == ElemKind::UInt4FusedQTy;
+}
+
+/// \returns whether \p e is a fused rowwise-quantized ElemKind, i.e. one that
+/// stores a float scale and offset at the end of every row.
+inline bool isFusedQuantizedElemKind(ElemKind e) {
+  return e == ElemKind::UInt8FusedQTy || e == ElemKind::UInt4FusedQTy;
 }
 
 /// A class that represents a type of a tensor.
@@ -443,6 +451,8 @@ struct Type final {
       return std::is_same<ElemTy, int64_t>::value;
     case ElemKind::UInt8FusedQTy:
       return std::is_same<ElemTy, uint8_t>::value;
+    case ElemKind::UInt4FusedQTy:
+      return std::is_same<ElemTy, uint8_t>::value;
     case ElemKind::BoolTy:
       return std::is_same<ElemTy, bool>::value;
     }
@@ -484,6 +494,8 @@ struct Type final {
       return sizeof(int64_t);
     case ElemKind::UInt8FusedQTy:
       return sizeof(uint8_t);
+    case ElemKind::UInt4FusedQTy:
+      return sizeof(uint8_t);
     case ElemKind::BoolTy:
       return sizeof(bool);
     }
@@ -498,8 +510,8 @@ struct Type final {
   /// \return the textual name of the element \p Ty.
   static llvm::StringRef getElementName(ElemKind Ty) {
     static const char *names[] = {
-        "float",   "float16", "i8",       "i16",  "i32",
-        "index32", "index64", "ui8fused", "bool",
+        "float",   "float16",  "i8",       "i16",      "i32",
+        "index32", "index64",  "ui8fused", "ui4fused", "bool",
     };
     return names[(int)Ty];
   }
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_EXECUTIONENGINE_DATAPARALLELTRAINER_H
+#define GLOW_EXECUTIONENGINE_DATAPARALLELTRAINER_H
+
+#include "glow/Backends/Backend.h"
+#include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/DeviceManager.h"
+#include "glow/Backends/ExecutionContext.h"
+#include "glow/Base/Train.h"
+#include "glow/Graph/Graph.h"
+#include "glow/Graph/PlaceholderBindings.h"
+#include "glow/Support/ThreadPool.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <memory>
+#include <vector>
+
+namespace glow {
+
+/// Trains a Function data-parallel on several devices. Every device runs a
+/// replica of the gradient Function of the network on its own minibatch. The
+/// gradients of the replicas are summed on the host (all-reduce), and the
+/// SGD update is applied once to the weights, which all the replicas share.
+/// The host splits the all-reduce and the update into chunks of the weights,
+/// which a pool of threads processes in parallel.
+///
+/// A step over N devices with minibatches of size B is equivalent to a step
+/// over one minibatch of size N * B, including the L1 and L2 decay.
+class DataParallelTrainer final {
+  /// A trainable Placeholder of the network.
+  struct Weight {
+    /// The weight.
+    Placeholder *weight;
+    /// The tensor of the weight, which all the replicas read.
+    Tensor *tensor;
+    /// The Placeholder into which the replicas save the gradient of weight.
+    Placeholder *grad;
+    /// The accumulated update, used with momentum.
+    Tensor gsum;
+  };
+
+  /// The backend that compiles the replicas.
+  std::unique_ptr<Backend> backend_;
+
+  /// The backend that evaluates the subgraphs that only depend on Constants
+  /// when the gradient Function is optimized.
+  std::unique_ptr<Backend> constantFoldingBackend_;
+
+  /// One device per replica.
+  std::vector<std::unique_ptr<runtime::DeviceManager>> devices_;
+
+  /// The compiled replicas, one per device.
+  std::vector<std::unique_ptr<CompiledFunction>> replicas_;
+
+  /// The name of the gradient Function.
+  std::string name_;
+
+  /// The execution context of each replica. The replicas share the tensors of
+  /// the weights, and have their own tensors for all other Placeholders.
+  std::vector<std::unique_ptr<ExecutionContext>> contexts_;
+
+  /// The trainable Placeholders.
+  std::vector<Weight> weights_;
+
+  /// The training parameters.
+  TrainingConfig config_;
+
+  /// The threads that run the all-reduce and the update on the host.
+  ThreadPool pool_;
+
+  /// Removes the replicas from the devices.
+  void clear();
+
+  /// Averages the gradients of the replicas of \p W and applies the SGD
+  /// update to the elements [\p begin, \p end) of its tensor.
+  void update(Weight &W, size_t begin, size_t end);
+
+  /// Runs update on all the weights, in chunks on the threads of pool_, and
+  /// waits for it to finish.
+  void updateAll();
+
+public:
+  /// Creates a trainer that runs on \p numDevices devices of \p backendKind.
+  DataParallelTrainer(BackendKind backendKind, unsigned numDevices);
+
+  ~DataParallelTrainer();
+
+  /// \returns the number of devices, which is the number of minibatches that
+  /// a training step consumes.
+  unsigned getNumDevices() const { return devices_.size(); }
+
+  /// Differentiates \p F with the parameters \p config, and compiles the
+  /// gradient Function on every device. The weights are the trainable
+  /// Placeholders of \p F, which must be allocated in \p bindings. The
+  /// training steps update these tensors.
+  void compile(Function *F, const TrainingConfig &config,
+               PlaceholderBindings &bindings);
+
+  /// Runs one training step. Every replica loads into the Placeholders \p ph
+  /// the minibatch of \p inputs that starts at the sample \p sampleCounter
+  /// plus the replica index times the minibatch size. \p sampleCounter is
+  /// advanced by the number of samples that the step consumed.
+  void trainStep(size_t &sampleCounter, llvm::ArrayRef<Placeholder *> ph,
+                 llvm::ArrayRef<Tensor *> inputs);
+
+  /// \returns the bindings of the replica \p idx.
+  PlaceholderBindings *getReplicaBindings(unsigned idx) {
+    return contexts_[idx]->getPlaceholderBindings();
+  }
+};
+
+/// Runs \p iterations training steps of \p trainer. Every step consumes one
+/// minibatch per device of the slices of \p inputs, starting at the sample
+/// \p sampleCounter, which is updated like in runBatch for the
+/// ExecutionEngine.
+void runBatch(DataParallelTrainer &trainer, size_t iterations,
+              size_t &sampleCounter, llvm::ArrayRef<Placeholder *> ph,
+              llvm::ArrayRef<Tensor *> inputs);
+
+} // namespace glow
+
+#endif // GLOW_EXECUTIONENGINE_DATAPARALLELTRAINER_H
@@ -51,6 +51,10 @@ class ExecutionEngine final {
   /// The device manager for executing compiled funtions.
   std::unique_ptr<runtime::DeviceManager> device_;
 
+  /// The backend that evaluates the subgraphs that only depend on Constants
+  /// at compile time.
+  std::unique_ptr<Backend> constantFoldingBackend_;
+
   /// Glow functions compiled for this ExecutionEngine's backend.
   llvm::StringMap<std::unique_ptr<CompiledFunction>> compiledFunctions_;
 
@@ -59,6 +63,10 @@ class ExecutionEngine final {
   void runInternal(ExecutionContext &context, llvm::StringRef name,
                    CompiledFunction &compiledFunction);
 
+  /// Optimize \p F for the backend with the options \p opts. Constants are
+  /// folded with constantFoldingBackend_ unless \p opts sets another backend.
+  void optimizeFunction(Function *F, const CompilationOptions &opts);
+
 public:
   ExecutionEngine(BackendKind backendKind = BackendKind::Interpreter);
 
@@ -112,6 +120,12 @@ public:
   void compile(CompilationMode mode, Function *F,
                bool clearOtherFunctions = true);
 
+  /// Optimize the Functions \p functions one after another and then compile
+  /// them with the backend in parallel. \p clearOtherFunctions works like in
+  /// the compile method for a single Function.
+  void compile(llvm::ArrayRef<Function *> functions,
+               const CompilationOptions &opts, bool clearOtherFunctions = true);
+
   /// Save a bundle for a standalone execution. This method takes care of
   /// everything when preparing the bundle for saving. There is no need to
   /// invoke the compile method before it.
@@ -27,6 +27,7 @@
 #include "llvm/ADT/ilist_node.h"
 
 #include <list>
+#include <mutex>
 #include <vector>
 
 namespace glow {
@@ -59,6 +60,12 @@ class Module final {
   PlaceholderList placeholders_;
   /// Deterministic PRNG used to initialize weights in this module.
   PseudoRNG PRNG_;
+  /// Guards types_, so that Functions of this module can be compiled in
+  /// parallel.
+  std::mutex typesLock_;
+  /// Guards uniqueVariableNames_, constants_ and placeholders_ when Constants
+  /// and Placeholders are created, erased or looked up by name.
+  mutable std::mutex storageLock_;
 
 public:
   Module() = default;
@@ -76,7 +83,7 @@ public:
   /// Inserts the placeholder node \p ph to the list of variables.
   Placeholder *addPlaceholder(Placeholder *ph);
 
-  /// Return a pointer to a uniqued type \p T.
+  /// Return a pointer to a uniqued type \p T. This method is thread-safe.
   TypeRef uniqueType(const Type &T);
 
   /// Return a pointer to a uniqued type \p T.
@@ -282,6 +289,20 @@ public:
                               unsigned_t kernel, unsigned_t stride,
                               unsigned_t pad, unsigned_t group);
 
+  /// Creates a ChannelwiseQuantizedConvolutionNode with the given \p name
+  /// which convolves the 4D \p input with \p filter and \p bias. \p input,
+  /// \p bias and the result of type \p outTy are quantized in the regular way,
+  /// while the constant \p filter is floating point and will be quantized per
+  /// output channel during node creation time, using \p schema. \p kernels,
+  /// \p strides, \p pads and \p group have the same meaning as in
+  /// \ref createConv().
+  ChannelwiseQuantizedConvolutionNode *createChannelwiseQuantizedConv(
+      llvm::StringRef name, NodeValue input, Constant *filter, NodeValue bias,
+      TypeRef outTy, llvm::ArrayRef<unsigned_t> kernels,
+      llvm::ArrayRef<unsigned_t> strides, llvm::ArrayRef<unsigned_t> pads,
+      unsigned_t group,
+      quantization::Schema schema = quantization::Schema::Asymmetric);
+
   /// Creates a Convolution3DNode with the given \p name which convolves the 5D
   /// \p input with \p filter and \bias. \p kernels defines the size of the
   /// height, width, and depth dimensions of the filters. \p strides defines the
@@ -707,31 +728,31 @@ public:
   /// Creates and \returns a node of \p name, performing the SparseLengthsSum
   /// operation, using fused rowwise quantization for the input \p data wherein
   /// the scales and offsets are fused inline with each row of data. \p data
-  /// must be ElemKind::UInt8FusedQTy. Gathers slices of the outer-most
-  /// dimension of data indexed by the \p indices vector, and then accumulates
-  /// them into len(\p lengths) entries: first Lengths[0] slices are aggregated
-  /// to Result[0], next Lengths[1] slices are aggregated to Result[1], etc.
-  /// I.e. sum(Lengths) must be equal to len(Indices).
+  /// must be ElemKind::UInt8FusedQTy or ElemKind::UInt4FusedQTy. Gathers
+  /// slices of the outer-most dimension of data indexed by the \p indices
+  /// vector, and then accumulates them into len(\p lengths) entries: first
+  /// Lengths[0] slices are aggregated to Result[0], next Lengths[1] slices are
+  /// aggregated to Result[1], etc. I.e. sum(Lengths) must be equal to
+  /// len(Indices).
   FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
   createFusedRowwiseQuantizedSparseLengthsSum(llvm::StringRef name,
                                               Constant *data, NodeValue indices,
                                               NodeValue lengths);
 
   /// Same as \ref createFusedRowwiseQuantizedSparseLengthsSum(), but expects
-  /// float input \p data, which is rowwise-quantized and fused internally.
+  /// float input \p data, which is rowwise-quantized and fused internally
+  /// into \p fusedElemKind.
   FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
-  createFusedRowwiseQuantizedSparseLengthsSum(llvm::StringRef name,
-                                              Tensor &data, NodeValue indices,
-                                              NodeValue lengths);
+  createFusedRowwiseQuantizedSparseLengthsSum(
+      llvm::StringRef name, Tensor &data, NodeValue indices, NodeValue lengths,
+      ElemKind fusedElemKind = ElemKind::UInt8FusedQTy);
 
   /// Same as \ref createFusedRowwiseQuantizedSparseLengthsSum(), but i-th slice
   /// is multiplied by weights[i]. len(weights) must be equal to len(indices).
   FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
-  createFusedRowwiseQuantizedSparseLengthsWeightedSum(llvm::StringRef name,
-                                                      Tensor &data,
-                                                      NodeValue weights,
-                                                      NodeValue indices,
-                                                      NodeValue lengths);
+  createFusedRowwiseQuantizedSparseLengthsWeightedSum(
+      llvm::StringRef name, Tensor &data, NodeValue weights, NodeValue indices,
+      NodeValue lengths, ElemKind fusedElemKind = ElemKind::UInt8FusedQTy);
 
   /// Same as \ref createFusedRowwiseQuantizedSparseLengthsWeightedSum(), but
   /// expects float input \p data, which is rowwise-quantized and fused
@@ -743,6 +764,18 @@ public:
                                                       NodeValue indices,
                                                       NodeValue lengths);
 
+  /// Selects the lookups of a SparseLengthsWeightedSum with \p weights,
+  /// \p indices and \p lengths that go to shard \p shard of a table whose row
+  /// R is row (R / \p numShards) of shard (R % \p numShards). The results
+  /// hold the weights, the shard row indices and the lengths of only these
+  /// lookups, so that a lookup into the shard processes only its own rows.
+  SparseLengthsShardNode *createSparseLengthsShard(llvm::StringRef name,
+                                                   NodeValue weights,
+                                                   NodeValue indices,
+                                                   NodeValue lengths,
+                                                   unsigned_t numShards,
+                                                   unsigned_t shard);
+
   /// Given a vector of segment lengths, calculates offsets of each segment and
   /// packs them next to the lengths. For the input vector of length N the
   /// output is a Nx2 matrix with (offset, lengths) packaged for each segment.
@@ -57,6 +57,13 @@ public:
     return sizeof(uint64_t);
   }
 
+  /// \returns true if input \p idx of \p user reads its floating point
+  /// weights as a plain tensor, so that a bundle saved with
+  /// -bundle-compress-weights may store them as int8 and dequantize them
+  /// right before \p user runs. Scales, offsets and biases, and the inputs
+  /// that IRGen looks up as Constants, must not be compressed.
+  virtual bool isCompressibleWeight(const Node &user, unsigned idx) const;
+
   /// Method that creates the LLVM IR generator. This gives the possibility to
   /// create a backend that inherits from the CPU backend, while providing
   /// a specific version of the LLVM IR generator derived from LLVMIRGen.
@@ -54,6 +54,12 @@ void lower(Function *F, LoweredInfoMap *loweredMap, const Backend *B = nullptr,
 /// Dead code elimination.
 void DCE(Function *F);
 
+/// Evaluate the subgraphs of \p F that only depend on Constants with the
+/// backend \p B, which must run the Functions it compiles on the host, and
+/// replace their results with new Constants. Results with more elements than
+/// -const_fold_max_size are not folded. \returns true if \p F was changed.
+bool constantFold(Function *F, const Backend &B);
+
 /// Convert placeholders in Module \p M to constants based on the values in \p
 /// bindings.  Do not convert any placeholders explicitly listed in \p vars.
 void convertPlaceholdersToConstants(Function *F,
@@ -127,6 +127,16 @@ class Partitioner {
   /// Inititalize the minimal compute time for each op in the function.
   void initOpComputeTime();
 
+  /// Split the data table of every SparseLengthsWeightedSum and
+  /// FusedRowwiseQuantizedSparseLengthsWeightedSum node in the representative
+  /// function whose table takes more than half of \p availableMemory into
+  /// row-wise shards that fit on a device, with at most one shard per device.
+  /// Every shard gets a SparseLengthsShard node that selects the indices it
+  /// owns and a lookup node over only these, and the partial results are
+  /// added together. Tables that fit, and lookups with non-float weights, are
+  /// left alone; they are distributed by the regular partitioning.
+  void shardEmbeddingTables(uint64_t availableMemory);
+
   /// Combine the partitions if necessary : if all outside uses of the nodes in
   /// partition1 is in partition2, and the sum of memory consumption of
   /// partition1 and partition2 is less than availableMemory, combine partition1
@@ -154,6 +164,19 @@ class Partitioner {
   /// Given the node-function mapping, do the actual partitioning.
   void doPartitioning(Function *F, NodeToFunctionMap &mapping);
 
+  /// \returns the distinct backends of the devices, in the order of the
+  /// devices.
+  std::vector<BackendKind> getBackendKinds() const;
+
+  /// Split \p F into sub-functions that each run on one of the backends \p
+  /// kinds, and add the DAG of the sub-functions to partitions_. Every node
+  /// goes to the first backend that supports it. A connected group of nodes
+  /// whose neighbors all run on another backend that supports it moves there
+  /// when it computes too little to pay for its transfers. All the
+  /// sub-functions of a backend are assigned to the same logical device.
+  llvm::Error partitionByBackend(Function *F,
+                                 llvm::ArrayRef<BackendKind> kinds);
+
 public:
   /// \p parent is the module which contains the functions need to be divided.
   /// Here we assume that all the functions in one module belong to a same
@@ -258,10 +258,13 @@ void tensorRowwiseQuantization(const Tensor &input, Tensor &output,
 /// Fused-rowwise quantize the tensor \p input. Scales and offsets are generated
 /// from each row of \p input. \p output is tensor of the same shape as input
 /// but with 8 extra columns for storing fused scales (4 bytes (columns) for
-/// float) and offset (4 bytes (columns) for int32_t).
+/// float) and offset (4 bytes (columns) for int32_t). If \p output is
+/// UInt4FusedQTy then two 4-bit values are packed in every byte (low nibble
+/// first), so the data part of each output row is half as wide as the input.
 /// \pre input.dims().size() == 2
 /// \pre output.dims().size() == 2
-/// \pre input.dims()[1] + 8 == output.dims()[1]
+/// \pre input.dims()[1] + 8 == output.dims()[1] for UInt8FusedQTy
+/// \pre input.dims()[1] / 2 + 8 == output.dims()[1] for UInt4FusedQTy
 void tensorFusedRowwiseQuantization(const Tensor &input, Tensor &output);
 
 } // namespace quantization
@@ -45,6 +45,10 @@ struct QuantizationConfiguration {
   /// Whether to use rowwise quantization when quantizing a Function.
   bool enableRowwise{false};
 
+  /// Whether to use channelwise quantization for the filters of convolutions
+  /// when quantizing a Function.
+  bool enableChannelwise{false};
+
   /// New name for the quantized function. If no name is given then
   /// \ref quantizeFunction() will generate a name.
   std::string newFuncName{""};
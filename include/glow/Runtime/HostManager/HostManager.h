@@ -19,10 +19,14 @@
 #include "glow/Backends/DeviceManager.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Runtime/RuntimeTypes.h"
+#include "glow/Support/Histogram.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +37,24 @@ class Executor;
 
 class Provisioner;
 
+/// Runtime metrics of a network served by the HostManager. They are updated
+/// without locks while requests run and can be read at any time.
+struct NetworkMetrics {
+  /// Number of requests accepted for the network.
+  std::atomic<uint64_t> requestCount{0};
+  /// Number of accepted requests that finished with an error.
+  std::atomic<uint64_t> failedRequestCount{0};
+  /// Number of requests refused because too many requests were active.
+  std::atomic<uint64_t> refusedRequestCount{0};
+  /// Time in microseconds each request waited in DeviceManager queues.
+  Histogram queueWaitUs;
+  /// Time in microseconds each request executed on devices.
+  Histogram deviceTimeUs;
+  /// Time in microseconds from runNetwork() to the result callback of each
+  /// request.
+  Histogram latencyUs;
+};
+
 /// The HostManager serves as an entry point into the Runtime environment. It
 /// provides an interface to add, run, and evict networks from the host. It
 /// handles DeviceManager initialization, houses the Executor, and calls into
@@ -45,6 +67,9 @@ class HostManager final {
     // Module that was used to create this network. Everything except
     // placeholders and types have been removed from it.
     std::shared_ptr<Module> module;
+    /// Runtime metrics of the network. Shared with the requests in flight, so
+    /// that they outlive the removal of the network.
+    std::shared_ptr<NetworkMetrics> metrics;
   };
 
   /// Count of current in-flight networks being run. Atomic to allow
@@ -76,15 +101,31 @@ class HostManager final {
   std::unique_ptr<Executor> executor_;
 
   /// Backend pointer. This allows the HostManager to optimize functions before
-  /// they are passed to the Partitioner. It is just one since we are currently
-  /// assuming a homogenous set of devices. This may get moved into the
-  /// Partitioner at a later point.
+  /// they are passed to the Partitioner. This is the backend of the first
+  /// device. When the devices have different backends, the Partitioner prefers
+  /// it, and only places the nodes it does not support on the other backends.
+  /// This may get moved into the Partitioner at a later point.
   std::unique_ptr<Backend> backend_;
 
+  /// The backend that evaluates the subgraphs that only depend on Constants
+  /// when the functions are optimized.
+  std::unique_ptr<Backend> constantFoldingBackend_;
+
   /// The provisioner owns the compiledFunctions and handles loading functions
   /// onto the devices.
   std::unique_ptr<Provisioner> provisioner_;
 
+  /// Thread dumping the metrics periodically, see startMetricsDump().
+  std::thread metricsDumpThread_;
+
+  /// Set to stop metricsDumpThread_.
+  bool stopMetricsDump_{false};
+
+  /// Mutex and condition variable to wake up metricsDumpThread_ when it has to
+  /// stop.
+  std::mutex metricsDumpMtx_;
+  std::condition_variable metricsDumpCV_;
+
 public:
   /// Adds the network to the host and does the necessary setup work. This
   /// includes partitioning, provisioning, compiling and initializing
@@ -117,6 +158,28 @@ public:
   RunIdentifierTy runNetwork(llvm::StringRef networkName,
                              std::unique_ptr<ExecutionContext> context,
                              ResultCBTy callback);
+
+  /// \returns the runtime metrics of \p networkName, or nullptr if there is no
+  /// such network. The metrics are updated live as requests complete.
+  std::shared_ptr<const NetworkMetrics>
+  getNetworkMetrics(llvm::StringRef networkName);
+
+  /// \returns the memory in bytes in use on each device.
+  std::map<DeviceIDTy, uint64_t> getDeviceMemoryUsage() const;
+
+  /// Dump the metrics of all networks and the memory and load of all devices
+  /// as a JSON object to \p os.
+  void dumpMetrics(llvm::raw_ostream &os);
+
+  /// Start a background thread which calls \p dumpCB with the output of
+  /// dumpMetrics() every \p interval, until stopMetricsDump() is called or the
+  /// HostManager is destroyed. Replaces any previously started dump.
+  void startMetricsDump(std::chrono::milliseconds interval,
+                        std::function<void(llvm::StringRef)> dumpCB);
+
+  /// Stop the periodic dump started by startMetricsDump(), if any.
+  void stopMetricsDump();
+
   HostManager(std::vector<std::unique_ptr<DeviceConfig>> configs);
 
   /// Initialize the HostManager with the given \p configs creating one
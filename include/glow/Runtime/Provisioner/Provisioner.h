@@ -43,9 +43,9 @@ public:
   void removeFunction(llvm::StringRef name);
 
 private:
-  /// Pointer to backend used for compilation. This currently gets reset per
-  /// device to ensure the correct backed per device.
-  std::unique_ptr<Backend> backend_;
+  /// The backends used for compilation, one per backend of the devices. Every
+  /// network is compiled by the backend of its DAGNode.
+  std::map<BackendKind, std::unique_ptr<Backend>> backends_;
 
   /// Map of compiledFunction unique pointers. This maintains ownership of the
   /// functions.
@@ -60,6 +60,9 @@ struct DeviceInfo {
   float peakSramBw;
   /// Peak ingress/egress PCI-E bandwidth from device in bytes/second.
   float peakPCIeBw;
+  /// Backend of the device. When the devices have different backends, the
+  /// Partitioner places every node on a backend that supports it.
+  BackendKind backendKind{BackendKind::Interpreter};
 };
 
 /// Individual Node in the DAG for a given network. This contains all the
@@ -78,19 +81,18 @@ struct DAGNode {
   /// indicates the network should be duplicated.
   std::vector<DeviceIDTy> logicalDevices;
   /// Index of the current deviceID in deviceIDs. This is used by the Executor
-  /// when picking a device to request a network run.
+  /// to rotate between equally loaded devices when picking a device to request
+  /// a network run.
   unsigned currentDeviceIdx{0};
   /// Name assigned to the sub-network, this is the id that will be passed to
   /// the DeviceManager when requesting a run of the network.
   std::string name;
+  /// Backend the sub-network is compiled for. The Provisioner only assigns it
+  /// to devices of this backend.
+  BackendKind backendKind{BackendKind::Interpreter};
   /// Runtime bundle containing all the symbol information for this network at
   /// runtime.
   std::unique_ptr<RuntimeBundle> runtimeBundle;
-
-  DeviceIDTy getNextDevice() {
-    currentDeviceIdx++;
-    return deviceIDs[currentDeviceIdx % deviceIDs.size()];
-  }
 };
 
 /// This struct represents a DAG. The first element is the root of a DAG, and
@@ -113,6 +115,12 @@ using DAGListTy = std::vector<DAG>;
 class DeviceConfig {
   const BackendKind backendKind_;
   std::string name_;
+  /// Host cores that the threads of the device run on. Empty if they can run
+  /// on any core.
+  std::vector<unsigned> cores_;
+  /// NUMA node that the host memory of the device comes from, or -1 if it
+  /// comes from wherever it is first touched.
+  int numaNode_{-1};
 
 public:
   DeviceConfig(BackendKind kind) : backendKind_(kind) {}
@@ -124,6 +132,18 @@ public:
   llvm::StringRef getName() const { return name_; }
   bool hasName() const { return name_ != ""; }
   void setName(llvm::StringRef name) { name_ = name; }
+
+  /// Pin the threads of the device to the host \p cores. This applies to the
+  /// devices driven by host threads, like the CPU.
+  void setCores(std::vector<unsigned> cores) { cores_ = std::move(cores); }
+  const std::vector<unsigned> &getCores() const { return cores_; }
+
+  /// Allocate the host memory of the device, like the constants and the
+  /// activations of the CPU, on the NUMA node \p node. Unless setCores() is
+  /// used, the threads of the device run on the cores of the node.
+  void setNUMANode(unsigned node) { numaNode_ = node; }
+  bool hasNUMANode() const { return numaNode_ >= 0; }
+  unsigned getNUMANode() const { return numaNode_; }
 };
 
 } // namespace runtime
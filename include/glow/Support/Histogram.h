@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_HISTOGRAM_H
+#define GLOW_SUPPORT_HISTOGRAM_H
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace glow {
+
+/// A histogram of non-negative integer samples, such as latencies in
+/// microseconds, in the style of HDR histograms. Buckets are log-linear: every
+/// power of two range is split into kSubBuckets equal buckets, so any value is
+/// reported with a relative error below 1/kSubBuckets, with a fixed footprint
+/// and no configuration. Recording and reading are lock-free and may happen
+/// concurrently from any number of threads; a read that races with writes may
+/// miss the samples being recorded.
+class Histogram {
+public:
+  /// Number of buckets each power of two range is split into.
+  static constexpr unsigned kSubBucketBits = 4;
+  static constexpr unsigned kSubBuckets = 1u << kSubBucketBits;
+  /// Values below kSubBuckets get one bucket each; every power of two above
+  /// gets kSubBuckets buckets.
+  static constexpr unsigned kNumBuckets =
+      (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  Histogram() { reset(); }
+
+  Histogram(const Histogram &) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+
+  /// Record one sample of \p value.
+  void record(uint64_t value) {
+    buckets_[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(
+                              max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  /// Forget all recorded samples.
+  void reset();
+
+  /// \returns the number of recorded samples.
+  uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+
+  /// \returns the sum of all recorded samples.
+  uint64_t getSum() const { return sum_.load(std::memory_order_relaxed); }
+
+  /// \returns the largest recorded sample, or zero if there is none.
+  uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+
+  /// \returns the mean of the recorded samples, or zero if there is none.
+  double getMean() const;
+
+  /// \returns the smallest value such that \p percentile percent of the
+  /// samples are at most that value, up to the bucket precision. \p percentile
+  /// is in [0, 100]. \returns zero if there are no samples.
+  uint64_t getPercentile(double percentile) const;
+
+  /// Dump count, mean, max and the main percentiles as a JSON object to \p os.
+  void dumpJSON(llvm::raw_ostream &os) const;
+
+  /// \returns the index of the bucket that \p value is counted in.
+  static unsigned getBucketIndex(uint64_t value);
+
+  /// \returns the largest value that is counted in bucket \p index.
+  static uint64_t getBucketMaxValue(unsigned index);
+
+private:
+  /// Number of samples in each bucket.
+  std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+  /// Total number of samples.
+  std::atomic<uint64_t> count_;
+  /// Sum of all samples.
+  std::atomic<uint64_t> sum_;
+  /// Largest sample.
+  std::atomic<uint64_t> max_;
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_HISTOGRAM_H
@@ -57,6 +57,11 @@ public:
   /// threads and has them all run ThreadPool::threadPoolWorkerMain.
   ThreadPool(unsigned numWorkers = kNumWorkers);
 
+  /// Constructor. Initializes a thread pool with \p numWorkers threads, which
+  /// call \p initWorker before they process any work item, for example to pin
+  /// themselves to cores.
+  ThreadPool(unsigned numWorkers, std::function<void()> initWorker);
+
   /// Destructor. Signals to all threads to stop and waits for all of them
   /// to exit.
   ~ThreadPool();
@@ -110,6 +115,19 @@ private:
   /// Vector of worker thread objects.
   std::vector<std::thread> workers_;
 };
+
+/// Pins the calling thread to the host \p cores. \returns false if the host
+/// does not support it or it failed.
+bool pinCurrentThread(const std::vector<unsigned> &cores);
+
+/// Makes the pages that the calling thread touches first come from the NUMA
+/// node \p node, as long as the node has free memory. \returns false if the
+/// host does not support it or it failed.
+bool setCurrentThreadNUMANode(unsigned node);
+
+/// \returns the host cores of the NUMA node \p node, or an empty list if they
+/// are not known.
+std::vector<unsigned> getNUMANodeCores(unsigned node);
 } // namespace glow
 
 #endif // GLOW_SUPPORT_THREADPOOL_H
@@ -19,8 +19,47 @@
 #include "glow/Graph/PlaceholderBindings.h"
 #include "glow/IR/Instrs.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 using namespace glow;
 
+std::vector<std::unique_ptr<CompiledFunction>>
+Backend::compileFunctions(llvm::ArrayRef<Function *> functions,
+                          const CompilationOptions &opts) const {
+  std::vector<std::unique_ptr<CompiledFunction>> compiledFunctions(
+      functions.size());
+  size_t numThreads = opts.maxCompileThreads;
+  if (numThreads == 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  numThreads = std::min(numThreads, functions.size());
+
+  // Every thread compiles the next function that no thread has picked yet.
+  // The graph is only read here, and the Module state that code generation
+  // updates, like the uniqued types, is guarded by the Module.
+  std::atomic<size_t> next{0};
+  auto compileNext = [&]() {
+    for (size_t i = next++; i < functions.size(); i = next++) {
+      compiledFunctions[i] = compile(functions[i], opts);
+    }
+  };
+  if (numThreads <= 1) {
+    compileNext();
+    return compiledFunctions;
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; i++) {
+    threads.emplace_back(compileNext);
+  }
+  compileNext();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return compiledFunctions;
+}
+
 TraceInfo Backend::buildManualTraceInfo(Function *F) const {
   TraceInfo info(false, getTraceEventDataSize());
   const auto &nodes = F->getNodes();
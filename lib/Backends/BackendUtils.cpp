@@ -16,6 +16,8 @@
 #include "glow/Backends/BackendUtils.h"
 #include "glow/IR/Instrs.h"
 
+#include <algorithm>
+
 using namespace glow;
 
 using llvm::cast;
@@ -26,24 +28,21 @@ void glow::runtime::RuntimeBundle::collectConstants(const IRFunction *F) {
   collectConstants(F->getGraph()->getParent());
 }
 
-void glow::runtime::RuntimeBundle::freeConstants() {
-  if (constants_) {
-    glow::alignedFree(constants_);
-    constants_ = nullptr;
-  }
-}
+void glow::runtime::RuntimeBundle::freeConstants() { constants_.reset(); }
+
 void glow::runtime::RuntimeBundle::collectConstants(const Module *M) {
   // At compile time condense constants to a single block of memory.
   // This allows the graph to go away after compile time.
   // If there are no constants return nullptr.
   if (constantWeightVarsMemSize_ == 0) {
-    constants_ = nullptr;
+    constants_.reset();
     return;
   }
 
   assert(constants_ == nullptr && "constants already allocated");
-  constants_ =
-      (uint8_t *)alignedAlloc(constantWeightVarsMemSize_, TensorAlignment);
+  constants_ = std::shared_ptr<uint8_t>(
+      (uint8_t *)alignedAlloc(constantWeightVarsMemSize_, TensorAlignment),
+      glow::alignedFree);
 
   for (const auto &symbol : symbolTable_) {
     llvm::StringRef name = symbol.first;
@@ -58,8 +57,94 @@ void glow::runtime::RuntimeBundle::collectConstants(const Module *M) {
            "Mismatched constant size");
 
     // Copy weight to offset.
-    memcpy(constants_ + info.offset, payload, info.size);
+    memcpy(constants_.get() + info.offset, payload, info.size);
+  }
+}
+
+runtime::ConstantStore::LayoutTy
+runtime::ConstantStore::getLayout(const RuntimeBundle &bundle) {
+  LayoutTy layout;
+  for (const auto &symbol : bundle.getSymbolTable()) {
+    if (symbol.second.symbolCategory != SymbolCategory::Constant) {
+      continue;
+    }
+    layout.emplace_back(symbol.first, symbol.second.offset, symbol.second.size);
+  }
+  std::sort(layout.begin(), layout.end(),
+            [](const LayoutTy::value_type &a, const LayoutTy::value_type &b) {
+              return std::get<1>(a) < std::get<1>(b);
+            });
+  return layout;
+}
+
+bool runtime::ConstantStore::isSameContents(const Entry &entry,
+                                            const RuntimeBundle &bundle,
+                                            const Module *M) {
+  // Only the bytes of the Constants are compared, the padding between them is
+  // not initialized.
+  for (const auto &C : entry.layout) {
+    size_t offset = std::get<1>(C);
+    size_t size = std::get<2>(C);
+    const void *data = nullptr;
+    if (bundle.getConstants()) {
+      data = bundle.getConstants() + offset;
+    } else if (Constant *c = M->getConstantByName(std::get<0>(C))) {
+      data = c->getPayload().getUnsafePtr();
+    }
+    if (!data || memcmp(entry.constants.get() + offset, data, size) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t runtime::ConstantStore::acquire(RuntimeBundle &bundle,
+                                         const Module *M) {
+  size_t size = bundle.getConstantWeightSize();
+  if (size == 0) {
+    return 0;
+  }
+
+  auto layout = getLayout(bundle);
+  for (auto &entry : entries_) {
+    if (entry.size != size || entry.layout != layout ||
+        !isSameContents(entry, bundle, M)) {
+      continue;
+    }
+    // Drop the copy of the bundle, if it has one, and use the shared block.
+    if (bundle.getConstants() != entry.constants.get()) {
+      bundle.setConstants(entry.constants);
+    }
+    entry.users.push_back(&bundle);
+    return 0;
+  }
+
+  if (bundle.getConstants() == nullptr) {
+    bundle.collectConstants(M);
+  }
+  entries_.push_back(
+      {std::move(layout), size, bundle.getSharedConstants(), {&bundle}});
+  size_ += size;
+  return size;
+}
+
+uint64_t runtime::ConstantStore::release(const RuntimeBundle &bundle) {
+  for (auto it = entries_.begin(), e = entries_.end(); it != e; ++it) {
+    auto user = std::find(it->users.begin(), it->users.end(), &bundle);
+    if (user == it->users.end()) {
+      continue;
+    }
+    it->users.erase(user);
+    if (!it->users.empty()) {
+      return 0;
+    }
+    // The bundles keep the block alive until their functions are destroyed.
+    size_t size = it->size;
+    entries_.erase(it);
+    size_ -= size;
+    return size;
   }
+  return 0;
 }
 
 size_t glow::runtime::RuntimeBundle::getValueOffset(const Named *v) const {
@@ -28,6 +28,9 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <mutex>
 
 using namespace glow;
 
@@ -40,6 +43,49 @@ static const unsigned char libjit_bc[] = {
 };
 static const size_t libjit_bc_size = sizeof(libjit_bc);
 
+CPUBackend::CPUBackend(CPUTuningCache *tuningCache)
+    : tuningCache_(tuningCache) {}
+
+void CPUBackend::autotune(llvm::ArrayRef<Function *> functions) const {
+  if (tuningCache_ || !CPUTuningCache::isAutotuneEnabled()) {
+    return;
+  }
+  // Tuning times the kernels, so two tuners must not compete for the cores.
+  // This also keeps concurrent compilations from tuning the same shapes and
+  // writing the cache file at the same time.
+  static std::mutex autotuneLock;
+  std::lock_guard<std::mutex> g(autotuneLock);
+  unsigned tuned = 0;
+  for (const auto *F : functions) {
+    tuned += autotuneCPUKernels(F, CPUTuningCache::getGlobal());
+  }
+  if (tuned && !CPUTuningCache::saveGlobal()) {
+    llvm::errs() << "Could not write the CPU tuning cache\n";
+  }
+}
+
+std::vector<std::unique_ptr<CompiledFunction>>
+CPUBackend::compileFunctions(llvm::ArrayRef<Function *> functions,
+                             const CompilationOptions &opts) const {
+  // Tune every Function before the parallel code generation starts, so that
+  // the timings are not skewed by the other compile threads. The compile()
+  // calls below then find all of their shapes in the cache.
+  autotune(functions);
+  return LLVMBackend::compileFunctions(functions, opts);
+}
+
+std::unique_ptr<CompiledFunction>
+CPUBackend::compile(Function *F, const CompilationOptions &opts) const {
+  autotune(F);
+  return LLVMBackend::compile(F, opts);
+}
+
+void CPUBackend::save(Function *F, llvm::StringRef outputDir,
+                      llvm::StringRef networkName) const {
+  autotune(F);
+  LLVMBackend::save(F, outputDir, networkName);
+}
+
 bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
   // Note: For brevity below, "X ==> Y, Z" signifes that Node X is IRGen'd into
   // Instructions Y and Z.
@@ -112,6 +158,14 @@ bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
   case Kinded::Kind::LengthsToRangesNodeKind:
     return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::Int32ITy});
 
+  case Kinded::Kind::SparseLengthsShardNodeKind:
+    return (NI.getInElemTy(SparseLengthsShardNode::WeightsIdx) ==
+            ElemKind::FloatTy) &&
+           (NI.getInElemTy(SparseLengthsShardNode::IndicesIdx) ==
+            ElemKind::Int64ITy) &&
+           (NI.getInElemTy(SparseLengthsShardNode::LengthsIdx) ==
+            ElemKind::Int32ITy);
+
   case Kinded::Kind::IntLookupTableNodeKind:
   case Kinded::Kind::RescaleQuantizedNodeKind:
     return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::Int8QTy});
@@ -121,11 +175,15 @@ bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
   case Kinded::Kind::MaxPoolGradNodeKind:
   case Kinded::Kind::QuantizationProfileNodeKind:
   case Kinded::Kind::CPUConvDKKC8NodeKind:
+  case Kinded::Kind::CPUGroupConvNodeKind:
   case Kinded::Kind::LocalResponseNormalizationNodeKind:
   case Kinded::Kind::LocalResponseNormalizationGradNodeKind:
   case Kinded::Kind::LogNodeKind:
   case Kinded::Kind::TanhNodeKind:
   case Kinded::Kind::SigmoidNodeKind:
+  case Kinded::Kind::SGDNodeKind:
+  case Kinded::Kind::MomentumSGDNodeKind:
+  case Kinded::Kind::AdamNodeKind:
     return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::FloatTy});
 
   case Kinded::Kind::ConvolutionNodeKind:
@@ -137,6 +195,30 @@ bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
                                                   {ConvolutionNode::BiasIdx}) &&
            (NI.getInElemTy(ConvolutionNode::BiasIdx) == ElemKind::Int32QTy);
 
+  case Kinded::Kind::CPUDepthwiseConvNodeKind:
+    if (!NI.getInTy(CPUDepthwiseConvNode::InputIdx)->isQuantizedType()) {
+      return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::FloatTy});
+    }
+
+    return NI.allInputsAndOutputsHaveSameElemKind(
+               {ElemKind::Int8QTy}, {CPUDepthwiseConvNode::BiasIdx}) &&
+           (NI.getInElemTy(CPUDepthwiseConvNode::BiasIdx) ==
+            ElemKind::Int32QTy);
+
+  case Kinded::Kind::ChannelwiseQuantizedConvolutionNodeKind:
+    return (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::InputIdx) ==
+            ElemKind::Int8QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::FilterIdx) ==
+            ElemKind::Int8QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::BiasIdx) ==
+            ElemKind::Int32QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::ScalesIdx) ==
+            ElemKind::FloatTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::OffsetsIdx) ==
+            ElemKind::Int32ITy) &&
+           (NI.getOutElemTy(ChannelwiseQuantizedConvolutionNode::ResultIdx) ==
+            ElemKind::Int8QTy);
+
   case Kinded::Kind::BatchedAddNodeKind:
     if (!NI.getInTy(BatchedAddNode::BatchIdx)->isQuantizedType()) {
       return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::FloatTy});
@@ -228,9 +310,8 @@ bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
            (NI.getInElemTy(LengthsSumNode::LengthsIdx) == ElemKind::Int32ITy);
 
   case Kinded::Kind::FusedRowwiseQuantizedSparseLengthsWeightedSumNodeKind:
-    return (NI.getInElemTy(
-                FusedRowwiseQuantizedSparseLengthsWeightedSumNode::DataIdx) ==
-            ElemKind::UInt8FusedQTy) &&
+    return isFusedQuantizedElemKind(NI.getInElemTy(
+               FusedRowwiseQuantizedSparseLengthsWeightedSumNode::DataIdx)) &&
            (NI.getInElemTy(FusedRowwiseQuantizedSparseLengthsWeightedSumNode::
                                WeightsIdx) == ElemKind::FloatTy) &&
            (NI.getInElemTy(FusedRowwiseQuantizedSparseLengthsWeightedSumNode::
@@ -291,9 +372,31 @@ bool CPUBackend::isOpSupported(const NodeInfo &NI) const {
 }
 
 bool CPUBackend::shouldLower(const Node *N) const {
-  if (N->getKind() == Kinded::Kind::ConvolutionNodeKind)
+  switch (N->getKind()) {
+  case Kinded::Kind::ConvolutionNodeKind:
+  // The optimizers update the weights with fused, single pass kernels.
+  case Kinded::Kind::SGDNodeKind:
+  case Kinded::Kind::MomentumSGDNodeKind:
+  case Kinded::Kind::AdamNodeKind:
     return false;
-  return true;
+  default:
+    return true;
+  }
+}
+
+bool CPUBackend::isCompressibleWeight(const Node &user, unsigned idx) const {
+  // The filters of the CPU convolutions have been laid out for their kernels
+  // at compile time, and are read as plain tensors.
+  switch (user.getKind()) {
+  case Kinded::Kind::CPUConvDKKC8NodeKind:
+    return idx == CPUConvDKKC8Node::FilterIdx;
+  case Kinded::Kind::CPUDepthwiseConvNodeKind:
+    return idx == CPUDepthwiseConvNode::FilterIdx;
+  case Kinded::Kind::CPUGroupConvNodeKind:
+    return idx == CPUGroupConvNode::FilterIdx;
+  default:
+    return LLVMBackend::isCompressibleWeight(user, idx);
+  }
 }
 
 std::unique_ptr<CompiledFunction> CPUBackend::createCompiledFunction(
@@ -305,8 +408,8 @@ std::unique_ptr<CompiledFunction> CPUBackend::createCompiledFunction(
 std::unique_ptr<LLVMIRGen>
 CPUBackend::createIRGen(const IRFunction *IR,
                         AllocationsInfo &allocationsInfo) const {
-  CPULLVMIRGen *irgen =
-      new CPULLVMIRGen(IR, allocationsInfo, "", getLibjitBitcode());
+  CPULLVMIRGen *irgen = new CPULLVMIRGen(IR, allocationsInfo, "",
+                                         getLibjitBitcode(), &getTuningCache());
   return std::unique_ptr<CPULLVMIRGen>(irgen);
 }
 
@@ -16,6 +16,8 @@
 #ifndef GLOW_BACKENDS_CPU_CPUBACKEND_H
 #define GLOW_BACKENDS_CPU_CPUBACKEND_H
 
+#include "CPUTuningCache.h"
+
 #include "glow/Backends/Backend.h"
 #include "glow/Base/Tensor.h"
 #include "glow/LLVMIRCodeGen/LLVMBackend.h"
@@ -28,9 +30,28 @@ namespace glow {
 class NodeInfo;
 
 class CPUBackend : public LLVMBackend {
+  /// The tuned tile sizes of the convolution and matrix multiplication
+  /// kernels, or nullptr to use the global tuning cache.
+  CPUTuningCache *tuningCache_{nullptr};
+
+  /// \returns the tuning cache that code generation takes its tile sizes from.
+  CPUTuningCache &getTuningCache() const {
+    return tuningCache_ ? *tuningCache_ : CPUTuningCache::getGlobal();
+  }
+
+  /// Tune the shapes of \p functions that are missing from the global tuning
+  /// cache if -cpu-autotune is set, and save the cache if anything was tuned.
+  /// Only one tuner runs at a time in the process.
+  void autotune(llvm::ArrayRef<Function *> functions) const;
+
 public:
+  /// Create a backend that uses the global tuning cache.
   CPUBackend() = default;
 
+  /// Create a backend that takes its tile sizes from \p tuningCache and never
+  /// autotunes. This is used to time the candidate tilings.
+  explicit CPUBackend(CPUTuningCache *tuningCache);
+
   /// @name Backend methods.
   /// This is the implementation of the Backend interface.
   ///@{
@@ -45,12 +66,25 @@ public:
   bool isOpSupported(const NodeInfo &NI) const override;
 
   bool shouldLower(const Node *N) const override;
+
+  std::unique_ptr<CompiledFunction>
+  compile(Function *F, const CompilationOptions &opts) const override;
+
+  std::vector<std::unique_ptr<CompiledFunction>>
+  compileFunctions(llvm::ArrayRef<Function *> functions,
+                   const CompilationOptions &opts) const override;
+
+  void save(Function *F, llvm::StringRef outputDir,
+            llvm::StringRef networkName) const override;
   /// @}
 
 public:
   /// @name LLVMBackend methods.
   /// This is the implementation of the LLVMBackend interface.
   ///@{
+  virtual bool isCompressibleWeight(const Node &user,
+                                    unsigned idx) const override;
+
   virtual std::unique_ptr<LLVMIRGen>
   createIRGen(const IRFunction *IR,
               AllocationsInfo &allocationsInfo) const override;
@@ -19,6 +19,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+
 static llvm::cl::OptionCategory CPUBackendCat("Glow CPU Backend Options");
 llvm::cl::opt<unsigned>
     cpuMaxMem("cpu-memory", llvm::cl::desc("CPU DeviceManager maximum memory"),
@@ -49,6 +51,15 @@ bool CPUDeviceManager::isMemoryAvailable(uint64_t estimate) const {
   return maxMemoryBytes_ >= (usedMemoryBytes_ + estimate);
 }
 
+void CPUDeviceManager::updateUsedMemory() {
+  runMemoryBytes_ = 0;
+  for (const auto &func : functions_) {
+    runMemoryBytes_ = std::max<uint64_t>(
+        runMemoryBytes_, func.second->getRuntimeBundle().getRunMemorySize());
+  }
+  usedMemoryBytes_ = constants_.getSize() + runMemoryBytes_;
+}
+
 void CPUDeviceManager::addNetworkImpl(const Module *module,
                                       FunctionMapTy functions,
                                       ReadyCBTy readyCB) {
@@ -77,7 +88,21 @@ void CPUDeviceManager::addNetworkImpl(const Module *module,
     }
   }
 
-  if (usedMemoryBytes_ + functionCost_ > maxMemoryBytes_) {
+  // Acquire the constants. The functions that use weights already on the
+  // device share them, so only new weights cost memory. The constants are
+  // copied on the device thread, so they come from the NUMA node of the
+  // device.
+  uint64_t runBytes = runMemoryBytes_;
+  for (const auto &func : functions) {
+    auto &bundle = func.second->getRuntimeBundle();
+    constants_.acquire(bundle, module);
+    runBytes = std::max<uint64_t>(runBytes, bundle.getRunMemorySize());
+  }
+
+  if (constants_.getSize() + runBytes > maxMemoryBytes_) {
+    for (const auto &func : functions) {
+      constants_.release(func.second->getRuntimeBundle());
+    }
     readyCB(module, MAKE_ERR(GlowErr::ErrorCode::RUNTIME_OUT_OF_DEVICE_MEMORY,
                              "Failed to add network: not enough memory"));
     return;
@@ -85,12 +110,9 @@ void CPUDeviceManager::addNetworkImpl(const Module *module,
 
   // Add to the function name lookup map.
   for (const auto &func : functions) {
-    if (func.second->getRuntimeBundle().getConstants() == nullptr) {
-      func.second->getRuntimeBundle().collectConstants(module);
-    }
     functions_.emplace(func.first, func.second);
-    usedMemoryBytes_ += functionCost_; // TODO:: static moduleSize
   }
+  updateUsedMemory();
 
   assert(usedMemoryBytes_ <= maxMemoryBytes_);
 
@@ -102,8 +124,11 @@ void CPUDeviceManager::evictNetworkImpl(std::string functionName,
                                         EvictFunctionCBTy evictCB) {
   llvm::Error err = llvm::Error::success();
 
-  if (functions_.erase(functionName)) {
-    usedMemoryBytes_ -= functionCost_; // TODO: static moduleSize
+  auto funcIt = functions_.find(functionName);
+  if (funcIt != functions_.end()) {
+    constants_.release(funcIt->second->getRuntimeBundle());
+    functions_.erase(funcIt);
+    updateUsedMemory();
   } else {
     err =
         MAKE_ERR(GlowErr::ErrorCode::RUNTIME_NET_NOT_FOUND,
@@ -16,6 +16,7 @@
 #ifndef GLOW_BACKENDS_CPU_CPUDEVICEMANAGER_H
 #define GLOW_BACKENDS_CPU_CPUDEVICEMANAGER_H
 
+#include "glow/Backends/BackendUtils.h"
 #include "glow/Backends/QueueBackedDeviceManager.h"
 
 namespace glow {
@@ -32,12 +33,20 @@ class CPUDeviceManager : public QueueBackedDeviceManager {
   /// constant.
   uint64_t maxMemoryBytes_{0};
 
-  /// Amount of memory used by all models.
+  /// Amount of memory used by all models, the constants plus the memory of
+  /// a run.
   uint64_t usedMemoryBytes_{0};
 
-  /// Static memory cost of the CPU Function.
-  /// This is very arbitrary for the CPU backend.
-  const uint64_t functionCost_{1};
+  /// The constants of the functions, shared by the functions with the same
+  /// weights.
+  ConstantStore constants_;
+
+  /// Memory allocated by a run. The runs are executed one at a time, so this
+  /// is the run memory of the largest function.
+  uint64_t runMemoryBytes_{0};
+
+  /// Recomputes the memory used by the functions on the device.
+  void updateUsedMemory();
 
 public:
   CPUDeviceManager(std::unique_ptr<DeviceConfig> config = nullptr,
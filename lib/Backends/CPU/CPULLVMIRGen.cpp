@@ -15,6 +15,7 @@
  */
 
 #include "CPULLVMIRGen.h"
+#include "CPUTuningCache.h"
 
 #include "glow/IR/Instrs.h"
 #include "glow/LLVMIRCodeGen/LLVMBackend.h"
@@ -25,8 +26,10 @@ using llvm::cast;
 
 CPULLVMIRGen::CPULLVMIRGen(const IRFunction *F,
                            AllocationsInfo &allocationsInfo,
-                           std::string mainEntryName, llvm::StringRef libjitBC)
-    : LLVMIRGen(F, allocationsInfo, mainEntryName, libjitBC) {}
+                           std::string mainEntryName, llvm::StringRef libjitBC,
+                           const CPUTuningCache *tuningCache)
+    : LLVMIRGen(F, allocationsInfo, mainEntryName, libjitBC),
+      tuningCache_(tuningCache) {}
 
 void CPULLVMIRGen::generateLLVMIRForModule(llvm::IRBuilder<> &builder) {
   // TODO: Add here any backend specific logic.
@@ -62,44 +65,19 @@ void CPULLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     auto *pads = emitConstSizeTArray(builder, CI->getPads());
     auto *group = emitConstSizeT(builder, CI->getGroup());
 
-    size_t inChannels = src->dims()[3];
-    size_t outChannels = dest->dims()[3];
-
-    // Select a method for iterating on the image in the pixel (filter-first, or
-    // input-first). Perform convolutions with a high channel count by scanning
-    // the input image multiple times, once for each filter entry. Scan images
-    // with a low channel count by scanning the image once because the filter
-    // scan will fall in the cache.
-    bool pixelScanFirst = (inChannels < 16);
-
-    // The number of float8 registers that we use to process the depth channel.
-    unsigned numDepthRegs = (pixelScanFirst ? 8 : 2);
-    // The number of y pixels to process at once.
-    unsigned sizeGroupY = (pixelScanFirst ? 1 : 5);
-
-    // When producing output pixels process this many times of depth-strips,
-    // where each chunk is float8 * numDepthRegs. This is a form of tiling. It's
-    // profitable to scan multiple depth-strips of the filter if the scanned
-    // memory fits in the cahce and does not get evicted before the next
-    // iteration. By increasing the number strips (and using more cache memory)
-    // we reduce the number of times that we iterate over the input. However, we
-    // also increase the pressure on the cache that has to store the filter so
-    // we can't process too many strips at once.
-    unsigned depthStrips = 1;
-    unsigned stripSize = 8 * numDepthRegs * inChannels;
-    unsigned tileSize = 16384;
-    // Increase the number of strips until we reach the output-tensor depth size
-    // or until we exceed some threashold.
-    while (2 * depthStrips * stripSize <= tileSize &&
-           2 * depthStrips * numDepthRegs * 8 <= outChannels / CI->getGroup() &&
-           depthStrips < 8) {
-      depthStrips *= 2;
+    // Use the tiling that the autotuner picked for this shape, if any, and
+    // otherwise the default heuristic. See getDefaultConvDKKC8Tiling.
+    ConvDKKC8Tiling tiling;
+    if (!tuningCache_ ||
+        !tuningCache_->lookup(CPUTuningCache::getKey(CI), tiling)) {
+      tiling = getDefaultConvDKKC8Tiling(src->dims()[3],
+                                         dest->dims()[3] / CI->getGroup());
     }
 
-    auto *pixelScanFirstVal = emitConstI32(builder, pixelScanFirst);
-    auto *numDepthRegsVal = emitConstI32(builder, numDepthRegs);
-    auto *sizeGroupYVal = emitConstI32(builder, sizeGroupY);
-    auto *depthStripsVal = emitConstI32(builder, depthStrips);
+    auto *pixelScanFirstVal = emitConstI32(builder, tiling.pixelScanFirst);
+    auto *numDepthRegsVal = emitConstI32(builder, tiling.numDepthRegs);
+    auto *sizeGroupYVal = emitConstI32(builder, tiling.sizeGroupY);
+    auto *depthStripsVal = emitConstI32(builder, tiling.depthStrips);
 
     const char *kernelName = "convDKKC8";
     auto *F = getFunction(kernelName, dest->getElementType());
@@ -111,6 +89,127 @@ void CPULLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
                 depthStripsVal});
     break;
   }
+  case Kinded::Kind::CPUDepthwiseConvInstKind: {
+    auto *CI = cast<CPUDepthwiseConvInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernels = emitConstSizeTArray(builder, CI->getKernels());
+    auto *strides = emitConstSizeTArray(builder, CI->getStrides());
+    auto *pads = emitConstSizeTArray(builder, CI->getPads());
+
+    auto *F = getFunction("depthwise_conv", dest->getElementType());
+
+    if (!src->getType()->isQuantizedType()) {
+      createCall(builder, F,
+                 {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                  filterDims, biasDims, kernels, strides, pads});
+      break;
+    }
+
+    auto *destTy = dest->getType();
+    auto *srcTy = src->getType();
+    auto *filterTy = filter->getType();
+    auto *biasTy = bias->getType();
+
+    auto *destOffset = emitConstI32(builder, destTy->getOffset());
+    auto *srcOffset = emitConstI32(builder, srcTy->getOffset());
+    auto *filterOffset = emitConstI32(builder, filterTy->getOffset());
+    auto *biasOffset = emitConstI32(builder, biasTy->getOffset());
+
+    // Calculate the scale of the values that come out of the products of the
+    // input and the filter.
+    float matMulScale = srcTy->getScale() * filterTy->getScale();
+
+    // Calculate the scaling parameters for the bias and output.
+    auto biasScaleParam = quantization::quantizeScaleOffset32To8(
+        biasTy->getScale() / matMulScale, biasTy->getOffset());
+    auto outScaleParam = quantization::quantizeScaleOffset32To8(
+        matMulScale / destTy->getScale(), 0);
+
+    auto *biasPre = emitConstI32(builder, biasScaleParam.pre);
+    auto *biasPost = emitConstI32(builder, biasScaleParam.post);
+    auto *biasScale = emitConstI32(builder, biasScaleParam.scale);
+    auto *outPre = emitConstI32(builder, outScaleParam.pre);
+    auto *outPost = emitConstI32(builder, outScaleParam.post);
+    auto *outScale = emitConstI32(builder, outScaleParam.scale);
+
+    createCall(builder, F,
+               {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                filterDims, biasDims, kernels, strides, pads, destOffset,
+                srcOffset, filterOffset, biasOffset, biasPre, biasPost,
+                biasScale, outPre, outPost, outScale});
+    break;
+  }
+  case Kinded::Kind::CPUGroupConvInstKind: {
+    auto *CI = cast<CPUGroupConvInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernels = emitConstSizeTArray(builder, CI->getKernels());
+    auto *strides = emitConstSizeTArray(builder, CI->getStrides());
+    auto *pads = emitConstSizeTArray(builder, CI->getPads());
+    auto *group = emitConstSizeT(builder, CI->getGroup());
+
+    auto *F = getFunction("group_conv", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                filterDims, biasDims, kernels, strides, pads, group});
+    break;
+  }
+  case Kinded::Kind::MatMulInstKind: {
+    auto *MM = cast<MatMulInst>(I);
+    auto *dest = MM->getDest();
+    MatMulTiling tiling;
+    // Quantized and untuned matrix multiplications use the default libjit
+    // kernel call.
+    if (dest->getElementType() != ElemKind::FloatTy || !tuningCache_ ||
+        !tuningCache_->lookup(CPUTuningCache::getKey(MM), tiling)) {
+      LLVMIRGen::generateLLVMIRForInstr(builder, I);
+      break;
+    }
+    auto *lhs = MM->getLHS();
+    auto *rhs = MM->getRHS();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *lhsPtr = emitValueAddress(builder, lhs);
+    auto *rhsPtr = emitValueAddress(builder, rhs);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *lhsDims = emitValueDims(builder, lhs);
+    auto *rhsDims = emitValueDims(builder, rhs);
+
+    // The tile sizes are constants, so the call is specialized for them.
+    auto *mcBlock = emitConstSizeT(builder, tiling.mcBlock);
+    auto *kcBlock = emitConstSizeT(builder, tiling.kcBlock);
+
+    auto *F = getFunction("matmul", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, lhsPtr, rhsPtr, destDims, lhsDims, rhsDims, mcBlock,
+                kcBlock});
+    break;
+  }
   default:
     LLVMIRGen::generateLLVMIRForInstr(builder, I);
   }
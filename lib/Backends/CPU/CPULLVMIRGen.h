@@ -20,16 +20,23 @@
 
 namespace glow {
 
+class CPUTuningCache;
+
 /// This is a class containing a common logic for the generation of the LLVM IR
 /// from an IRFunction. The primary clients of this class are JITs and bundlers.
 class CPULLVMIRGen : public LLVMIRGen {
+  /// The tuned tile sizes of the kernels, or nullptr to always use the default
+  /// heuristics.
+  const CPUTuningCache *tuningCache_;
 
 public:
   /// Destructor
   virtual ~CPULLVMIRGen() = default;
-  /// Ctor.
+  /// Ctor. The tile sizes of the convolution and matrix multiplication kernels
+  /// are looked up in \p tuningCache, if given.
   explicit CPULLVMIRGen(const IRFunction *M, AllocationsInfo &allocationsInfo,
-                        std::string mainEntryName, llvm::StringRef libjitBC);
+                        std::string mainEntryName, llvm::StringRef libjitBC,
+                        const CPUTuningCache *tuningCache = nullptr);
 
   /// Emit LLVM-IR for the instruction \p I, using the builder \p builder.
   virtual void generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
@@ -0,0 +1,471 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CPUTuningCache.h"
+#include "CPUBackend.h"
+
+#include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
+#include "glow/Graph/Graph.h"
+#include "glow/Graph/Nodes.h"
+#include "glow/IR/Instrs.h"
+#include "glow/Support/Debug.h"
+#include "glow/Support/Random.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#define DEBUG_TYPE "cpu-autotune"
+
+using namespace glow;
+using llvm::dyn_cast;
+
+static llvm::cl::OptionCategory
+    CPUTuningCat("Glow CPU Backend Autotuning Options");
+
+static llvm::cl::opt<bool> cpuAutotune(
+    "cpu-autotune",
+    llvm::cl::desc("Benchmark candidate tile sizes of the CPU convolution and "
+                   "matrix multiplication kernels for every shape that is "
+                   "compiled and not in the tuning cache yet"),
+    llvm::cl::init(false), llvm::cl::cat(CPUTuningCat));
+
+static llvm::cl::opt<std::string> cpuTuningCache(
+    "cpu-tuning-cache",
+    llvm::cl::desc("File that the CPU backend loads its tuned tile sizes "
+                   "from, and that -cpu-autotune stores new results into"),
+    llvm::cl::value_desc("file.txt"), llvm::cl::init(""),
+    llvm::cl::cat(CPUTuningCat));
+
+static llvm::cl::opt<unsigned> cpuAutotuneRuns(
+    "cpu-autotune-runs",
+    llvm::cl::desc("Number of timed runs of every candidate tiling"),
+    llvm::cl::init(3), llvm::cl::cat(CPUTuningCat));
+
+/// The largest number of floats in a packed block of the left-hand side of a
+/// matrix multiplication (256 KB).
+static constexpr unsigned maxMatMulBlockSize = 65536;
+
+/// Append \p dims to \p key, separated by 'x'.
+template <typename T>
+static void appendDims(std::string &key, llvm::ArrayRef<T> dims) {
+  key += '_';
+  for (size_t i = 0, e = dims.size(); i < e; i++) {
+    key += (i ? "x" : "") + std::to_string(dims[i]);
+  }
+}
+
+/// \returns the shape key of a convDKKC8 with the given operand dimensions
+/// and parameters.
+static std::string
+getConvDKKC8Key(llvm::ArrayRef<size_t> destDims, llvm::ArrayRef<size_t> srcDims,
+                llvm::ArrayRef<size_t> filterDims,
+                llvm::ArrayRef<unsigned_t> kernels,
+                llvm::ArrayRef<unsigned_t> strides,
+                llvm::ArrayRef<unsigned_t> pads, unsigned_t group) {
+  std::string key = "convDKKC8_f";
+  appendDims(key, destDims);
+  appendDims(key, srcDims);
+  appendDims(key, filterDims);
+  appendDims(key, kernels);
+  appendDims(key, strides);
+  appendDims(key, pads);
+  key += "_" + std::to_string(group);
+  return key;
+}
+
+/// \returns the shape key of a matmul with the given operand dimensions.
+static std::string getMatMulKey(llvm::ArrayRef<size_t> destDims,
+                                llvm::ArrayRef<size_t> lhsDims,
+                                llvm::ArrayRef<size_t> rhsDims) {
+  std::string key = "matmul_f";
+  appendDims(key, destDims);
+  appendDims(key, lhsDims);
+  appendDims(key, rhsDims);
+  return key;
+}
+
+std::string CPUTuningCache::getKey(const CPUConvDKKC8Inst *CI) {
+  return getConvDKKC8Key(CI->getDest()->dims(), CI->getSrc()->dims(),
+                         CI->getFilter()->dims(), CI->getKernels(),
+                         CI->getStrides(), CI->getPads(), CI->getGroup());
+}
+
+std::string CPUTuningCache::getKey(const CPUConvDKKC8Node *CN) {
+  return getConvDKKC8Key(CN->getResult().dims(), CN->getInput().dims(),
+                         CN->getFilter().dims(), CN->getKernels(),
+                         CN->getStrides(), CN->getPads(), CN->getGroup());
+}
+
+std::string CPUTuningCache::getKey(const MatMulInst *MM) {
+  return getMatMulKey(MM->getDest()->dims(), MM->getLHS()->dims(),
+                      MM->getRHS()->dims());
+}
+
+std::string CPUTuningCache::getKey(const MatMulNode *MN) {
+  return getMatMulKey(MN->getResult().dims(), MN->getLHS().dims(),
+                      MN->getRHS().dims());
+}
+
+CPUTuningCache &CPUTuningCache::getGlobal() {
+  static CPUTuningCache *cache = [] {
+    auto *cache = new CPUTuningCache();
+    if (!cpuTuningCache.empty() && !cache->load(cpuTuningCache)) {
+      DEBUG_GLOW(llvm::dbgs() << "Starting a new tuning cache "
+                              << cpuTuningCache << "\n");
+    }
+    return cache;
+  }();
+  return *cache;
+}
+
+bool CPUTuningCache::isAutotuneEnabled() { return cpuAutotune; }
+
+bool CPUTuningCache::saveGlobal() {
+  if (cpuTuningCache.empty()) {
+    return true;
+  }
+  return getGlobal().save(cpuTuningCache);
+}
+
+bool CPUTuningCache::lookupValues(const std::string &key, size_t size,
+                                  std::vector<unsigned> &values) const {
+  std::lock_guard<std::mutex> g(lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.size() != size) {
+    return false;
+  }
+  values = it->second;
+  return true;
+}
+
+void CPUTuningCache::insertValues(const std::string &key,
+                                  llvm::ArrayRef<unsigned> values) {
+  std::lock_guard<std::mutex> g(lock_);
+  entries_[key] = values.vec();
+}
+
+bool CPUTuningCache::lookup(const std::string &key,
+                            ConvDKKC8Tiling &tiling) const {
+  std::vector<unsigned> values;
+  if (!lookupValues(key, 4, values)) {
+    return false;
+  }
+  // Reject entries the kernel can't run, e.g. from an edited cache file. The
+  // output channels of each group are a multiple of 64, so they are a
+  // multiple of the float8 registers as long as their number divides 8.
+  unsigned numDepthRegs = values[1];
+  if (values[0] > 1 || !numDepthRegs || 8 % numDepthRegs || !values[2] ||
+      !values[3]) {
+    return false;
+  }
+  tiling = {values[0], values[1], values[2], values[3]};
+  return true;
+}
+
+bool CPUTuningCache::lookup(const std::string &key,
+                            MatMulTiling &tiling) const {
+  std::vector<unsigned> values;
+  if (!lookupValues(key, 2, values)) {
+    return false;
+  }
+  // libjit packs the mcBlock x kcBlock blocks of the left-hand side on the
+  // stack.
+  if (!values[0] || !values[1] || values[0] * values[1] > maxMatMulBlockSize) {
+    return false;
+  }
+  tiling = {values[0], values[1]};
+  return true;
+}
+
+void CPUTuningCache::insert(const std::string &key,
+                            const ConvDKKC8Tiling &tiling) {
+  insertValues(key, {tiling.pixelScanFirst, tiling.numDepthRegs,
+                     tiling.sizeGroupY, tiling.depthStrips});
+}
+
+void CPUTuningCache::insert(const std::string &key,
+                            const MatMulTiling &tiling) {
+  insertValues(key, {tiling.mcBlock, tiling.kcBlock});
+}
+
+size_t CPUTuningCache::size() const {
+  std::lock_guard<std::mutex> g(lock_);
+  return entries_.size();
+}
+
+bool CPUTuningCache::load(llvm::StringRef filename) {
+  std::ifstream file(filename.str());
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    if (!(fields >> key) || key[0] == '#') {
+      continue;
+    }
+    std::vector<unsigned> values;
+    unsigned value;
+    while (fields >> value) {
+      values.push_back(value);
+    }
+    insertValues(key, values);
+  }
+  return true;
+}
+
+bool CPUTuningCache::save(llvm::StringRef filename) const {
+  std::lock_guard<std::mutex> g(lock_);
+  // Write a temporary file next to the cache and rename it over the cache, so
+  // that concurrent saves, also from other processes, never leave a truncated
+  // or interleaved file behind.
+  int fd;
+  llvm::SmallString<128> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(filename + ".%%%%%%.tmp", fd, tmpPath)) {
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream file(fd, /* shouldClose */ true);
+    file << "# Glow CPU backend tuning cache: <shape> <tile sizes>...\n";
+    for (const auto &entry : entries_) {
+      file << entry.first;
+      for (auto value : entry.second) {
+        file << ' ' << value;
+      }
+      file << '\n';
+    }
+    file.close();
+    if (file.has_error()) {
+      file.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(tmpPath, filename)) {
+    llvm::sys::fs::remove(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+ConvDKKC8Tiling glow::getDefaultConvDKKC8Tiling(size_t inChannels,
+                                                size_t outChannelsPerGroup) {
+  // Select a method for iterating on the image in the pixel (filter-first, or
+  // input-first). Perform convolutions with a high channel count by scanning
+  // the input image multiple times, once for each filter entry. Scan images
+  // with a low channel count by scanning the image once because the filter
+  // scan will fall in the cache.
+  bool pixelScanFirst = (inChannels < 16);
+
+  // The number of float8 registers that we use to process the depth channel.
+  unsigned numDepthRegs = (pixelScanFirst ? 8 : 2);
+  // The number of y pixels to process at once.
+  unsigned sizeGroupY = (pixelScanFirst ? 1 : 5);
+
+  // When producing output pixels process this many times of depth-strips,
+  // where each chunk is float8 * numDepthRegs. This is a form of tiling. It's
+  // profitable to scan multiple depth-strips of the filter if the scanned
+  // memory fits in the cahce and does not get evicted before the next
+  // iteration. By increasing the number strips (and using more cache memory)
+  // we reduce the number of times that we iterate over the input. However, we
+  // also increase the pressure on the cache that has to store the filter so
+  // we can't process too many strips at once.
+  unsigned depthStrips = 1;
+  unsigned stripSize = 8 * numDepthRegs * inChannels;
+  unsigned tileSize = 16384;
+  // Increase the number of strips until we reach the output-tensor depth size
+  // or until we exceed some threashold.
+  while (2 * depthStrips * stripSize <= tileSize &&
+         2 * depthStrips * numDepthRegs * 8 <= outChannelsPerGroup &&
+         depthStrips < 8) {
+    depthStrips *= 2;
+  }
+  return {pixelScanFirst, numDepthRegs, sizeGroupY, depthStrips};
+}
+
+/// \returns the best time in seconds of cpuAutotuneRuns runs of \p F, which is
+/// compiled by a CPU backend that takes its tile sizes from \p candidate.
+static double timeCandidate(Function *F, CPUTuningCache &candidate) {
+  CPUBackend backend(&candidate);
+  CompilationOptions opts;
+  auto function = backend.compile(F, opts);
+
+  ExecutionContext context;
+  auto *bindings = context.getPlaceholderBindings();
+  PseudoRNG PRNG;
+  for (auto *PH : F->getParent()->getPlaceholders()) {
+    bindings->allocate(PH)->getHandle().randomize(-1.0, 1.0, PRNG);
+  }
+
+  function->setupRuns();
+  function->beforeRun(*bindings);
+  // The first run warms up the caches and is not timed.
+  function->execute(&context);
+  double best = std::numeric_limits<double>::max();
+  for (unsigned i = 0, e = std::max(1u, unsigned(cpuAutotuneRuns)); i < e;
+       i++) {
+    auto start = std::chrono::steady_clock::now();
+    function->execute(&context);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  function->afterRun(*bindings);
+  function->tearDownRuns();
+  return best;
+}
+
+/// Tune the tile sizes of \p CN, whose shape key is \p key, and store the
+/// fastest tiling in \p cache.
+static void tuneConvDKKC8(const CPUConvDKKC8Node *CN, const std::string &key,
+                          CPUTuningCache &cache) {
+  // Build a function that computes just this convolution.
+  Module mod;
+  Function *F = mod.createFunction("tune_convDKKC8");
+  PseudoRNG PRNG;
+  auto *input = mod.createPlaceholder(CN->getInput().getType(), "input",
+                                      /* isTrainable */ false);
+  auto *filter = mod.createConstant(CN->getFilter().getType(), "filter");
+  filter->getPayload().getHandle().randomize(-1.0, 1.0, PRNG);
+  auto *bias = mod.createConstant(CN->getBias().getType(), "bias");
+  bias->getPayload().getHandle().randomize(-1.0, 1.0, PRNG);
+  auto *conv = F->addNode(new CPUConvDKKC8Node(
+      "conv", mod.uniqueType(*CN->getResult().getType()), input, filter, bias,
+      CN->getKernels(), CN->getStrides(), CN->getPads(), CN->getGroup()));
+  F->createSave("save", conv);
+
+  size_t inChannels = CN->getInput().dims()[3];
+  size_t outChannelsPerGroup = CN->getResult().dims()[3] / CN->getGroup();
+
+  // The default heuristic is the first candidate, so that tuning never picks
+  // a slower tiling because of noise between equally fast candidates.
+  std::vector<ConvDKKC8Tiling> candidates = {
+      getDefaultConvDKKC8Tiling(inChannels, outChannelsPerGroup)};
+  for (unsigned pixelScanFirst : {0, 1}) {
+    for (unsigned numDepthRegs : {2, 4, 8}) {
+      // Pixel-first scanning processes one y pixel at a time.
+      for (unsigned sizeGroupY : {1, 3, 5}) {
+        if (pixelScanFirst && sizeGroupY != 1) {
+          continue;
+        }
+        for (unsigned depthStrips : {1, 2, 4}) {
+          if (8 * numDepthRegs * depthStrips > outChannelsPerGroup) {
+            continue;
+          }
+          candidates.push_back(
+              {pixelScanFirst, numDepthRegs, sizeGroupY, depthStrips});
+        }
+      }
+    }
+  }
+
+  ConvDKKC8Tiling best = candidates[0];
+  double bestTime = std::numeric_limits<double>::max();
+  for (const auto &tiling : candidates) {
+    CPUTuningCache candidate;
+    candidate.insert(key, tiling);
+    double time = timeCandidate(F, candidate);
+    DEBUG_GLOW(llvm::dbgs()
+               << key << " " << tiling.pixelScanFirst << " "
+               << tiling.numDepthRegs << " " << tiling.sizeGroupY << " "
+               << tiling.depthStrips << ": " << time << "s\n");
+    if (time < bestTime) {
+      bestTime = time;
+      best = tiling;
+    }
+  }
+  cache.insert(key, best);
+}
+
+/// Tune the cache blocking of \p MN, whose shape key is \p key, and store the
+/// fastest tiling in \p cache.
+static void tuneMatMul(const MatMulNode *MN, const std::string &key,
+                       CPUTuningCache &cache) {
+  // Build a function that computes just this matrix multiplication.
+  Module mod;
+  Function *F = mod.createFunction("tune_matmul");
+  auto *lhs = mod.createPlaceholder(MN->getLHS().getType(), "lhs",
+                                    /* isTrainable */ false);
+  auto *rhs = mod.createPlaceholder(MN->getRHS().getType(), "rhs",
+                                    /* isTrainable */ false);
+  auto *matmul = F->createMatMul(
+      "matmul", mod.uniqueType(*MN->getResult().getType()), lhs, rhs);
+  F->createSave("save", matmul);
+
+  // The libjit defaults are 256 and 128 and are the first candidate.
+  std::vector<MatMulTiling> candidates = {{256, 128}};
+  for (unsigned mcBlock : {64, 128, 256, 512}) {
+    for (unsigned kcBlock : {64, 128, 256}) {
+      if (mcBlock * kcBlock <= maxMatMulBlockSize &&
+          !(mcBlock == 256 && kcBlock == 128)) {
+        candidates.push_back({mcBlock, kcBlock});
+      }
+    }
+  }
+
+  MatMulTiling best = candidates[0];
+  double bestTime = std::numeric_limits<double>::max();
+  for (const auto &tiling : candidates) {
+    CPUTuningCache candidate;
+    candidate.insert(key, tiling);
+    double time = timeCandidate(F, candidate);
+    DEBUG_GLOW(llvm::dbgs() << key << " " << tiling.mcBlock << " "
+                            << tiling.kcBlock << ": " << time << "s\n");
+    if (time < bestTime) {
+      bestTime = time;
+      best = tiling;
+    }
+  }
+  cache.insert(key, best);
+}
+
+unsigned glow::autotuneCPUKernels(const Function *F, CPUTuningCache &cache) {
+  unsigned tuned = 0;
+  for (const auto &node : F->getNodes()) {
+    if (const auto *CN = dyn_cast<CPUConvDKKC8Node>(&node)) {
+      auto key = CPUTuningCache::getKey(CN);
+      ConvDKKC8Tiling tiling;
+      if (!cache.lookup(key, tiling)) {
+        tuneConvDKKC8(CN, key, cache);
+        tuned++;
+      }
+      continue;
+    }
+    if (const auto *MN = dyn_cast<MatMulNode>(&node)) {
+      if (MN->getResult().getElementType() != ElemKind::FloatTy) {
+        continue;
+      }
+      auto key = CPUTuningCache::getKey(MN);
+      MatMulTiling tiling;
+      if (!cache.lookup(key, tiling)) {
+        tuneMatMul(MN, key, cache);
+        tuned++;
+      }
+    }
+  }
+  return tuned;
+}
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_BACKENDS_CPU_CPUTUNINGCACHE_H
+#define GLOW_BACKENDS_CPU_CPUTUNINGCACHE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace glow {
+
+class CPUConvDKKC8Inst;
+class CPUConvDKKC8Node;
+class Function;
+class MatMulInst;
+class MatMulNode;
+
+/// Tile configuration of libjit_convDKKC8_f. See CPULLVMIRGen for the meaning
+/// of the fields.
+struct ConvDKKC8Tiling {
+  unsigned pixelScanFirst;
+  unsigned numDepthRegs;
+  unsigned sizeGroupY;
+  unsigned depthStrips;
+};
+
+/// Tile configuration of libjit_matmul_f, i.e. the cache blocking of the
+/// left-hand side of the column-major product.
+struct MatMulTiling {
+  unsigned mcBlock;
+  unsigned kcBlock;
+};
+
+/// A thread-safe map from kernel shapes to the tile configurations that the
+/// autotuner measured to be the fastest for them. The cache can be stored in
+/// a text file with one entry per line, "<shape key> <value>...", so that the
+/// tuning results are reused by later compilations.
+class CPUTuningCache {
+  /// Maps shape keys to the tile configuration values.
+  std::map<std::string, std::vector<unsigned>> entries_;
+  /// Protects entries_.
+  mutable std::mutex lock_;
+
+  /// \returns the values stored for \p key in \p values, or false if there is
+  /// no entry of \p size values for \p key.
+  bool lookupValues(const std::string &key, size_t size,
+                    std::vector<unsigned> &values) const;
+
+  /// Store \p values for \p key.
+  void insertValues(const std::string &key, llvm::ArrayRef<unsigned> values);
+
+public:
+  /// \returns the cache that the CPU backend uses by default. It is loaded
+  /// from the file given by -cpu-tuning-cache, if any, on first use.
+  static CPUTuningCache &getGlobal();
+
+  /// \returns whether -cpu-autotune is set.
+  static bool isAutotuneEnabled();
+
+  /// Write the global cache back to the -cpu-tuning-cache file, if any.
+  /// \returns false if the file could not be written.
+  static bool saveGlobal();
+
+  /// \returns the shape keys of \p CI, \p CN, \p MM and \p MN. An instruction
+  /// and the node it was generated from have the same key.
+  static std::string getKey(const CPUConvDKKC8Inst *CI);
+  static std::string getKey(const CPUConvDKKC8Node *CN);
+  static std::string getKey(const MatMulInst *MM);
+  static std::string getKey(const MatMulNode *MN);
+
+  /// Look up the tile configuration for \p key into \p tiling.
+  /// \returns false if the shape was not tuned.
+  bool lookup(const std::string &key, ConvDKKC8Tiling &tiling) const;
+  bool lookup(const std::string &key, MatMulTiling &tiling) const;
+
+  /// Store \p tiling as the configuration for \p key.
+  void insert(const std::string &key, const ConvDKKC8Tiling &tiling);
+  void insert(const std::string &key, const MatMulTiling &tiling);
+
+  /// \returns the number of tuned shapes.
+  size_t size() const;
+
+  /// Merge the entries of the file \p filename into the cache.
+  /// \returns false if the file could not be read.
+  bool load(llvm::StringRef filename);
+
+  /// Write all entries of the cache to the file \p filename. The file is
+  /// replaced atomically. \returns false if the file could not be written.
+  bool save(llvm::StringRef filename) const;
+};
+
+/// \returns the tiling that the CPU backend uses for a convDKKC8 with
+/// \p inChannels input channels and \p outChannelsPerGroup output channels in
+/// each group when the shape was not tuned.
+ConvDKKC8Tiling getDefaultConvDKKC8Tiling(size_t inChannels,
+                                          size_t outChannelsPerGroup);
+
+/// Benchmark candidate tilings for every convolution and matrix multiplication
+/// shape in \p F that is not in \p cache yet, and store the fastest one in
+/// \p cache. Each candidate is compiled with the CPU backend into a function
+/// that computes just that shape, and is timed over a few runs.
+/// \returns the number of shapes that were tuned.
+unsigned autotuneCPUKernels(const Function *F, CPUTuningCache &cache);
+
+} // namespace glow
+
+#endif // GLOW_BACKENDS_CPU_CPUTUNINGCACHE_H
@@ -79,6 +79,64 @@ static Node *optimizeCPUConv(ConvolutionNode *CN, Function *F) {
       CN->getBias(), CN->getKernels(), CN->getStrides(), CN->getPads(), group));
 }
 
+/// Try to optimize a depthwise Convolution, where every group has a single
+/// input channel, into a CPUDepthwiseConv. Its filter is transposed from the
+/// shape [D, K, K, 1] to [1, K, K, D], so that the filter values of
+/// consecutive channels are next to each other, like in the input and the
+/// output. The transpose of a Constant filter is folded at compile time.
+static Node *optimizeCPUDepthwiseConv(ConvolutionNode *CN, Function *F) {
+  auto group = CN->getGroup();
+  if (group == 1 || group != CN->getInput().dims()[3]) {
+    return nullptr;
+  }
+
+  NodeValue filter = CN->getFilter();
+  auto *filterT = F->createTranspose(filter.getNode()->getName(), filter,
+                                     {3, 1, 2, 0});
+
+  return F->addNode(new CPUDepthwiseConvNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), filterT,
+      CN->getBias(), CN->getKernels(), CN->getStrides(), CN->getPads()));
+}
+
+/// Try to optimize a grouped Convolution into a CPUGroupConv, which computes
+/// blocks of 8 output channels at a time. The output channels of every group
+/// are padded with zero filters to a multiple of 8, and the filter is
+/// transposed from the shape [D, K, K, C] to [G * B, K, K, C, 8], where B is
+/// the number of blocks of a group. This is computed by nodes that constant
+/// folding evaluates at compile time when the filter is a Constant.
+static Node *optimizeCPUGroupConv(ConvolutionNode *CN, Function *F) {
+  auto group = CN->getGroup();
+  NodeValue filter = CN->getFilter();
+
+  // We only support Floats for now.
+  if (group == 1 || filter.getElementType() != ElemKind::FloatTy) {
+    return nullptr;
+  }
+
+  auto dims = filter.dims();
+  assert(dims.size() == 4 && "Invalid filter size");
+  size_t outCperG = dims[0] / group;
+  size_t blocksPerGroup = (outCperG + 7) / 8;
+  auto name = filter.getNode()->getName();
+
+  NodeValue padded = F->createReshape(
+      name, filter, {group, outCperG, dims[1], dims[2], dims[3]});
+  if (size_t pad = blocksPerGroup * 8 - outCperG) {
+    auto *zeroTy = F->getParent()->uniqueType(
+        ElemKind::FloatTy, {group, pad, dims[1], dims[2], dims[3]});
+    auto *zero = F->createSplat(name, zeroTy, 0);
+    padded = F->createConcat(name, {padded, zero}, 1);
+  }
+  auto *blocks = F->createReshape(
+      name, padded, {group * blocksPerGroup, 8, dims[1], dims[2], dims[3]});
+  auto *filterT = F->createTranspose(name, blocks, {0, 2, 3, 4, 1});
+
+  return F->addNode(new CPUGroupConvNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), filterT,
+      CN->getBias(), CN->getKernels(), CN->getStrides(), CN->getPads(), group));
+}
+
 /// Merge Max and Splat nodes into target-specific CPUMaxSplat node.
 /// For quantized network, sinkRescaleQuantizedNode transformation might have
 /// merged Rescale into Max node. In this case we need to pull it out, since
@@ -125,6 +183,16 @@ bool CPUBackend::transformPostLowering(Function *F,
         changed = true;
         continue;
       }
+      if (Node *NCN = optimizeCPUDepthwiseConv(CN, F)) {
+        CN->getResult().replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
+      if (Node *NCN = optimizeCPUGroupConv(CN, F)) {
+        CN->getResult().replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
     }
 
     // Merge Max and Splat nodes into CPUMaxSplat.
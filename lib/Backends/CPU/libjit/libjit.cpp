@@ -684,10 +684,82 @@ static size_t get_bin(size_t nBins, float binWidth, float minValue,
           : MIN(static_cast<size_t>((value - minValue) / binWidth), nBins - 1);
   return result;
 }
+
+/// Number of indices the SLWS kernels look ahead when prefetching rows.
+#define SLWS_PREFETCH_DISTANCE 16
+
+/// Prefetch the \p size bytes of the row at \p row, one cache line at a time.
+static void libjit_prefetch_row(const void *row, size_t size) {
+  const char *ptr = (const char *)row;
+  for (size_t b = 0; b < size; b += 64) {
+    __builtin_prefetch(ptr + b);
+  }
+}
+
+/// \returns the total number of indices covered by the \p segments entries in
+/// \p lengths.
+static size_t libjit_sum_lengths(const int32_t *lengths, size_t segments) {
+  size_t total = 0;
+  for (size_t i = 0; i < segments; i++) {
+    total += lengths[i];
+  }
+  return total;
+}
+
+/// Load the float scale and offset fused at the end of the \p inLineSize byte
+/// row \p row into \p scale and \p offset.
+static void libjit_load_fused_scale_offset(const uint8_t *row,
+                                           size_t inLineSize, float *scale,
+                                           float *offset) {
+  const uint8_t *scaleOffsetPtr = row + inLineSize - 2 * sizeof(float);
+  memcpy(scale, scaleOffsetPtr, sizeof(float));
+  memcpy(offset, scaleOffsetPtr + sizeof(float), sizeof(float));
+}
+
+/// \returns the gradient \p g of the weight \p w with the decay terms
+/// \p L1Decay and \p L2Decay added, divided by the \p batchSize.
+static float libjit_decayed_gradient(float g, float w, float L1Decay,
+                                     float L2Decay, size_t batchSize) {
+  if (L1Decay) {
+    g += L1Decay * (0 <= w ? 1 : -1);
+  }
+  if (L2Decay) {
+    g += L2Decay * w;
+  }
+  if (batchSize > 1) {
+    g /= batchSize;
+  }
+  return g;
+}
+
+/// The parallel-for registered by the client of a bundle, or null if the
+/// kernels should run on the calling thread.
+libjit_parallel_for_fn libjit_parallel_for_impl = nullptr;
+
+/// The context passed to libjit_parallel_for_impl.
+void *libjit_parallel_for_ctx = nullptr;
+
 } // namespace
 
 extern "C" {
 
+/// Register \p fn as the parallel-for used by the kernels, with \p runtimeCtx
+/// as its context. A null \p fn makes the kernels run on the calling thread.
+/// This must not be called while the network is running.
+void libjit_set_parallel_for(libjit_parallel_for_fn fn, void *runtimeCtx) {
+  libjit_parallel_for_impl = fn;
+  libjit_parallel_for_ctx = runtimeCtx;
+}
+
+void libjit_parallel_for(size_t numIters, libjit_parallel_body body,
+                         void *ctx) {
+  if (!libjit_parallel_for_impl || numIters <= 1) {
+    body(ctx, 0, numIters);
+    return;
+  }
+  libjit_parallel_for_impl(libjit_parallel_for_ctx, numIters, body, ctx);
+}
+
 /// Macro to define a mini-kernel for data-parallel operations. The body of the
 /// kernel is auto-generated by the macro.
 /// \p name the name of the kernel
@@ -1076,9 +1148,15 @@ void libjit_sparse_lengths_weighted_sum_f(float *dest, float *data,
                                           int32_t *lengths, size_t segments,
                                           size_t lineSize) {
   memset(dest, 0, segments * lineSize * sizeof(float));
+  const size_t numIndices = libjit_sum_lengths(lengths, segments);
   size_t curIndex = 0;
   for (size_t i = 0; i < segments; i++) {
     for (int32_t j = 0; j < lengths[i]; j++) {
+      if (curIndex + SLWS_PREFETCH_DISTANCE < numIndices) {
+        libjit_prefetch_row(
+            data + indices[curIndex + SLWS_PREFETCH_DISTANCE] * lineSize,
+            lineSize * sizeof(float));
+      }
       float weight = weights[curIndex];
       size_t line = indices[curIndex];
       for (size_t k = 0; k < lineSize; k++) {
@@ -1089,21 +1167,55 @@ void libjit_sparse_lengths_weighted_sum_f(float *dest, float *data,
   }
 }
 
+void libjit_sparse_lengths_shard_f(float *shardWeights, size_t *shardIndices,
+                                   int32_t *shardLengths, const float *weights,
+                                   const size_t *indices,
+                                   const int32_t *lengths, size_t numIndices,
+                                   size_t segments, size_t numShards,
+                                   size_t shard) {
+  memset(shardWeights, 0, numIndices * sizeof(float));
+  memset(shardIndices, 0, numIndices * sizeof(size_t));
+  size_t curIndex = 0;
+  size_t shardIndex = 0;
+  for (size_t i = 0; i < segments; i++) {
+    int32_t shardLength = 0;
+    for (int32_t j = 0; j < lengths[i]; j++, curIndex++) {
+      size_t index = indices[curIndex];
+      if (index % numShards != shard) {
+        continue;
+      }
+      shardWeights[shardIndex] = weights[curIndex];
+      shardIndices[shardIndex] = index / numShards;
+      shardIndex++;
+      shardLength++;
+    }
+    shardLengths[i] = shardLength;
+  }
+}
+
 void libjit_rowwise_quantized_sparse_lengths_weighted_sum_f(
     float *dest, int8_t *data, float *scales, float *offsets, float *weights,
     size_t *indices, int32_t *lengths, size_t segments, size_t lineSize) {
   memset(dest, 0, segments * lineSize * sizeof(float));
+  const size_t numIndices = libjit_sum_lengths(lengths, segments);
   size_t curIndex = 0;
   for (size_t i = 0; i < segments; i++) {
+    float *out = dest + i * lineSize;
     for (int32_t j = 0; j < lengths[i]; j++) {
+      if (curIndex + SLWS_PREFETCH_DISTANCE < numIndices) {
+        libjit_prefetch_row(
+            data + indices[curIndex + SLWS_PREFETCH_DISTANCE] * lineSize,
+            lineSize);
+      }
       const float weight = weights[curIndex];
       const size_t line = indices[curIndex];
-      const float scale = scales[line];
-      const float offset = offsets[line];
+      // Fold the weight into the row scale and offset so that the inner loop
+      // is a single multiply-add per element.
+      const float scale = weight * scales[line];
+      const float offset = weight * offsets[line];
+      const int8_t *row = data + line * lineSize;
       for (size_t k = 0; k < lineSize; k++) {
-        const float fData =
-            (scale * ((uint8_t)(data[line * lineSize + k] + 128))) + offset;
-        dest[i * lineSize + k] += weight * fData;
+        out[k] += scale * (uint8_t)(row[k] + 128) + offset;
       }
       curIndex++;
     }
@@ -1114,20 +1226,76 @@ void libjit_fused_rowwise_quantized_sparse_lengths_weighted_sum_f(
     float *dest, int8_t *data, float *weights, size_t *indices,
     int32_t *lengths, size_t segments, size_t inLineSize, size_t outLineSize) {
   memset(dest, 0, segments * outLineSize * sizeof(float));
+  const uint8_t *udata = (const uint8_t *)data;
+  const size_t numIndices = libjit_sum_lengths(lengths, segments);
   size_t curIndex = 0;
   for (size_t i = 0; i < segments; i++) {
-    for (int32_t j = 0, e = lengths[i]; j < e; j++) {
-      const float weight = weights[curIndex];
-      const size_t line = indices[curIndex];
-      const int8_t *currRowScaleOffsetPtr =
-          data + ((line + 1) * inLineSize) - 2 * sizeof(float);
+    float *out = dest + i * outLineSize;
+    const size_t end = curIndex + lengths[i];
+    // Gather two rows per iteration, so that every load and store of the
+    // output row is shared by two rows.
+    for (; curIndex + 1 < end; curIndex += 2) {
+      for (size_t p = 0; p < 2; p++) {
+        if (curIndex + p + SLWS_PREFETCH_DISTANCE < numIndices) {
+          libjit_prefetch_row(
+              udata +
+                  indices[curIndex + p + SLWS_PREFETCH_DISTANCE] * inLineSize,
+              inLineSize);
+        }
+      }
+      const uint8_t *row0 = udata + indices[curIndex] * inLineSize;
+      const uint8_t *row1 = udata + indices[curIndex + 1] * inLineSize;
+      float scale0, offset0, scale1, offset1;
+      libjit_load_fused_scale_offset(row0, inLineSize, &scale0, &offset0);
+      libjit_load_fused_scale_offset(row1, inLineSize, &scale1, &offset1);
+      // w * (scale * q + offset) == (w * scale) * q + w * offset.
+      scale0 *= weights[curIndex];
+      scale1 *= weights[curIndex + 1];
+      const float offset =
+          weights[curIndex] * offset0 + weights[curIndex + 1] * offset1;
+      for (size_t k = 0; k < outLineSize; k++) {
+        out[k] += scale0 * row0[k] + scale1 * row1[k] + offset;
+      }
+    }
+    if (curIndex < end) {
+      const uint8_t *row = udata + indices[curIndex] * inLineSize;
       float scale, offset;
-      memcpy(&scale, currRowScaleOffsetPtr, sizeof(float));
-      memcpy(&offset, currRowScaleOffsetPtr + sizeof(float), sizeof(float));
+      libjit_load_fused_scale_offset(row, inLineSize, &scale, &offset);
+      scale *= weights[curIndex];
+      offset *= weights[curIndex];
       for (size_t k = 0; k < outLineSize; k++) {
-        const float fData =
-            (scale * (uint8_t)(data[line * inLineSize + k])) + offset;
-        dest[i * outLineSize + k] += weight * fData;
+        out[k] += scale * row[k] + offset;
+      }
+      curIndex++;
+    }
+  }
+}
+
+void libjit_fused_4bit_rowwise_quantized_sparse_lengths_weighted_sum_f(
+    float *dest, int8_t *data, float *weights, size_t *indices,
+    int32_t *lengths, size_t segments, size_t inLineSize, size_t outLineSize) {
+  memset(dest, 0, segments * outLineSize * sizeof(float));
+  const uint8_t *udata = (const uint8_t *)data;
+  const size_t numIndices = libjit_sum_lengths(lengths, segments);
+  size_t curIndex = 0;
+  for (size_t i = 0; i < segments; i++) {
+    float *out = dest + i * outLineSize;
+    for (int32_t j = 0; j < lengths[i]; j++) {
+      if (curIndex + SLWS_PREFETCH_DISTANCE < numIndices) {
+        libjit_prefetch_row(
+            udata + indices[curIndex + SLWS_PREFETCH_DISTANCE] * inLineSize,
+            inLineSize);
+      }
+      const uint8_t *row = udata + indices[curIndex] * inLineSize;
+      float scale, offset;
+      libjit_load_fused_scale_offset(row, inLineSize, &scale, &offset);
+      scale *= weights[curIndex];
+      offset *= weights[curIndex];
+      // Every byte holds two consecutive values, low nibble first.
+      for (size_t k = 0; k < outLineSize / 2; k++) {
+        const uint8_t packed = row[k];
+        out[2 * k] += scale * (packed & 0x0F) + offset;
+        out[2 * k + 1] += scale * (packed >> 4) + offset;
       }
       curIndex++;
     }
@@ -1248,6 +1416,57 @@ void libjit_local_response_normalization_grad_f(
   }     // N
 }
 
+/// The optimizers update the \p size elements of \p weight into \p dest in a
+/// single pass. \p dest may be the same buffer as \p weight.
+void libjit_sgd_f(float *dest, const float *weight, const float *gradient,
+                  size_t size, float L1Decay, float L2Decay,
+                  float learningRate, size_t batchSize) {
+  for (size_t i = 0; i < size; i++) {
+    float w = weight[i];
+    float g =
+        libjit_decayed_gradient(gradient[i], w, L1Decay, L2Decay, batchSize);
+    dest[i] = w - learningRate * g;
+  }
+}
+
+void libjit_momentum_sgd_f(float *dest, const float *weight,
+                           const float *gradient, float *gsum, size_t size,
+                           float L1Decay, float L2Decay, float learningRate,
+                           float momentum, size_t batchSize) {
+  for (size_t i = 0; i < size; i++) {
+    float w = weight[i];
+    float g =
+        libjit_decayed_gradient(gradient[i], w, L1Decay, L2Decay, batchSize);
+    float dx = momentum * gsum[i] - learningRate * g;
+    gsum[i] = dx;
+    dest[i] = w + dx;
+  }
+}
+
+void libjit_adam_f(float *dest, const float *weight, const float *gradient,
+                   float *m, float *v, float *step, size_t size, float L1Decay,
+                   float L2Decay, float learningRate, float beta1, float beta2,
+                   float epsilon, size_t batchSize) {
+  // Count the step and compute the bias corrections of the moments.
+  float t = step[0] + 1;
+  step[0] = t;
+  float correction1 = 1 - powf(beta1, t);
+  float correction2 = 1 - powf(beta2, t);
+
+  for (size_t i = 0; i < size; i++) {
+    float w = weight[i];
+    float g =
+        libjit_decayed_gradient(gradient[i], w, L1Decay, L2Decay, batchSize);
+    float mi = beta1 * m[i] + (1 - beta1) * g;
+    float vi = beta2 * v[i] + (1 - beta2) * g * g;
+    m[i] = mi;
+    v[i] = vi;
+    float mHat = mi / correction1;
+    float vHat = vi / correction2;
+    dest[i] = w - learningRate * mHat / (sqrtf(vHat) + epsilon);
+  }
+}
+
 void libjit_max_pool_i8(const int8_t *inW, int8_t *outW, const size_t *inWdims,
                         const size_t *outWdims, size_t *kernelSizes,
                         size_t *strides, size_t *pads) {
@@ -1597,6 +1816,7 @@ libjit_dump_tensor(uint8_t *tensor, size_t *tensorDim, size_t numDimsTensor,
     Int32ITy,      // 32-bit index type (int32_t)
     Int64ITy,      // 64-bit index type (int64_t)
     UInt8FusedQTy, // 8-bit quantized type with fused scale/offset (uint8_t)
+    UInt4FusedQTy, // 4-bit quantized type with fused scale/offset (uint8_t)
     BoolTy,        // Bool type (bool)
   };
   // Dump the content of a tensor.
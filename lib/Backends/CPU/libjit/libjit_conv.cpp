@@ -251,6 +251,321 @@ void libjit_convDKKC8_foreach_xy_pixels_filter(
   }       // For each X in the output.
 }
 
+/// Type of the functions that perform the convolution for each pixel.
+using libjit_convDKKC8_pixel_fn = decltype(
+    &libjit_convDKKC8_foreach_xy_filter_pixels);
+
+/// The state of a libjit_convDKKC8_f call, shared by the chunks of work that
+/// libjit_convDKKC8_body runs.
+struct libjit_convDKKC8_args {
+  float *outW;
+  const float *inW;
+  const float *filterW;
+  const float *biasW;
+  const size_t *outWdims;
+  const size_t *inWdims;
+  const size_t *filterWdims;
+  const size_t *biasWdims;
+  const size_t *kernelSizes;
+  const size_t *strides;
+  const size_t *pads;
+  size_t group;
+  unsigned numDepthRegs;
+  unsigned sizeGroupY;
+  unsigned depthStrips;
+  libjit_convDKKC8_pixel_fn eachPixelConv;
+  /// The number of blocks of output channels in each group.
+  size_t blocksPerGroup;
+};
+
+/// Perform the convolution for the work items [\p begin, \p end). Each work
+/// item is one block of output channels of one group of one sample, so work
+/// items write disjoint parts of the output.
+void libjit_convDKKC8_body(void *ctx, size_t begin, size_t end) {
+  const auto *args = static_cast<const libjit_convDKKC8_args *>(ctx);
+  size_t inCperG = args->inWdims[3] / args->group;
+  size_t outCperG = args->outWdims[3] / args->group;
+  size_t blockSize = 8 * args->numDepthRegs * args->depthStrips;
+  for (size_t item = begin; item < end; item++) {
+    size_t n = item / (args->group * args->blocksPerGroup);
+    size_t g = (item / args->blocksPerGroup) % args->group;
+    size_t d = g * outCperG + (item % args->blocksPerGroup) * blockSize;
+    args->eachPixelConv(n, d, args->numDepthRegs, args->depthStrips,
+                        args->sizeGroupY, inCperG, args->outW, args->inW,
+                        args->filterW, args->biasW, args->outWdims,
+                        args->inWdims, args->filterWdims, args->biasWdims,
+                        args->kernelSizes, args->strides, args->pads, g,
+                        (g + 1) * outCperG);
+  }
+}
+
+/// Compute the range [\p begin, \p end) of the filter positions along one
+/// dimension that fall inside an input of size \p inSize, for an output
+/// position whose filter starts at input position \p start.
+void libjit_conv_filter_range(ssize_t start, size_t kernel, size_t inSize,
+                              size_t &begin, size_t &end) {
+  ssize_t b = MAX(-start, 0);
+  ssize_t e = MIN((ssize_t)kernel, (ssize_t)inSize - start);
+  begin = b;
+  end = MAX(b, e);
+}
+
+/// The state of a libjit_depthwise_conv_f call, shared by the rows of the
+/// output that libjit_depthwise_conv_f_body runs.
+struct libjit_depthwise_conv_f_args {
+  float *outW;
+  const float *inW;
+  /// The filter in the layout [1, K, K, D].
+  const float *filterW;
+  const float *biasW;
+  const size_t *outWdims;
+  const size_t *inWdims;
+  const size_t *kernelSizes;
+  const size_t *strides;
+  const size_t *pads;
+};
+
+/// Perform the depthwise convolution for the work items [\p begin, \p end).
+/// Each work item is one row of the output of one sample.
+void libjit_depthwise_conv_f_body(void *ctx, size_t begin, size_t end) {
+  const auto *args = static_cast<const libjit_depthwise_conv_f_args *>(ctx);
+  const size_t *outWdims = args->outWdims;
+  const size_t *inWdims = args->inWdims;
+  size_t kernel_w = args->kernelSizes[1];
+  size_t outC = outWdims[3];
+  size_t multiplier = outC / inWdims[3];
+  for (size_t item = begin; item < end; item++) {
+    size_t n = item / outWdims[1];
+    size_t ax = item % outWdims[1];
+    ssize_t x = (ssize_t)(ax * args->strides[0]) - (ssize_t)args->pads[0];
+    size_t fxBegin, fxEnd;
+    libjit_conv_filter_range(x, args->kernelSizes[0], inWdims[1], fxBegin,
+                             fxEnd);
+    for (size_t ay = 0; ay < outWdims[2]; ay++) {
+      ssize_t y = (ssize_t)(ay * args->strides[1]) - (ssize_t)args->pads[1];
+      size_t fyBegin, fyEnd;
+      libjit_conv_filter_range(y, kernel_w, inWdims[2], fyBegin, fyEnd);
+      float *out = args->outW + libjit_getXYZW(outWdims, n, ax, ay, 0);
+
+      size_t d = 0;
+      if (multiplier == 1) {
+        // The input and the output channels match, so process 32 and then 8
+        // channels at a time with SIMD.
+        for (; d + 32 <= outC; d += 32) {
+          float8 sum0 = LoaduFloat8(args->biasW + d);
+          float8 sum1 = LoaduFloat8(args->biasW + d + 8);
+          float8 sum2 = LoaduFloat8(args->biasW + d + 16);
+          float8 sum3 = LoaduFloat8(args->biasW + d + 24);
+          for (size_t fx = fxBegin; fx < fxEnd; fx++) {
+            for (size_t fy = fyBegin; fy < fyEnd; fy++) {
+              const float *in = args->inW + libjit_getXYZW(inWdims, n, x + fx,
+                                                           y + fy, d);
+              const float *filter =
+                  args->filterW + (fx * kernel_w + fy) * outC + d;
+              sum0 += LoaduFloat8(in) * LoaduFloat8(filter);
+              sum1 += LoaduFloat8(in + 8) * LoaduFloat8(filter + 8);
+              sum2 += LoaduFloat8(in + 16) * LoaduFloat8(filter + 16);
+              sum3 += LoaduFloat8(in + 24) * LoaduFloat8(filter + 24);
+            }
+          }
+          StoreuFloat8(out + d, sum0);
+          StoreuFloat8(out + d + 8, sum1);
+          StoreuFloat8(out + d + 16, sum2);
+          StoreuFloat8(out + d + 24, sum3);
+        }
+        for (; d + 8 <= outC; d += 8) {
+          float8 sum = LoaduFloat8(args->biasW + d);
+          for (size_t fx = fxBegin; fx < fxEnd; fx++) {
+            for (size_t fy = fyBegin; fy < fyEnd; fy++) {
+              const float *in = args->inW + libjit_getXYZW(inWdims, n, x + fx,
+                                                           y + fy, d);
+              const float *filter =
+                  args->filterW + (fx * kernel_w + fy) * outC + d;
+              sum += LoaduFloat8(in) * LoaduFloat8(filter);
+            }
+          }
+          StoreuFloat8(out + d, sum);
+        }
+      }
+
+      // The remaining channels. Output channel d reads input channel
+      // d / multiplier.
+      for (; d < outC; d++) {
+        float sum = args->biasW[d];
+        for (size_t fx = fxBegin; fx < fxEnd; fx++) {
+          for (size_t fy = fyBegin; fy < fyEnd; fy++) {
+            sum += args->inW[libjit_getXYZW(inWdims, n, x + fx, y + fy,
+                                            d / multiplier)] *
+                   args->filterW[(fx * kernel_w + fy) * outC + d];
+          }
+        }
+        out[d] = sum;
+      }
+    } // For each Y in the output.
+  }   // For each row of the output.
+}
+
+/// The state of a libjit_depthwise_conv_i8 call, shared by the rows of the
+/// output that libjit_depthwise_conv_i8_body runs.
+struct libjit_depthwise_conv_i8_args {
+  int8_t *outW;
+  const int8_t *inW;
+  /// The filter in the layout [1, K, K, D].
+  const int8_t *filterW;
+  /// The bias scaled to the scale of the products of the input and filter.
+  const int32_t *biasT;
+  const size_t *outWdims;
+  const size_t *inWdims;
+  const size_t *kernelSizes;
+  const size_t *strides;
+  const size_t *pads;
+  int32_t outOffset;
+  int32_t inOffset;
+  int32_t filterOffset;
+  int32_t outPre;
+  int32_t outPost;
+  int32_t outScale;
+};
+
+/// Perform the quantized depthwise convolution for the work items
+/// [\p begin, \p end). Each work item is one row of the output of one sample.
+void libjit_depthwise_conv_i8_body(void *ctx, size_t begin, size_t end) {
+  const auto *args = static_cast<const libjit_depthwise_conv_i8_args *>(ctx);
+  const size_t *outWdims = args->outWdims;
+  const size_t *inWdims = args->inWdims;
+  size_t kernel_w = args->kernelSizes[1];
+  size_t outC = outWdims[3];
+  size_t multiplier = outC / inWdims[3];
+  // The sums of all of the channels of one output pixel. The loops over the
+  // channels are long and consecutive in memory, so the compiler vectorizes
+  // them.
+  int32_t sum[outC];
+  for (size_t item = begin; item < end; item++) {
+    size_t n = item / outWdims[1];
+    size_t ax = item % outWdims[1];
+    ssize_t x = (ssize_t)(ax * args->strides[0]) - (ssize_t)args->pads[0];
+    size_t fxBegin, fxEnd;
+    libjit_conv_filter_range(x, args->kernelSizes[0], inWdims[1], fxBegin,
+                             fxEnd);
+    for (size_t ay = 0; ay < outWdims[2]; ay++) {
+      ssize_t y = (ssize_t)(ay * args->strides[1]) - (ssize_t)args->pads[1];
+      size_t fyBegin, fyEnd;
+      libjit_conv_filter_range(y, kernel_w, inWdims[2], fyBegin, fyEnd);
+
+      for (size_t d = 0; d < outC; d++) {
+        sum[d] = args->biasT[d];
+      }
+      for (size_t fx = fxBegin; fx < fxEnd; fx++) {
+        for (size_t fy = fyBegin; fy < fyEnd; fy++) {
+          const int8_t *in =
+              args->inW + libjit_getXYZW(inWdims, n, x + fx, y + fy, 0);
+          const int8_t *filter = args->filterW + (fx * kernel_w + fy) * outC;
+          if (multiplier == 1) {
+            for (size_t d = 0; d < outC; d++) {
+              sum[d] += (in[d] - args->inOffset) *
+                        (filter[d] - args->filterOffset);
+            }
+          } else {
+            // Output channel d reads input channel d / multiplier.
+            for (size_t d = 0; d < outC; d++) {
+              sum[d] += (in[d / multiplier] - args->inOffset) *
+                        (filter[d] - args->filterOffset);
+            }
+          }
+        }
+      }
+
+      int8_t *out = args->outW + libjit_getXYZW(outWdims, n, ax, ay, 0);
+      for (size_t d = 0; d < outC; d++) {
+        // Scale the result back to the expected destination scale.
+        int32_t scaledSum = libjit_scale_i32i8(
+            sum[d], args->outPre, args->outPost, args->outScale,
+            args->outOffset);
+        out[d] = libjit_clip(scaledSum);
+      }
+    } // For each Y in the output.
+  }   // For each row of the output.
+}
+
+/// The state of a libjit_group_conv_f call, shared by the rows of the output
+/// that libjit_group_conv_f_body runs.
+struct libjit_group_conv_f_args {
+  float *outW;
+  const float *inW;
+  /// The filter of every block of 8 output channels in the layout
+  /// [K, K, C, 8]. The last block of a group is padded with zero filters.
+  const float *filterW;
+  const float *biasW;
+  const size_t *outWdims;
+  const size_t *inWdims;
+  const size_t *kernelSizes;
+  const size_t *strides;
+  const size_t *pads;
+  size_t group;
+};
+
+/// Perform the grouped convolution for the work items [\p begin, \p end).
+/// Each work item is one row of the output of one sample, for all groups.
+void libjit_group_conv_f_body(void *ctx, size_t begin, size_t end) {
+  const auto *args = static_cast<const libjit_group_conv_f_args *>(ctx);
+  const size_t *outWdims = args->outWdims;
+  const size_t *inWdims = args->inWdims;
+  size_t kernel_h = args->kernelSizes[0];
+  size_t kernel_w = args->kernelSizes[1];
+  size_t inCperG = inWdims[3] / args->group;
+  size_t outCperG = outWdims[3] / args->group;
+  size_t blocksPerGroup = (outCperG + 7) / 8;
+  size_t blockFilterSize = kernel_h * kernel_w * inCperG * 8;
+  for (size_t item = begin; item < end; item++) {
+    size_t n = item / outWdims[1];
+    size_t ax = item % outWdims[1];
+    ssize_t x = (ssize_t)(ax * args->strides[0]) - (ssize_t)args->pads[0];
+    size_t fxBegin, fxEnd;
+    libjit_conv_filter_range(x, kernel_h, inWdims[1], fxBegin, fxEnd);
+    for (size_t ay = 0; ay < outWdims[2]; ay++) {
+      ssize_t y = (ssize_t)(ay * args->strides[1]) - (ssize_t)args->pads[1];
+      size_t fyBegin, fyEnd;
+      libjit_conv_filter_range(y, kernel_w, inWdims[2], fyBegin, fyEnd);
+      float *out = args->outW + libjit_getXYZW(outWdims, n, ax, ay, 0);
+
+      for (size_t g = 0; g < args->group; g++) {
+        // Compute 8 output channels at a time. Every input value is
+        // broadcast and multiplied with the filter values of the 8 channels.
+        for (size_t b = 0; b < blocksPerGroup; b++) {
+          size_t d = g * outCperG + b * 8;
+          const float *blockFilter =
+              args->filterW + (g * blocksPerGroup + b) * blockFilterSize;
+          float8 sum = BroadcastFloat8(0.0f);
+          for (size_t fx = fxBegin; fx < fxEnd; fx++) {
+            for (size_t fy = fyBegin; fy < fyEnd; fy++) {
+              const float *in = args->inW + libjit_getXYZW(inWdims, n, x + fx,
+                                                           y + fy, g * inCperG);
+              const float *filter =
+                  blockFilter + (fx * kernel_w + fy) * inCperG * 8;
+              for (size_t c = 0; c < inCperG; c++) {
+                sum += BroadcastFloat8(in[c]) * LoaduFloat8(filter + c * 8);
+              }
+            }
+          }
+
+          // The last block of a group may be padded, so only the channels of
+          // the group are written.
+          size_t numChannels = MIN(outCperG - b * 8, (size_t)8);
+          if (numChannels == 8) {
+            StoreuFloat8(out + d, sum + LoaduFloat8(args->biasW + d));
+            continue;
+          }
+          float partial[8];
+          StoreuFloat8(partial, sum);
+          for (size_t i = 0; i < numChannels; i++) {
+            out[d + i] = partial[i] + args->biasW[d + i];
+          }
+        }
+      } // For each group.
+    }   // For each Y in the output.
+  }     // For each row of the output.
+}
+
 } // namespace
 
 extern "C" {
@@ -261,41 +576,42 @@ void libjit_convDKKC8_f(float *outW, const float *inW, const float *filterW,
                         const size_t *strides, const size_t *pads, size_t group,
                         unsigned pixelScanFirst, unsigned numDepthRegs,
                         unsigned sizeGroupY, unsigned depthStrips) {
-  size_t inChannels = inWdims[3];
-  size_t outChannels = outWdims[3];
-  size_t inCperG = inChannels / group;
-  size_t outCperG = outChannels / group;
+  size_t outCperG = outWdims[3] / group;
+  size_t blockSize = 8 * numDepthRegs * depthStrips;
 
-  // Select the order in which we iterate over the pixels in the picture.
-  auto eachPixelConv =
-      (pixelScanFirst ? &libjit_convDKKC8_foreach_xy_pixels_filter
-                      : &libjit_convDKKC8_foreach_xy_filter_pixels);
-
-  // For each input in the batch:
+  // Initialize the output frame of each sample with the bias. Later we will
+  // accumulate values into these slices.
   for (size_t n = 0; n < inWdims[0]; n++) {
-
-    // Initialize the output frame for the N'th slice with the bias.
-    // Later we will accumulate values into this slice.
     libjit_conv_init_output_with_bias(n, outW, biasW, outWdims, biasWdims);
+  }
 
-    // For each group of input channels:
-    for (size_t g = 0; g < group; g++) {
+  libjit_convDKKC8_args args;
+  args.outW = outW;
+  args.inW = inW;
+  args.filterW = filterW;
+  args.biasW = biasW;
+  args.outWdims = outWdims;
+  args.inWdims = inWdims;
+  args.filterWdims = filterWdims;
+  args.biasWdims = biasWdims;
+  args.kernelSizes = kernelSizes;
+  args.strides = strides;
+  args.pads = pads;
+  args.group = group;
+  args.numDepthRegs = numDepthRegs;
+  args.sizeGroupY = sizeGroupY;
+  args.depthStrips = depthStrips;
+  // Select the order in which we iterate over the pixels in the picture.
+  args.eachPixelConv =
+      (pixelScanFirst ? &libjit_convDKKC8_foreach_xy_pixels_filter
+                      : &libjit_convDKKC8_foreach_xy_filter_pixels);
+  // For each output channel, process [numDepthRegs x float8] elements.
+  args.blocksPerGroup = (outCperG + blockSize - 1) / blockSize;
 
-      // For each output channel, process [numDepthRegs x float8] elements.
-      size_t startChannelIndex = g * outCperG;
-      size_t endChannelIndex = (g + 1) * outCperG;
-      for (size_t d = startChannelIndex; d < endChannelIndex;
-           d += 8 * numDepthRegs * depthStrips) {
-
-        // Perform the convolution for each pixel.
-        eachPixelConv(n, d, numDepthRegs, depthStrips, sizeGroupY, inCperG,
-                      outW, inW, filterW, biasW, outWdims, inWdims, filterWdims,
-                      biasWdims, kernelSizes, strides, pads, g,
-                      endChannelIndex);
-
-      } // For each D (the depth, or the output channel).
-    }   // for each G, the group
-  }     // For each N, the sample in the batch.
+  // For each sample in the batch, each group and each block of output
+  // channels, perform the convolution for each pixel.
+  libjit_parallel_for(inWdims[0] * group * args.blocksPerGroup,
+                      &libjit_convDKKC8_body, &args);
 }
 
 void libjit_convolution_f(float *outW, const float *inW, const float *filterW,
@@ -513,6 +829,217 @@ void libjit_convolution_i8(
   }         // N
 }
 
+void libjit_channelwise_quantized_conv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW,
+    const int32_t *biasW, const int32_t *filterOffsets, const int32_t *biasPre,
+    const int32_t *biasPost, const int32_t *biasScale, const int32_t *outPre,
+    const int32_t *outPost, const int32_t *outScale, const size_t *outWdims,
+    const size_t *inWdims, const size_t *filterWdims, const size_t *biasWdims,
+    const size_t *kernelSizes, const size_t *strides, const size_t *pads,
+    size_t group, int32_t outOffset, int32_t inOffset, int32_t biasOffset,
+    unsigned depthUnroll) {
+  size_t inChannels = inWdims[3];
+  size_t outChannels = outWdims[3];
+  size_t inCperG = inChannels / group;
+  size_t outCperG = outChannels / group;
+  size_t pad_t = pads[0];
+  size_t pad_l = pads[1];
+  size_t stride_h = strides[0];
+  size_t stride_w = strides[1];
+  size_t kernel_h = kernelSizes[0];
+  size_t kernel_w = kernelSizes[1];
+  size_t sliceSize = filterWdims[1] * filterWdims[2] * filterWdims[3];
+
+  // Every output channel has its own filter offset, so we can't fold it into
+  // the innermost loop as a single constant. Instead we use the identity:
+  //   sum((F - fOffset) * (I - iOffset)) =
+  //       sum(F * (I - iOffset)) - fOffset * sum(I - iOffset)
+  // The innermost loop is then a plain multiply-accumulate that is shared by
+  // all of the output channels, and the second term is computed once per
+  // output pixel and group.
+
+  // For each input in the batch:
+  for (size_t n = 0; n < inWdims[0]; n++) {
+    // For each group of input channels:
+    for (size_t g = 0; g < group; g++) {
+
+      // For each convolution 'jump' in the input tensor:
+      ssize_t x = -(ssize_t)pad_t;
+      for (size_t ax = 0; ax < outWdims[1]; x += stride_h, ax++) {
+        ssize_t y = -(ssize_t)pad_l;
+        for (size_t ay = 0; ay < outWdims[2]; y += stride_w, ay++) {
+
+          // Sum the input values of the receptive field of this pixel.
+          int32_t inSum = 0;
+          for (size_t fx = 0; fx < kernel_h; fx++) {
+            for (size_t fy = 0; fy < kernel_w; fy++) {
+              ssize_t ox = x + fx;
+              ssize_t oy = y + fy;
+
+              // Ignore index access below zero (this is due to padding).
+              if (ox < 0 || oy < 0 || ox >= (ssize_t)inWdims[1] ||
+                  oy >= (ssize_t)inWdims[2]) {
+                continue;
+              }
+              size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)ox,
+                                            (size_t)oy, g * inCperG);
+              for (size_t fd = 0; fd < inCperG; fd++) {
+                inSum += inW[inIdx + fd] - inOffset;
+              }
+            }
+          }
+
+          // For each output channel in the group. Process 'depthUnroll'
+          // output layers together.
+          for (size_t d = g * outCperG; d < (g + 1) * outCperG;
+               d += depthUnroll) {
+            int32_t sum[depthUnroll];
+            for (unsigned i = 0; i < depthUnroll; i++) {
+              sum[i] = 0;
+            }
+
+            // For each element in the convolution-filter:
+            for (size_t fx = 0; fx < kernel_h; fx++) {
+              for (size_t fy = 0; fy < kernel_w; fy++) {
+                ssize_t ox = x + fx;
+                ssize_t oy = y + fy;
+
+                // Ignore index access below zero (this is due to padding).
+                if (ox < 0 || oy < 0 || ox >= (ssize_t)inWdims[1] ||
+                    oy >= (ssize_t)inWdims[2]) {
+                  continue;
+                }
+
+                // Calculate the indices into the Filter and Input buffers.
+                size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)ox,
+                                              (size_t)oy, g * inCperG);
+                size_t filterIdx = libjit_getXYZW(filterWdims, d, fx, fy, 0);
+
+                // Perform the innermost loop of the convolution using 4 vector
+                // registers.
+                for (size_t fd = 0; fd < inCperG; fd++) {
+                  int32_t in = inW[inIdx + fd] - inOffset;
+                  for (unsigned i = 0; i < MIN(4, depthUnroll); i++) {
+                    sum[i] += filterW[filterIdx + (sliceSize * i) + fd] * in;
+                  }
+                }
+
+                // And perform the innermost loop again with 4 more registers.
+                if (depthUnroll > 4)
+                  for (size_t fd = 0; fd < inCperG; fd++) {
+                    int32_t in = inW[inIdx + fd] - inOffset;
+                    for (unsigned i = 4; i < MIN(8, depthUnroll); i++) {
+                      sum[i] +=
+                          filterW[filterIdx + (sliceSize * i) + fd] * in;
+                    }
+                  }
+              }
+            }
+
+            for (unsigned i = 0; i < depthUnroll; i++) {
+              size_t c = d + i;
+              // Remove the contribution of the filter offset.
+              sum[i] -= filterOffsets[c] * inSum;
+
+              // Scale the bias to match the scale of the matrix multiplication
+              // of this output channel, and add it.
+              sum[i] += libjit_scale_i32i8((int32_t)biasW[c] - biasOffset,
+                                           biasPre[c], biasPost[c],
+                                           biasScale[c], 0);
+
+              // Scale the result back to the expected destination scale.
+              int32_t scaledSum = libjit_scale_i32i8(
+                  sum[i], outPre[c], outPost[c], outScale[c], outOffset);
+              outW[libjit_getXYZW(outWdims, n, ax, ay, c)] =
+                  libjit_clip(scaledSum);
+            }
+          } // C
+        }   // W
+      }     // H
+    }       // G
+  }         // N
+}
+
+void libjit_depthwise_conv_f(float *outW, const float *inW,
+                             const float *filterW, const float *biasW,
+                             const size_t *outWdims, const size_t *inWdims,
+                             const size_t *filterWdims,
+                             const size_t *biasWdims,
+                             const size_t *kernelSizes, const size_t *strides,
+                             const size_t *pads) {
+  libjit_depthwise_conv_f_args args;
+  args.outW = outW;
+  args.inW = inW;
+  args.filterW = filterW;
+  args.biasW = biasW;
+  args.outWdims = outWdims;
+  args.inWdims = inWdims;
+  args.kernelSizes = kernelSizes;
+  args.strides = strides;
+  args.pads = pads;
+  libjit_parallel_for(outWdims[0] * outWdims[1], &libjit_depthwise_conv_f_body,
+                      &args);
+}
+
+void libjit_depthwise_conv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW,
+    const int32_t *biasW, const size_t *outWdims, const size_t *inWdims,
+    const size_t *filterWdims, const size_t *biasWdims,
+    const size_t *kernelSizes, const size_t *strides, const size_t *pads,
+    int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale) {
+  size_t outC = outWdims[3];
+
+  // Scale the bias to match the scale of the products of the input and the
+  // filter.
+  int32_t biasT[outC];
+  for (size_t d = 0; d < outC; d++) {
+    biasT[d] = libjit_scale_i32i8(biasW[d] - biasOffset, biasPre, biasPost,
+                                  biasScale, 0);
+  }
+
+  libjit_depthwise_conv_i8_args args;
+  args.outW = outW;
+  args.inW = inW;
+  args.filterW = filterW;
+  args.biasT = biasT;
+  args.outWdims = outWdims;
+  args.inWdims = inWdims;
+  args.kernelSizes = kernelSizes;
+  args.strides = strides;
+  args.pads = pads;
+  args.outOffset = outOffset;
+  args.inOffset = inOffset;
+  args.filterOffset = filterOffset;
+  args.outPre = outPre;
+  args.outPost = outPost;
+  args.outScale = outScale;
+  libjit_parallel_for(outWdims[0] * outWdims[1],
+                      &libjit_depthwise_conv_i8_body, &args);
+}
+
+void libjit_group_conv_f(float *outW, const float *inW, const float *filterW,
+                         const float *biasW, const size_t *outWdims,
+                         const size_t *inWdims, const size_t *filterWdims,
+                         const size_t *biasWdims, const size_t *kernelSizes,
+                         const size_t *strides, const size_t *pads,
+                         size_t group) {
+  libjit_group_conv_f_args args;
+  args.outW = outW;
+  args.inW = inW;
+  args.filterW = filterW;
+  args.biasW = biasW;
+  args.outWdims = outWdims;
+  args.inWdims = inWdims;
+  args.kernelSizes = kernelSizes;
+  args.strides = strides;
+  args.pads = pads;
+  args.group = group;
+  libjit_parallel_for(outWdims[0] * outWdims[1], &libjit_group_conv_f_body,
+                      &args);
+}
+
 void libjit_convolution_grad_f(float *inG, const float *outG, const float *inW,
                                float *filterG, float *biasG,
                                const float *filterW, const size_t *outGdims,
@@ -124,6 +124,24 @@ inline int32_t libjit_scale_i32i8(int32_t input, int32_t pre, int32_t post,
   return ((((input >> pre) * scale) + rtn) >> post) + offset;
 }
 
+/// Body of a parallel loop. It runs the iterations [\p begin, \p end) of the
+/// loop whose state is in \p ctx.
+typedef void (*libjit_parallel_body)(void *ctx, size_t begin, size_t end);
+
+/// A parallel-for implementation provided by the client of a bundle. It must
+/// run \p body on every iteration in [0, \p numIters) exactly once, possibly
+/// in chunks on several threads, and return only when all of them are done.
+/// \p runtimeCtx is the context that was registered with the function.
+typedef void (*libjit_parallel_for_fn)(void *runtimeCtx, size_t numIters,
+                                       libjit_parallel_body body,
+                                       void *bodyCtx);
+
+/// Run \p body with \p ctx on the iterations [0, \p numIters), splitting
+/// them across threads if a parallel-for was registered with
+/// libjit_set_parallel_for, and serially otherwise.
+extern "C" void libjit_parallel_for(size_t numIters, libjit_parallel_body body,
+                                    void *ctx);
+
 #ifdef _WIN32
 #define libjit_aligned_malloc(p, a, s)                                         \
   (((*(p)) = _aligned_malloc((s), (a))), *(p) ? 0 : errno)
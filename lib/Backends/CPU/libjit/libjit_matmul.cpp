@@ -117,7 +117,7 @@ void libjit_matmul_zdot(size_t k, const float *a, size_t lda, const float *b,
 template <size_t regsA>
 void pack_matrix_a(size_t m, size_t k, const float *a, size_t lda,
                    float *a_to) {
-  for (size_t i = 0; i < m - mr + 1; i += mr) {
+  for (size_t i = 0; i + mr <= m; i += mr) {
     for (size_t j = 0; j < k; j++) {
       const float *a_ij_pntr = &A(i, j);
       for (size_t ai = 0; ai < regsA; ai++) {
@@ -174,7 +174,7 @@ void libjit_matmul_inner_unpacked(int m, int n, int k, const float *a, int lda,
 template <bool pack>
 void libjit_matmul_inner(int m, int n, int k, const float *a, int lda,
                          const float *b, int ldb, float *c, int ldc,
-                         float *packedB) {
+                         const float *packedB) {
   // The tiling scheme naturally divides the input matrices into 2 parts each;
   // one tiled section, and three "ragged" edges.
   //
@@ -213,9 +213,54 @@ void libjit_matmul_inner(int m, int n, int k, const float *a, int lda,
   }
 }
 
-/// Tile A into mc * kc blocks, where mc and kc are chosen to approximately fit
-/// the L2 cache on recent Intel processors (e.g., 256 KB for Skylake).  Stream
-/// kc * n panels of B through memory to compute each mc * n block of C.
+/// The state of a libjit_matmul_outer call, shared by the chunks of work that
+/// libjit_matmul_panel runs on the current kcb * nc panel of B. The matrices
+/// are column-major, as in libjit_matmul_outer.
+struct libjit_matmul_args {
+  size_t m;
+  const float *a;
+  size_t lda;
+  const float *b;
+  size_t ldb;
+  float *c;
+  size_t ldc;
+  size_t mcb;
+  /// The first row and the number of rows of the panel of B.
+  size_t p;
+  size_t pb;
+  /// The first column and the number of columns of the panel of B.
+  size_t j;
+  size_t jb;
+  /// The packed panel, read by all the chunks.
+  const float *packedB;
+};
+
+/// Multiply the blocks [\p begin, \p end) of mcb rows of A with the current
+/// panel of B. Each block only writes its own rows of C.
+template <bool pack>
+void libjit_matmul_panel(void *ctx, size_t begin, size_t end) {
+  const auto *args = static_cast<const libjit_matmul_args *>(ctx);
+  const float *a = args->a;
+  size_t lda = args->lda;
+  const float *b = args->b;
+  size_t ldb = args->ldb;
+  float *c = args->c;
+  size_t ldc = args->ldc;
+  size_t p = args->p;
+  size_t j = args->j;
+  for (size_t block = begin; block < end; block++) {
+    size_t i = block * args->mcb;
+    size_t ib = MIN(args->m - i, args->mcb);
+    libjit_matmul_inner<pack>(ib, args->jb, args->pb, &A(i, p), lda, &B(p, j),
+                              ldb, &C(i, j), ldc, args->packedB);
+  }
+}
+
+/// Tile A into \p mcb * \p kcb blocks, where the block sizes are chosen to
+/// approximately fit the L2 cache (mc and kc fit recent Intel processors, e.g.,
+/// 256 KB for Skylake).  Stream kcb * n panels of B through memory to compute
+/// each mcb * n block of C. Each panel of B is packed once, and the blocks of
+/// rows of A are multiplied with it in parallel.
 /// \p a is an \p m x \p k column-major matrix;
 /// \p b is a \p k x \p n column-major matrix;
 /// \p c is a \p m x \p n column-major matrix.
@@ -224,26 +269,34 @@ void libjit_matmul_inner(int m, int n, int k, const float *a, int lda,
 template <bool pack>
 void __attribute__((noinline))
 libjit_matmul_outer(size_t m, size_t n, size_t k, const float *a, size_t lda,
-                    const float *b, size_t ldb, float *c, size_t ldc) {
-  float *packedB;
-  libjit_aligned_malloc((void **)&packedB, 64, kc * nc);
+                    const float *b, size_t ldb, float *c, size_t ldc,
+                    size_t mcb, size_t kcb) {
+  float *packedB = nullptr;
+  if (pack) {
+    libjit_aligned_malloc((void **)&packedB, 64, kcb * nc * sizeof(float));
+  }
 
-  for (size_t p = 0; p < k; p += kc) {
-    size_t pb = MIN(k - p, kc);
+  libjit_matmul_args args = {m, a, lda, b, ldb, c, ldc, mcb, 0, 0, 0, 0,
+                             packedB};
+  size_t numBlocks = (m + mcb - 1) / mcb;
+  for (size_t p = 0; p < k; p += kcb) {
+    size_t pb = MIN(k - p, kcb);
     for (size_t j = 0; j < n; j += nc) {
       size_t jb = MIN(n - j, nc);
       if (pack) {
         pack_matrix_b<regsB>(jb, pb, &B(p, j), ldb, packedB);
       }
-      for (size_t i = 0; i < m; i += mc) {
-        size_t ib = MIN(m - i, mc);
-        libjit_matmul_inner<pack>(ib, jb, pb, &A(i, p), lda, &B(p, j), ldb,
-                                  &C(i, j), ldc, packedB);
-      }
+      args.p = p;
+      args.pb = pb;
+      args.j = j;
+      args.jb = jb;
+      libjit_parallel_for(numBlocks, &libjit_matmul_panel<pack>, &args);
     }
   }
 
-  libjit_aligned_free(packedB);
+  if (pack) {
+    libjit_aligned_free(packedB);
+  }
 }
 
 #undef C
@@ -259,9 +312,12 @@ extern "C" {
 /// \p c is a m x n matrix, so \p cDims = {m, n}
 /// \p a is a m x k matrix, so \p aDims = {m, k}
 /// \p b is a k x n matrix, so \p bDims = {k, n}
+/// \p mcBlock and \p kcBlock override the mc and kc cache blocking of A when
+/// they are non-zero. The CPU backend passes them as constants, so the call is
+/// specialized for the tile sizes that the autotuner picked for this shape.
 void libjit_matmul_f(float *c, const float *a, const float *b,
                      const size_t *cDims, const size_t *aDims,
-                     const size_t *bDims) {
+                     const size_t *bDims, size_t mcBlock, size_t kcBlock) {
   memset(c, 0, cDims[0] * cDims[1] * sizeof(float));
   // Call the matrix multiplication routine with appropriate dimensions and
   // leading dimensions. The "leading dimension" for a row-major matrix is equal
@@ -278,10 +334,14 @@ void libjit_matmul_f(float *c, const float *a, const float *b,
   int n = cDims[0];
   int k = aDims[1];
   bool pack = m >= pack_threshold;
+  size_t mcb = mcBlock ? mcBlock : mc;
+  size_t kcb = kcBlock ? kcBlock : kc;
   if (pack) {
-    libjit_matmul_outer<true>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1]);
+    libjit_matmul_outer<true>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1],
+                              mcb, kcb);
   } else {
-    libjit_matmul_outer<false>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1]);
+    libjit_matmul_outer<false>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1],
+                               mcb, kcb);
   }
 }
 
@@ -69,6 +69,37 @@ createHabanaDeviceManager(std::unique_ptr<DeviceConfig> config = nullptr) {
 } // namespace runtime
 } // namespace glow
 
+void DeviceManager::requestFinished(uint64_t execTimeUs) {
+  // Weight of the newest sample in the moving average is 1/8, which follows
+  // changes in load within a few requests without being too noisy.
+  uint64_t oldAvg = avgExecutionTimeUs_.load();
+  uint64_t newAvg;
+  do {
+    newAvg = oldAvg ? (oldAvg * 7 + execTimeUs) / 8 : execTimeUs;
+  } while (!avgExecutionTimeUs_.compare_exchange_weak(oldAvg, newAvg));
+  outstandingRequests_--;
+}
+
+ResultCBTy DeviceManager::wrapResultCallback(
+    std::chrono::steady_clock::time_point submitTime, ResultCBTy resultCB) {
+  auto startTime = std::chrono::steady_clock::now();
+  uint64_t queueWaitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                             startTime - submitTime)
+                             .count();
+  return [this, startTime, queueWaitUs, resultCB = std::move(resultCB)](
+             RunIdentifierTy id, llvm::Error err,
+             std::unique_ptr<ExecutionContext> context) {
+    uint64_t execTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - startTime)
+                              .count();
+    requestFinished(execTimeUs);
+    if (context) {
+      context->addDeviceTime(queueWaitUs, execTimeUs);
+    }
+    resultCB(id, std::move(err), std::move(context));
+  };
+}
+
 DeviceManager *
 DeviceManager::createDeviceManager(BackendKind backendKind,
                                    std::unique_ptr<DeviceConfig> config) {
@@ -69,6 +69,8 @@ static synDataType getSynType(ElemKind kind) {
     return syn_type_int32;
   case ElemKind::UInt8FusedQTy:
     return syn_type_fixed;
+  case ElemKind::UInt4FusedQTy:
+    GLOW_UNREACHABLE("Unhandled ElemKind: UInt4FusedQTy");
   case ElemKind::BoolTy:
     GLOW_UNREACHABLE("Unhandled ElemKind: BoolTy");
   }
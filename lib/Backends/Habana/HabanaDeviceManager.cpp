@@ -20,6 +20,8 @@
 
 #include "synapse.h"
 
+#include <chrono>
+
 using namespace glow;
 using namespace glow::runtime;
 
@@ -336,11 +338,14 @@ HabanaDeviceManager::runFunction(std::string functionName,
                                  std::unique_ptr<ExecutionContext> ctx,
                                  runtime::ResultCBTy resultCB) {
   RunIdentifierTy runId = runIdentifier_++;
-  runPool_->submit([this, runId, functionName = std::move(functionName),
+  requestStarted();
+  auto submitTime = std::chrono::steady_clock::now();
+  runPool_->submit([this, runId, submitTime,
+                    functionName = std::move(functionName),
                     ctx = std::move(ctx),
                     resultCB = std::move(resultCB)]() mutable {
     runFunctionImpl(runId, std::move(functionName), std::move(ctx),
-                    std::move(resultCB));
+                    wrapResultCallback(submitTime, std::move(resultCB)));
   });
   return runId;
 }
@@ -124,6 +124,11 @@ bool Interpreter::isOpSupported(const NodeInfo &NI) const {
     return NI.allInputsAndOutputsHaveSameElemKind(
         {ElemKind::Int32ITy, ElemKind::Int64ITy});
 
+  case Kinded::Kind::SGDNodeKind:
+  case Kinded::Kind::MomentumSGDNodeKind:
+  case Kinded::Kind::AdamNodeKind:
+    return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::FloatTy});
+
   case Kinded::Kind::ConvolutionNodeKind:
     if (!NI.getInTy(ConvolutionNode::InputIdx)->isQuantizedType()) {
       return NI.allInputsAndOutputsHaveSameElemKind(
@@ -134,6 +139,20 @@ bool Interpreter::isOpSupported(const NodeInfo &NI) const {
                {ConvolutionNode::BiasIdx}) &&
            (NI.getInElemTy(ConvolutionNode::BiasIdx) == ElemKind::Int32QTy);
 
+  case Kinded::Kind::ChannelwiseQuantizedConvolutionNodeKind:
+    return (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::InputIdx) ==
+            ElemKind::Int8QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::FilterIdx) ==
+            ElemKind::Int8QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::BiasIdx) ==
+            ElemKind::Int32QTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::ScalesIdx) ==
+            ElemKind::FloatTy) &&
+           (NI.getInElemTy(ChannelwiseQuantizedConvolutionNode::OffsetsIdx) ==
+            ElemKind::Int32ITy) &&
+           (NI.getOutElemTy(ChannelwiseQuantizedConvolutionNode::ResultIdx) ==
+            ElemKind::Int8QTy);
+
   case Kinded::Kind::Convolution3DNodeKind:
     if (!NI.getInTy(Convolution3DNode::InputIdx)->isQuantizedType()) {
       return NI.allInputsAndOutputsHaveSameElemKind(
@@ -211,9 +230,8 @@ bool Interpreter::isOpSupported(const NodeInfo &NI) const {
             ElemKind::FloatTy);
 
   case Kinded::Kind::FusedRowwiseQuantizedSparseLengthsWeightedSumNodeKind:
-    return (NI.getInElemTy(
-                FusedRowwiseQuantizedSparseLengthsWeightedSumNode::DataIdx) ==
-            ElemKind::UInt8FusedQTy) &&
+    return isFusedQuantizedElemKind(NI.getInElemTy(
+               FusedRowwiseQuantizedSparseLengthsWeightedSumNode::DataIdx)) &&
            (NI.getInElemTy(FusedRowwiseQuantizedSparseLengthsWeightedSumNode::
                                WeightsIdx) == ElemKind::FloatTy) &&
            (NI.getInElemTy(FusedRowwiseQuantizedSparseLengthsWeightedSumNode::
@@ -227,6 +245,14 @@ bool Interpreter::isOpSupported(const NodeInfo &NI) const {
   case Kinded::Kind::LengthsToRangesNodeKind:
     return NI.allInputsAndOutputsHaveSameElemKind({ElemKind::Int32ITy});
 
+  case Kinded::Kind::SparseLengthsShardNodeKind:
+    return (NI.getInElemTy(SparseLengthsShardNode::WeightsIdx) ==
+            ElemKind::FloatTy) &&
+           (NI.getInElemTy(SparseLengthsShardNode::IndicesIdx) ==
+            ElemKind::Int64ITy) &&
+           (NI.getInElemTy(SparseLengthsShardNode::LengthsIdx) ==
+            ElemKind::Int32ITy);
+
   case Kinded::Kind::GatherNodeKind:
     // Note: Data and Result can be any data type, but must match.
     return (NI.getInElemTy(GatherNode::DataIdx) ==
@@ -373,7 +399,14 @@ bool Interpreter::isOpSupported(const NodeInfo &NI) const {
 }
 
 bool Interpreter::shouldLower(const Node *N) const {
-  if (N->getKind() == Kinded::Kind::ConvolutionNodeKind)
+  switch (N->getKind()) {
+  case Kinded::Kind::ConvolutionNodeKind:
+  // The optimizers update the weights with fused, single pass kernels.
+  case Kinded::Kind::SGDNodeKind:
+  case Kinded::Kind::MomentumSGDNodeKind:
+  case Kinded::Kind::AdamNodeKind:
     return false;
-  return true;
+  default:
+    return true;
+  }
 }
@@ -19,14 +19,136 @@
 #include "glow/IR/IR.h"
 #include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
+#include "glow/Support/ThreadPool.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 using namespace glow;
 
+llvm::cl::opt<unsigned> interpreterThreads(
+    "interpreter-threads",
+    llvm::cl::desc("Number of threads that execute the independent "
+                   "instructions of Interpreter functions. 0 uses one thread "
+                   "per hardware thread, 1 executes the instructions in "
+                   "order."),
+    llvm::cl::init(0));
+
+/// \returns the number of threads of the Interpreter pool, or 1 if the
+/// instructions are executed in order.
+static unsigned getNumInterpreterThreads() {
+  if (interpreterThreads) {
+    return interpreterThreads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// \returns the thread pool that all Interpreter functions share, or nullptr
+/// if the instructions are executed in order.
+static ThreadPool *getInterpreterThreadPool() {
+  if (getNumInterpreterThreads() <= 1) {
+    return nullptr;
+  }
+  static ThreadPool pool(getNumInterpreterThreads());
+  return &pool;
+}
+
+/// \returns true if \p I has effects that its operands don't describe, and
+/// so must run after all the instructions before it and before all the
+/// instructions after it.
+static bool isBarrier(const Instruction &I) {
+  // Trace events record the time, and debug prints write to the output.
+  return llvm::isa<TraceEventInst>(&I) || llvm::isa<DebugPrintInst>(&I);
+}
+
+InstrDependencies::InstrDependencies(const IRFunction &F) {
+  for (const auto &I : F.getInstrs()) {
+    instrs.push_back(&I);
+  }
+  size_t numInstrs = instrs.size();
+  successors.resize(numInstrs);
+  numPredecessors.resize(numInstrs);
+
+  /// The accesses to a memory buffer since its last write.
+  struct Accesses {
+    int lastWriter{-1};
+    std::vector<unsigned> readers;
+  };
+  llvm::DenseMap<const Value *, Accesses> accesses;
+  llvm::DenseMap<const Value *, unsigned> definitions;
+  // The instructions since the last barrier that no instruction depends on.
+  std::vector<unsigned> open;
+  int lastBarrier = -1;
+
+  for (unsigned i = 0; i < numInstrs; i++) {
+    const Instruction &I = *instrs[i];
+    llvm::SmallVector<unsigned, 8> preds;
+    if (isBarrier(I)) {
+      preds.append(open.begin(), open.end());
+    } else if (lastBarrier >= 0) {
+      preds.push_back(lastBarrier);
+    }
+
+    for (const auto &op : I.getOperands()) {
+      const Value *V = op.first;
+      // The tensor of an allocation or a view is created by its instruction.
+      auto def = definitions.find(V);
+      if (def != definitions.end()) {
+        preds.push_back(def->second);
+      }
+      // Views are accessed through the buffer that they view.
+      auto &acc = accesses[getOrigin(V)];
+      if (acc.lastWriter >= 0) {
+        preds.push_back(acc.lastWriter);
+      }
+      if (op.second == OperandKind::In) {
+        acc.readers.push_back(i);
+        continue;
+      }
+      preds.append(acc.readers.begin(), acc.readers.end());
+      acc.readers.clear();
+      acc.lastWriter = i;
+    }
+    if (llvm::isa<AllocActivationInst>(&I) || llvm::isa<TensorViewInst>(&I)) {
+      definitions[&I] = i;
+    }
+
+    // Record the dependencies, without duplicates and self dependencies.
+    std::sort(preds.begin(), preds.end());
+    preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+    for (unsigned pred : preds) {
+      if (pred == i) {
+        continue;
+      }
+      successors[pred].push_back(i);
+      numPredecessors[i]++;
+    }
+
+    if (isBarrier(I)) {
+      open.clear();
+      lastBarrier = i;
+    } else {
+      open.erase(std::remove_if(open.begin(), open.end(),
+                                [&](unsigned idx) {
+                                  return std::binary_search(
+                                      preds.begin(), preds.end(), idx);
+                                }),
+                 open.end());
+    }
+    open.push_back(i);
+  }
+}
+
 InterpreterFunction::InterpreterFunction(std::unique_ptr<IRFunction> F,
                                          const runtime::RuntimeBundle &bundle)
-    : CompiledFunction(bundle), F_(std::move(F)) {}
+    : CompiledFunction(bundle), F_(std::move(F)), deps_(*F_) {}
 
 InterpreterFunction::~InterpreterFunction() {
   for (const auto &p : constants_) {
@@ -53,7 +175,7 @@ void InterpreterFunction::collectConstants(Module *module) {
 
 void InterpreterFunction::execute(ExecutionContext *context) {
   BoundInterpreterFunction boundFunc(constants_);
-  boundFunc.execute(F_.get(), context);
+  boundFunc.execute(F_.get(), context, deps_, getInterpreterThreadPool());
   {
     auto ev = context->scopedEvent("processInstrumentation");
     translateTraceEvents(context);
@@ -102,6 +224,7 @@ BoundInterpreterFunction::~BoundInterpreterFunction() {
 }
 
 Tensor *BoundInterpreterFunction::getTensor(const Value *v) const {
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
   auto it = tensors_.find(v);
   if (it != tensors_.end()) {
     return it->second;
@@ -117,6 +240,7 @@ Tensor *BoundInterpreterFunction::getTensor(const Value *v) const {
 }
 
 Tensor *BoundInterpreterFunction::getOrCreateTensor(const Value *v) {
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
   auto ie = externalTensors_.find(v);
   if (ie != externalTensors_.end()) {
     return ie->second;
@@ -140,21 +264,23 @@ Tensor *BoundInterpreterFunction::getOrCreateUnownedTensor(
     const Value *v, const Value *src, llvm::ArrayRef<size_t> offsets) {
   assert(llvm::isa<TensorViewInst>(v) && "Expected a tensor view");
 
-  // Pick the tensor.
-  auto it = tensors_.find(v);
+  auto *T = new Tensor();
+  *T = getTensor(src)->getUnowned(v->dims(), offsets);
 
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
   // Release unowned tensors before re-creating them.
+  auto it = tensors_.find(v);
   if (it != tensors_.end()) {
-    deleteTensor(v);
+    delete it->second;
+    it->second = T;
+    return T;
   }
-
-  auto *T = new Tensor();
-  *T = getTensor(src)->getUnowned(v->dims(), offsets);
   tensors_[v] = T;
   return T;
 }
 
 void BoundInterpreterFunction::deleteTensor(const Value *v) {
+  std::lock_guard<std::mutex> lock(tensorsMutex_);
   auto it = tensors_.find(v);
   if (it == tensors_.end()) {
     return;
@@ -164,23 +290,66 @@ void BoundInterpreterFunction::deleteTensor(const Value *v) {
   tensors_.erase(it);
 }
 
-void BoundInterpreterFunction::execute(IRFunction *F,
-                                       ExecutionContext *context) {
-  {
-    auto ev = context->scopedEvent("registerTensors");
-    // Register the concrete tensors that back the placeholder tensors.
-    for (auto &ph : context->getPlaceholderBindings()->pairs()) {
-      auto *w = F->getWeightForNode(ph.first);
-      // If the Placeholder has been aliased to the same Weight, just skip it.
-      if (externalTensors_.count(w)) {
+/// The state of one concurrent execution of the instructions.
+struct BoundInterpreterFunction::ParallelRun {
+  /// The dependencies between the instructions.
+  const InstrDependencies &deps;
+
+  /// The pool that runs the instructions.
+  ThreadPool &pool;
+
+  /// The number of dependencies of each instruction that did not run yet.
+  std::unique_ptr<std::atomic<unsigned>[]> remaining;
+
+  /// The number of instructions that ran, guarded by mutex.
+  size_t numDone{0};
+  std::mutex mutex;
+  std::condition_variable done;
+
+  ParallelRun(const InstrDependencies &deps, ThreadPool &pool)
+      : deps(deps), pool(pool),
+        remaining(new std::atomic<unsigned>[deps.instrs.size()]) {
+    for (size_t i = 0, e = deps.instrs.size(); i < e; i++) {
+      remaining[i] = deps.numPredecessors[i];
+    }
+  }
+};
+
+void BoundInterpreterFunction::runInstrs(std::shared_ptr<ParallelRun> run,
+                                         unsigned idx) {
+  while (true) {
+    executeInstr(*run->deps.instrs[idx]);
+
+    // Continue on this thread with the first instruction that became ready,
+    // and hand the others to the pool.
+    int next = -1;
+    for (unsigned succ : run->deps.successors[idx]) {
+      if (--run->remaining[succ] != 0) {
         continue;
       }
+      if (next < 0) {
+        next = succ;
+      } else {
+        run->pool.submit([this, run, succ] { runInstrs(run, succ); });
+      }
+    }
 
-      externalTensors_[w] = ph.second;
+    {
+      // Once the last instruction is done, the caller may destroy this
+      // object, so nothing but run is touched after this point.
+      std::lock_guard<std::mutex> lock(run->mutex);
+      if (++run->numDone == run->deps.instrs.size()) {
+        run->done.notify_one();
+      }
     }
+    if (next < 0) {
+      return;
+    }
+    idx = next;
   }
+}
 
-// Do the forward pass.
+void BoundInterpreterFunction::executeInstr(const Instruction &I) {
 #define DEF_VALUE(CLASS, NAME)
 #define DEF_INSTR(CLASS, NAME)                                                 \
   case Kinded::Kind::CLASS##Kind: {                                            \
@@ -188,14 +357,49 @@ void BoundInterpreterFunction::execute(IRFunction *F,
     break;                                                                     \
   }
 #define DEF_BACKEND_SPECIFIC_INSTR(CLASS, NAME)
-  // Dispatch the interpreter on each instruction in the program:
-  for (const auto &I : F->getInstrs()) {
-    switch (I.getKind()) {
+  switch (I.getKind()) {
 #include "glow/AutoGenInstr.def"
 
-    default:
-      llvm_unreachable("Invalid instruction.");
+  default:
+    llvm_unreachable("Invalid instruction.");
+  }
+}
+
+void BoundInterpreterFunction::execute(IRFunction *F,
+                                       ExecutionContext *context,
+                                       const InstrDependencies &deps,
+                                       ThreadPool *pool) {
+  {
+    auto ev = context->scopedEvent("registerTensors");
+    // Register the concrete tensors that back the placeholder tensors.
+    for (auto &ph : context->getPlaceholderBindings()->pairs()) {
+      auto *w = F->getWeightForNode(ph.first);
+      // If the Placeholder has been aliased to the same Weight, just skip it.
+      if (externalTensors_.count(w)) {
+        continue;
+      }
+
+      externalTensors_[w] = ph.second;
+    }
+  }
+
+  // Do the forward pass.
+  if (!pool || deps.instrs.empty()) {
+    for (const auto &I : F->getInstrs()) {
+      executeInstr(I);
+    }
+  } else {
+    // Start with the instructions that depend on nothing, and wait for all
+    // of them to run.
+    auto run = std::make_shared<ParallelRun>(deps, *pool);
+    for (unsigned i = 0, e = deps.instrs.size(); i < e; i++) {
+      if (deps.numPredecessors[i] == 0) {
+        pool->submit([this, run, i] { runInstrs(run, i); });
+      }
     }
+    std::unique_lock<std::mutex> lock(run->mutex);
+    run->done.wait(lock,
+                   [&] { return run->numDone == deps.instrs.size(); });
   }
 
   {
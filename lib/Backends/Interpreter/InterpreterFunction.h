@@ -26,14 +26,18 @@
 #include "llvm/ADT/ArrayRef.h"
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace glow {
 
 class IRFunction;
+class Instruction;
 class Value;
 class Tensor;
 class Constant;
+class ThreadPool;
 
 // Forward declare all of the classes.
 #define DEF_VALUE(CLASS, NAME) class CLASS;
@@ -41,11 +45,32 @@ class Constant;
 #define DEF_BACKEND_SPECIFIC_INSTR(CLASS, NAME)
 #include "glow/AutoGenInstr.def"
 
+/// The dependencies between the instructions of an IRFunction. An
+/// instruction depends on the instructions that last wrote the memory that it
+/// reads or writes, and on the instructions that read the memory that it
+/// writes since. Independent instructions can run concurrently.
+struct InstrDependencies {
+  /// The instructions, in program order.
+  std::vector<const Instruction *> instrs;
+
+  /// The indices of the instructions that depend on each instruction.
+  std::vector<std::vector<unsigned>> successors;
+
+  /// The number of instructions that each instruction depends on.
+  std::vector<unsigned> numPredecessors;
+
+  /// Computes the dependencies of the instructions of \p F.
+  explicit InstrDependencies(const IRFunction &F);
+};
+
 /// Function "compiled" for execution by the interpreter.
 class InterpreterFunction final : public CompiledFunction {
   /// The IR to be executed.
   std::unique_ptr<IRFunction> F_;
 
+  /// The dependencies between the instructions of F_.
+  InstrDependencies deps_;
+
   /// Maps Value.name to tensors for constants.
   std::unordered_map<std::string, Tensor *> constants_;
 
@@ -86,6 +111,12 @@ class BoundInterpreterFunction {
   /// A reference to the constant map from the owning InterpreterFunction.
   const std::unordered_map<std::string, Tensor *> &constants_;
 
+  /// Guards tensors_, which the instructions that run concurrently update.
+  mutable std::mutex tensorsMutex_;
+
+  /// The state of one concurrent execution of the instructions.
+  struct ParallelRun;
+
 public:
   explicit BoundInterpreterFunction(
       const std::unordered_map<std::string, Tensor *> &constants)
@@ -93,9 +124,20 @@ public:
 
   ~BoundInterpreterFunction();
 
-  void execute(IRFunction *F, ExecutionContext *context);
+  /// Executes the instructions of \p F with the bindings of \p context.
+  /// When \p pool is given, independent instructions, as given by \p deps,
+  /// run concurrently on it. Otherwise they run in order on this thread.
+  void execute(IRFunction *F, ExecutionContext *context,
+               const InstrDependencies &deps, ThreadPool *pool);
 
 private:
+  /// Executes the instruction \p I.
+  void executeInstr(const Instruction &I);
+
+  /// Executes the instruction \p idx of \p run, then the instructions that
+  /// become ready.
+  void runInstrs(std::shared_ptr<ParallelRun> run, unsigned idx);
+
   /// \returns a pointer to the tensor that is saved under \p v.
   Tensor *getTensor(const Value *v) const;
 
@@ -276,6 +276,90 @@ void BoundInterpreterFunction::fwdConvolutionInst(const ConvolutionInst *I) {
                             kernelSizes, strides, pads, group);
 }
 
+void BoundInterpreterFunction::fwdChannelwiseQuantizedConvolutionInst(
+    const ChannelwiseQuantizedConvolutionInst *I) {
+  auto inW = getWeightHandle<int8_t>(I->getSrc());
+  auto outW = getWeightHandle<int8_t>(I->getDest());
+  auto filterW = getWeightHandle<int8_t>(I->getFilter());
+  auto biasW = getWeightHandle<int32_t>(I->getBias());
+  auto scalesW = getWeightHandle<float>(I->getScales());
+  auto offsetsW = getWeightHandle<int32_t>(I->getOffsets());
+
+  ShapeNHWC odim(outW.dims());
+  ShapeNHWC idim(inW.dims());
+  ShapeHW kdim(I->getKernels());
+  ShapeHW sdim(I->getStrides());
+  PaddingTLBR pdim(I->getPads());
+  size_t group = I->getGroup();
+
+  assert(idim.c % group == 0 && "Input channels must be divisible by group.");
+  assert(odim.c % group == 0 && "Output channels must be divisible by group.");
+  size_t inCperG = idim.c / group;
+  size_t outCperG = odim.c / group;
+
+  auto inTy = inW.getType();
+  auto biasTy = biasW.getType();
+  auto outTy = outW.getType();
+  int32_t outOffset = outTy.getOffset();
+  int32_t inOffset = inTy.getOffset();
+  int32_t biasOffset = biasTy.getOffset();
+  float outScale = outTy.getScale();
+  float inScale = inTy.getScale();
+  float biasScale = biasTy.getScale();
+
+  // For each input in the batch:
+  for (size_t n = 0; n < idim.n; n++) {
+    // For each group of input channels:
+    for (size_t g = 0; g < group; g++) {
+
+      // For each output channel in the group:
+      for (size_t d = g * outCperG; d < (g + 1) * outCperG; d++) {
+        // The filter of each output channel has its own scale and offset.
+        int32_t filterOffset = offsetsW.raw(d);
+        float matMulScale = inScale * scalesW.raw(d);
+
+        // For each convolution 'jump' in the input tensor:
+        ssize_t x = -ssize_t(pdim.top);
+        for (size_t ax = 0; ax < odim.h; x += sdim.height, ax++) {
+          ssize_t y = -ssize_t(pdim.left);
+          for (size_t ay = 0; ay < odim.w; y += sdim.width, ay++) {
+
+            // For each element in the convolution-filter:
+            int32_t sum = 0;
+            for (size_t fx = 0; fx < kdim.height; fx++) {
+              for (size_t fy = 0; fy < kdim.width; fy++) {
+                ssize_t ox = x + fx;
+                ssize_t oy = y + fy;
+
+                // Ignore index access below zero (this is due to padding).
+                if (ox < 0 || oy < 0 || ox >= ssize_t(idim.h) ||
+                    oy >= ssize_t(idim.w)) {
+                  continue;
+                }
+                for (size_t fd = 0; fd < inCperG; fd++) {
+                  int32_t F = filterW.at({d, fx, fy, fd});
+                  int32_t I =
+                      inW.at({n, (size_t)ox, (size_t)oy, g * inCperG + fd});
+                  sum += (F - filterOffset) * (I - inOffset);
+                }
+              }
+            }
+
+            // Scale the bias to match the scale of the matrix multiplication.
+            int32_t B = std::round(float(biasW.at({d}) - biasOffset) *
+                                   (biasScale / matMulScale));
+            sum += B;
+
+            // Scale the result back to the expected destination scale.
+            outW.at({n, ax, ay, d}) = quantization::clip<int32_t, int8_t>(
+                std::round(float(sum) * (matMulScale / outScale) + outOffset));
+          } // W
+        }   // H
+      }     // C
+    }       // G
+  }         // N
+}
+
 void BoundInterpreterFunction::fwdConvolutionGradInst(
     const ConvolutionGradInst *I) {
   auto inW = getWeightHandle(I->getSrc());
@@ -2439,6 +2523,9 @@ void BoundInterpreterFunction::
   auto WH = weights->getHandle<float>();
   auto OH = out->getHandle<float>();
 
+  // 4-bit data stores two values per byte, low nibble first.
+  const bool is4Bit = data->getElementType() == ElemKind::UInt4FusedQTy;
+
   size_t curIdx = 0;
   for (size_t i = 0; i < segments; i++) {
     for (size_t j = 0, e = LH.raw(i); j < e; j++) {
@@ -2456,8 +2543,9 @@ void BoundInterpreterFunction::
       memcpy(&scale, currRowScaleOffsetPtr, sizeof(float));
       memcpy(&offset, currRowScaleOffsetPtr + sizeof(float), sizeof(float));
       for (size_t k = 0; k < outLineSize; k++) {
-        float d = quantization::dequantizeWithFloatOffset(DH.raw(offsetIn++),
-                                                          scale, offset);
+        uint8_t q = is4Bit ? (DH.raw(offsetIn + k / 2) >> ((k % 2) * 4)) & 0x0F
+                           : DH.raw(offsetIn + k);
+        float d = quantization::dequantizeWithFloatOffset(q, scale, offset);
         OH.raw(offsetOut++) += d * weight;
       }
     }
@@ -2477,6 +2565,37 @@ void BoundInterpreterFunction::fwdLengthsToRangesInst(
   }
 }
 
+void BoundInterpreterFunction::fwdSparseLengthsShardInst(
+    const SparseLengthsShardInst *I) {
+  auto shardWeights = getTensor(I->getShardWeights())->getHandle<float>();
+  auto shardIndices = getTensor(I->getShardIndices())->getHandle<int64_t>();
+  auto shardLengths = getTensor(I->getShardLengths())->getHandle<int32_t>();
+  auto weights = getTensor(I->getWeights())->getHandle<float>();
+  auto indices = getTensor(I->getIndices())->getHandle<int64_t>();
+  auto lengths = getTensor(I->getLengths())->getHandle<int32_t>();
+  const int64_t numShards = I->getNumShards();
+  const int64_t shard = I->getShard();
+
+  shardWeights.clear(0);
+  shardIndices.clear(0);
+  size_t curIdx = 0;
+  size_t shardIdx = 0;
+  for (size_t i = 0, e = lengths.size(); i < e; i++) {
+    int32_t shardLength = 0;
+    for (int32_t j = 0; j < lengths.raw(i); j++, curIdx++) {
+      int64_t index = indices.raw(curIdx);
+      if (index % numShards != shard) {
+        continue;
+      }
+      shardWeights.raw(shardIdx) = weights.raw(curIdx);
+      shardIndices.raw(shardIdx) = index / numShards;
+      shardIdx++;
+      shardLength++;
+    }
+    shardLengths.raw(i) = shardLength;
+  }
+}
+
 template <typename ElemTy>
 void BoundInterpreterFunction::fwdSparseToDenseInstFloatImpl(
     const SparseToDenseInst *I) {
@@ -2654,6 +2773,98 @@ void BoundInterpreterFunction::fwdDeallocActivationInst(
   deleteTensor(I->getSrc());
 }
 
+//===----------------------------------------------------------------------===//
+//                Instructions used for network training
+//===----------------------------------------------------------------------===//
+
+/// \returns the gradient \p g of the weight \p w with the decay terms
+/// \p L1Decay and \p L2Decay added, divided by the \p batchSize.
+static float getDecayedGradient(float g, float w, float L1Decay,
+                                float L2Decay, unsigned batchSize) {
+  if (L1Decay) {
+    g += L1Decay * (0 <= w ? 1 : -1);
+  }
+  if (L2Decay) {
+    g += L2Decay * w;
+  }
+  if (batchSize > 1) {
+    g /= batchSize;
+  }
+  return g;
+}
+
+void BoundInterpreterFunction::fwdSGDInst(const SGDInst *I) {
+  auto destW = getWeightHandle(I->getDest());
+  auto weightW = getWeightHandle(I->getWeight());
+  auto gradW = getWeightHandle(I->getGradient());
+  float L1Decay = I->getL1Decay();
+  float L2Decay = I->getL2Decay();
+  float learningRate = I->getLearningRate();
+  unsigned batchSize = I->getBatchSize();
+
+  // Dest may be the same buffer as Weight, so every element is read before it
+  // is written.
+  for (size_t i = 0, e = destW.size(); i < e; i++) {
+    float w = weightW.raw(i);
+    float g = getDecayedGradient(gradW.raw(i), w, L1Decay, L2Decay, batchSize);
+    destW.raw(i) = w - learningRate * g;
+  }
+}
+
+void BoundInterpreterFunction::fwdMomentumSGDInst(const MomentumSGDInst *I) {
+  auto destW = getWeightHandle(I->getDest());
+  auto weightW = getWeightHandle(I->getWeight());
+  auto gradW = getWeightHandle(I->getGradient());
+  auto gsumW = getWeightHandle(I->getGsum());
+  float L1Decay = I->getL1Decay();
+  float L2Decay = I->getL2Decay();
+  float learningRate = I->getLearningRate();
+  float momentum = I->getMomentum();
+  unsigned batchSize = I->getBatchSize();
+
+  for (size_t i = 0, e = destW.size(); i < e; i++) {
+    float w = weightW.raw(i);
+    float g = getDecayedGradient(gradW.raw(i), w, L1Decay, L2Decay, batchSize);
+    float dx = momentum * gsumW.raw(i) - learningRate * g;
+    gsumW.raw(i) = dx;
+    destW.raw(i) = w + dx;
+  }
+}
+
+void BoundInterpreterFunction::fwdAdamInst(const AdamInst *I) {
+  auto destW = getWeightHandle(I->getDest());
+  auto weightW = getWeightHandle(I->getWeight());
+  auto gradW = getWeightHandle(I->getGradient());
+  auto MW = getWeightHandle(I->getM());
+  auto VW = getWeightHandle(I->getV());
+  auto stepW = getWeightHandle(I->getStep());
+  float L1Decay = I->getL1Decay();
+  float L2Decay = I->getL2Decay();
+  float learningRate = I->getLearningRate();
+  float beta1 = I->getBeta1();
+  float beta2 = I->getBeta2();
+  float epsilon = I->getEpsilon();
+  unsigned batchSize = I->getBatchSize();
+
+  // Count the step and compute the bias corrections of the moments.
+  float step = stepW.raw(0) + 1;
+  stepW.raw(0) = step;
+  float correction1 = 1 - std::pow(beta1, step);
+  float correction2 = 1 - std::pow(beta2, step);
+
+  for (size_t i = 0, e = destW.size(); i < e; i++) {
+    float w = weightW.raw(i);
+    float g = getDecayedGradient(gradW.raw(i), w, L1Decay, L2Decay, batchSize);
+    float m = beta1 * MW.raw(i) + (1 - beta1) * g;
+    float v = beta2 * VW.raw(i) + (1 - beta2) * g * g;
+    MW.raw(i) = m;
+    VW.raw(i) = v;
+    float MHat = m / correction1;
+    float VHat = v / correction2;
+    destW.raw(i) = w - learningRate * MHat / (std::sqrt(VHat) + epsilon);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 //                       Debug instructions
 //===----------------------------------------------------------------------===//
@@ -35,7 +35,11 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
 #define DEBUG_TYPE "opencl"
@@ -81,6 +85,11 @@ llvm::cl::opt<bool> clDoProfile("opencl-profile",
                                 llvm::cl::desc("Profile OpenCL kernels"),
                                 llvm::cl::init(false),
                                 llvm::cl::cat(OpenCLBackendCat));
+llvm::cl::opt<std::string> clProgramCacheDir(
+    "opencl-program-cache",
+    llvm::cl::desc("Directory where the binaries of the built OpenCL programs "
+                   "are cached"),
+    llvm::cl::init(""), llvm::cl::cat(OpenCLBackendCat));
 
 static void dumpCompileLog(cl_device_id dev, cl_program prog) {
 #ifndef NDEBUG
@@ -106,6 +115,189 @@ static void addStringOption(std::vector<std::string> &options,
   options.push_back("-D" + name + "=" + value);
 }
 
+/// \returns the value of the string parameter \p param of \p device.
+static std::string getDeviceString(cl_device_id device, cl_device_info param) {
+  size_t size = 0;
+  clGetDeviceInfo(device, param, 0, nullptr, &size);
+  std::string value(size, '\0');
+  clGetDeviceInfo(device, param, size, &value[0], nullptr);
+  return value;
+}
+
+/// \returns the path of the file in the program cache that holds the binary
+/// of the program built from \p source with \p options for \p device. Unlike
+/// cl_device_id, the name and the driver version of the device identify it
+/// across processes.
+static std::string getProgramCachePath(const std::string &source,
+                                       const std::string &options,
+                                       cl_device_id device) {
+  llvm::MD5 hash;
+  hash.update(source);
+  hash.update(options);
+  for (cl_device_info param : {CL_DEVICE_VENDOR, CL_DEVICE_NAME,
+                               CL_DEVICE_VERSION, CL_DRIVER_VERSION}) {
+    hash.update(getDeviceString(device, param));
+  }
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  llvm::SmallString<32> digest = result.digest();
+  llvm::SmallString<128> path(clProgramCacheDir);
+  llvm::sys::path::append(path, llvm::Twine(digest) + ".clbin");
+  return path.str().str();
+}
+
+/// \returns a program for \p device in \p ctx built with \p options from the
+/// binary in the file \p path, or nullptr if there is no such file or the
+/// binary cannot be used.
+static cl_program loadProgramBinary(cl_context ctx, cl_device_id device,
+                                    const std::string &path,
+                                    const std::string &options) {
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path);
+  if (!fileOrErr) {
+    return nullptr;
+  }
+  size_t size = (*fileOrErr)->getBufferSize();
+  auto *binary =
+      reinterpret_cast<const unsigned char *>((*fileOrErr)->getBufferStart());
+  cl_int binaryStatus;
+  cl_int err;
+  cl_program program = clCreateProgramWithBinary(ctx, 1, &device, &size,
+                                                 &binary, &binaryStatus, &err);
+  if (!program) {
+    return nullptr;
+  }
+  // Programs created from binaries have to be built as well.
+  if (err == CL_SUCCESS && binaryStatus == CL_SUCCESS) {
+    err = clBuildProgram(program, 1, &device, options.c_str(), nullptr,
+                         nullptr);
+  }
+  if (err != CL_SUCCESS || binaryStatus != CL_SUCCESS) {
+    DEBUG_GLOW(llvm::dbgs() << "Ignoring the OpenCL program binary " << path
+                            << "\n");
+    clReleaseProgram(program);
+    return nullptr;
+  }
+  return program;
+}
+
+/// Stores the binary of \p program for \p device into the file \p path. The
+/// binary is written into a temporary file that is renamed, so that
+/// concurrent processes never load a partial binary.
+static void saveProgramBinary(cl_program program, cl_device_id device,
+                              const std::string &path) {
+  cl_uint numDevices;
+  cl_int err = clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES,
+                                sizeof(numDevices), &numDevices, nullptr);
+  if (err != CL_SUCCESS) {
+    return;
+  }
+  std::vector<cl_device_id> devices(numDevices);
+  std::vector<size_t> sizes(numDevices);
+  err = clGetProgramInfo(program, CL_PROGRAM_DEVICES,
+                         sizeof(cl_device_id) * numDevices, devices.data(),
+                         nullptr);
+  err |= clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                          sizeof(size_t) * numDevices, sizes.data(), nullptr);
+  auto it = std::find(devices.begin(), devices.end(), device);
+  if (err != CL_SUCCESS || it == devices.end()) {
+    return;
+  }
+  size_t idx = it - devices.begin();
+  // Only the binary of \p device is requested.
+  std::vector<unsigned char> binary(sizes[idx]);
+  std::vector<unsigned char *> binaries(numDevices, nullptr);
+  binaries[idx] = binary.data();
+  err = clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                         sizeof(unsigned char *) * numDevices, binaries.data(),
+                         nullptr);
+  if (err != CL_SUCCESS || binary.empty()) {
+    return;
+  }
+
+  int fd;
+  llvm::SmallString<128> tmpPath;
+  if (llvm::sys::fs::create_directories(clProgramCacheDir) ||
+      llvm::sys::fs::createUniqueFile(path + ".%%%%%%.tmp", fd, tmpPath)) {
+    return;
+  }
+  llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+  os.write(reinterpret_cast<const char *>(binary.data()), binary.size());
+  os.close();
+  if (os.has_error() || llvm::sys::fs::rename(tmpPath, path)) {
+    os.clear_error();
+    llvm::sys::fs::remove(tmpPath);
+    return;
+  }
+  DEBUG_GLOW(llvm::dbgs() << "Saved the OpenCL program binary " << path
+                          << "\n");
+}
+
+void BufferEventTracker::getWaitList(llvm::ArrayRef<Region> regions,
+                                     std::vector<cl_event> &waitList) const {
+  for (const auto &access : accesses_) {
+    for (const auto &region : regions) {
+      bool overlaps = access.region.begin < region.end &&
+                      region.begin < access.region.end;
+      if (!overlaps || (!access.region.write && !region.write)) {
+        continue;
+      }
+      if (std::find(waitList.begin(), waitList.end(), access.event) ==
+          waitList.end()) {
+        waitList.push_back(access.event);
+      }
+      break;
+    }
+  }
+}
+
+void BufferEventTracker::addCommand(llvm::ArrayRef<Region> regions,
+                                    cl_event event) {
+  for (const auto &region : regions) {
+    if (region.begin == region.end) {
+      continue;
+    }
+    // A command that writes a region waited for all the earlier accesses of
+    // the region, so the later commands only have to wait for it.
+    if (region.write) {
+      size_t kept = 0;
+      for (auto &access : accesses_) {
+        if (access.event != event && region.begin <= access.region.begin &&
+            access.region.end <= region.end) {
+          clReleaseEvent(access.event);
+          continue;
+        }
+        accesses_[kept++] = access;
+      }
+      accesses_.resize(kept);
+    }
+    clRetainEvent(event);
+    accesses_.push_back({region, event});
+  }
+}
+
+void BufferEventTracker::removeCompleted() {
+  size_t kept = 0;
+  for (auto &access : accesses_) {
+    cl_int status;
+    cl_int err =
+        clGetEventInfo(access.event, CL_EVENT_COMMAND_EXECUTION_STATUS,
+                       sizeof(status), &status, nullptr);
+    if (err == CL_SUCCESS && status == CL_COMPLETE) {
+      clReleaseEvent(access.event);
+      continue;
+    }
+    accesses_[kept++] = access;
+  }
+  accesses_.resize(kept);
+}
+
+void BufferEventTracker::clear() {
+  for (auto &access : accesses_) {
+    clReleaseEvent(access.event);
+  }
+  accesses_.clear();
+}
+
 OpenCLFunction::OpenCLFunction(std::unique_ptr<IRFunction> F,
                                const runtime::RuntimeBundle &bundle,
                                TraceInfo traceInfo)
@@ -121,6 +313,17 @@ OpenCLFunction::OpenCLFunction(std::unique_ptr<IRFunction> F,
     }
   }
   setTraceInfo(std::move(traceInfo));
+
+  // Lay out the placeholders in a staging buffer.
+  const uint64_t alignment = 128;
+  for (const auto &symbol : runtimeBundle_.getSymbolTable()) {
+    if (symbol.second.symbolCategory !=
+        runtime::SymbolCategory::Placeholder) {
+      continue;
+    }
+    stagingOffsets_[symbol.first] = stagingSize_;
+    stagingSize_ += alignedSize(symbol.second.size, alignment);
+  }
 }
 
 OpenCLFunction::~OpenCLFunction() {
@@ -195,6 +398,15 @@ OpenCLFunction::createProgram(const std::string &source,
   if (program) {
     return program;
   }
+  // Reuse the binary of a program that an earlier process built.
+  std::string cachePath;
+  if (!clProgramCacheDir.empty()) {
+    cachePath = getProgramCachePath(source, combinedOptions, deviceId);
+    program = loadProgramBinary(ctx, deviceId, cachePath, combinedOptions);
+    if (program) {
+      return program;
+    }
+  }
   // Create a new compiled program.
   program = clCreateProgramWithSource(ctx, 1, &src, nullptr, &err);
   GLOW_ASSERT(program && "clCreateProgramWithSource Failed.");
@@ -204,6 +416,9 @@ OpenCLFunction::createProgram(const std::string &source,
     dumpCompileLog(deviceId, program);
   }
   GLOW_ASSERT(err == CL_SUCCESS && "clBuildProgram Failed.");
+  if (!cachePath.empty()) {
+    saveProgramBinary(program, deviceId, cachePath);
+  }
   // Add this program to the program cache.
   return program;
 }
@@ -307,13 +522,19 @@ void OpenCLFunction::enqueueKernel(llvm::StringRef name,
                                sizeof(kernelType), &kernelType, &retSize);
   GLOW_ASSERT(err == CL_SUCCESS && "Error in clGetKernelInfo.");
 
+  auto waitList = getWaitList();
   cl_event event{nullptr};
-  bool profile = kernelProfiling_;
   err = clEnqueueNDRangeKernel(commands, kernel, global.size(), nullptr,
-                               &global[0], &local[0], 0, nullptr,
-                               profile ? &event : nullptr);
+                               &global[0], &local[0], waitList.size(),
+                               waitList.empty() ? nullptr : waitList.data(),
+                               &event);
   GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueNDRangeKernel.");
-  kernelLaunches.push_back(KernelLaunch(kernel, name, kernelType, event));
+  addCommand(event);
+  if (kernelProfiling_) {
+    clRetainEvent(event);
+  }
+  kernelLaunches.push_back(KernelLaunch(kernel, name, kernelType,
+                                        kernelProfiling_ ? event : nullptr));
 }
 
 /// Enqueue a \p kernel for execution on the command queue \p commands on a
@@ -332,13 +553,52 @@ void OpenCLFunction::enqueueKernel(llvm::StringRef name,
                                sizeof(kernelType), &kernelType, &retSize);
   GLOW_ASSERT(err == CL_SUCCESS && "Error in clGetKernelInfo.");
 
-  cl_event event{nullptr};
-  bool profile = kernelProfiling_;
-  err = clEnqueueNDRangeKernel(commands, kernel, global.size(), nullptr,
-                               &global[0], &local[0], 0, nullptr,
-                               profile ? &event : nullptr);
-  GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueNDRangeKernel.");
-  kernelLaunches.push_back(KernelLaunch(kernel, name, kernelType, event));
+  enqueueKernel(name, commands, kernel, device, global, local, kernelLaunches);
+}
+
+void OpenCLFunction::beginCommands(
+    llvm::ArrayRef<BufferEventTracker::Region> regions) {
+  for (auto event : instrEvents_) {
+    clReleaseEvent(event);
+  }
+  instrEvents_.clear();
+  commandRegions_.assign(regions.begin(), regions.end());
+}
+
+void OpenCLFunction::beginInstr(const Instruction &I) {
+  std::vector<BufferEventTracker::Region> regions;
+  for (unsigned i = 0, e = I.getNumOperands(); i < e; i++) {
+    auto op = I.getOperand(i);
+    uint64_t begin = runtimeBundle_.getValueOffset(op.first);
+    regions.push_back({begin, begin + op.first->getSizeInBytes(),
+                       op.second != OperandKind::In});
+  }
+  beginCommands(regions);
+}
+
+std::vector<cl_event> OpenCLFunction::getWaitList() const {
+  std::vector<cl_event> waitList;
+  events_->getWaitList(commandRegions_, waitList);
+  return waitList;
+}
+
+void OpenCLFunction::addCommand(cl_event event) {
+  events_->addCommand(commandRegions_, event);
+  instrEvents_.push_back(event);
+}
+
+void OpenCLFunction::addCopyCommand(cl_event event, llvm::StringRef name) {
+  addCommand(event);
+  if (kernelProfiling_) {
+    clRetainEvent(event);
+    kernelLaunches_.emplace_back(KernelLaunch(name, name.str(), event));
+  }
+}
+
+void OpenCLFunction::waitForInstr() {
+  if (!instrEvents_.empty()) {
+    clWaitForEvents(instrEvents_.size(), instrEvents_.data());
+  }
 }
 
 void OpenCLFunction::executeConvolution(const OCLConvolutionInst *CC) {
@@ -540,8 +800,11 @@ static void topK(Tensor &outW, Tensor &indW, Tensor &inW, size_t k) {
 }
 
 void OpenCLFunction::execute(ExecutionContext *context) {
-  (void)context;
+  enqueueRun(context);
+  completeRun(context);
+}
 
+void OpenCLFunction::enqueueRun(ExecutionContext *context) {
   auto clBindings = static_cast<runtime::OpenCLDeviceBindings *>(
       context->getDeviceBindings());
 
@@ -549,6 +812,12 @@ void OpenCLFunction::execute(ExecutionContext *context) {
   deviceId_ = clBindings->deviceId;
   commands_ = clBindings->commandQueue;
   context_ = clBindings->context;
+  events_ = clBindings->events ? clBindings->events : &localEvents_;
+  events_->removeCompleted();
+  staging_ = clBindings->staging;
+  constantsOnDevice_ = clBindings->constantsOnDevice;
+  assert((!staging_ || staging_->getSize() >= stagingSize_) &&
+         "The staging buffer is too small");
 
   kernelProfiling_ = clDoProfile || getTraceInfo().autoInstrumented;
 
@@ -565,6 +834,8 @@ void OpenCLFunction::execute(ExecutionContext *context) {
       continue;
     }
 
+    beginInstr(I);
+
     // The kernels are named after the name of the instruction, plus the "W"
     // suffix to prevent name colissions for functions like 'tanh' that are also
     // a part of the OpenCL runtime.
@@ -1162,14 +1433,18 @@ void OpenCLFunction::execute(ExecutionContext *context) {
       size_t destOff = runtimeBundle_.getValueOffset(dest);
       size_t srcOff = runtimeBundle_.getValueOffset(src);
       size_t sizeInBytes = dest->getSizeInBytes();
+      auto waitList = getWaitList();
       cl_event event{nullptr};
-      cl_int err = clEnqueueCopyBuffer(commands_, deviceBuffer_, deviceBuffer_,
-                                       srcOff, destOff, sizeInBytes, 0, nullptr,
-                                       kernelProfiling_ ? &event : nullptr);
+      cl_int err = clEnqueueCopyBuffer(
+          commands_, deviceBuffer_, deviceBuffer_, srcOff, destOff, sizeInBytes,
+          waitList.size(), waitList.empty() ? nullptr : waitList.data(),
+          &event);
+      GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueCopyBuffer.");
+      addCommand(event);
       if (kernelProfiling_) {
+        clRetainEvent(event);
         kernelLaunches_.emplace_back(KernelLaunch(I.getName(), "copy", event));
       }
-      GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueCopyBuffer.");
       continue;
     }
 
@@ -1225,13 +1500,12 @@ void OpenCLFunction::execute(ExecutionContext *context) {
     }
 
     if (auto *DP = dyn_cast<DebugPrintInst>(&I)) {
-      clFinish(commands_);
       auto *V = DP->getSrc();
       // Allocate a temporary tensor to hold the value.
       Tensor T(V->getType());
       // Load the current value of the variable into host memory.
       copyValueFromDevice(V, T.getUnsafePtr());
-      clFinish(commands_);
+      waitForInstr();
       llvm::outs() << I.getName() << ": ";
       // Dump the content of a value.
       V->dump();
@@ -1250,11 +1524,15 @@ void OpenCLFunction::execute(ExecutionContext *context) {
       llvm::SmallVector<size_t, 4> local(global.size(), 0);
       getMaxLocalWorkgroupSize(kernel, deviceId_, global, local);
 
+      auto waitList = getWaitList();
       cl_event event;
-      cl_int err =
-          clEnqueueNDRangeKernel(commands_, kernel, global.size(), nullptr,
-                                 &global[0], &local[0], 0, nullptr, &event);
+      cl_int err = clEnqueueNDRangeKernel(
+          commands_, kernel, global.size(), nullptr, &global[0], &local[0],
+          waitList.size(), waitList.empty() ? nullptr : waitList.data(),
+          &event);
       GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueNDRangeKernel.");
+      addCommand(event);
+      clRetainEvent(event);
       kernelLaunches_.push_back(
           KernelLaunch(kernel, TE->getName(), "checkpoint", event));
       continue;
@@ -1265,7 +1543,6 @@ void OpenCLFunction::execute(ExecutionContext *context) {
     // tensor from GPU memory to host memory, perform the computation, and then
     // copy the results back to GPU memory.
     if (auto *TK = dyn_cast<TopKInst>(&I)) {
-      clFinish(commands_);
       auto *destDev = TK->getValues();
       auto *indDev = TK->getIndices();
       auto *srcDev = TK->getInput();
@@ -1275,7 +1552,7 @@ void OpenCLFunction::execute(ExecutionContext *context) {
       size_t k = TK->getK();
 
       copyValueFromDevice(srcDev, srcT.getUnsafePtr());
-      clFinish(commands_);
+      waitForInstr();
 
       if (isQuantized) {
         topK<int8_t>(destT, indT, srcT, k);
@@ -1284,7 +1561,8 @@ void OpenCLFunction::execute(ExecutionContext *context) {
       }
       copyValueToDevice(destDev, destT.getUnsafePtr());
       copyValueToDevice(indDev, indT.getUnsafePtr());
-      clFinish(commands_);
+      // The host tensors have to outlive the copies.
+      waitForInstr();
       continue;
     }
 
@@ -1344,12 +1622,36 @@ void OpenCLFunction::execute(ExecutionContext *context) {
 
   enqueueEvent.end();
 
-  clFinish(commands_);
-
   {
     auto ev = context->scopedEvent("updatePlaceholders");
     updatePlaceholders(context->getPlaceholderBindings());
   }
+  beginCommands({});
+
+  // On a queue of its own, the run completes when all the commands that were
+  // enqueued before the marker completed.
+  cl_int err = clEnqueueMarkerWithWaitList(commands_, 0, nullptr,
+                                           &clBindings->completion);
+  GLOW_ASSERT(err == CL_SUCCESS && "Error in clEnqueueMarkerWithWaitList.");
+  // Submit the commands without waiting for them.
+  clFlush(commands_);
+  clBindings->kernelLaunches = std::move(kernelLaunches_);
+  kernelLaunches_.clear();
+}
+
+void OpenCLFunction::completeRun(ExecutionContext *context) {
+  auto clBindings = static_cast<runtime::OpenCLDeviceBindings *>(
+      context->getDeviceBindings());
+  {
+    auto ev = context->scopedEvent("waitForRun");
+    clWaitForEvents(1, &clBindings->completion);
+  }
+
+  if (clBindings->staging) {
+    auto ev = context->scopedEvent("copyOutputsFromStaging");
+    copyOutputsFromStaging(context->getPlaceholderBindings(),
+                           *clBindings->staging);
+  }
 
   {
     auto ev = context->scopedEvent("processInstrumentation");
@@ -1359,10 +1661,15 @@ void OpenCLFunction::execute(ExecutionContext *context) {
 
   {
     auto ev = context->scopedEvent("releaseKernels");
-    for (auto &kl : kernelLaunches_) {
-      clReleaseKernel(kl.kernel_);
+    for (auto &kl : clBindings->kernelLaunches) {
+      if (kl.kernel_) {
+        clReleaseKernel(kl.kernel_);
+      }
+      if (kl.event_) {
+        clReleaseEvent(kl.event_);
+      }
     }
-    kernelLaunches_.clear();
+    clBindings->kernelLaunches.clear();
   }
 }
 
@@ -1373,17 +1680,14 @@ uint64_t OpenCLFunction::copyValueToDevice(const Value *v, void *buf) {
   // Issue a non-blocking command to copy the buffer to the device.
   if (sizeInBytes) {
     size_t valueOffset = symbolInfo.offset;
+    auto waitList = getWaitList();
     cl_event event{nullptr};
     cl_int err = clEnqueueWriteBuffer(
         commands_, deviceBuffer_, /* blocking_write */ CL_FALSE, valueOffset,
-        sizeInBytes, buf, /* num_events_in_wait_list */ 0,
-        /* event_list */ nullptr,
-        /* event */ kernelProfiling_ ? &event : nullptr);
+        sizeInBytes, buf, waitList.size(),
+        waitList.empty() ? nullptr : waitList.data(), &event);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data to the device");
-    if (kernelProfiling_) {
-      kernelLaunches_.emplace_back(
-          KernelLaunch("copyValueToDevice", "copyValueToDevice", event));
-    }
+    addCopyCommand(event, "copyValueToDevice");
     copiedBytes += sizeInBytes;
   }
   return copiedBytes;
@@ -1396,19 +1700,16 @@ uint64_t OpenCLFunction::copyValueFromDevice(const Value *v, void *buf) {
   // Issue a non-blocking command to copy the buffer from the device.
   if (sizeInBytes) {
     size_t valueOffset = symbolInfo.offset;
+    auto waitList = getWaitList();
     cl_event event{nullptr};
     cl_int err = clEnqueueReadBuffer(
         commands_, deviceBuffer_, /* blocking_read */ CL_FALSE, valueOffset,
-        sizeInBytes, buf, /* num_events_in_wait_list */ 0,
-        /* event_list */ nullptr,
-        /* event */ kernelProfiling_ ? &event : nullptr);
+        sizeInBytes, buf, waitList.size(),
+        waitList.empty() ? nullptr : waitList.data(), &event);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy from the device");
     DEBUG_GLOW(llvm::dbgs()
                << "Copied the value from device: " << v->getName() << "\n");
-    if (kernelProfiling_) {
-      kernelLaunches_.emplace_back(
-          KernelLaunch("copyValueFromDevice", "copyValueFromDevice", event));
-    }
+    addCopyCommand(event, "copyValueFromDevice");
     copiedBytes += sizeInBytes;
   }
   return copiedBytes;
@@ -1416,26 +1717,63 @@ uint64_t OpenCLFunction::copyValueFromDevice(const Value *v, void *buf) {
 
 void OpenCLFunction::loadPlaceholders(PlaceholderBindings *bindings) {
   size_t sizeInBytes = runtimeBundle_.getConstantWeightSize();
-  if (runtimeBundle_.getConstants()) {
+  if (!constantsOnDevice_ && runtimeBundle_.getConstants()) {
     // Issue a non-blocking command to copy the buffer to the device.
     auto buf = runtimeBundle_.getConstants();
     size_t valueOffset = 0;
+    beginCommands({{valueOffset, valueOffset + sizeInBytes, true}});
+    auto waitList = getWaitList();
     cl_event event{nullptr};
     cl_int err = clEnqueueWriteBuffer(
         commands_, deviceBuffer_, /* blocking_write */ CL_FALSE, valueOffset,
-        sizeInBytes, buf, /* num_events_in_wait_list */ 0,
-        /* event_list */ nullptr,
-        /* event */ kernelProfiling_ ? &event : nullptr);
+        sizeInBytes, buf, waitList.size(),
+        waitList.empty() ? nullptr : waitList.data(), &event);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data to the device");
-    if (kernelProfiling_) {
-      kernelLaunches_.emplace_back(KernelLaunch(
-          "copyConstantsToDevice", "copyConstantsToDevice", event));
-    }
-    // Do it!
-    clFinish(commands_);
+    addCopyCommand(event, "copyConstantsToDevice");
   }
 
   auto &symbolTable = runtimeBundle_.getSymbolTable();
+  if (staging_) {
+    // Copy the inputs into the mapped staging buffer, then let the device
+    // copy them from there once it is unmapped.
+    for (auto PH : bindings->pairs()) {
+      auto it = stagingOffsets_.find(PH.first->getName());
+      if (it == stagingOffsets_.end()) {
+        continue;
+      }
+      memcpy(staging_->getHostPtr() + it->second, PH.second->getUnsafePtr(),
+             symbolTable.find(it->first)->second.size);
+    }
+    cl_event unmapEvent;
+    cl_int err = clEnqueueUnmapMemObject(commands_, staging_->getBuffer(),
+                                         staging_->getHostPtr(), 0, nullptr,
+                                         &unmapEvent);
+    GLOW_ASSERT(err == CL_SUCCESS && "Unable to unmap the staging buffer");
+    staging_->setHostPtr(nullptr);
+    stagingEvents_.push_back(unmapEvent);
+
+    for (auto PH : bindings->pairs()) {
+      auto it = stagingOffsets_.find(PH.first->getName());
+      if (it == stagingOffsets_.end()) {
+        continue;
+      }
+      auto addr = symbolTable.find(it->first)->second.offset;
+      auto numBytes = symbolTable.find(it->first)->second.size;
+      beginCommands({{addr, addr + numBytes, true}});
+      auto waitList = getWaitList();
+      waitList.push_back(unmapEvent);
+      cl_event event{nullptr};
+      err = clEnqueueCopyBuffer(commands_, staging_->getBuffer(), deviceBuffer_,
+                                it->second, addr, numBytes, waitList.size(),
+                                waitList.data(), &event);
+      GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data to the device");
+      addCopyCommand(event, "copyInputsToDevice");
+      clRetainEvent(event);
+      stagingEvents_.push_back(event);
+    }
+    return;
+  }
+
   for (auto PH : bindings->pairs()) {
     auto it = symbolTable.find(PH.first->getName());
     if (it == symbolTable.end()) {
@@ -1444,27 +1782,63 @@ void OpenCLFunction::loadPlaceholders(PlaceholderBindings *bindings) {
     auto symbolInfo = it->second;
     auto addr = symbolInfo.offset;
     auto numBytes = symbolInfo.size;
-    // Issue a non-blocking command to copy the buffer to the device.
+    // Issue a non-blocking command to copy the buffer to the device. Only the
+    // commands of earlier runs that access the same placeholder delay it.
     auto buf = PH.second->getUnsafePtr();
+    beginCommands({{addr, addr + numBytes, true}});
+    auto waitList = getWaitList();
     cl_event event{nullptr};
 
     cl_int err = clEnqueueWriteBuffer(
         commands_, deviceBuffer_, /* blocking_write */ CL_FALSE, addr, numBytes,
-        buf, /* num_events_in_wait_list */ 0,
-        /* event_list */ nullptr,
-        /* event */ kernelProfiling_ ? &event : nullptr);
+        buf, waitList.size(), waitList.empty() ? nullptr : waitList.data(),
+        &event);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data to the device");
-    if (kernelProfiling_) {
-      kernelLaunches_.emplace_back(
-          KernelLaunch("copyInputsToDevice", "copyInputsToDevice", event));
-    }
+    addCopyCommand(event, "copyInputsToDevice");
   }
-  // Do it!
-  clFinish(commands_);
 }
 
 void OpenCLFunction::updatePlaceholders(PlaceholderBindings *bindings) {
   auto &symbolTable = runtimeBundle_.getSymbolTable();
+  if (staging_) {
+    // Copy the outputs into the staging buffer, then map it. The host copies
+    // them into the tensors when the run completed.
+    for (auto PH : bindings->pairs()) {
+      auto it = stagingOffsets_.find(PH.first->getName());
+      if (it == stagingOffsets_.end()) {
+        continue;
+      }
+      auto addr = symbolTable.find(it->first)->second.offset;
+      auto numBytes = symbolTable.find(it->first)->second.size;
+      beginCommands({{addr, addr + numBytes, false}});
+      auto waitList = getWaitList();
+      // The staging buffer has to be unmapped, and the input may share the
+      // region of the output.
+      waitList.insert(waitList.end(), stagingEvents_.begin(),
+                      stagingEvents_.end());
+      cl_event event{nullptr};
+      cl_int err = clEnqueueCopyBuffer(
+          commands_, deviceBuffer_, staging_->getBuffer(), addr, it->second,
+          numBytes, waitList.size(), waitList.data(), &event);
+      GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data from the device");
+      addCopyCommand(event, "copyOutputsFromDevice");
+      clRetainEvent(event);
+      stagingEvents_.push_back(event);
+    }
+    cl_int err;
+    void *hostPtr = clEnqueueMapBuffer(
+        commands_, staging_->getBuffer(), /* blocking_map */ CL_FALSE,
+        CL_MAP_READ | CL_MAP_WRITE, 0, staging_->getSize(),
+        stagingEvents_.size(), stagingEvents_.data(), nullptr, &err);
+    GLOW_ASSERT(err == CL_SUCCESS && "Unable to map the staging buffer");
+    staging_->setHostPtr(hostPtr);
+    for (auto event : stagingEvents_) {
+      clReleaseEvent(event);
+    }
+    stagingEvents_.clear();
+    return;
+  }
+
   for (auto PH : bindings->pairs()) {
     auto it = symbolTable.find(PH.first->getName());
     if (it == symbolTable.end()) {
@@ -1473,23 +1847,32 @@ void OpenCLFunction::updatePlaceholders(PlaceholderBindings *bindings) {
     auto symbolInfo = it->second;
     auto addr = symbolInfo.offset;
     auto numBytes = symbolInfo.size;
-    // Issue a non-blocking command to copy the buffer to the device.
+    // Issue a non-blocking command to copy the buffer from the device.
     auto buf = PH.second->getUnsafePtr();
+    beginCommands({{addr, addr + numBytes, false}});
+    auto waitList = getWaitList();
     cl_event event{nullptr};
 
     cl_int err = clEnqueueReadBuffer(
         commands_, deviceBuffer_, /* blocking_read */ CL_FALSE, addr, numBytes,
-        buf, /* num_events_in_wait_list */ 0,
-        /* event_list */ nullptr,
-        /* event */ kernelProfiling_ ? &event : nullptr);
+        buf, waitList.size(), waitList.empty() ? nullptr : waitList.data(),
+        &event);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data from the device");
-    if (kernelProfiling_) {
-      kernelLaunches_.emplace_back(KernelLaunch(
-          "copyOutputsFromDevice", "copyOutputsFromDevice", event));
+    addCopyCommand(event, "copyOutputsFromDevice");
+  }
+}
+
+void OpenCLFunction::copyOutputsFromStaging(
+    PlaceholderBindings *bindings, const OpenCLStagingBuffer &staging) const {
+  auto &symbolTable = runtimeBundle_.getSymbolTable();
+  for (auto PH : bindings->pairs()) {
+    auto it = stagingOffsets_.find(PH.first->getName());
+    if (it == stagingOffsets_.end()) {
+      continue;
     }
+    memcpy(PH.second->getUnsafePtr(), staging.getHostPtr() + it->second,
+           symbolTable.find(it->first)->second.size);
   }
-  // Do it!
-  clFinish(commands_);
 }
 
 cl_mem OpenCLFunction::allocDeviceBuffer(uint64_t size) {
@@ -1519,8 +1902,10 @@ void OpenCLFunction::translateTraceEvents(ExecutionContext *context) const {
   auto &traceEvents = context->getTraceContext()->getTraceEvents();
   int tid = context->getTraceContext()->getTraceThread();
   std::vector<cl_ulong> manualTimestamps;
+  auto clBindings = static_cast<runtime::OpenCLDeviceBindings *>(
+      context->getDeviceBindings());
 
-  for (auto &kl : kernelLaunches_) {
+  for (auto &kl : clBindings->kernelLaunches) {
     auto &event = kl.event_;
     if (event == nullptr) {
       continue;
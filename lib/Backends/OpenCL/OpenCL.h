@@ -60,6 +60,83 @@ struct KernelLaunch {
       : kernel_(nullptr), name_(name), type_(type), event_(event) {}
 };
 
+/// Orders the commands that access a device buffer. Every command records the
+/// regions of the buffer that it reads and writes, and only waits for the
+/// earlier commands that write a region it accesses or read a region it writes.
+/// This lets the commands run on an out-of-order command queue, and lets the
+/// commands of consecutive runs overlap.
+class BufferEventTracker {
+public:
+  /// A region of the buffer that a command accesses.
+  struct Region {
+    /// The offset of the first byte of the region.
+    uint64_t begin;
+    /// The offset after the last byte of the region.
+    uint64_t end;
+    /// Whether the command writes the region.
+    bool write;
+  };
+
+  ~BufferEventTracker() { clear(); }
+
+  /// Adds to \p waitList the events of the commands that have to complete
+  /// before a command that accesses \p regions starts.
+  void getWaitList(llvm::ArrayRef<Region> regions,
+                   std::vector<cl_event> &waitList) const;
+
+  /// Records that the command of \p event accesses \p regions.
+  void addCommand(llvm::ArrayRef<Region> regions, cl_event event);
+
+  /// Forgets the commands that have completed.
+  void removeCompleted();
+
+  /// Forgets all commands.
+  void clear();
+
+private:
+  /// A region accessed by a command, and the event of the command.
+  struct Access {
+    Region region;
+    cl_event event;
+  };
+
+  /// The accesses that later commands may have to wait for. Every access
+  /// holds a reference to its event.
+  std::vector<Access> accesses_;
+};
+
+/// A buffer in pinned host memory (CL_MEM_ALLOC_HOST_PTR) through which the
+/// placeholders of a run are transferred. The host copies the inputs into it
+/// while it is mapped, and the device copies them into the device buffer after
+/// it is unmapped. The outputs take the opposite way. A device that shares
+/// memory with the host accesses the staging buffer without copies.
+class OpenCLStagingBuffer {
+  /// The pinned buffer.
+  cl_mem buffer_;
+  /// The address at which the buffer is mapped, or nullptr if it is unmapped.
+  void *hostPtr_;
+  /// Size of the buffer in bytes.
+  const size_t size_;
+
+public:
+  OpenCLStagingBuffer(cl_mem buffer, void *hostPtr, size_t size)
+      : buffer_(buffer), hostPtr_(hostPtr), size_(size) {}
+
+  ~OpenCLStagingBuffer() { clReleaseMemObject(buffer_); }
+
+  /// Returns the pinned buffer.
+  cl_mem getBuffer() const { return buffer_; }
+
+  /// Returns the address at which the buffer is mapped.
+  uint8_t *getHostPtr() const { return static_cast<uint8_t *>(hostPtr_); }
+
+  /// Sets the address at which the buffer is mapped to \p hostPtr.
+  void setHostPtr(void *hostPtr) { hostPtr_ = hostPtr; }
+
+  /// Get size of buffer in bytes.
+  size_t getSize() const { return size_; }
+};
+
 /// Add an macro definition with an integer value to the set of options.
 template <typename T>
 static void addIntOption(std::vector<std::string> &options,
@@ -101,6 +178,27 @@ class OpenCLFunction final : public CompiledFunction {
   /// Manual trace events:
   std::map<std::string, std::pair<Placeholder *, const TraceInfo::Event *>>
       manualTraceEvents_;
+  /// Orders the commands of the current run. Points to the tracker of the
+  /// device buffer, or to localEvents_ if the buffer has no tracker.
+  BufferEventTracker *events_{nullptr};
+  /// Tracker for runs on device buffers that don't have their own.
+  BufferEventTracker localEvents_;
+  /// The regions of the device buffer that the command being enqueued
+  /// accesses.
+  std::vector<BufferEventTracker::Region> commandRegions_;
+  /// The events of the commands enqueued for the current instruction.
+  std::vector<cl_event> instrEvents_;
+  /// Offsets of the placeholders in a staging buffer.
+  std::unordered_map<std::string, size_t> stagingOffsets_;
+  /// Size of a staging buffer that holds all the placeholders.
+  size_t stagingSize_{0};
+  /// The staging buffer of the current run, or nullptr.
+  OpenCLStagingBuffer *staging_{nullptr};
+  /// The events of the commands of the current run that access staging_.
+  std::vector<cl_event> stagingEvents_;
+  /// Whether the device buffer of the current run already holds the
+  /// constants.
+  bool constantsOnDevice_{false};
 
 public:
   /// Ctor.
@@ -112,6 +210,7 @@ public:
   ///@{
   ~OpenCLFunction() override;
 
+  /// Enqueues a run and waits for it to complete.
   void execute(ExecutionContext *context) override;
 
   /// Collects constants for runtime.
@@ -127,10 +226,25 @@ public:
   IRFunction *getIR() { return F_.get(); }
 
   /// Create a program from the \p source using provided \p options.
+  /// If a program cache directory is set, the binary of the program is loaded
+  /// from it, or stored into it after the program was built.
   cl_program createProgram(const std::string &source,
                            const std::vector<std::string> &options,
                            cl_command_queue queue);
 
+  /// \returns the size of a staging buffer for the placeholders.
+  size_t getStagingSize() const { return stagingSize_; }
+
+  /// Enqueues all the commands of a run with the device bindings of \p
+  /// context without waiting for them. The commands wait for the commands of
+  /// earlier runs that access the same parts of the device buffer. The
+  /// completion event of the run is stored in the device bindings.
+  void enqueueRun(ExecutionContext *context);
+
+  /// Waits for the completion event of a run enqueued by enqueueRun with \p
+  /// context, then translates the trace events and releases the kernels.
+  void completeRun(ExecutionContext *context);
+
 private:
   /// Copy the value from a device to a provided buffer.
   /// \returns number of copied bytes.
@@ -144,6 +258,22 @@ private:
   void fillBuffer(cl_mem buffer, uint64_t start, uint64_t len, float value,
                   ElemKind elemKind);
 
+  /// Sets the \p regions that the next commands access, and releases the
+  /// events of the previous commands.
+  void beginCommands(llvm::ArrayRef<BufferEventTracker::Region> regions);
+  /// Sets the regions that the commands enqueued for the instruction \p I
+  /// access, and releases the events of the commands of the previous
+  /// instruction.
+  void beginInstr(const Instruction &I);
+  /// \returns the events that the next command has to wait for.
+  std::vector<cl_event> getWaitList() const;
+  /// Records the \p event of an enqueued command.
+  void addCommand(cl_event event);
+  /// Records the \p event of an enqueued buffer copy called \p name.
+  void addCopyCommand(cl_event event, llvm::StringRef name);
+  /// Waits for the commands enqueued for the current instruction.
+  void waitForInstr();
+
   /// Execution a convolution instruction which uses NCHW format.
   void executeConvolution(const OCLConvolutionInst *CC);
   /// Allocate a device buffer of required \p size.
@@ -169,12 +299,17 @@ private:
                      llvm::ArrayRef<size_t> local,
                      std::vector<KernelLaunch> &kernelLaunches);
 
-  /// Load inputs from \p bindings onto the device.
+  /// Load inputs from \p bindings onto the device, and the constants unless
+  /// the device buffer already holds them.
   void loadPlaceholders(PlaceholderBindings *bindings);
 
   /// Load outputs from the device into \p bindings.
   void updatePlaceholders(PlaceholderBindings *bindings);
 
+  /// Copy the outputs of a run from the \p staging buffer into \p bindings.
+  void copyOutputsFromStaging(PlaceholderBindings *bindings,
+                              const OpenCLStagingBuffer &staging) const;
+
   /// Read trace events out of this func and write them into /p bindings
   void translateTraceEvents(ExecutionContext *context) const override;
 };
@@ -231,9 +366,11 @@ namespace runtime {
 /// device.
 struct OpenCLDeviceBindings : DeviceBindings {
   OpenCLDeviceBindings(cl_mem buffer, cl_command_queue commands,
-                       cl_device_id device, cl_context ctx)
+                       cl_device_id device, cl_context ctx,
+                       BufferEventTracker *events = nullptr)
       : DeviceBindings(BackendKind::OpenCL), deviceBuffer{buffer},
-        commandQueue{commands}, deviceId{device}, context{ctx} {}
+        commandQueue{commands}, deviceId{device}, context{ctx},
+        events{events} {}
 
   /// CL memory buffer. Currently this contains both mutable and immutable
   /// weights, the buffer is allocated once when the network is added.
@@ -251,6 +388,32 @@ struct OpenCLDeviceBindings : DeviceBindings {
   /// will take place in.
   ///
   cl_context context;
+
+  /// Orders the commands that access deviceBuffer across runs. May be null.
+  BufferEventTracker *events;
+
+  /// Whether deviceBuffer already holds the constants, so that the run does
+  /// not upload them.
+  bool constantsOnDevice{false};
+
+  /// The staging buffer through which the placeholders are transferred. If it
+  /// is null, they are transferred from and to the tensors directly.
+  OpenCLStagingBuffer *staging{nullptr};
+
+  /// The event that completes when all the commands of the run completed.
+  cl_event completion{nullptr};
+
+  /// Information about the kernel launches of the run.
+  std::vector<KernelLaunch> kernelLaunches;
+
+  /// Waits for the run, since its transfers may still access the host
+  /// tensors of the placeholder bindings.
+  ~OpenCLDeviceBindings() override {
+    if (completion) {
+      clWaitForEvents(1, &completion);
+      clReleaseEvent(completion);
+    }
+  }
 };
 } // namespace runtime
 } // namespace glow
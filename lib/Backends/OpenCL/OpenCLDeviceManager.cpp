@@ -117,13 +117,40 @@ llvm::Error OpenCLDeviceManager::init() {
   }
   maxMemoryBytes_ = mem_size;
 
+  cl_command_queue_properties queueProperties;
+  err = clGetDeviceInfo(deviceId_, CL_DEVICE_QUEUE_PROPERTIES,
+                        sizeof(queueProperties), &queueProperties, NULL);
+  if (err != CL_SUCCESS) {
+    RETURN_ERR("Error getting device queue properties");
+  }
+  queueProperties_ = queueProperties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+
   return llvm::Error::success();
 }
 
 OpenCLDeviceManager::~OpenCLDeviceManager() {
+  llvm::toString(stop(true));
+  for (auto &queues : queuePool_) {
+    for (auto commands : queues.second) {
+      clReleaseCommandQueue(commands);
+    }
+  }
+  stagingPool_.clear();
   clReleaseContext(context_);
   buffers_.clear();
 }
+
+llvm::Error OpenCLDeviceManager::stop(bool block) {
+  workThread_.stop(block);
+  // Stopping the completion thread drops its queued tasks, so let it first
+  // complete the runs that were enqueued and fire their resultCB.
+  if (!completionDrained_) {
+    completionThread_.submit([] {}).wait();
+    completionDrained_ = true;
+  }
+  completionThread_.stop(block);
+  return llvm::Error::success();
+}
 uint64_t OpenCLDeviceManager::getMaximumMemory() const {
   return maxMemoryBytes_;
 }
@@ -205,6 +232,9 @@ void OpenCLDeviceManager::addNetworkImpl(const Module *module,
         /* event_list */ nullptr, /* event */ doProfile_ ? &event : nullptr);
     GLOW_ASSERT(err == CL_SUCCESS && "Unable to copy data to the device");
     clFinish(commands);
+    // The constants are on the device now, so the runs don't copy them. The
+    // bundle keeps its copy: the same CompiledFunction may still be added to
+    // other devices, which upload the constants from it.
   }
   usedMemoryBytes_ += sizeInBytes;
   // Compile the CL program.
@@ -271,13 +301,71 @@ OpenCLDeviceManager::requestRunCommandQueue(CompiledFunction *function) {
   if (clDoProfile || traceInfo.enabled) {
     profiling = CL_QUEUE_PROFILING_ENABLE;
   }
+  cl_command_queue_properties properties = profiling | queueProperties_;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    auto &queues = queuePool_[properties];
+    if (!queues.empty()) {
+      cl_command_queue commands = queues.back();
+      queues.pop_back();
+      return commands;
+    }
+  }
   cl_command_queue commands =
-      clCreateCommandQueue(context_, deviceId_, profiling, &err);
+      clCreateCommandQueue(context_, deviceId_, properties, &err);
   return commands;
 }
 
 void OpenCLDeviceManager::returnRunCommandQueue(cl_command_queue commands) {
-  clReleaseCommandQueue(commands);
+  cl_command_queue_properties properties;
+  cl_int err = clGetCommandQueueInfo(commands, CL_QUEUE_PROPERTIES,
+                                     sizeof(properties), &properties, nullptr);
+  if (err != CL_SUCCESS) {
+    clReleaseCommandQueue(commands);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(poolMutex_);
+  queuePool_[properties].push_back(commands);
+}
+
+std::unique_ptr<OpenCLStagingBuffer>
+OpenCLDeviceManager::requestStagingBuffer(size_t size,
+                                          cl_command_queue commands) {
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    auto best = stagingPool_.end();
+    for (auto it = stagingPool_.begin(); it != stagingPool_.end(); ++it) {
+      if ((*it)->getSize() >= size &&
+          (best == stagingPool_.end() ||
+           (*it)->getSize() < (*best)->getSize())) {
+        best = it;
+      }
+    }
+    if (best != stagingPool_.end()) {
+      auto staging = std::move(*best);
+      stagingPool_.erase(best);
+      return staging;
+    }
+  }
+
+  // The driver allocates the buffer in pinned host memory, which the device
+  // accesses directly.
+  cl_int err;
+  cl_mem buffer = clCreateBuffer(
+      context_, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size, nullptr, &err);
+  GLOW_ASSERT(buffer && "Staging buffer allocation failed!");
+  void *hostPtr =
+      clEnqueueMapBuffer(commands, buffer, /* blocking_map */ CL_TRUE,
+                         CL_MAP_READ | CL_MAP_WRITE, 0, size, 0, nullptr,
+                         nullptr, &err);
+  GLOW_ASSERT(err == CL_SUCCESS && "Unable to map the staging buffer");
+  return llvm::make_unique<OpenCLStagingBuffer>(buffer, hostPtr, size);
+}
+
+void OpenCLDeviceManager::returnStagingBuffer(
+    std::unique_ptr<OpenCLStagingBuffer> staging) {
+  std::lock_guard<std::mutex> lock(poolMutex_);
+  stagingPool_.push_back(std::move(staging));
 }
 
 void OpenCLDeviceManager::runFunctionImpl(
@@ -295,26 +383,45 @@ void OpenCLDeviceManager::runFunctionImpl(
     return;
   }
 
-  CompiledFunction *func = funcIt->second;
+  OpenCLFunction *func = static_cast<OpenCLFunction *>(funcIt->second);
 
   // Get a command queue for this run.
   cl_command_queue commands = requestRunCommandQueue(func);
 
   // Create and set deviceBindings for call. This contains all the state needed
   // for the function to run on a device.
+  auto buffer = buffers_[function];
   auto clBindings = llvm::make_unique<runtime::OpenCLDeviceBindings>(
-      buffers_[function]->getBuffer(), commands, deviceId_, context_);
+      buffer->getBuffer(), commands, deviceId_, context_, &buffer->getEvents());
+  // addNetworkImpl uploaded the constants into the buffer.
+  clBindings->constantsOnDevice = true;
+  // Transfer the placeholders through a pinned staging buffer.
+  std::unique_ptr<OpenCLStagingBuffer> staging;
+  if (func->getStagingSize()) {
+    staging = requestStagingBuffer(func->getStagingSize(), commands);
+    clBindings->staging = staging.get();
+  }
   context->setDeviceBindings(std::move(clBindings));
 
-  // Run that function.
-  func->execute(context.get());
+  // Enqueue the run. The next run can be enqueued while this one executes.
+  func->enqueueRun(context.get());
+
+  completionThread_.submit([this, id, func, commands, buffer,
+                            staging = std::move(staging),
+                            context = std::move(context),
+                            resultCB = std::move(resultCB)]() mutable {
+    func->completeRun(context.get());
 
-  // Return the command queue.
-  returnRunCommandQueue(commands);
+    // Return the command queue and the staging buffer.
+    returnRunCommandQueue(commands);
+    if (staging) {
+      returnStagingBuffer(std::move(staging));
+    }
 
-  // End the TraceEvent early to avoid time in the CB.
-  TRACE_EVENT_END(context, "DM_run");
+    // End the TraceEvent early to avoid time in the CB.
+    TRACE_EVENT_END(context, "DM_run");
 
-  // Fire the resultCB.
-  resultCB(id, llvm::Error::success(), std::move(context));
+    // Fire the resultCB.
+    resultCB(id, llvm::Error::success(), std::move(context));
+  });
 }
@@ -16,8 +16,12 @@
 #ifndef GLOW_BACKENDS_OPENCL_OPENCLDEVICEMANAGER_H
 #define GLOW_BACKENDS_OPENCL_OPENCLDEVICEMANAGER_H
 
+#include "OpenCL.h"
 #include "glow/Backends/QueueBackedDeviceManager.h"
 
+#include <map>
+#include <mutex>
+
 #if defined(__APPLE__) || defined(__MACOSX)
 #include "OpenCL/opencl.h"
 #else
@@ -43,6 +47,9 @@ class OpenCLBuffer {
   /// Size of the buffer in bytes.
   const size_t size_{0};
 
+  /// Orders the commands of the runs that access the buffer.
+  BufferEventTracker events_;
+
 public:
   ~OpenCLBuffer() { clReleaseMemObject(buffer_); }
 
@@ -59,10 +66,14 @@ public:
 
   /// Get size of buffer in bytes.
   size_t getSize() { return size_; }
+
+  /// Returns the tracker of the commands that access the buffer.
+  BufferEventTracker &getEvents() { return events_; }
 };
 
 /// A class controlling a single OpenCL device. Many OpenCLFunctions may be
-/// added, but only one inference is executed at a time.
+/// added. Runs are enqueued one at a time, but the transfers of a run may
+/// overlap the kernels of the previous run.
 class OpenCLDeviceManager : public QueueBackedDeviceManager {
   /// Compiled function list by name.
   FunctionMapTy functions_;
@@ -81,6 +92,28 @@ class OpenCLDeviceManager : public QueueBackedDeviceManager {
   /// Enable profiling flag.
   bool doProfile_{false};
 
+  /// Out-of-order execution if the device supports it, or 0.
+  cl_command_queue_properties queueProperties_{0};
+
+  /// Thread that waits for the enqueued runs and fires their callbacks, so
+  /// that workThread_ can enqueue the next run meanwhile.
+  ThreadPool completionThread_{1};
+
+  /// Whether stop() has already let the completion thread fire the resultCB
+  /// of the enqueued runs.
+  bool completionDrained_{false};
+
+  /// Protects the pools below, since runs are enqueued by workThread_ and
+  /// completed by completionThread_.
+  std::mutex poolMutex_;
+
+  /// Command queues that no run uses, by their properties.
+  std::map<cl_command_queue_properties, std::vector<cl_command_queue>>
+      queuePool_;
+
+  /// Staging buffers that no run uses. They are mapped.
+  std::vector<std::unique_ptr<OpenCLStagingBuffer>> stagingPool_;
+
   /// A pointer to the on-device memory buffer.
   std::map<std::string, std::shared_ptr<OpenCLBuffer>> buffers_;
 
@@ -104,19 +137,30 @@ public:
   /// Returns the amount of memory in bytes currently available on the device.
   uint64_t getAvailableMemory() const override;
 
+  /// Stops enqueueing runs, then stops waiting for the enqueued ones.
+  llvm::Error stop(bool block = true) override;
+
   /// Returns true if a function requiring the \p estimate size will fit on the
   /// device. This is not a promise as memory cost could vary due to alignment,
   /// etc.
   bool isMemoryAvailable(uint64_t estimate) const override;
 
-  /// Requests a command queue for the current run. Currently this creates a new
-  /// queue for each run. It could be extended to use a pool of pre-allocated
-  /// queues.
+  /// Requests a command queue for the current run. The queue is taken from
+  /// the pool of the queues of finished runs, or created if it is empty.
   cl_command_queue requestRunCommandQueue(CompiledFunction *function);
 
-  /// Returns a command queue. Currently this frees the queue.
+  /// Returns a command queue to the pool.
   void returnRunCommandQueue(cl_command_queue commands);
 
+  /// Requests a staging buffer of at least \p size bytes for the current run.
+  /// The smallest large enough buffer is taken from the pool, or a buffer is
+  /// created and mapped with \p commands if there is none.
+  std::unique_ptr<OpenCLStagingBuffer>
+  requestStagingBuffer(size_t size, cl_command_queue commands);
+
+  /// Returns the mapped staging buffer \p staging to the pool.
+  void returnStagingBuffer(std::unique_ptr<OpenCLStagingBuffer> staging);
+
 protected:
   /// Adds functions to the device. Calls to this are serialized so concurrency
   /// is not an issue.
@@ -128,8 +172,9 @@ protected:
   void evictNetworkImpl(std::string functionName,
                         EvictFunctionCBTy evictCB) override;
 
-  /// Run the function on the device, there is a single thread of execution so
-  /// only one function can execute at a time.
+  /// Enqueue a run of the function on the device. The commands of the run
+  /// only wait for the commands of earlier runs that access the same part of
+  /// the device buffer. resultCB is fired by completionThread_.
   void runFunctionImpl(runtime::RunIdentifierTy id, std::string functionName,
                        std::unique_ptr<ExecutionContext> context,
                        ResultCBTy cb) override;
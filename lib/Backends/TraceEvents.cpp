@@ -16,12 +16,64 @@
 
 #include "glow/Backends/TraceEvents.h"
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <fstream>
 
 namespace glow {
 
+namespace {
+/// Process-wide table of the event names logged into TraceContext ring
+/// buffers. Names are never removed, so that an id stays valid for the
+/// lifetime of the process.
+struct TraceNameTable {
+  std::mutex lock;
+  llvm::StringMap<uint32_t> ids;
+  /// Names by id; they point into the keys of ids.
+  std::vector<llvm::StringRef> names;
+};
+
+TraceNameTable &getTraceNameTable() {
+  static TraceNameTable table;
+  return table;
+}
+
+/// \returns the id of the event name \p name. Each thread caches the ids it
+/// looked up, so that only the first lookup of a name takes the lock.
+uint32_t internTraceName(llvm::StringRef name) {
+  thread_local llvm::StringMap<uint32_t> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  auto &table = getTraceNameTable();
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> l(table.lock);
+    auto res = table.ids.insert({name, table.names.size()});
+    if (res.second) {
+      table.names.push_back(res.first->getKey());
+    }
+    id = res.first->second;
+  }
+  cache[name] = id;
+  return id;
+}
+
+/// \returns the event name with id \p id.
+llvm::StringRef getTraceName(uint32_t id) {
+  auto &table = getTraceNameTable();
+  std::lock_guard<std::mutex> l(table.lock);
+  return table.names[id];
+}
+
+/// Number of bits of the interned name in a packed TraceRecord.
+constexpr unsigned kTraceNameBits = 24;
+} // namespace
+
+constexpr size_t TraceContext::kRingSize;
+
 void TraceEvent::dumpTraceEvents(
     std::vector<TraceEvent> &events, llvm::StringRef filename,
     const std::string &processName,
@@ -75,16 +127,100 @@ void TraceContext::logTraceEvent(
   logTraceEvent(name, type, TraceEvent::now(), std::move(additionalAttributes));
 }
 
+TraceContext::TraceContext(TraceLevel level, int thread)
+    : baseTimestamp_(TraceEvent::now()), traceLevel_(level),
+      traceThread_(thread) {}
+
+std::vector<TraceEvent> &TraceContext::getTraceEvents() {
+  std::lock_guard<std::mutex> l(lock_);
+  flushRing();
+  return traceEvents_;
+}
+
+llvm::ArrayRef<TraceEvent> TraceContext::getTraceEvents() const {
+  std::lock_guard<std::mutex> l(lock_);
+  flushRing();
+  return traceEvents_;
+}
+
+uint64_t TraceContext::getDroppedEvents() const {
+  std::lock_guard<std::mutex> l(lock_);
+  flushRing();
+  return droppedEvents_;
+}
+
+bool TraceContext::logToRing(llvm::StringRef name, llvm::StringRef type,
+                             uint64_t timestamp) {
+  if (type.size() != 1 || timestamp < baseTimestamp_ ||
+      timestamp - baseTimestamp_ > UINT32_MAX) {
+    return false;
+  }
+  uint64_t nameId = internTraceName(name);
+  if (nameId >= (1u << kTraceNameBits)) {
+    return false;
+  }
+
+  std::call_once(ringInit_,
+                 [this]() { ring_.reset(new TraceRecord[kRingSize]); });
+  // Claiming the slot releases the allocation of ring_ to flushRing().
+  uint64_t index = ringHead_.fetch_add(1, std::memory_order_acq_rel);
+  TraceRecord &record = ring_[index % kRingSize];
+  record.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  record.data.store(((timestamp - baseTimestamp_) << 32) |
+                        (nameId << 8) | uint8_t(type[0]),
+                    std::memory_order_relaxed);
+  record.tid.store(traceThread_, std::memory_order_relaxed);
+  record.seq.store(index + 1, std::memory_order_release);
+  return true;
+}
+
+void TraceContext::flushRing() const {
+  uint64_t head = ringHead_.load(std::memory_order_acquire);
+  uint64_t index = ringFlushed_;
+  if (head - index > kRingSize) {
+    droppedEvents_ += head - kRingSize - index;
+    index = head - kRingSize;
+  }
+  for (; index < head; index++) {
+    const TraceRecord &record = ring_[index % kRingSize];
+    uint64_t seq = record.seq.load(std::memory_order_acquire);
+    if (seq < index + 1) {
+      // Still being written; pick it up on the next read.
+      break;
+    }
+    uint64_t data = record.data.load(std::memory_order_relaxed);
+    int tid = record.tid.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq != index + 1 ||
+        record.seq.load(std::memory_order_relaxed) != index + 1) {
+      // Overwritten by a later event.
+      droppedEvents_++;
+      continue;
+    }
+    char type = data & 0xFF;
+    traceEvents_.emplace_back(
+        getTraceName((data >> 8) & ((1u << kTraceNameBits) - 1)),
+        baseTimestamp_ + (data >> 32), llvm::StringRef(&type, 1), tid);
+  }
+  ringFlushed_ = index;
+}
+
 void TraceContext::logTraceEvent(
     llvm::StringRef name, llvm::StringRef type, uint64_t timestamp,
     std::map<std::string, std::string> additionalAttributes) {
   if (traceLevel_ == TraceLevel::NONE || traceLevel_ == TraceLevel::OPERATOR) {
     return;
   }
+  if (additionalAttributes.empty() && logToRing(name, type, timestamp)) {
+    return;
+  }
   TraceEvent ev(name, timestamp, type, traceThread_,
                 std::move(additionalAttributes));
   {
     std::lock_guard<std::mutex> l(lock_);
+    // Keep the order with the events logged into the ring buffer.
+    flushRing();
     traceEvents_.push_back(std::move(ev));
   }
 }
@@ -100,10 +236,11 @@ void TraceContext::dump(llvm::StringRef filename,
 }
 
 void TraceContext::merge(TraceContext *other) {
-  std::lock_guard<std::mutex> l(lock_);
   auto &newEvents = other->getTraceEvents();
+  std::lock_guard<std::mutex> l(lock_);
+  flushRing();
   std::move(newEvents.begin(), newEvents.end(),
-            std::back_inserter(getTraceEvents()));
+            std::back_inserter(traceEvents_));
   auto &names = other->getThreadNames();
   threadNames_.insert(names.begin(), names.end());
   names.clear();
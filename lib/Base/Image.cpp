@@ -17,6 +17,7 @@
 #include "glow/Base/Image.h"
 #include "glow/Base/Tensor.h"
 #include "glow/Support/Support.h"
+#include "glow/Support/ThreadPool.h"
 
 #include "llvm/Support/CommandLine.h"
 
@@ -398,7 +399,8 @@ void glow::loadImagesAndPreprocess(const llvm::ArrayRef<std::string> &filenames,
                                    Tensor *inputImageData,
                                    ImageNormalizationMode imageNormMode,
                                    ImageChannelOrder imageChannelOrder,
-                                   ImageLayout imageLayout) {
+                                   ImageLayout imageLayout,
+                                   ThreadPool *pool) {
   assert(!filenames.empty() &&
          "There must be at least one filename in filenames.");
   size_t numImages = filenames.size();
@@ -452,8 +454,10 @@ void glow::loadImagesAndPreprocess(const llvm::ArrayRef<std::string> &filenames,
   inputImageData->reset(ElemKind::FloatTy, batchDims);
   auto IIDH = inputImageData->getHandle<>();
 
-  // Read images into local tensors and add to batch.
-  for (size_t n = 0; n < filenames.size(); n++) {
+  // Read images into local tensors and add to batch. Each image is written
+  // into its own slice of the batch, so the images can be processed
+  // concurrently.
+  auto loadImage = [&](size_t n) {
     Tensor localCopy =
         readPngImageAndPreprocess(filenames[n], imageNormMode,
                                   imageChannelOrder, imageLayout, mean, stddev);
@@ -461,5 +465,21 @@ void glow::loadImagesAndPreprocess(const llvm::ArrayRef<std::string> &filenames,
                       inputImageData->dims().begin() + 1) &&
            "All images must have the same dimensions");
     IIDH.insertSlice(localCopy, n);
+  };
+
+  if (!pool || numImages == 1) {
+    for (size_t n = 0; n < numImages; n++) {
+      loadImage(n);
+    }
+    return;
+  }
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(numImages);
+  for (size_t n = 0; n < numImages; n++) {
+    futures.push_back(pool->submit([&loadImage, n]() { loadImage(n); }));
+  }
+  for (auto &future : futures) {
+    future.get();
   }
 }
@@ -285,6 +285,8 @@ void glow::dumpAsciiImpl(const Tensor *T, llvm::raw_ostream &os) {
     return dumpAsciiGenericImpl(T->getHandle<int64_t>(), os);
   case ElemKind::UInt8FusedQTy:
     return dumpAsciiGenericImpl(T->getHandle<uint8_t>(), os);
+  case ElemKind::UInt4FusedQTy:
+    return dumpAsciiGenericImpl(T->getHandle<uint8_t>(), os);
   case ElemKind::BoolTy:
     return dumpAsciiGenericImpl(T->getHandle<bool>(), os);
   }
@@ -311,6 +313,8 @@ void glow::dumpImpl(const Tensor *T, llvm::raw_ostream &os,
     return dumpGenericImpl(T->getHandle<int64_t>(), os, maxNumElem);
   case ElemKind::UInt8FusedQTy:
     return dumpGenericImpl(T->getHandle<uint8_t>(), os, maxNumElem);
+  case ElemKind::UInt4FusedQTy:
+    return dumpGenericImpl(T->getHandle<uint8_t>(), os, maxNumElem);
   case ElemKind::BoolTy:
     return dumpGenericImpl(T->getHandle<bool>(), os, maxNumElem);
   }
@@ -386,6 +390,9 @@ void glow::genericTranspose(const Tensor *src, Tensor *dest,
   case ElemKind::UInt8FusedQTy: {
     llvm_unreachable("Transposing UInt8FusedQTy is unsupported.");
   }
+  case ElemKind::UInt4FusedQTy: {
+    llvm_unreachable("Transposing UInt4FusedQTy is unsupported.");
+  }
   case ElemKind::BoolTy: {
     auto srcH = src->getHandle<bool>();
     auto destH = dest->getHandle<bool>();
@@ -454,6 +461,25 @@ void Tensor::init(InitKind init, float val, PseudoRNG &PRNG) {
       }
       break;
     }
+    case ElemKind::UInt4FusedQTy: {
+      DCHECK(dims().size() == 2)
+          << "Fused tensor must be 2-dimensional but instead has "
+          << dims().size() << " dimensions.";
+      DCHECK(dims()[1] > 8)
+          << "Fused tensor must have more than 8 columns but has " << dims()[1]
+          << " columns.";
+      DCHECK(val >= 0 && val <= 15)
+          << "4-bit fused tensor can only hold values in [0, 15].";
+      // Broadcast into both nibbles of every byte.
+      const uint8_t nibble = static_cast<uint8_t>(val);
+      auto H = getHandle<uint8_t>();
+      for (size_t i = 0; i < dims()[0]; i++) {
+        for (size_t j = 0, f = dims()[1] - 8; j < f; j++) {
+          H.at({i, j}) = nibble | (nibble << 4);
+        }
+      }
+      break;
+    }
     case ElemKind::BoolTy: {
       getHandle<bool>().clear(val);
       break;
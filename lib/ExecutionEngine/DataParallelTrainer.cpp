@@ -0,0 +1,268 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/ExecutionEngine/DataParallelTrainer.h"
+#include "glow/Optimizer/Optimizer.h"
+
+#include "llvm/ADT/STLExtras.h"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
+using namespace glow;
+
+/// The number of elements of a weight that one task of the thread pool
+/// reduces and updates. Smaller weights make a single task.
+static constexpr size_t kUpdateChunkSize = 64 * 1024;
+
+/// \returns the number of threads for the all-reduce and the update.
+static unsigned getNumUpdateThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+DataParallelTrainer::DataParallelTrainer(BackendKind backendKind,
+                                         unsigned numDevices)
+    : backend_(createBackend(backendKind)),
+      constantFoldingBackend_(createBackend(BackendKind::Interpreter)),
+      pool_(getNumUpdateThreads()) {
+  assert(numDevices > 0 && "Expected at least one device");
+  for (unsigned i = 0; i < numDevices; i++) {
+    devices_.emplace_back(
+        runtime::DeviceManager::createDeviceManager(backendKind));
+    EXIT_ON_ERR(devices_.back()->init());
+  }
+}
+
+DataParallelTrainer::~DataParallelTrainer() {
+  clear();
+  for (auto &device : devices_) {
+    EXIT_ON_ERR(device->stop());
+  }
+}
+
+void DataParallelTrainer::clear() {
+  if (replicas_.empty()) {
+    return;
+  }
+  for (auto &device : devices_) {
+    std::promise<void> evictPromise;
+    auto fut = evictPromise.get_future();
+    device->evictNetwork(name_,
+                         [&evictPromise](std::string, llvm::Error err) {
+                           EXIT_ON_ERR(std::move(err));
+                           evictPromise.set_value();
+                         });
+    fut.wait();
+  }
+  contexts_.clear();
+  replicas_.clear();
+  weights_.clear();
+}
+
+void DataParallelTrainer::compile(Function *F, const TrainingConfig &config,
+                                  PlaceholderBindings &bindings) {
+  assert(config.optimizer == OptimizerKind::SGD &&
+         "Only SGD is supported for data-parallel training");
+  clear();
+  config_ = config;
+  Module &M = *F->getParent();
+
+  // Differentiate F into a Function that saves the gradients of the
+  // Placeholders instead of updating them.
+  VariableGradientsList varGrads;
+  name_ = F->getName().str() + "_dp_grads";
+  if (Function *old = M.getFunction(name_)) {
+    M.eraseFunction(old);
+  }
+  Function *G = glow::differentiate(F, config, name_, &varGrads);
+  for (auto &varGrad : varGrads) {
+    // Only the gradients of the weights are needed, the others are left to
+    // the dead code elimination.
+    if (!varGrad.first->isTraining()) {
+      G->eraseNode(getOutputSave(G, varGrad.second));
+      continue;
+    }
+    assert(varGrad.first->getElementType() == ElemKind::FloatTy &&
+           "Only float weights are supported");
+    Tensor *tensor = bindings.get(varGrad.first);
+    assert(tensor && "The weights must be allocated");
+    Tensor gsum(varGrad.first->getType());
+    gsum.zero();
+    weights_.push_back(
+        {varGrad.first, tensor, varGrad.second, std::move(gsum)});
+  }
+
+  // Compile one replica per device. The replicas only share the graph, so
+  // they are generated in parallel.
+  CompilationOptions opts;
+  opts.mode = CompilationMode::Train;
+  opts.constantFoldingBackend = constantFoldingBackend_.get();
+  ::glow::optimizeFunction(G, *backend_, opts);
+  std::vector<Function *> functions(devices_.size(), G);
+  replicas_ = backend_->compileFunctions(functions, opts);
+
+  for (size_t i = 0, e = devices_.size(); i < e; i++) {
+    auto replicaBindings = llvm::make_unique<PlaceholderBindings>();
+    // The replicas read the weights in place.
+    for (auto &W : weights_) {
+      replicaBindings->insert(W.weight, W.tensor->getUnowned(W.tensor->dims()));
+    }
+    // All other Placeholders, like the inputs and the gradients, belong to
+    // the replica. They start with the values in bindings.
+    for (auto *PH : G->findPlaceholders()) {
+      if (replicaBindings->get(PH)) {
+        continue;
+      }
+      Tensor *T = replicaBindings->allocate(PH);
+      if (Tensor *src = bindings.get(PH)) {
+        T->assign(src);
+      }
+    }
+    replicaBindings->allocate(M.getPlaceholders());
+    contexts_.push_back(
+        llvm::make_unique<ExecutionContext>(std::move(replicaBindings)));
+
+    runtime::FunctionMapTy functionMap;
+    functionMap[name_] = replicas_[i].get();
+    std::promise<void> addPromise;
+    auto fut = addPromise.get_future();
+    llvm::Error addErr = llvm::Error::success();
+    devices_[i]->addNetwork(
+        &M, std::move(functionMap),
+        [&addPromise, &addErr](const Module *, llvm::Error err) {
+          addErr = std::move(err);
+          addPromise.set_value();
+        });
+    fut.wait();
+    EXIT_ON_ERR(std::move(addErr));
+  }
+}
+
+void DataParallelTrainer::update(Weight &W, size_t begin, size_t end) {
+  auto WH = W.tensor->getHandle<float>();
+  auto GSH = W.gsum.getHandle<float>();
+  std::vector<Handle<float>> grads;
+  for (auto &context : contexts_) {
+    grads.push_back(
+        context->getPlaceholderBindings()->get(W.grad)->getHandle<float>());
+  }
+
+  // The replicas together ran one minibatch of this size.
+  float batchSize = config_.batchSize * contexts_.size();
+  for (size_t i = begin; i < end; i++) {
+    // All-reduce: sum the gradients of the replicas.
+    float g = 0;
+    for (auto &GH : grads) {
+      g += GH.raw(i);
+    }
+
+    // Then update the weight like the SGD kernels do for the whole
+    // minibatch, so the decay is added once.
+    float w = WH.raw(i);
+    if (config_.L1Decay) {
+      g += config_.L1Decay * (0 <= w ? 1 : -1);
+    }
+    if (config_.L2Decay) {
+      g += config_.L2Decay * w;
+    }
+    if (batchSize > 1) {
+      g /= batchSize;
+    }
+    float dx = -config_.learningRate * g;
+    if (config_.momentum > 0.0) {
+      dx += config_.momentum * GSH.raw(i);
+      GSH.raw(i) = dx;
+    }
+    WH.raw(i) = w + dx;
+  }
+}
+
+void DataParallelTrainer::updateAll() {
+  // The chunks touch disjoint elements, and every replica has its own
+  // gradient tensors, so the tasks don't need to synchronize.
+  std::vector<std::future<void>> futures;
+  for (auto &W : weights_) {
+    for (size_t begin = 0, e = W.tensor->size(); begin < e;
+         begin += kUpdateChunkSize) {
+      size_t end = std::min(begin + kUpdateChunkSize, e);
+      futures.push_back(
+          pool_.submit([this, &W, begin, end] { update(W, begin, end); }));
+    }
+  }
+  for (auto &fut : futures) {
+    fut.wait();
+  }
+}
+
+void DataParallelTrainer::trainStep(size_t &sampleCounter,
+                                    llvm::ArrayRef<Placeholder *> ph,
+                                    llvm::ArrayRef<Tensor *> inputs) {
+  assert(!replicas_.empty() && "The trainer was not compiled");
+  assert(!inputs.empty() && "No inputs");
+  assert(inputs.size() == ph.size() &&
+         "The number of inputs does not match the number of placeholders");
+  // This is the size of one minibatch.
+  size_t batchSize = ph[0]->getType()->dims()[0];
+  size_t numReplicas = contexts_.size();
+
+  // Load the minibatch of every replica.
+  for (size_t r = 0; r < numReplicas; r++) {
+    auto *replicaBindings = contexts_[r]->getPlaceholderBindings();
+    for (size_t i = 0, e = ph.size(); i < e; i++) {
+      auto *backingTensor = replicaBindings->get(ph[i]);
+      assert(backingTensor && "Can't find the backing tensor");
+      size_t slc = (sampleCounter + r * batchSize) % inputs[i]->dims()[0];
+      backingTensor->copyConsecutiveSlices(inputs[i], slc);
+    }
+  }
+
+  // Run the replicas on all the devices at once.
+  std::vector<std::promise<void>> runPromises(numReplicas);
+  std::vector<std::future<void>> futures;
+  std::vector<llvm::Error> runErrs;
+  for (size_t r = 0; r < numReplicas; r++) {
+    futures.push_back(runPromises[r].get_future());
+    runErrs.emplace_back(llvm::Error::success());
+  }
+  for (size_t r = 0; r < numReplicas; r++) {
+    devices_[r]->runFunction(
+        name_, std::move(contexts_[r]),
+        [this, r, &runPromises,
+         &runErrs](runtime::RunIdentifierTy, llvm::Error err,
+                   std::unique_ptr<ExecutionContext> context) {
+          contexts_[r] = std::move(context);
+          runErrs[r] = std::move(err);
+          runPromises[r].set_value();
+        });
+  }
+  for (size_t r = 0; r < numReplicas; r++) {
+    futures[r].wait();
+    EXIT_ON_ERR(std::move(runErrs[r]));
+  }
+
+  // All replicas are done with the weights, update them.
+  updateAll();
+  sampleCounter += batchSize * numReplicas;
+}
+
+void glow::runBatch(DataParallelTrainer &trainer, size_t iterations,
+                    size_t &sampleCounter, llvm::ArrayRef<Placeholder *> ph,
+                    llvm::ArrayRef<Tensor *> inputs) {
+  for (size_t j = 0; j < iterations; j++) {
+    trainer.trainStep(sampleCounter, ph, inputs);
+  }
+}
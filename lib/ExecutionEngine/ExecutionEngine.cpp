@@ -26,7 +26,8 @@
 
 using namespace glow;
 
-ExecutionEngine::ExecutionEngine(BackendKind backendKind) {
+ExecutionEngine::ExecutionEngine(BackendKind backendKind)
+    : constantFoldingBackend_(createBackend(BackendKind::Interpreter)) {
   setBackend(backendKind);
 }
 
@@ -241,6 +242,15 @@ void ExecutionEngine::compile(CompilationMode mode, Function *F,
   compile(F, opts, clearOtherFunctions);
 }
 
+void ExecutionEngine::optimizeFunction(Function *F,
+                                       const CompilationOptions &opts) {
+  CompilationOptions optimizeOpts = opts;
+  if (!optimizeOpts.constantFoldingBackend) {
+    optimizeOpts.constantFoldingBackend = constantFoldingBackend_.get();
+  }
+  ::glow::optimizeFunction(F, *backend_, optimizeOpts);
+}
+
 void ExecutionEngine::compile(Function *F, const CompilationOptions &opts,
                               bool clearOtherFunctions) {
   llvm::StringRef name = F->getName();
@@ -252,7 +262,7 @@ void ExecutionEngine::compile(Function *F, const CompilationOptions &opts,
   assert(!compiledFunctions_.count(name) &&
          "A function with this name has already been compiled.");
 
-  ::glow::optimizeFunction(F, *backend_, opts);
+  optimizeFunction(F, opts);
 
   for (const Node &N : F->getNodes()) {
     (void)N;
@@ -264,9 +274,37 @@ void ExecutionEngine::compile(Function *F, const CompilationOptions &opts,
   insertCompiledFunction(name, std::move(func));
 }
 
+void ExecutionEngine::compile(llvm::ArrayRef<Function *> functions,
+                              const CompilationOptions &opts,
+                              bool clearOtherFunctions) {
+  if (clearOtherFunctions) {
+    clear();
+  }
+
+  // The graph optimizations create and erase Constants of the Module and
+  // update the users of the Storage nodes that the Functions share, so they
+  // run one Function at a time. Only code generation runs in parallel.
+  for (auto *F : functions) {
+    assert(!compiledFunctions_.count(F->getName()) &&
+           "A function with this name has already been compiled.");
+    optimizeFunction(F, opts);
+
+    for (const Node &N : F->getNodes()) {
+      (void)N;
+      assert(backend_->isOpSupported(N) &&
+             "Backend must support all nodes after high-level optimizations.");
+    }
+  }
+
+  auto funcs = backend_->compileFunctions(functions, opts);
+  for (size_t i = 0, e = functions.size(); i < e; i++) {
+    insertCompiledFunction(functions[i]->getName(), std::move(funcs[i]));
+  }
+}
+
 void ExecutionEngine::save(Function *F, const CompilationOptions &opts,
                            llvm::StringRef outputDir,
                            llvm::StringRef networkName) {
-  ::glow::optimizeFunction(F, *backend_, opts);
+  optimizeFunction(F, opts);
   backend_->save(F, outputDir, networkName);
 }
@@ -259,11 +259,35 @@ Function *glow::differentiate(Function *F, const TrainingConfig &conf,
       continue;
     }
 
-    auto X = new SGDNode(PH->getName(), map.getGradient(PH), PH, conf.L1Decay,
-                         conf.L2Decay, conf.learningRate, conf.momentum,
-                         conf.batchSize);
+    // The state of the optimizers is kept in Placeholders, which the
+    // optimizer nodes update in place.
+    auto &mod = *G->getParent();
+    Node *X = nullptr;
+    switch (conf.optimizer) {
+    case OptimizerKind::SGD:
+      if (conf.momentum > 0.0) {
+        auto *gsum = mod.createPlaceholder(PH->getType(), "gsum", false);
+        X = new MomentumSGDNode(PH->getName(), map.getGradient(PH), PH, gsum,
+                                conf.L1Decay, conf.L2Decay, conf.learningRate,
+                                conf.momentum, conf.batchSize);
+      } else {
+        X = new SGDNode(PH->getName(), map.getGradient(PH), PH, conf.L1Decay,
+                        conf.L2Decay, conf.learningRate, conf.batchSize);
+      }
+      break;
+    case OptimizerKind::Adam: {
+      auto *M = mod.createPlaceholder(PH->getType(), "adam_m", false);
+      auto *V = mod.createPlaceholder(PH->getType(), "adam_v", false);
+      auto *step =
+          mod.createPlaceholder(ElemKind::FloatTy, {1}, "adam_step", false);
+      X = new AdamNode(PH->getName(), map.getGradient(PH), PH, M, V, step,
+                       conf.L1Decay, conf.L2Decay, conf.learningRate,
+                       conf.beta1, conf.beta2, conf.epsilon, conf.batchSize);
+      break;
+    }
+    }
     toAppend.push_back(X);
-    // Now update the weight with the value computed by SGD.
+    // Now update the weight with the value computed by the optimizer.
     auto *save = new SaveNode(PH->getName().str() + ".saveGrad", {X, 0}, PH);
     toAppend.push_back(save);
   }
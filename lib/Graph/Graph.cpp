@@ -329,6 +329,7 @@ TypeRef Module::uniqueTypeWithNewShape(TypeRef T, llvm::ArrayRef<size_t> dims) {
 }
 
 TypeRef Module::uniqueType(const Type &T) {
+  std::lock_guard<std::mutex> g(typesLock_);
   for (auto &tp : types_) {
     if (T.isEqual(tp)) {
       return &tp;
@@ -431,12 +432,14 @@ llvm::StringRef Module::uniqueName(llvm::StringRef name,
 }
 
 Constant *Module::addConstant(Constant *V) {
+  std::lock_guard<std::mutex> g(storageLock_);
   V->setName(uniqueName(V->getName(), uniqueVariableNames_));
   constants_.push_back(V);
   return V;
 }
 
 Placeholder *Module::addPlaceholder(Placeholder *ph) {
+  std::lock_guard<std::mutex> g(storageLock_);
   ph->setName(uniqueName(ph->getName(), uniqueVariableNames_));
   placeholders_.push_back(ph);
   return ph;
@@ -561,6 +564,39 @@ ConvolutionNode *Function::createConv(llvm::StringRef name, NodeValue input,
                     group);
 }
 
+ChannelwiseQuantizedConvolutionNode *Function::createChannelwiseQuantizedConv(
+    llvm::StringRef name, NodeValue input, Constant *filter, NodeValue bias,
+    TypeRef outTy, llvm::ArrayRef<unsigned_t> kernels,
+    llvm::ArrayRef<unsigned_t> strides, llvm::ArrayRef<unsigned_t> pads,
+    unsigned_t group, quantization::Schema schema) {
+  assertConvDims(input, filter, bias, kernels, strides, pads, group);
+
+  // Since the filter is constant, quantize it at compilation time. The filter
+  // layout is {outChannels, kernelH, kernelW, inChannels / group}, so the
+  // slices along the first dimension are exactly the per output channel
+  // filters. The quantized data is in qFilter, the scale of each output
+  // channel is in scales, and the offset of each output channel is in offsets.
+  size_t numChannels = filter->dims()[0];
+
+  // As for the row-wise quantized FC, the scales and offsets are stored in
+  // separate vectors, so we add a dummy scale and offset to the filter type.
+  auto *qFilter = getParent()->createConstant(
+      ElemKind::Int8QTy, filter->dims(), 0.0, 0, "filter.cwqconv");
+  auto *scales = getParent()->createConstant(ElemKind::FloatTy, {numChannels},
+                                             "scales.cwqconv");
+  auto *offsets = getParent()->createConstant(
+      ElemKind::Int32ITy, {numChannels}, "offsets.cwqconv");
+
+  quantization::tensorRowwiseQuantization<int32_t>(
+      filter->getPayload(), qFilter->getPayload(), scales->getPayload(),
+      offsets->getPayload(), schema);
+
+  auto OT = getParent()->uniqueType(*outTy);
+  return addNode(new ChannelwiseQuantizedConvolutionNode(
+      name, OT, input, qFilter, bias, scales, offsets, kernels, strides, pads,
+      group));
+}
+
 Convolution3DNode *Function::createConv3D(llvm::StringRef name, NodeValue input,
                                           NodeValue filter, NodeValue bias,
                                           TypeRef outTy,
@@ -1508,8 +1544,11 @@ Function::createFusedRowwiseQuantizedSparseLengthsWeightedSum(
   outDims[0] = lengths.dims()[0];
   // The output column count is the same as the input column count, but without
   // the extra 8 bytes for the fused scale/offset, as the output is not
-  // UInt8FusedQTy.
+  // UInt8FusedQTy. UInt4FusedQTy data holds two columns in every byte.
   outDims[1] -= 8;
+  if (data->getElementType() == ElemKind::UInt4FusedQTy) {
+    outDims[1] *= 2;
+  }
   auto outTy = getParent()->uniqueType(ElemKind::FloatTy, outDims);
   return addNode(new FusedRowwiseQuantizedSparseLengthsWeightedSumNode(
       name, outTy, data, weights, indices, lengths));
@@ -1530,11 +1569,12 @@ Function::createFusedRowwiseQuantizedSparseLengthsSum(llvm::StringRef name,
 /// Function \p F with \p name, using \ data, \p weights, \p indices, and \p
 /// lengths as inputs. The provided float data in \p Tensor is rowwise
 /// quantized, creating Constants for the rowwise quantized data as well as
-/// Scales and Offsets, in the Module containing \p F.
+/// Scales and Offsets, in the Module containing \p F. The data is stored as
+/// \p fusedElemKind.
 static FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
 quantizeDataAndCreateFusedRowwiseQuantizedSparseLengthsWeightedSum(
     Function *F, llvm::StringRef name, Tensor &data, NodeValue weights,
-    NodeValue indices, NodeValue lengths) {
+    NodeValue indices, NodeValue lengths, ElemKind fusedElemKind) {
   // For fused rowwise quantization, we must have a two-dimensional input. If
   // passed in a single dimensional data Tensor then add an extra dimension.
   const auto fDims = flattenCdr(data.dims());
@@ -1545,8 +1585,14 @@ quantizeDataAndCreateFusedRowwiseQuantizedSparseLengthsWeightedSum(
   // scale/offset are fused inline with each row. Also, we expand the second
   // dimension to include space for the scale/offset, each 4 bytes
   // (float/int32_t).
+  // For 4-bit data two values share a byte, so the row width must be even.
+  assert(isFusedQuantizedElemKind(fusedElemKind) &&
+         "Data must be stored using a fused ElemKind.");
+  const size_t dataCols = fusedElemKind == ElemKind::UInt4FusedQTy
+                              ? fDims.second / 2
+                              : fDims.second;
   Constant *rwqData = F->getParent()->createConstant(
-      ElemKind::UInt8FusedQTy, {fDims.first, fDims.second + 8}, 0.0, 0, "data");
+      fusedElemKind, {fDims.first, dataCols + 8}, 0.0, 0, "data");
 
   quantization::tensorFusedRowwiseQuantization(fData, rwqData->getPayload());
   return F->createFusedRowwiseQuantizedSparseLengthsWeightedSum(
@@ -1556,20 +1602,30 @@ quantizeDataAndCreateFusedRowwiseQuantizedSparseLengthsWeightedSum(
 FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
 Function::createFusedRowwiseQuantizedSparseLengthsWeightedSum(
     llvm::StringRef name, Tensor &data, NodeValue weights, NodeValue indices,
-    NodeValue lengths) {
+    NodeValue lengths, ElemKind fusedElemKind) {
   return quantizeDataAndCreateFusedRowwiseQuantizedSparseLengthsWeightedSum(
-      this, name, data, weights, indices, lengths);
+      this, name, data, weights, indices, lengths, fusedElemKind);
 }
 
 FusedRowwiseQuantizedSparseLengthsWeightedSumNode *
 Function::createFusedRowwiseQuantizedSparseLengthsSum(llvm::StringRef name,
                                                       Tensor &data,
                                                       NodeValue indices,
-                                                      NodeValue lengths) {
+                                                      NodeValue lengths,
+                                                      ElemKind fusedElemKind) {
   auto ty = getParent()->uniqueType(ElemKind::FloatTy, {indices.dims()[0]});
   auto ones = createSplat(name.str() + ".ones", ty, 1.0);
   return quantizeDataAndCreateFusedRowwiseQuantizedSparseLengthsWeightedSum(
-      this, name, data, ones, indices, lengths);
+      this, name, data, ones, indices, lengths, fusedElemKind);
+}
+
+SparseLengthsShardNode *
+Function::createSparseLengthsShard(llvm::StringRef name, NodeValue weights,
+                                   NodeValue indices, NodeValue lengths,
+                                   unsigned_t numShards, unsigned_t shard) {
+  return addNode(new SparseLengthsShardNode(
+      name, weights.getType(), indices.getType(), lengths.getType(), weights,
+      indices, lengths, numShards, shard));
 }
 
 LengthsToRangesNode *Function::createLengthsToRanges(llvm::StringRef name,
@@ -2656,6 +2712,7 @@ Node *Function::getNodeByName(llvm::StringRef name) {
 }
 
 void Module::eraseConstant(ConstList::iterator I) {
+  std::lock_guard<std::mutex> g(storageLock_);
   if (I == constants_.end())
     return;
   delete *I;
@@ -2665,6 +2722,7 @@ void Module::eraseConstant(ConstList::iterator I) {
 void Function::eraseNode(NodesList::iterator I) { nodes_.erase(I); }
 
 Constant *Module::getConstantByName(llvm::StringRef name) const {
+  std::lock_guard<std::mutex> g(storageLock_);
   for (auto *V : getConstants()) {
     if (V->getName() == name)
       return V;
@@ -2673,6 +2731,7 @@ Constant *Module::getConstantByName(llvm::StringRef name) const {
 }
 
 Placeholder *Module::getPlaceholderByName(llvm::StringRef name) const {
+  std::lock_guard<std::mutex> g(storageLock_);
   for (auto *P : getPlaceholders()) {
     if (P->getName() == name) {
       return P;
@@ -2683,9 +2742,12 @@ Placeholder *Module::getPlaceholderByName(llvm::StringRef name) const {
 }
 
 void Module::eraseConstant(Constant *N) {
-  auto &vars = getConstants();
-  auto I = std::find(vars.begin(), vars.end(), N);
-  eraseConstant(I);
+  std::lock_guard<std::mutex> g(storageLock_);
+  auto I = std::find(constants_.begin(), constants_.end(), N);
+  if (I == constants_.end())
+    return;
+  delete *I;
+  constants_.erase(I);
 }
 
 void Function::eraseNode(Node *N) {
@@ -386,6 +386,30 @@ bool ConvolutionNode::verify() const {
                            Kernels_, Strides_, Pads_, Group_);
 }
 
+bool ChannelwiseQuantizedConvolutionNode::verify() const {
+  auto filter = getFilter();
+  auto scales = getScales();
+  auto offsets = getOffsets();
+
+  bool isValid = checkType(getInput(), ElemKind::Int8QTy, this);
+  isValid &= checkType(filter, ElemKind::Int8QTy, this);
+  isValid &= checkType(getResult(), ElemKind::Int8QTy, this);
+  isValid &= checkType(scales, ElemKind::FloatTy, this);
+  isValid &= checkType(offsets, ElemKind::Int32ITy, this);
+  isValid &= verifyConvolution(getInput(), getResult(), filter, getBias(),
+                               Kernels_, Strides_, Pads_, Group_);
+
+  isValid &= expectCompareTrue("Scales should be 1D tensor",
+                               scales.dims().size(), size_t(1), this);
+  isValid &= expectCompareTrue("Offsets should be 1D tensor",
+                               offsets.dims().size(), size_t(1), this);
+  isValid &= expectCompareTrue("Inconsistent scales/offsets sizes",
+                               scales.dims()[0], offsets.dims()[0], this);
+  isValid &= expectCompareTrue("Inconsistent scales/filter sizes",
+                               scales.dims()[0], filter.dims()[0], this);
+  return isValid;
+}
+
 bool Convolution3DNode::verify() const {
   return verifyConvolution3D(getInput(), getResult(), getFilter(), getBias(),
                              Kernels_, Strides_, Pads_, Group_);
@@ -878,7 +902,11 @@ bool RowwiseQuantizedSparseLengthsWeightedSumNode::verify() const {
 
 bool FusedRowwiseQuantizedSparseLengthsWeightedSumNode::verify() const {
   bool isValid = checkType(getResult(), ElemKind::FloatTy, this);
-  isValid &= checkType(getData(), ElemKind::UInt8FusedQTy, this);
+  isValid &= checkType(
+      getData(),
+      llvm::ArrayRef<ElemKind>(
+          {ElemKind::UInt8FusedQTy, ElemKind::UInt4FusedQTy}),
+      this);
   isValid &= checkType(getWeights(), ElemKind::FloatTy, this);
   isValid &= checkType(getIndices(), ElemKind::Int64ITy, this);
   isValid &= checkType(getLengths(), ElemKind::Int32ITy, this);
@@ -900,11 +928,38 @@ bool FusedRowwiseQuantizedSparseLengthsWeightedSumNode::verify() const {
                                getResult().dims().size(), size_t(2), this);
   // Wrap this in isValid to prevent potential segfault if the result is
   // incorrectly shaped.
-  if (isValid) {
+  if (isValid && getData().getElementType() == ElemKind::UInt8FusedQTy) {
     isValid &= expectCompareTrue(
         "Result output shape should have second dim as 8 less than Data.",
         getResult().dims()[1] + 8, getData().dims()[1], this);
   }
+  // 4-bit data packs two values per byte.
+  if (isValid && getData().getElementType() == ElemKind::UInt4FusedQTy) {
+    isValid &= expectCompareTrue(
+        "Result output shape should have second dim as twice the number of "
+        "Data columns without the 8 scale/offset columns.",
+        getResult().dims()[1], (getData().dims()[1] - 8) * 2, this);
+  }
+  return isValid;
+}
+
+bool SparseLengthsShardNode::verify() const {
+  bool isValid = checkSameShape(getShardWeights(), getWeights(), this);
+  isValid &= checkTypeIgnoreShape(getShardWeights(), getWeights(), this);
+  isValid &= checkSameShape(getShardIndices(), getIndices(), this);
+  isValid &= checkTypeIgnoreShape(getShardIndices(), getIndices(), this);
+  isValid &= checkSameShape(getShardLengths(), getLengths(), this);
+  isValid &= checkTypeIgnoreShape(getShardLengths(), getLengths(), this);
+  isValid &= checkType(getIndices(), ElemKind::Int64ITy, this);
+  isValid &= checkType(getLengths(), ElemKind::Int32ITy, this);
+  isValid &= expectCompareTrue("Indices must be a 1D vector",
+                               getIndices().dims().size(), size_t(1), this);
+  isValid &= expectCompareTrue("Lengths must be a 1D vector",
+                               getLengths().dims().size(), size_t(1), this);
+  isValid &= checkSameShape(getWeights(), getIndices(), this);
+  isValid &= expectCompareTrue("NumShards must be greater than Shard",
+                               getNumShards(), getShard(), this,
+                               CompareOperatorGreaterThan<unsigned_t>());
   return isValid;
 }
 
@@ -956,6 +1011,22 @@ bool SGDNode::verify() const {
   return checkSameType(getGradient(), getWeight(), this);
 }
 
+bool MomentumSGDNode::verify() const {
+  bool isValid = checkSameType(getGradient(), getWeight(), this);
+  isValid &= checkSameType(getGsum(), getWeight(), this);
+  return isValid;
+}
+
+bool AdamNode::verify() const {
+  bool isValid = checkSameType(getGradient(), getWeight(), this);
+  isValid &= checkSameType(getM(), getWeight(), this);
+  isValid &= checkSameType(getV(), getWeight(), this);
+  isValid &= checkType(getStep(), ElemKind::FloatTy, this);
+  isValid &= expectCompareTrue("Step must have a single element",
+                               getStep().getType()->size(), size_t(1), this);
+  return isValid;
+}
+
 bool QuantizationProfileNode::verify() const {
   // Make sure that input tensor is a floating point type.
   bool isValid = checkType(getInput(), ElemKind::FloatTy, this);
@@ -19,9 +19,11 @@
 
 using namespace glow;
 
-namespace {
+namespace glow {
 llvm::cl::OptionCategory graphSchedulerCat("Graph Scheduler Options");
+} // namespace glow
 
+namespace {
 llvm::cl::opt<SchedulerKind> graphScheduler(
     llvm::cl::desc("Scheduler to use:"),
     llvm::cl::values(clEnumValN(SchedulerKind::ChildMemSizeBased,
@@ -29,7 +31,9 @@ llvm::cl::opt<SchedulerKind> graphScheduler(
                                 "Use ChildMemSizeBased"),
                      clEnumValN(SchedulerKind::TopologicalSortBased,
                                 "topological-sort-based",
-                                "Use TopologicalSortBased")),
+                                "Use TopologicalSortBased"),
+                     clEnumValN(SchedulerKind::MemoryAware, "memory-aware",
+                                "Use MemoryAware")),
     llvm::cl::init(SchedulerKind::ChildMemSizeBased),
     llvm::cl::cat(graphSchedulerCat));
 } // namespace
@@ -42,6 +46,8 @@ Scheduler *createScheduler(SchedulerKind schedulerKind, Function &G,
     return new ChildMemSizeBasedScheduler(G, scheduled);
   case SchedulerKind::TopologicalSortBased:
     return new TopologicalSortBasedScheduler(G, scheduled);
+  case SchedulerKind::MemoryAware:
+    return new MemoryAwareScheduler(G, scheduled);
   }
   llvm_unreachable("unreachable");
 }
@@ -19,6 +19,7 @@
 #include "glow/IR/IR.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace glow {
 
@@ -28,6 +29,8 @@ enum class SchedulerKind {
   ChildMemSizeBased,
   /// Performs a standard topological search
   TopologicalSortBased,
+  /// Searches for a schedule with a low peak of live activation memory.
+  MemoryAware,
 };
 
 class Scheduler {
@@ -104,6 +107,65 @@ public:
   void schedule() override;
 };
 
+/// This scheduler explicitly minimizes the peak number of bytes of node
+/// results that are alive at the same time. A result is alive from the moment
+/// its node is scheduled until its last user in the function is scheduled,
+/// which is how the results are later packed into the activation buffer.
+///
+/// The scheduler performs a beam search over topological orders: it extends
+/// the best partial schedules by every node that is ready to run, and keeps
+/// the ones with the lowest peak, then the lowest live memory. The result of
+/// ChildMemSizeBasedScheduler is used instead if it turns out better, so this
+/// scheduler never increases the peak.
+///
+/// Every step copies the state of each extended schedule, so the search takes
+/// O(W * N^2) time for a beam of width W over N nodes. This is why it is only
+/// used on request, with -memory-aware.
+class MemoryAwareScheduler : public Scheduler {
+  /// The nodes of the function, indexed by their position in it.
+  std::vector<Node *> nodes_;
+  /// Maps nodes to their indices in nodes_.
+  std::unordered_map<const Node *, unsigned> index_;
+  /// The nodes that have to be scheduled before each node.
+  std::vector<std::vector<unsigned>> preds_;
+  /// The nodes that have to be scheduled after each node.
+  std::vector<std::vector<unsigned>> succs_;
+  /// The nodes that read the results of each node.
+  std::vector<std::vector<unsigned>> users_;
+  /// The nodes whose results each node reads.
+  std::vector<std::vector<unsigned>> operands_;
+  /// Required number of bytes to hold the results of each node.
+  std::vector<uint64_t> resultMemSize_;
+  /// Peak memory of the schedule of ChildMemSizeBasedScheduler.
+  uint64_t baselinePeakMemSize_{0};
+  /// Peak memory of the computed schedule.
+  uint64_t peakMemSize_{0};
+
+  /// Build the dependencies and result sizes of the nodes.
+  void computeDependencies();
+
+  /// \returns the peak memory of the nodes \p order, given as indices.
+  uint64_t computePeakMemSize(llvm::ArrayRef<unsigned> order) const;
+
+  /// \returns the schedule that the beam search found.
+  std::vector<unsigned> searchSchedule() const;
+
+public:
+  MemoryAwareScheduler(Function &G, NodesPtrList &Schedule)
+      : Scheduler(G, Schedule) {}
+
+  ~MemoryAwareScheduler() override = default;
+
+  void schedule() override;
+
+  /// \returns the peak activation memory of ChildMemSizeBasedScheduler's
+  /// schedule for the function.
+  uint64_t getBaselinePeakMemSize() const { return baselinePeakMemSize_; }
+
+  /// \returns the peak activation memory of the computed schedule.
+  uint64_t getPeakMemSize() const { return peakMemSize_; }
+};
+
 Scheduler *createScheduler(SchedulerKind schedulerKind, Function &G,
                            NodesPtrList &scheduled);
 
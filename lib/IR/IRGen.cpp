@@ -371,6 +371,48 @@ void IRGenVisitor::post(Node *parent, Node *N) {
                                            histogram, computationInfo);
     break;
   }
+  case glow::Kinded::Kind::SGDNodeKind: {
+    auto *SGD = cast<SGDNode>(N);
+    auto *weight = valueForNode(SGD->getWeight());
+    auto *gradient = valueForNode(SGD->getGradient());
+    auto *dest = builder_.createAllocActivationInst(
+        "sgd.res", SGD->getUpdatedWeight().getType());
+    builder_.createSGDInst(N->getName(), dest, weight, gradient,
+                           SGD->getL1Decay(), SGD->getL2Decay(),
+                           SGD->getLearningRate(), SGD->getBatchSize());
+    registerIR(SGD->getUpdatedWeight(), dest);
+    break;
+  }
+  case glow::Kinded::Kind::MomentumSGDNodeKind: {
+    auto *SGD = cast<MomentumSGDNode>(N);
+    auto *weight = valueForNode(SGD->getWeight());
+    auto *gradient = valueForNode(SGD->getGradient());
+    auto *gsum = valueForNode(SGD->getGsumPlaceholder());
+    auto *dest = builder_.createAllocActivationInst(
+        "sgd.res", SGD->getUpdatedWeight().getType());
+    builder_.createMomentumSGDInst(N->getName(), dest, weight, gradient, gsum,
+                                   SGD->getL1Decay(), SGD->getL2Decay(),
+                                   SGD->getLearningRate(), SGD->getMomentum(),
+                                   SGD->getBatchSize());
+    registerIR(SGD->getUpdatedWeight(), dest);
+    break;
+  }
+  case glow::Kinded::Kind::AdamNodeKind: {
+    auto *A = cast<AdamNode>(N);
+    auto *weight = valueForNode(A->getWeight());
+    auto *gradient = valueForNode(A->getGradient());
+    auto *M = valueForNode(A->getMPlaceholder());
+    auto *V = valueForNode(A->getVPlaceholder());
+    auto *step = valueForNode(A->getStepPlaceholder());
+    auto *dest = builder_.createAllocActivationInst(
+        "adam.res", A->getUpdatedWeight().getType());
+    builder_.createAdamInst(N->getName(), dest, weight, gradient, M, V, step,
+                            A->getL1Decay(), A->getL2Decay(),
+                            A->getLearningRate(), A->getBeta1(), A->getBeta2(),
+                            A->getEpsilon(), A->getBatchSize());
+    registerIR(A->getUpdatedWeight(), dest);
+    break;
+  }
   case glow::Kinded::Kind::TopKNodeKind: {
     auto *TKN = cast<TopKNode>(N);
     auto *inputTensor = valueForNode(TKN->getInput());
@@ -381,6 +423,26 @@ void IRGenVisitor::post(Node *parent, Node *N) {
     break;
   }
 
+  case glow::Kinded::Kind::SparseLengthsShardNodeKind: {
+    auto *SLS = cast<SparseLengthsShardNode>(N);
+    auto *weights = valueForNode(SLS->getWeights());
+    auto *indices = valueForNode(SLS->getIndices());
+    auto *lengths = valueForNode(SLS->getLengths());
+    auto *shardWeights = builder_.createAllocActivationInst(
+        N->getName().str() + ".weights", weights->getType());
+    auto *shardIndices = builder_.createAllocActivationInst(
+        N->getName().str() + ".indices", indices->getType());
+    auto *shardLengths = builder_.createAllocActivationInst(
+        N->getName().str() + ".lengths", lengths->getType());
+    builder_.createSparseLengthsShardInst(
+        N->getName(), shardWeights, shardIndices, shardLengths, weights,
+        indices, lengths, SLS->getNumShards(), SLS->getShard());
+    registerIR(SLS->getShardWeights(), shardWeights);
+    registerIR(SLS->getShardIndices(), shardIndices);
+    registerIR(SLS->getShardLengths(), shardLengths);
+    break;
+  }
+
   case glow::Kinded::Kind::TraceEventNodeKind: {
     auto *TEN = cast<TraceEventNode>(N);
     auto *dataTensor = valueForNode(TEN->getData());
@@ -0,0 +1,313 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GraphScheduler.h"
+
+#include "glow/Graph/Nodes.h"
+#include "glow/Support/Debug.h"
+
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <tuple>
+
+#define DEBUG_TYPE "graph-scheduler"
+
+using llvm::dyn_cast;
+
+namespace glow {
+extern llvm::cl::OptionCategory graphSchedulerCat;
+} // namespace glow
+
+namespace {
+llvm::cl::opt<unsigned> memorySchedulerBeamWidth(
+    "memory-scheduler-beam-width",
+    llvm::cl::desc("Number of partial schedules that the memory-aware "
+                   "scheduler keeps at every step"),
+    llvm::cl::init(8), llvm::cl::cat(glow::graphSchedulerCat));
+
+llvm::cl::opt<bool> dumpSchedulePeakMemory(
+    "dump-schedule-peak-memory",
+    llvm::cl::desc("Print the peak activation memory of every Function "
+                   "before and after memory-aware scheduling"),
+    llvm::cl::init(false), llvm::cl::cat(glow::graphSchedulerCat));
+
+/// \returns a pseudo-random 64-bit number for \p x (splitmix64), used to hash
+/// the sets of scheduled nodes.
+uint64_t hashIndex(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/// Adds \p val to \p vec unless it is there already.
+void addUnique(std::vector<unsigned> &vec, unsigned val) {
+  if (std::find(vec.begin(), vec.end(), val) == vec.end()) {
+    vec.push_back(val);
+  }
+}
+} // namespace
+
+namespace glow {
+
+void MemoryAwareScheduler::computeDependencies() {
+  for (auto &N : G_.getNodes()) {
+    index_[&N] = nodes_.size();
+    nodes_.push_back(&N);
+  }
+  size_t numNodes = nodes_.size();
+  preds_.resize(numNodes);
+  succs_.resize(numNodes);
+  users_.resize(numNodes);
+  operands_.resize(numNodes);
+  resultMemSize_.resize(numNodes);
+
+  // Record that \p before has to be scheduled before \p after.
+  auto addDependency = [&](unsigned after, unsigned before) {
+    if (std::find(preds_[after].begin(), preds_[after].end(), before) ==
+        preds_[after].end()) {
+      preds_[after].push_back(before);
+      succs_[before].push_back(after);
+    }
+  };
+
+  for (unsigned idx = 0; idx < numNodes; idx++) {
+    Node *N = nodes_[idx];
+    for (size_t r = 0, e = N->getNumResults(); r < e; ++r) {
+      resultMemSize_[idx] += N->getType(r)->getSizeInBytes();
+    }
+
+    llvm::SmallVector<Node *, 8> inputs;
+    for (size_t i = 0, e = N->getNumInputs(); i < e; ++i) {
+      inputs.push_back(N->getNthInput(i).getNode());
+    }
+    if (N->hasPredicate()) {
+      inputs.push_back(N->getPredicate().getNode());
+    }
+    for (auto *input : inputs) {
+      // Storage nodes don't need memory for their results, and are not
+      // scheduled here.
+      auto it = index_.find(input);
+      if (it == index_.end()) {
+        continue;
+      }
+      addUnique(operands_[idx], it->second);
+      addUnique(users_[it->second], idx);
+      addDependency(idx, it->second);
+    }
+
+    // Like in ChildMemSizeBasedScheduler, make sure the SaveNode happens after
+    // the last use of the output placeholder.
+    if (auto *save = dyn_cast<SaveNode>(N)) {
+      auto *destination = save->getOutput().getNode();
+      for (NodeUse &use : destination->getUsers()) {
+        Node *user = use.getUser();
+        if (user == save || &G_ != user->getParent()) {
+          continue;
+        }
+        addDependency(idx, index_[user]);
+      }
+    }
+  }
+}
+
+uint64_t
+MemoryAwareScheduler::computePeakMemSize(llvm::ArrayRef<unsigned> order) const {
+  std::vector<size_t> remainingUsers(nodes_.size());
+  for (size_t idx = 0, e = nodes_.size(); idx < e; idx++) {
+    remainingUsers[idx] = users_[idx].size();
+  }
+  uint64_t live = 0;
+  uint64_t peak = 0;
+  for (auto idx : order) {
+    // The operands are alive while the results are computed.
+    live += resultMemSize_[idx];
+    peak = std::max(peak, live);
+    for (auto op : operands_[idx]) {
+      if (--remainingUsers[op] == 0) {
+        live -= resultMemSize_[op];
+      }
+    }
+    if (users_[idx].empty()) {
+      live -= resultMemSize_[idx];
+    }
+  }
+  return peak;
+}
+
+namespace {
+/// A partial schedule of the beam search.
+struct PartialSchedule {
+  /// The scheduled nodes, in order.
+  std::vector<unsigned> order;
+  /// The number of unscheduled predecessors of every node.
+  std::vector<unsigned> remainingPreds;
+  /// The number of unscheduled users of every node.
+  std::vector<unsigned> remainingUsers;
+  /// The nodes whose predecessors are all scheduled.
+  std::vector<unsigned> ready;
+  /// The bytes of the results that are alive after the last scheduled node.
+  uint64_t live{0};
+  /// The peak of the live bytes so far.
+  uint64_t peak{0};
+  /// Hash of the set of scheduled nodes.
+  uint64_t hash{0};
+};
+
+/// A way to extend a partial schedule by one node.
+struct Extension {
+  uint64_t peak;
+  uint64_t live;
+  unsigned parent;
+  unsigned node;
+  uint64_t hash;
+
+  bool operator<(const Extension &other) const {
+    return std::tie(peak, live, parent, node) <
+           std::tie(other.peak, other.live, other.parent, other.node);
+  }
+};
+} // namespace
+
+std::vector<unsigned> MemoryAwareScheduler::searchSchedule() const {
+  size_t numNodes = nodes_.size();
+  size_t beamWidth = std::max(1u, unsigned(memorySchedulerBeamWidth));
+
+  PartialSchedule initial;
+  initial.remainingPreds.resize(numNodes);
+  initial.remainingUsers.resize(numNodes);
+  for (unsigned idx = 0; idx < numNodes; idx++) {
+    initial.remainingPreds[idx] = preds_[idx].size();
+    initial.remainingUsers[idx] = users_[idx].size();
+    if (preds_[idx].empty()) {
+      initial.ready.push_back(idx);
+    }
+  }
+  std::vector<PartialSchedule> beam;
+  beam.push_back(std::move(initial));
+
+  std::vector<Extension> extensions;
+  for (size_t step = 0; step < numNodes; step++) {
+    // Evaluate every ready node of every partial schedule without copying
+    // the schedules.
+    extensions.clear();
+    for (unsigned parent = 0, e = beam.size(); parent < e; parent++) {
+      const auto &S = beam[parent];
+      for (auto idx : S.ready) {
+        uint64_t live = S.live + resultMemSize_[idx];
+        uint64_t peak = std::max(S.peak, live);
+        for (auto op : operands_[idx]) {
+          if (S.remainingUsers[op] == 1) {
+            live -= resultMemSize_[op];
+          }
+        }
+        if (users_[idx].empty()) {
+          live -= resultMemSize_[idx];
+        }
+        extensions.push_back(
+            {peak, live, parent, idx, S.hash ^ hashIndex(idx)});
+      }
+    }
+    assert(!extensions.empty() && "The dependencies of the nodes have cycles");
+    std::sort(extensions.begin(), extensions.end());
+
+    // Keep the best extensions that lead to different sets of scheduled
+    // nodes. Schedules of the same set of nodes only differ in their peak so
+    // far, and the sorting put the lowest peak first.
+    std::vector<Extension> selected;
+    llvm::SmallVector<uint64_t, 16> hashes;
+    for (const auto &ext : extensions) {
+      if (selected.size() == beamWidth) {
+        break;
+      }
+      if (std::find(hashes.begin(), hashes.end(), ext.hash) != hashes.end()) {
+        continue;
+      }
+      hashes.push_back(ext.hash);
+      selected.push_back(ext);
+    }
+
+    // Build the new partial schedules. A parent that is extended only once is
+    // moved instead of copied.
+    std::vector<unsigned> numChildren(beam.size());
+    for (const auto &ext : selected) {
+      numChildren[ext.parent]++;
+    }
+    std::vector<PartialSchedule> nextBeam;
+    for (const auto &ext : selected) {
+      auto &parent = beam[ext.parent];
+      PartialSchedule S = --numChildren[ext.parent] == 0
+                              ? std::move(parent)
+                              : PartialSchedule(parent);
+      S.order.push_back(ext.node);
+      S.live = ext.live;
+      S.peak = ext.peak;
+      S.hash = ext.hash;
+      S.ready.erase(std::find(S.ready.begin(), S.ready.end(), ext.node));
+      for (auto op : operands_[ext.node]) {
+        S.remainingUsers[op]--;
+      }
+      for (auto succ : succs_[ext.node]) {
+        if (--S.remainingPreds[succ] == 0) {
+          S.ready.push_back(succ);
+        }
+      }
+      nextBeam.push_back(std::move(S));
+    }
+    beam = std::move(nextBeam);
+  }
+  // The partial schedules are sorted by their peak.
+  return beam.empty() ? std::vector<unsigned>() : std::move(beam[0].order);
+}
+
+void MemoryAwareScheduler::schedule() {
+  computeDependencies();
+
+  // Use the schedule of ChildMemSizeBasedScheduler as the baseline.
+  NodesPtrList baselineSchedule;
+  ChildMemSizeBasedScheduler baseline(G_, baselineSchedule);
+  baseline.schedule();
+  std::vector<unsigned> baselineOrder;
+  for (auto *N : baselineSchedule) {
+    baselineOrder.push_back(index_[N]);
+  }
+  baselinePeakMemSize_ = computePeakMemSize(baselineOrder);
+
+  std::vector<unsigned> order = searchSchedule();
+  peakMemSize_ = computePeakMemSize(order);
+  if (order.size() != nodes_.size() || peakMemSize_ >= baselinePeakMemSize_) {
+    order = std::move(baselineOrder);
+    peakMemSize_ = baselinePeakMemSize_;
+  }
+
+  DEBUG_GLOW(llvm::dbgs() << "Peak activation memory of " << G_.getName()
+                          << ": " << baselinePeakMemSize_ << " -> "
+                          << peakMemSize_ << " bytes\n");
+  if (dumpSchedulePeakMemory) {
+    llvm::outs() << "Peak activation memory of " << G_.getName() << ": "
+                 << baselinePeakMemSize_ << " -> " << peakMemSize_
+                 << " bytes\n";
+  }
+
+  for (auto idx : order) {
+    scheduled_.push_back(nodes_[idx]);
+  }
+}
+} // namespace glow
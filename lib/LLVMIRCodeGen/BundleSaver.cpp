@@ -227,6 +227,31 @@ void BundleSaver::emitBundleEntryFunction() {
   irgen_->generateFunctionDebugInfo(func);
 }
 
+/// Emit the function that lets the client split the heavy kernels of the
+/// bundle across threads. It has the following API:
+/// void <network_name>_set_parallel_for(
+///     void (*parallelFor)(void *runtimeCtx, size_t numIters,
+///                         void (*body)(void *ctx, size_t begin, size_t end),
+///                         void *ctx),
+///     void *runtimeCtx);
+/// It forwards its arguments to libjit_set_parallel_for, which is internal to
+/// the bundle.
+void BundleSaver::emitSetParallelForFunction() {
+  auto *setParallelForF = irgen_->getFunction("set_parallel_for");
+  auto *func = llvm::Function::Create(
+      setParallelForF->getFunctionType(), llvm::Function::ExternalLinkage,
+      irgen_->getMainEntryName() + "_set_parallel_for", &irgen_->getModule());
+  llvm::BasicBlock *entry_bb =
+      llvm::BasicBlock::Create(irgen_->getLLVMContext(), "entry", func);
+  llvm::IRBuilder<> builder(entry_bb);
+  llvm::SmallVector<llvm::Value *, 2> args;
+  for (auto &arg : func->args()) {
+    args.push_back(&arg);
+  }
+  irgen_->createCall(builder, setParallelForF, args);
+  builder.CreateRetVoid();
+}
+
 // Create a config for this network. It will be exposed to the clients,
 // so that they know how much memory they need to allocate, etc.
 // Config consists of the following fields:
@@ -292,6 +317,8 @@ void BundleSaver::save(llvm::StringRef target, llvm::StringRef arch,
   performBundleMemoryAllocation();
   // Create the bundle entry function.
   emitBundleEntryFunction();
+  // Create the function registering the parallel-for used by the kernels.
+  emitSetParallelForFunction();
   // Emit the code for the body of the entry function.
   irgen_->performCodeGen();
   // Produce the bundle.
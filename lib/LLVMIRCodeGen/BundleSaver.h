@@ -44,6 +44,8 @@ class BundleSaver final {
   void emitSymbolTable();
   /// Emit the entry function for the bundle.
   void emitBundleEntryFunction();
+  /// Emit the function that registers the parallel-for of the bundle.
+  void emitSetParallelForFunction();
 
 public:
   /// Ctor.
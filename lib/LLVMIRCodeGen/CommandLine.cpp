@@ -42,3 +42,16 @@ llvm::cl::list<std::string> llvmCompilerOptions(
     "llvm-compiler-opt",
     llvm::cl::desc("Options to pass to the external LLVM compiler"),
     llvm::cl::ZeroOrMore);
+
+llvm::cl::opt<bool> bundleCompressWeights(
+    "bundle-compress-weights",
+    llvm::cl::desc("Store the large floating point constant weights of a "
+                   "bundle quantized to int8, and dequantize each of them "
+                   "into the activations memory right before it is used"),
+    llvm::cl::init(false), llvm::cl::cat(getLLVMBackendCat()));
+
+llvm::cl::opt<unsigned> bundleCompressWeightsMinSize(
+    "bundle-compress-weights-min-size",
+    llvm::cl::desc("The minimum number of elements of a constant weight "
+                   "compressed by -bundle-compress-weights"),
+    llvm::cl::init(1024), llvm::cl::cat(getLLVMBackendCat()));
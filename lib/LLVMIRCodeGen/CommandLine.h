@@ -40,5 +40,10 @@ extern llvm::cl::list<std::string> llvmTargetFeatures;
 extern llvm::cl::opt<std::string> llvmCompiler;
 /// Set of options to pass to the external LLVM compiler.
 extern llvm::cl::list<std::string> llvmCompilerOptions;
+/// Whether bundles store their large floating point constants as int8 and
+/// dequantize them right before they are used.
+extern llvm::cl::opt<bool> bundleCompressWeights;
+/// The minimum number of elements of a constant compressed in a bundle.
+extern llvm::cl::opt<unsigned> bundleCompressWeightsMinSize;
 
 #endif // GLOW_LLVMIRCODEGEN_COMMANDLINE_H
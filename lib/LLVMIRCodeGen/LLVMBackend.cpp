@@ -23,12 +23,16 @@
 #include "glow/Graph/Graph.h"
 #include "glow/Graph/PlaceholderBindings.h"
 #include "glow/IR/Instrs.h"
+#include "glow/Quantization/Base/Base.h"
 #include "glow/Support/Debug.h"
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "jit"
 
 using namespace glow;
 
@@ -46,6 +50,69 @@ void allocateJITMemory(const IRFunction *F, AllocationsInfo &allocationsInfo) {
   allocationsInfo.allocateTensorViews(F);
 }
 
+/// \returns true if \p F uses \p C and every such use reads it through an
+/// input that \p backend allows to be compressed.
+bool hasOnlyCompressibleUses(const Constant *C, const Function *F,
+                             const LLVMBackend &backend) {
+  bool usedByF = false;
+  for (const auto &use : C->getUsers()) {
+    const Node *user = use.getUser();
+    if (user->getParent() != F) {
+      continue;
+    }
+    usedByF = true;
+    for (unsigned idx = 0, e = user->getNumInputs(); idx < e; idx++) {
+      if (user->getNthInput(idx).getNode() == C &&
+          !backend.isCompressibleWeight(*user, idx)) {
+        return false;
+      }
+    }
+  }
+  return usedByF;
+}
+
+/// Replace the uses in \p F of each large floating point Constant with an
+/// int8 Constant quantized with the range of its values, followed by a
+/// Dequantize. The scheduler places each Dequantize right before its users,
+/// so the floating point weights only live in the activations memory while
+/// they are needed. Only the Constants whose uses \p backend accepts as
+/// compressible are replaced; the original Constants are left in the Module.
+/// \returns the int8 Constants created in the Module of \p F.
+std::vector<Constant *> compressBundleWeights(Function *F,
+                                              const LLVMBackend &backend) {
+  Module *M = F->getParent();
+  std::vector<Constant *> constants;
+  for (auto *C : M->getConstants()) {
+    if (C->getElementType() == ElemKind::FloatTy &&
+        C->getType()->size() >= bundleCompressWeightsMinSize &&
+        hasOnlyCompressibleUses(C, F, backend)) {
+      constants.push_back(C);
+    }
+  }
+
+  size_t origSize = 0;
+  size_t compressedSize = 0;
+  std::vector<Constant *> compressed;
+  for (auto *C : constants) {
+    auto H = C->getPayload().getHandle<float>();
+    auto minMaxIdx = H.minMaxArg();
+    auto TQP = quantization::chooseQuantizationParams(
+        H.raw(minMaxIdx.first), H.raw(minMaxIdx.second));
+    auto *QC = M->createConstant(
+        C->getName().str() + "_compressed",
+        quantization::quantizeTensor(C->getPayload(), TQP));
+    auto *DQ = F->createDequantize(C->getName().str() + "_decompress", QC);
+    C->getOutput().replaceAllUsesOfWith(DQ, F);
+    origSize += C->getType()->getSizeInBytes();
+    compressedSize += QC->getType()->getSizeInBytes();
+    compressed.push_back(QC);
+  }
+  DEBUG_GLOW(llvm::dbgs() << "Compressed " << origSize
+                          << " bytes of bundle weights into " << compressedSize
+                          << " bytes\n");
+  return compressed;
+}
+
 } // end namespace
 
 /// Emit the entry point for JIT called "jitmain".
@@ -153,7 +220,38 @@ void LLVMBackend::save(Function *F, llvm::StringRef outputDir,
   llvm::StringRef cpu = llvmCPU.getValue();
   llvm::SmallVector<std::string, 8> targetFeatures(llvmTargetFeatures.begin(),
                                                    llvmTargetFeatures.end());
-  auto IR = generateAndOptimizeIR(F, *this, shouldShareBuffers());
-  BundleSaver(IR.get(), *this)
-      .save(target, arch, cpu, targetFeatures, outputDir, networkName);
+  if (!bundleCompressWeights) {
+    auto IR = generateAndOptimizeIR(F, *this, shouldShareBuffers());
+    BundleSaver(IR.get(), *this)
+        .save(target, arch, cpu, targetFeatures, outputDir, networkName);
+    return;
+  }
+
+  // Compress the weights of a clone of F, so that the Function and the
+  // Constants of the caller are left untouched once the bundle is saved.
+  Module *M = F->getParent();
+  Function *compressedF = F->clone(F->getName().str() + "_compressed");
+  auto compressedConstants = compressBundleWeights(compressedF, *this);
+  {
+    auto IR = generateAndOptimizeIR(compressedF, *this, shouldShareBuffers());
+    BundleSaver(IR.get(), *this)
+        .save(target, arch, cpu, targetFeatures, outputDir, networkName);
+  }
+  M->eraseFunction(compressedF);
+  for (auto *QC : compressedConstants) {
+    M->eraseConstant(QC);
+  }
+}
+
+bool LLVMBackend::isCompressibleWeight(const Node &user, unsigned idx) const {
+  switch (user.getKind()) {
+  case Kinded::Kind::ConvolutionNodeKind:
+    return idx == ConvolutionNode::FilterIdx;
+  case Kinded::Kind::FullyConnectedNodeKind:
+    return idx == FullyConnectedNode::WeightsIdx;
+  case Kinded::Kind::MatMulNodeKind:
+    return true;
+  default:
+    return false;
+  }
 }
@@ -35,6 +35,8 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
+#include <mutex>
+
 using namespace glow;
 using llvm::cast;
 using llvm::dyn_cast;
@@ -63,6 +65,13 @@ llvm::cl::opt<llvm::Reloc::Model> relocModel(
         clEnumValN(llvm::Reloc::PIC_, "pic", "Position independent code")),
     llvm::cl::init(llvm::Reloc::Static), llvm::cl::cat(getLLVMBackendCat()));
 
+static llvm::cl::opt<bool> fuseAcrossInstrs(
+    "llvm-fuse-across-instrs",
+    llvm::cl::desc("Keep fusing data-parallel instructions into one kernel "
+                   "across non-data-parallel instructions that don't access "
+                   "the memory of the kernel"),
+    llvm::cl::init(true), llvm::cl::cat(getLLVMBackendCat()));
+
 /// Limitation of number of arguments for `emitDataParallelKernel`.
 constexpr static size_t kArgLimit = 64;
 
@@ -107,10 +116,15 @@ void LLVMIRGen::initTargetMachine(
     llvm::StringRef target, llvm::StringRef arch, llvm::StringRef cpu,
     const llvm::SmallVectorImpl<std::string> &targetFeatures,
     llvm::CodeModel::Model codeModel) {
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
+  // The target registry is global and Functions may be compiled in parallel,
+  // so the targets are registered only once.
+  static std::once_flag initTargets;
+  std::call_once(initTargets, []() {
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+  });
 
   if (target.empty()) {
     TM_.reset(llvm::EngineBuilder()
@@ -237,6 +251,8 @@ llvm::Type *LLVMIRGen::getElementType(llvm::IRBuilder<> &builder,
     return builder.getInt32Ty();
   case ElemKind::UInt8FusedQTy:
     return builder.getInt8Ty();
+  case ElemKind::UInt4FusedQTy:
+    return builder.getInt8Ty();
   case ElemKind::BoolTy:
     static_assert(sizeof(bool) == sizeof(int8_t),
                   "Bool is expected to be the same size as int8.");
@@ -331,6 +347,9 @@ llvm::Value *LLVMIRGen::emitValueAddress(llvm::IRBuilder<> &builder,
   case ElemKind::UInt8FusedQTy:
     T = llvm::Type::getInt8PtrTy(ctx_);
     break;
+  case ElemKind::UInt4FusedQTy:
+    T = llvm::Type::getInt8PtrTy(ctx_);
+    break;
   case ElemKind::BoolTy:
     T = llvm::Type::getInt8PtrTy(ctx_);
     break;
@@ -481,6 +500,8 @@ llvm::Value *LLVMIRGen::emitConst(llvm::IRBuilder<> &builder, float val,
     return builder.getInt32(static_cast<int32_t>(val));
   case ElemKind::UInt8FusedQTy:
     return builder.getInt8(static_cast<int8_t>(val));
+  case ElemKind::UInt4FusedQTy:
+    return builder.getInt8(static_cast<int8_t>(val));
   case ElemKind::BoolTy:
     return builder.getInt8(static_cast<int8_t>(val));
   }
@@ -778,6 +799,58 @@ static bool isOverlappingWithAnyBundleBufferOperands(
   return false;
 }
 
+/// \returns true if the memory of \p buf1 and \p buf2 may overlap. Buffers of
+/// different kinds (constant weights, mutable weights and activations) live in
+/// different memory areas and never overlap.
+static bool mayOverlap(AllocationsInfo &allocationsInfo, Value *buf1,
+                       Value *buf2) {
+  auto &valueNumbers = allocationsInfo.valueNumbers_;
+  auto it1 = valueNumbers.find(buf1);
+  auto it2 = valueNumbers.find(buf2);
+  if (it1 != valueNumbers.end() && it2 != valueNumbers.end() &&
+      it1->second.first != it2->second.first) {
+    return false;
+  }
+  auto addr1 = allocationsInfo.allocatedAddress_[buf1];
+  auto size1 = buf1->getSizeInBytes();
+  auto addr2 = allocationsInfo.allocatedAddress_[buf2];
+  auto size2 = buf2->getSizeInBytes();
+  return addr1 < addr2 + size2 && addr2 < addr1 + size1;
+}
+
+/// Check if the non-data-parallel instruction \p I can be executed before all
+/// instructions of the \p bundle, even though some of them precede it. This is
+/// the case if \p I neither reads memory that the bundle writes, nor writes
+/// memory that the bundle accesses. The bundle can then stay open, and the
+/// data-parallel instructions on both sides of \p I are fused into one kernel.
+///
+/// \param allocationsInfo information about allocations
+/// \param bundle current bundle of stacked instructions
+/// \param I the instruction to be moved above the \p bundle.
+static bool
+canMoveAboveBundle(AllocationsInfo &allocationsInfo,
+                   llvm::SmallVectorImpl<const Instruction *> &bundle,
+                   const Instruction &I) {
+  // These instructions observe the order of execution.
+  if (isa<TraceEventInst>(&I) || isa<DebugPrintInst>(&I)) {
+    return false;
+  }
+  for (auto op : I.getOperands()) {
+    for (auto bi : bundle) {
+      for (auto bop : bi->getOperands()) {
+        // Two reads of the same memory don't conflict.
+        if (op.second == OperandKind::In && bop.second == OperandKind::In) {
+          continue;
+        }
+        if (mayOverlap(allocationsInfo, op.first, bop.first)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 void LLVMIRGen::generateLLVMIRForModule(llvm::IRBuilder<> &builder) {
   // Go over the instructions and try to group them into bundles.
   auto &instrs = F_->getInstrs();
@@ -792,8 +865,15 @@ void LLVMIRGen::generateLLVMIRForModule(llvm::IRBuilder<> &builder) {
       if (isa<AllocActivationInst>(&I) || isa<DeallocActivationInst>(&I) ||
           isa<TensorViewInst>(&I))
         continue;
-      emitDataParallelKernel(builder, bundle);
-      bundle.clear();
+      // Emit the instruction ahead of the open bundle if it is independent of
+      // it, so that the bundle can keep growing with the data-parallel
+      // instructions that follow. Otherwise the bundle has to be executed
+      // first.
+      if (!fuseAcrossInstrs ||
+          !canMoveAboveBundle(allocationsInfo_, bundle, I)) {
+        emitDataParallelKernel(builder, bundle);
+        bundle.clear();
+      }
       generateLLVMIRForInstr(builder, &I);
       continue;
     }
@@ -1379,8 +1459,12 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
                  {destPtr, lhsPtr, rhsPtr, destDims, lhsDims, rhsDims,
                   destOffset, lhsOffset, rhsOffset, outPre, outPost, outScale});
     } else {
+      // Zero tile sizes select the default cache blocking of libjit.
+      auto *mcBlock = emitConstSizeT(builder, 0);
+      auto *kcBlock = emitConstSizeT(builder, 0);
       createCall(builder, F,
-                 {destPtr, lhsPtr, rhsPtr, destDims, lhsDims, rhsDims});
+                 {destPtr, lhsPtr, rhsPtr, destDims, lhsDims, rhsDims, mcBlock,
+                  kcBlock});
     }
     break;
   }
@@ -1704,6 +1788,123 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     break;
   }
 
+  case Kinded::Kind::ChannelwiseQuantizedConvolutionInstKind: {
+    auto *CQC = cast<ChannelwiseQuantizedConvolutionInst>(I);
+    // Since we can't get the variable from a glow::Value directly,
+    // we need to traverse the var list and find the one matching the given
+    // Value.
+    Tensor scalesT;
+    auto *F_ = getIRFunction();
+    for (auto &v : F_->findConstants()) {
+      assert(isa<WeightVar>(F_->getWeightForNode(v)));
+      auto *w = cast<glow::Value>(F_->getWeightForNode(v));
+      if (w == CQC->getScales()) {
+        scalesT.assign(&v->getPayload());
+        break;
+      }
+    }
+    GLOW_ASSERT(scalesT.getUnsafePtr() != nullptr &&
+                "Can't find the variable.");
+
+    auto scalesH = scalesT.getHandle();
+    size_t channelNum = scalesH.dims()[0];
+    float inputScale = CQC->getSrc()->getType()->getScale();
+
+    float bScale = CQC->getBias()->getType()->getScale();
+    int32_t bOffset = CQC->getBias()->getType()->getOffset();
+
+    float outputScale = CQC->getDest()->getType()->getScale();
+
+    std::vector<llvm::Constant *> biasPreV(channelNum);
+    std::vector<llvm::Constant *> biasPostV(channelNum);
+    std::vector<llvm::Constant *> biasScaleV(channelNum);
+    std::vector<llvm::Constant *> outputPreV(channelNum);
+    std::vector<llvm::Constant *> outputPostV(channelNum);
+    std::vector<llvm::Constant *> outputScaleV(channelNum);
+
+    for (size_t i = 0; i < channelNum; i++) {
+      // Calculate the scale of the values that come out of the matrix
+      // multiplication part of the calculation for this output channel.
+      float matMulScale = inputScale * scalesH.raw(i);
+
+      // Calculate the scaling parameters for the bias and output.
+      auto biasScaleParam =
+          quantization::quantizeScaleOffset32To8(bScale / matMulScale, bOffset);
+      auto outScaleParam =
+          quantization::quantizeScaleOffset32To8(matMulScale / outputScale, 0);
+
+      // Pass the pre-shift, post-shift and integer scale parameters for the
+      // bias and output calculation.
+      biasPreV[i] = llvm::ConstantInt::get(builder.getInt32Ty(),
+                                           biasScaleParam.pre, true);
+      biasPostV[i] = llvm::ConstantInt::get(builder.getInt32Ty(),
+                                            biasScaleParam.post, true);
+      biasScaleV[i] = llvm::ConstantInt::get(builder.getInt32Ty(),
+                                             biasScaleParam.scale, true);
+      outputPreV[i] =
+          llvm::ConstantInt::get(builder.getInt32Ty(), outScaleParam.pre, true);
+      outputPostV[i] = llvm::ConstantInt::get(builder.getInt32Ty(),
+                                              outScaleParam.post, true);
+      outputScaleV[i] = llvm::ConstantInt::get(builder.getInt32Ty(),
+                                               outScaleParam.scale, true);
+    }
+
+    auto *dest = CQC->getDest();
+    auto *src = CQC->getSrc();
+    auto *filter = CQC->getFilter();
+    auto *bias = CQC->getBias();
+    auto *filterOffsets = CQC->getOffsets();
+
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+    auto *filterOffsetsPtr = emitValueAddress(builder, filterOffsets);
+    auto *biasPrePtr = emitConstArray(builder, biasPreV, builder.getInt32Ty());
+    auto *biasPostPtr =
+        emitConstArray(builder, biasPostV, builder.getInt32Ty());
+    auto *biasScalePtr =
+        emitConstArray(builder, biasScaleV, builder.getInt32Ty());
+    auto *outputPrePtr =
+        emitConstArray(builder, outputPreV, builder.getInt32Ty());
+    auto *outputPostPtr =
+        emitConstArray(builder, outputPostV, builder.getInt32Ty());
+    auto *outputScalePtr =
+        emitConstArray(builder, outputScaleV, builder.getInt32Ty());
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernels = emitConstSizeTArray(builder, CQC->getKernels());
+    auto *strides = emitConstSizeTArray(builder, CQC->getStrides());
+    auto *pads = emitConstSizeTArray(builder, CQC->getPads());
+    auto *group = emitConstSizeT(builder, CQC->getGroup());
+
+    auto *destOffset = emitConstI32(builder, dest->getType()->getOffset());
+    auto *srcOffset = emitConstI32(builder, src->getType()->getOffset());
+    auto *biasOffset = emitConstI32(builder, bOffset);
+
+    // Block the convolution on the output depth dimension in the same way as
+    // the regular convolution does.
+    unsigned unrollDFactor = 1;
+    if (((dest->dims()[3] / CQC->getGroup()) % 8) == 0) {
+      unrollDFactor = 8;
+    }
+    auto *unrollD = emitConstI32(builder, unrollDFactor);
+
+    auto *F = getFunction("channelwise_quantized_conv", dest->getElementType());
+
+    createCall(builder, F,
+               {destPtr, srcPtr, filterPtr, biasPtr, filterOffsetsPtr,
+                biasPrePtr, biasPostPtr, biasScalePtr, outputPrePtr,
+                outputPostPtr, outputScalePtr, destDims, srcDims, filterDims,
+                biasDims, kernels, strides, pads, group, destOffset, srcOffset,
+                biasOffset, unrollD});
+    break;
+  }
+
   case Kinded::Kind::ConvolutionGradInstKind: {
     auto *CG = cast<ConvolutionGradInst>(I);
     auto *srcGrad = CG->getSrcGrad();
@@ -1762,6 +1963,30 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     break;
   }
 
+  case Kinded::Kind::SparseLengthsShardInstKind: {
+    auto *SLS = cast<SparseLengthsShardInst>(I);
+    auto *shardWeights = SLS->getShardWeights();
+    auto *weights = SLS->getWeights();
+    auto *lengths = SLS->getLengths();
+    auto *shardWeightsPtr = emitValueAddress(builder, shardWeights);
+    auto *shardIndicesPtr = emitValueAddress(builder, SLS->getShardIndices());
+    auto *shardLengthsPtr = emitValueAddress(builder, SLS->getShardLengths());
+    auto *weightsPtr = emitValueAddress(builder, weights);
+    auto *indicesPtr = emitValueAddress(builder, SLS->getIndices());
+    auto *lengthsPtr = emitValueAddress(builder, lengths);
+    auto *numIndices = emitConstSizeT(builder, weights->size());
+    auto *segments = emitConstSizeT(builder, lengths->dims()[0]);
+    auto *numShards = emitConstSizeT(builder, SLS->getNumShards());
+    auto *shard = emitConstSizeT(builder, SLS->getShard());
+    auto *F =
+        getFunction("sparse_lengths_shard", shardWeights->getElementType());
+    createCall(builder, F,
+               {shardWeightsPtr, shardIndicesPtr, shardLengthsPtr, weightsPtr,
+                indicesPtr, lengthsPtr, numIndices, segments, numShards,
+                shard});
+    break;
+  }
+
   case Kinded::Kind::LengthsSumInstKind: {
     auto *LS = cast<LengthsSumInst>(I);
     auto *dest = LS->getDest();
@@ -1808,6 +2033,72 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     break;
   }
 
+  case Kinded::Kind::SGDInstKind: {
+    auto *SGD = cast<SGDInst>(I);
+    auto *dest = SGD->getDest();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *weightPtr = emitValueAddress(builder, SGD->getWeight());
+    auto *gradientPtr = emitValueAddress(builder, SGD->getGradient());
+    auto *size = emitConstSizeT(builder, dest->getType()->size());
+    auto *L1Decay = emitConstF32(builder, SGD->getL1Decay());
+    auto *L2Decay = emitConstF32(builder, SGD->getL2Decay());
+    auto *learningRate = emitConstF32(builder, SGD->getLearningRate());
+    auto *batchSize = emitConstSizeT(builder, SGD->getBatchSize());
+
+    auto *F = getFunction("sgd", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, weightPtr, gradientPtr, size, L1Decay, L2Decay,
+                learningRate, batchSize});
+    break;
+  }
+
+  case Kinded::Kind::MomentumSGDInstKind: {
+    auto *SGD = cast<MomentumSGDInst>(I);
+    auto *dest = SGD->getDest();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *weightPtr = emitValueAddress(builder, SGD->getWeight());
+    auto *gradientPtr = emitValueAddress(builder, SGD->getGradient());
+    auto *gsumPtr = emitValueAddress(builder, SGD->getGsum());
+    auto *size = emitConstSizeT(builder, dest->getType()->size());
+    auto *L1Decay = emitConstF32(builder, SGD->getL1Decay());
+    auto *L2Decay = emitConstF32(builder, SGD->getL2Decay());
+    auto *learningRate = emitConstF32(builder, SGD->getLearningRate());
+    auto *momentum = emitConstF32(builder, SGD->getMomentum());
+    auto *batchSize = emitConstSizeT(builder, SGD->getBatchSize());
+
+    auto *F = getFunction("momentum_sgd", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, weightPtr, gradientPtr, gsumPtr, size, L1Decay,
+                L2Decay, learningRate, momentum, batchSize});
+    break;
+  }
+
+  case Kinded::Kind::AdamInstKind: {
+    auto *A = cast<AdamInst>(I);
+    auto *dest = A->getDest();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *weightPtr = emitValueAddress(builder, A->getWeight());
+    auto *gradientPtr = emitValueAddress(builder, A->getGradient());
+    auto *MPtr = emitValueAddress(builder, A->getM());
+    auto *VPtr = emitValueAddress(builder, A->getV());
+    auto *stepPtr = emitValueAddress(builder, A->getStep());
+    auto *size = emitConstSizeT(builder, dest->getType()->size());
+    auto *L1Decay = emitConstF32(builder, A->getL1Decay());
+    auto *L2Decay = emitConstF32(builder, A->getL2Decay());
+    auto *learningRate = emitConstF32(builder, A->getLearningRate());
+    auto *beta1 = emitConstF32(builder, A->getBeta1());
+    auto *beta2 = emitConstF32(builder, A->getBeta2());
+    auto *epsilon = emitConstF32(builder, A->getEpsilon());
+    auto *batchSize = emitConstSizeT(builder, A->getBatchSize());
+
+    auto *F = getFunction("adam", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, weightPtr, gradientPtr, MPtr, VPtr, stepPtr, size,
+                L1Decay, L2Decay, learningRate, beta1, beta2, epsilon,
+                batchSize});
+    break;
+  }
+
   case Kinded::Kind::LocalResponseNormalizationGradInstKind: {
     auto *LRNG = llvm::cast<LocalResponseNormalizationGradInst>(I);
     auto *srcGrad = LRNG->getSrcGrad();
@@ -2261,7 +2552,11 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     auto *segments = emitConstSizeT(builder, lengths->dims()[0]);
     auto *inLineSize = emitConstSizeT(builder, data->size() / data->dims()[0]);
     auto *outLineSize = emitConstSizeT(builder, dest->size() / dest->dims()[0]);
-    auto *F = getFunction("fused_rowwise_quantized_sparse_lengths_weighted_sum",
+    auto *F = getFunction(data->getElementType() == ElemKind::UInt4FusedQTy
+                              ? "fused_4bit_rowwise_quantized_sparse_lengths_"
+                                "weighted_sum"
+                              : "fused_rowwise_quantized_sparse_lengths_"
+                                "weighted_sum",
                           dest->getElementType());
     createCall(builder, F,
                {destPtr, dataPtr, weightsPtr, indicesPtr, lengthsPtr, segments,
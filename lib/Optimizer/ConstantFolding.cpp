@@ -0,0 +1,181 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Backends/Backend.h"
+#include "glow/Backends/ExecutionContext.h"
+#include "glow/Graph/Graph.h"
+#include "glow/Graph/Node.h"
+#include "glow/Graph/Nodes.h"
+#include "glow/Graph/PlaceholderBindings.h"
+#include "glow/Graph/Utils.h"
+#include "glow/Optimizer/Optimizer.h"
+
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern llvm::cl::OptionCategory graphOptCat;
+
+llvm::cl::opt<unsigned> constFoldMaxSizeOpt(
+    "const_fold_max_size",
+    llvm::cl::desc("Max number of elements of the Constants created by "
+                   "constant folding. 0 disables constant folding"),
+    llvm::cl::Optional, llvm::cl::init(1 << 20), llvm::cl::cat(graphOptCat));
+
+using namespace glow;
+using llvm::dyn_cast;
+using llvm::isa;
+
+/// \returns true if \p N can be evaluated at compile time by the backend \p B,
+/// given that the nodes in \p foldable are evaluated at compile time. None of
+/// the results of \p N may have more than \p maxSize elements.
+static bool canFold(const Node *N, const Backend &B, size_t maxSize,
+                    const std::unordered_set<const Node *> &foldable) {
+  // Splats are cheap and many optimizations look for them, so they are only
+  // folded into the nodes that use them.
+  if (isa<SplatNode>(N) || N->hasSideEffects() || N->hasPredicate() ||
+      N->getNumResults() == 0) {
+    return false;
+  }
+  for (unsigned r = 0, e = N->getNumResults(); r < e; r++) {
+    if (N->getType(r)->size() > maxSize) {
+      return false;
+    }
+  }
+  for (unsigned i = 0, e = N->getNumInputs(); i < e; i++) {
+    const Node *input = N->getNthInput(i).getNode();
+    if (N->isOverwrittenNthInput(i)) {
+      return false;
+    }
+    if (!isa<Constant>(input) && !isa<SplatNode>(input) &&
+        !foldable.count(input)) {
+      return false;
+    }
+  }
+  return B.isOpSupported(NodeInfo(*N));
+}
+
+bool glow::constantFold(Function *F, const Backend &B) {
+  size_t maxSize = constFoldMaxSizeOpt;
+  if (maxSize == 0) {
+    return false;
+  }
+
+  // Find the nodes whose results only depend on Constants and Splats, in
+  // post order.
+  std::unordered_set<const Node *> foldable;
+  std::vector<Node *> foldOrder;
+  GraphPostOrderVisitor visitor(*F);
+  for (auto *N : visitor.getPostOrder()) {
+    if (isa<Storage>(N) || !canFold(N, B, maxSize, foldable)) {
+      continue;
+    }
+    foldable.insert(N);
+    foldOrder.push_back(N);
+  }
+
+  // Only the results that are used by nodes that are not folded need to be
+  // computed and turned into Constants.
+  std::vector<NodeValue> results;
+  for (auto *N : foldOrder) {
+    for (unsigned r = 0, e = N->getNumResults(); r < e; r++) {
+      NodeValue result(N, r);
+      for (auto &use : result.getUsers()) {
+        if (!foldable.count(use.getUser())) {
+          results.push_back(result);
+          break;
+        }
+      }
+    }
+  }
+  if (results.empty()) {
+    return false;
+  }
+
+  // Copy the folded nodes into a function of a separate module, together with
+  // the Constants and Splats they use. The copies use the types of the new
+  // module.
+  Module mod;
+  Function *foldF = mod.createFunction("constant_folding");
+  std::unordered_map<const Node *, Node *> copies;
+  auto getCopy = [&](NodeValue V) -> NodeValue {
+    Node *N = V.getNode();
+    auto it = copies.find(N);
+    if (it != copies.end()) {
+      return NodeValue(it->second, V.getResNo());
+    }
+    Node *copy;
+    if (auto *C = dyn_cast<Constant>(N)) {
+      copy = mod.createConstant(C->getName(), C->getPayload());
+    } else {
+      assert(isa<SplatNode>(N) && "Only Splats have no folded copy");
+      copy = foldF->addNode(N->clone());
+      copy->setType(0, mod.uniqueType(*N->getType(0)));
+    }
+    copies[N] = copy;
+    return NodeValue(copy, V.getResNo());
+  };
+  for (auto *N : foldOrder) {
+    Node *copy = N->clone();
+    for (unsigned r = 0, e = N->getNumResults(); r < e; r++) {
+      copy->setType(r, mod.uniqueType(*N->getType(r)));
+    }
+    for (unsigned i = 0, e = N->getNumInputs(); i < e; i++) {
+      copy->setNthInput(i, getCopy(N->getNthInput(i)));
+    }
+    copies[N] = foldF->addNode(copy);
+  }
+
+  ExecutionContext context;
+  auto *bindings = context.getPlaceholderBindings();
+  std::vector<Placeholder *> outputs;
+  for (auto &result : results) {
+    auto *save = foldF->createSave(result.getNode()->getName(),
+                                   getCopy(result));
+    bindings->allocate(save->getPlaceholder());
+    outputs.push_back(save->getPlaceholder());
+  }
+
+  // Lowering may create nodes that the backend does not support. Leave the
+  // function unchanged in that case.
+  ::glow::lower(foldF, /* loweredMap */ nullptr, &B);
+  for (auto &N : foldF->getNodes()) {
+    if (!B.isOpSupported(NodeInfo(N))) {
+      return false;
+    }
+  }
+
+  CompilationOptions opts;
+  auto function = B.compile(foldF, opts);
+  function->setupRuns();
+  function->beforeRun(*bindings);
+  function->execute(&context);
+  function->afterRun(*bindings);
+  function->tearDownRuns();
+
+  // Replace the folded results by Constants.
+  Module *M = F->getParent();
+  for (size_t i = 0, e = results.size(); i < e; i++) {
+    auto *C = M->createConstant(results[i].getNode()->getName(),
+                                *bindings->get(outputs[i]));
+    results[i].replaceAllUsesOfWith(C, F);
+  }
+  DCE(F);
+  return true;
+}
@@ -25,8 +25,11 @@
 
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -37,12 +40,80 @@ llvm::cl::opt<unsigned> constDedupSizeOpt(
     llvm::cl::desc(
         "Max number of elements allowed for deduplicating Constants"),
     llvm::cl::Optional, llvm::cl::init(256), llvm::cl::cat(graphOptCat));
+llvm::cl::opt<bool> timeGraphOptsOpt(
+    "time_graph_opts",
+    llvm::cl::desc("Print the time spent in every graph optimization pass"),
+    llvm::cl::Optional, llvm::cl::init(false), llvm::cl::cat(graphOptCat));
 
 using namespace glow;
 using llvm::cast;
 using llvm::dyn_cast;
 using llvm::isa;
 
+namespace {
+/// Accumulates the time spent in every graph optimization pass over the
+/// optimizer runs on one Function, for -time_graph_opts.
+class GraphOptTimers {
+  struct PassTime {
+    std::string name;
+    double seconds;
+    unsigned runs;
+  };
+  /// The passes in the order in which they first ran.
+  std::vector<PassTime> passes_;
+
+public:
+  /// Run \p pass, and add the time it takes to the time of the pass \p name.
+  template <typename PassFn> void run(llvm::StringRef name, PassFn pass) {
+    if (!timeGraphOptsOpt) {
+      pass();
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pass();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    auto it = std::find_if(passes_.begin(), passes_.end(),
+                           [&](const PassTime &P) { return P.name == name; });
+    if (it == passes_.end()) {
+      passes_.push_back({name.str(), 0, 0});
+      it = std::prev(passes_.end());
+    }
+    it->seconds += elapsed.count();
+    it->runs++;
+  }
+
+  /// Print the times of the passes that ran on \p F, the slowest first.
+  void print(const Function *F) const {
+    if (!timeGraphOptsOpt) {
+      return;
+    }
+    auto passes = passes_;
+    std::stable_sort(passes.begin(), passes.end(),
+                     [](const PassTime &A, const PassTime &B) {
+                       return A.seconds > B.seconds;
+                     });
+    double total = 0;
+    for (auto &P : passes) {
+      total += P.seconds;
+    }
+    // Print the whole table at once, so that the tables of Functions that are
+    // optimized on different threads don't interleave.
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    os << "Graph optimization time of " << F->getName() << " ("
+       << F->getNodes().size() << " nodes): "
+       << llvm::format("%.3f", total * 1e3) << " ms\n";
+    os << "   Time (ms)   Runs  Pass\n";
+    for (auto &P : passes) {
+      os << llvm::format("%12.3f %6u  ", P.seconds * 1e3, P.runs) << P.name
+         << "\n";
+    }
+    llvm::outs() << os.str();
+  }
+};
+} // namespace
+
 static bool shouldDeleteNode(Node *N) {
   // In general, nodes who have side effects are retained.
   if (N->hasSideEffects()) {
@@ -58,34 +129,42 @@ static bool shouldDeleteNode(Node *N) {
 }
 
 void glow::DCE(Function *F) {
-  auto &nodes = F->getNodes();
   auto &consts = F->getParent()->getConstants();
 
   std::vector<ConstList::iterator> erasedConsts{};
-  std::vector<NodesList::iterator> erasedNodes{};
-
-  // Remove unused nodes.
-  while (true) {
-    bool changedLocally = false;
-    for (auto it = nodes.begin(), e = nodes.end(); it != e;) {
-      if (!shouldDeleteNode(&*it)) {
-        ++it;
-        continue;
-      }
 
-      erasedNodes.push_back(it);
-      ++it;
-      changedLocally = true;
+  // Remove unused nodes. Erasing a node can only make its operands unused, so
+  // only those are revisited.
+  std::vector<Node *> worklist;
+  for (auto &N : F->getNodes()) {
+    if (shouldDeleteNode(&N)) {
+      worklist.push_back(&N);
     }
+  }
+  while (!worklist.empty()) {
+    Node *N = worklist.back();
+    worklist.pop_back();
 
-    while (!erasedNodes.empty()) {
-      auto it = erasedNodes.back();
-      F->eraseNode(it);
-      erasedNodes.pop_back();
+    llvm::SmallVector<Node *, 8> operands;
+    auto addOperand = [&](NodeValue op) {
+      if (!isa<Storage>(op.getNode()) &&
+          std::find(operands.begin(), operands.end(), op.getNode()) ==
+              operands.end()) {
+        operands.push_back(op.getNode());
+      }
+    };
+    for (unsigned i = 0, e = N->getNumInputs(); i < e; i++) {
+      addOperand(N->getNthInput(i));
+    }
+    if (N->hasPredicate()) {
+      addOperand(N->getPredicate());
     }
+    F->eraseNode(N->getIterator());
 
-    if (!changedLocally) {
-      break;
+    for (auto *op : operands) {
+      if (shouldDeleteNode(op)) {
+        worklist.push_back(op);
+      }
     }
   }
 
@@ -106,6 +185,47 @@ void glow::DCE(Function *F) {
   }
 }
 
+/// Apply \p rewrite to every node of \p F until it doesn't change any node.
+/// Instead of sweeping over the whole function again after a change, only the
+/// users of the nodes that the change created are revisited. The new nodes
+/// themselves are appended to the node list, so the sweep reaches them.
+/// Nodes without users are skipped, because they are going to be removed by
+/// DCE.
+/// \returns true if \p F was changed.
+static bool rewriteUntilFixpoint(Function *F,
+                                 bool (*rewrite)(Function *, Node *)) {
+  auto &nodes = F->getNodes();
+  std::vector<Node *> worklist;
+  bool changed = false;
+  auto visit = [&](Node *N) {
+    if (!N->hasUsers() && !N->hasSideEffects()) {
+      return;
+    }
+    // New nodes are appended to the end of the node list.
+    Node *last = &nodes.back();
+    if (!rewrite(F, N)) {
+      return;
+    }
+    changed = true;
+    for (auto it = std::next(last->getIterator()), e = nodes.end(); it != e;
+         ++it) {
+      for (auto &use : it->getUsers()) {
+        worklist.push_back(use.getUser());
+      }
+    }
+  };
+
+  for (auto &N : nodes) {
+    visit(&N);
+  }
+  while (!worklist.empty()) {
+    Node *N = worklist.back();
+    worklist.pop_back();
+    visit(N);
+  }
+  return changed;
+}
+
 /// \returns true if the \p shuffle corresponds to an identity operation, false
 /// otherwise.
 static bool isIdentityShuffle(llvm::ArrayRef<unsigned> shuffle) {
@@ -209,217 +329,213 @@ static bool sinkTranposeBelowChannelShuffle(Function *F,
   return true;
 }
 
-/// Code Sinking.
+/// Code Sinking of the \p node of \p F.
 /// \returns true if code sinking was successful.
-static bool sinkCode(Function *F) {
-  auto &nodes = F->getNodes();
+static bool sinkCodeAt(Function *F, Node *node) {
   bool changed = false;
-  // For each node:
-  for (auto &N : nodes) {
-    auto *node = &N;
-    // Sink Transpose below batch normalization nodes:
-    if (auto *BN = dyn_cast<BatchNormalizationNode>(node)) {
-      auto *TR = dyn_cast<TransposeNode>(BN->getInput());
+  // Sink Transpose below batch normalization nodes:
+  if (auto *BN = dyn_cast<BatchNormalizationNode>(node)) {
+    auto *TR = dyn_cast<TransposeNode>(BN->getInput());
 
-      if (!TR) {
-        continue;
-      }
-
-      // Figure out where we transposed the channel index for batch
-      // normalization.
-      unsigned_t idx = BN->getChannelIdx();
-      unsigned_t newChannelIdx = TR->getShuffle()[idx];
-
-      auto *NewBN = F->createBatchNormalization(
-          BN->getName(), TR->getInput(), BN->getBias(), BN->getScale(),
-          BN->getMean(), BN->getVar(), newChannelIdx, BN->getEpsilon(),
-          BN->getMomentum());
-      NewBN->setPredicate(node->getPredicate());
-      auto *newTR = F->createTranspose(TR->getName(), NewBN, TR->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-
-      BN->getResult().replaceAllUsesOfWith(newTR);
-      changed = true;
-      continue;
+    if (!TR) {
+      return changed;
     }
 
-    // Sink Transpose below batch RELU nodes.
-    if (auto *RL = dyn_cast<ReluNode>(node)) {
-      auto *TR = dyn_cast<TransposeNode>(RL->getInput());
+    // Figure out where we transposed the channel index for batch
+    // normalization.
+    unsigned_t idx = BN->getChannelIdx();
+    unsigned_t newChannelIdx = TR->getShuffle()[idx];
 
-      if (!TR) {
-        continue;
-      }
+    auto *NewBN = F->createBatchNormalization(
+        BN->getName(), TR->getInput(), BN->getBias(), BN->getScale(),
+        BN->getMean(), BN->getVar(), newChannelIdx, BN->getEpsilon(),
+        BN->getMomentum());
+    NewBN->setPredicate(node->getPredicate());
+    auto *newTR = F->createTranspose(TR->getName(), NewBN, TR->getShuffle());
+    newTR->setPredicate(node->getPredicate());
 
-      // Keep the same quantization parameters for ReLU output, but
-      // change the shape to appropriate value.
-      auto reluOutTy = F->getParent()->uniqueTypeWithNewShape(
-          RL->getResult().getType(), TR->getInput().dims());
-      auto *NRL = F->createRELU(RL->getName(), TR->getInput(), reluOutTy);
-      NRL->setPredicate(node->getPredicate());
-      auto *newTR = F->createTranspose(TR->getName(), NRL, TR->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-      RL->getResult().replaceAllUsesOfWith(newTR);
-      changed = true;
-      continue;
-    }
+    BN->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+    return changed;
+  }
 
-    // Sink Transpose below Sigmoid nodes.
-    if (auto *SI = dyn_cast<SigmoidNode>(node)) {
-      auto *TR = dyn_cast<TransposeNode>(SI->getInput());
+  // Sink Transpose below batch RELU nodes.
+  if (auto *RL = dyn_cast<ReluNode>(node)) {
+    auto *TR = dyn_cast<TransposeNode>(RL->getInput());
 
-      if (!TR) {
-        continue;
-      }
+    if (!TR) {
+      return changed;
+    }
+
+    // Keep the same quantization parameters for ReLU output, but
+    // change the shape to appropriate value.
+    auto reluOutTy = F->getParent()->uniqueTypeWithNewShape(
+        RL->getResult().getType(), TR->getInput().dims());
+    auto *NRL = F->createRELU(RL->getName(), TR->getInput(), reluOutTy);
+    NRL->setPredicate(node->getPredicate());
+    auto *newTR = F->createTranspose(TR->getName(), NRL, TR->getShuffle());
+    newTR->setPredicate(node->getPredicate());
+    RL->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+    return changed;
+  }
 
-      auto *NSI = F->createSigmoid(SI->getName(), TR->getInput());
-      NSI->setPredicate(node->getPredicate());
-      auto *newTR = F->createTranspose(TR->getName(), NSI, TR->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-      SI->getResult().replaceAllUsesOfWith(newTR);
-      changed = true;
-      continue;
-    }
+  // Sink Transpose below Sigmoid nodes.
+  if (auto *SI = dyn_cast<SigmoidNode>(node)) {
+    auto *TR = dyn_cast<TransposeNode>(SI->getInput());
 
-    // Sink Transpose below Pad nodes.
-    if (auto *padNode = dyn_cast<PadNode>(node)) {
-      auto *transposeNode = dyn_cast<TransposeNode>(padNode->getInput());
+    if (!TR) {
+      return changed;
+    }
 
-      if (!transposeNode) {
-        continue;
-      }
+    auto *NSI = F->createSigmoid(SI->getName(), TR->getInput());
+    NSI->setPredicate(node->getPredicate());
+    auto *newTR = F->createTranspose(TR->getName(), NSI, TR->getShuffle());
+    newTR->setPredicate(node->getPredicate());
+    SI->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+    return changed;
+  }
+
+  // Sink Transpose below Pad nodes.
+  if (auto *padNode = dyn_cast<PadNode>(node)) {
+    auto *transposeNode = dyn_cast<TransposeNode>(padNode->getInput());
+
+    if (!transposeNode) {
+      return changed;
+    }
+
+    // The transpose shuffle specifies the source dimension.
+    // When sinking Transpose below Pad, shuffle describes the target
+    // dimension.
+    auto shuffle = transposeNode->getShuffle();
+
+    // Shuffle the Pad output type and the padding attribute.
+    auto outPadType = padNode->getResult().getType();
+    auto outPadShape = outPadType->dims();
+    auto pads = padNode->getPads();
+    size_t numDims = outPadShape.size();
+    std::vector<size_t> newOutPadShape(numDims);
+    std::vector<int> newPads(2 * numDims);
+    for (size_t i = 0; i < outPadShape.size(); i++) {
+      newOutPadShape[shuffle[i]] = outPadShape[i];
+      newPads[shuffle[i]] = pads[i];
+      newPads[shuffle[i] + numDims] = pads[i + numDims];
+    }
+
+    // New pad
+    auto newOutPadType =
+        F->getParent()->uniqueTypeWithNewShape(outPadType, newOutPadShape);
+    auto *NewPadNode = F->createPad(
+        padNode->getName(), transposeNode->getInput(), newOutPadType,
+        padNode->getMode(), newPads, padNode->getValue());
+    NewPadNode->setPredicate(node->getPredicate());
+    auto *newTransposeNode =
+        F->createTranspose(transposeNode->getName(), NewPadNode, shuffle);
+    newTransposeNode->setPredicate(node->getPredicate());
+    padNode->getResult().replaceAllUsesOfWith(newTransposeNode);
+    changed = true;
+    return changed;
+  }
 
-      // The transpose shuffle specifies the source dimension.
-      // When sinking Transpose below Pad, shuffle describes the target
-      // dimension.
-      auto shuffle = transposeNode->getShuffle();
-
-      // Shuffle the Pad output type and the padding attribute.
-      auto outPadType = padNode->getResult().getType();
-      auto outPadShape = outPadType->dims();
-      auto pads = padNode->getPads();
-      size_t numDims = outPadShape.size();
-      std::vector<size_t> newOutPadShape(numDims);
-      std::vector<int> newPads(2 * numDims);
-      for (size_t i = 0; i < outPadShape.size(); i++) {
-        newOutPadShape[shuffle[i]] = outPadShape[i];
-        newPads[shuffle[i]] = pads[i];
-        newPads[shuffle[i] + numDims] = pads[i + numDims];
-      }
+  // Sink Transpose below Tanh nodes.
+  if (auto *TN = dyn_cast<TanhNode>(node)) {
+    auto *TR = dyn_cast<TransposeNode>(TN->getInput());
 
-      // New pad
-      auto newOutPadType =
-          F->getParent()->uniqueTypeWithNewShape(outPadType, newOutPadShape);
-      auto *NewPadNode = F->createPad(
-          padNode->getName(), transposeNode->getInput(), newOutPadType,
-          padNode->getMode(), newPads, padNode->getValue());
-      NewPadNode->setPredicate(node->getPredicate());
-      auto *newTransposeNode =
-          F->createTranspose(transposeNode->getName(), NewPadNode, shuffle);
-      newTransposeNode->setPredicate(node->getPredicate());
-      padNode->getResult().replaceAllUsesOfWith(newTransposeNode);
-      changed = true;
-      continue;
+    if (!TR) {
+      return changed;
     }
 
-    // Sink Transpose below Tanh nodes.
-    if (auto *TN = dyn_cast<TanhNode>(node)) {
-      auto *TR = dyn_cast<TransposeNode>(TN->getInput());
+    auto *NTN = F->createTanh(TN->getName(), TR->getInput());
+    NTN->setPredicate(node->getPredicate());
+    auto *newTR = F->createTranspose(TR->getName(), NTN, TR->getShuffle());
+    newTR->setPredicate(node->getPredicate());
+    TN->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+    return changed;
+  }
 
-      if (!TR) {
-        continue;
-      }
+  // Remove 'identity' transpose operations.
+  if (auto *TR = dyn_cast<TransposeNode>(node)) {
+    auto mask = TR->getShuffle();
 
-      auto *NTN = F->createTanh(TN->getName(), TR->getInput());
-      NTN->setPredicate(node->getPredicate());
-      auto *newTR = F->createTranspose(TR->getName(), NTN, TR->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-      TN->getResult().replaceAllUsesOfWith(newTR);
+    if (isIdentityShuffle(mask)) {
+      TR->getResult().replaceAllUsesOfWith(TR->getInput());
       changed = true;
-      continue;
+      return changed;
     }
+  }
 
-    // Remove 'identity' transpose operations.
-    if (auto *TR = dyn_cast<TransposeNode>(node)) {
-      auto mask = TR->getShuffle();
+  // Merge consecutive Transpose operations.
+  if (auto *TR1 = dyn_cast<TransposeNode>(node)) {
+    auto *TR2 = dyn_cast<TransposeNode>(TR1->getInput());
 
-      if (isIdentityShuffle(mask)) {
-        TR->getResult().replaceAllUsesOfWith(TR->getInput());
-        changed = true;
-        continue;
-      }
+    if (!TR2) {
+      return changed;
     }
 
-    // Merge consecutive Transpose operations.
-    if (auto *TR1 = dyn_cast<TransposeNode>(node)) {
-      auto *TR2 = dyn_cast<TransposeNode>(TR1->getInput());
-
-      if (!TR2) {
-        continue;
-      }
+    auto mask1 = TR1->getShuffle();
+    auto mask2 = TR2->getShuffle();
+    assert(mask1.size() == mask2.size() && "Invalid mask size");
 
-      auto mask1 = TR1->getShuffle();
-      auto mask2 = TR2->getShuffle();
-      assert(mask1.size() == mask2.size() && "Invalid mask size");
+    llvm::SmallVector<unsigned_t, max_tensor_dimensions> newMask;
+    newMask.resize(mask2.size());
 
-      llvm::SmallVector<unsigned_t, max_tensor_dimensions> newMask;
-      newMask.resize(mask2.size());
+    for (size_t i = 0, end = mask2.size(); i < end; i++) {
+      newMask[i] = mask2[mask1[i]];
+    }
 
-      for (size_t i = 0, end = mask2.size(); i < end; i++) {
-        newMask[i] = mask2[mask1[i]];
-      }
+    auto *newTR = F->createTranspose("tranpose", TR2->getInput(), newMask);
+    TR1->getResult().replaceAllUsesOfWith(newTR->getResult());
+    changed = true;
+    return changed;
+  }
 
-      auto *newTR = F->createTranspose("tranpose", TR2->getInput(), newMask);
-      TR1->getResult().replaceAllUsesOfWith(newTR->getResult());
+  if (auto *CS = dyn_cast<ChannelShuffleNode>(node)) {
+    // Sink Transpose below ChannelShuffle.
+    if (sinkTranposeBelowChannelShuffle(F, CS)) {
       changed = true;
-      continue;
-    }
-
-    if (auto *CS = dyn_cast<ChannelShuffleNode>(node)) {
-      // Sink Transpose below ChannelShuffle.
-      if (sinkTranposeBelowChannelShuffle(F, CS)) {
+      return changed;
+    }
+  }
+
+  // Sink Transpose below Arithmetic nodes.
+  if (node->isArithmetic()) {
+    TransposeNode *LTR =
+        dyn_cast<TransposeNode>(node->getNthInput(ArithmeticNode::LHSIdx));
+    TransposeNode *RTR =
+        dyn_cast<TransposeNode>(node->getNthInput(ArithmeticNode::RHSIdx));
+
+    if (!LTR || !RTR) {
+      // If one of the sides is a splat, it can be seen as
+      // transpose (splat').
+      if (isa<SplatNode>(node->getNthInput(ArithmeticNode::LHSIdx)) && RTR) {
+        // Build splat' for LHS.
+        auto *SN =
+            dyn_cast<SplatNode>(node->getNthInput(ArithmeticNode::LHSIdx));
+        auto *NS = F->createSplat("splat", RTR->getInput().getType(),
+                                  SN->getValue());
+        LTR = F->createTranspose("transpose", NS, RTR->getShuffle());
         changed = true;
-        continue;
+      } else if (isa<SplatNode>(node->getNthInput(ArithmeticNode::RHSIdx)) &&
+                 LTR) {
+        // Build splat' for RHS.
+        auto *SN =
+            dyn_cast<SplatNode>(node->getNthInput(ArithmeticNode::RHSIdx));
+        auto *NS = F->createSplat("splat", LTR->getInput().getType(),
+                                  SN->getValue());
+        RTR = F->createTranspose("transpose", NS, LTR->getShuffle());
+        changed = true;
+      } else {
+        return changed;
       }
     }
+    // The masks of the transposes on both sizes must match.
+    if (LTR->getShuffle() != RTR->getShuffle()) {
+      return changed;
+    }
 
-    // Sink Transpose below Arithmetic nodes.
-    if (node->isArithmetic()) {
-      TransposeNode *LTR =
-          dyn_cast<TransposeNode>(node->getNthInput(ArithmeticNode::LHSIdx));
-      TransposeNode *RTR =
-          dyn_cast<TransposeNode>(node->getNthInput(ArithmeticNode::RHSIdx));
-
-      if (!LTR || !RTR) {
-        // If one of the sides is a splat, it can be seen as
-        // transpose (splat').
-        if (isa<SplatNode>(node->getNthInput(ArithmeticNode::LHSIdx)) && RTR) {
-          // Build splat' for LHS.
-          auto *SN =
-              dyn_cast<SplatNode>(node->getNthInput(ArithmeticNode::LHSIdx));
-          auto *NS = F->createSplat("splat", RTR->getInput().getType(),
-                                    SN->getValue());
-          LTR = F->createTranspose("transpose", NS, RTR->getShuffle());
-          changed = true;
-        } else if (isa<SplatNode>(node->getNthInput(ArithmeticNode::RHSIdx)) &&
-                   LTR) {
-          // Build splat' for RHS.
-          auto *SN =
-              dyn_cast<SplatNode>(node->getNthInput(ArithmeticNode::RHSIdx));
-          auto *NS = F->createSplat("splat", LTR->getInput().getType(),
-                                    SN->getValue());
-          RTR = F->createTranspose("transpose", NS, LTR->getShuffle());
-          changed = true;
-        } else {
-          continue;
-        }
-      }
-      // The masks of the transposes on both sizes must match.
-      if (LTR->getShuffle() != RTR->getShuffle()) {
-        continue;
-      }
-
-      Node *newAN = nullptr;
+    Node *newAN = nullptr;
 
 #define ARITHMETIC_CASE(NODE_NAME_)                                            \
   case glow::Kinded::Kind::NODE_NAME_##NodeKind:                               \
@@ -437,108 +553,106 @@ static bool sinkCode(Function *F) {
                                   RTR->getInput());                            \
     break;
 
-      switch (node->getKind()) {
-        ARITHMETIC_CASE(Add);
-        ARITHMETIC_CASE(Mul);
-        ARITHMETIC_CASE(Sub);
-        ARITHMETIC_CASE(Div);
-        ARITHMETIC_CASE(Max);
-        ARITHMETIC_CASE(Min);
-        BOOLEAN_OP_CASE(CmpLTE);
-        BOOLEAN_OP_CASE(CmpEQ);
-      default:
-        llvm_unreachable("Unhandled node");
-      }
+    switch (node->getKind()) {
+      ARITHMETIC_CASE(Add);
+      ARITHMETIC_CASE(Mul);
+      ARITHMETIC_CASE(Sub);
+      ARITHMETIC_CASE(Div);
+      ARITHMETIC_CASE(Max);
+      ARITHMETIC_CASE(Min);
+      BOOLEAN_OP_CASE(CmpLTE);
+      BOOLEAN_OP_CASE(CmpEQ);
+    default:
+      llvm_unreachable("Unhandled node");
+    }
 #undef BOOLEAN_OP_CASE
 #undef ARITHMETIC_CASE
 
-      newAN->setPredicate(node->getPredicate());
-      changed = true;
-      auto *newTR =
-          F->createTranspose(LTR->getName(), newAN, LTR->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-      node->getNthResult(ArithmeticNode::ResultIdx).replaceAllUsesOfWith(newTR);
-    }
-
-    // Sink Transpose below RescaleQuantized.
-    // Potentially exposes opportunity to be combined up with Convolution.
-    // If it doesn't work out it will be re-sinked later.
-    if (auto *RQ = dyn_cast<RescaleQuantizedNode>(node)) {
-      auto *TR = dyn_cast<TransposeNode>(RQ->getInput());
-      if (!TR) {
-        continue;
-      }
+    newAN->setPredicate(node->getPredicate());
+    changed = true;
+    auto *newTR = F->createTranspose(LTR->getName(), newAN, LTR->getShuffle());
+    newTR->setPredicate(node->getPredicate());
+    node->getNthResult(ArithmeticNode::ResultIdx).replaceAllUsesOfWith(newTR);
+  }
 
-      auto newRQType = F->getParent()->uniqueTypeWithNewShape(
-          RQ->getResult().getType(), TR->getInput().getType()->dims());
-      auto *newRQ =
-          F->createRescaleQuantized(RQ->getName(), TR->getInput(), newRQType);
-      auto *newTR = F->createTranspose(TR->getName(), newRQ, TR->getShuffle());
-      RQ->getResult().replaceAllUsesOfWith(newTR);
-      changed = true;
+  // Sink Transpose below RescaleQuantized.
+  // Potentially exposes opportunity to be combined up with Convolution.
+  // If it doesn't work out it will be re-sinked later.
+  if (auto *RQ = dyn_cast<RescaleQuantizedNode>(node)) {
+    auto *TR = dyn_cast<TransposeNode>(RQ->getInput());
+    if (!TR) {
+      return changed;
     }
 
-    // Sink RELU below batch concat nodes.
-    if (auto *CN = dyn_cast<ConcatNode>(node)) {
-      llvm::SmallVector<NodeValue, 6> CNInputs;
-      for (auto input : CN->getInputs()) {
-        auto *inputRL = dyn_cast<ReluNode>(input);
-        if (!inputRL) {
-          break;
-        }
-        CNInputs.push_back(inputRL->getInput());
-      }
+    auto newRQType = F->getParent()->uniqueTypeWithNewShape(
+        RQ->getResult().getType(), TR->getInput().getType()->dims());
+    auto *newRQ =
+        F->createRescaleQuantized(RQ->getName(), TR->getInput(), newRQType);
+    auto *newTR = F->createTranspose(TR->getName(), newRQ, TR->getShuffle());
+    RQ->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+  }
 
-      if (CNInputs.size() == CN->getNumInputs()) {
-        auto *newCN = F->createConcat(CN->getName(), CNInputs, CN->getDim());
-        newCN->setPredicate(node->getPredicate());
-        auto name = CN->getNthInput(0).getNode()->getName();
-        auto *newRL = F->createRELU(name, newCN, CN->getResult().getType());
-        newRL->setPredicate(node->getPredicate());
-        CN->getResult().replaceAllUsesOfWith(newRL);
-        changed = true;
+  // Sink RELU below batch concat nodes.
+  if (auto *CN = dyn_cast<ConcatNode>(node)) {
+    llvm::SmallVector<NodeValue, 6> CNInputs;
+    for (auto input : CN->getInputs()) {
+      auto *inputRL = dyn_cast<ReluNode>(input);
+      if (!inputRL) {
+        break;
       }
+      CNInputs.push_back(inputRL->getInput());
     }
 
-    // Sink Transpose below concat nodes.
-    if (auto *CN = dyn_cast<ConcatNode>(node)) {
-      llvm::SmallVector<NodeValue, 6> transVector;
-      auto inputIter = CN->getInputs().begin();
-      auto *firstInput = dyn_cast<TransposeNode>(*inputIter);
-      if (!firstInput) {
-        continue;
-      }
+    if (CNInputs.size() == CN->getNumInputs()) {
+      auto *newCN = F->createConcat(CN->getName(), CNInputs, CN->getDim());
+      newCN->setPredicate(node->getPredicate());
+      auto name = CN->getNthInput(0).getNode()->getName();
+      auto *newRL = F->createRELU(name, newCN, CN->getResult().getType());
+      newRL->setPredicate(node->getPredicate());
+      CN->getResult().replaceAllUsesOfWith(newRL);
+      changed = true;
+    }
+  }
 
-      transVector.push_back(firstInput->getInput());
-      auto shuffle = firstInput->getShuffle();
-      // If the shuffle masks don't agree or not all inputs are Transpose then
-      // bail out.
-      for (++inputIter; inputIter != CN->getInputs().end(); ++inputIter) {
-        auto *tTR = dyn_cast<TransposeNode>(*inputIter);
-        if (!tTR || tTR->getShuffle() != shuffle) {
-          break;
-        }
-        transVector.push_back(tTR->getInput());
-      }
+  // Sink Transpose below concat nodes.
+  if (auto *CN = dyn_cast<ConcatNode>(node)) {
+    llvm::SmallVector<NodeValue, 6> transVector;
+    auto inputIter = CN->getInputs().begin();
+    auto *firstInput = dyn_cast<TransposeNode>(*inputIter);
+    if (!firstInput) {
+      return changed;
+    }
 
-      if (transVector.size() != CN->getNumInputs()) {
-        continue;
+    transVector.push_back(firstInput->getInput());
+    auto shuffle = firstInput->getShuffle();
+    // If the shuffle masks don't agree or not all inputs are Transpose then
+    // bail out.
+    for (++inputIter; inputIter != CN->getInputs().end(); ++inputIter) {
+      auto *tTR = dyn_cast<TransposeNode>(*inputIter);
+      if (!tTR || tTR->getShuffle() != shuffle) {
+        break;
       }
+      transVector.push_back(tTR->getInput());
+    }
 
-      // Figure out where we transposed the channel index for batch
-      // normalization.
-      unsigned_t idx = CN->getDim();
-      unsigned_t newChannelIdx = shuffle[idx];
-
-      auto *newCN = F->createConcat(CN->getName(), transVector, newChannelIdx);
-      newCN->setPredicate(node->getPredicate());
-      auto *newTR = F->createTranspose(firstInput->getName(), newCN,
-                                       firstInput->getShuffle());
-      newTR->setPredicate(node->getPredicate());
-      CN->getResult().replaceAllUsesOfWith(newTR);
-      changed = true;
+    if (transVector.size() != CN->getNumInputs()) {
+      return changed;
     }
-  } // For all nodes in the graph.
+
+    // Figure out where we transposed the channel index for batch
+    // normalization.
+    unsigned_t idx = CN->getDim();
+    unsigned_t newChannelIdx = shuffle[idx];
+
+    auto *newCN = F->createConcat(CN->getName(), transVector, newChannelIdx);
+    newCN->setPredicate(node->getPredicate());
+    auto *newTR = F->createTranspose(firstInput->getName(), newCN,
+                                     firstInput->getShuffle());
+    newTR->setPredicate(node->getPredicate());
+    CN->getResult().replaceAllUsesOfWith(newTR);
+    changed = true;
+  }
 
   return changed;
 }
@@ -2205,158 +2319,157 @@ static bool combineDownRescaleToArithmeticNode(Function &F, T *AN) {
   return changed;
 }
 
-/// Sink Rescale nodes down when possible.
-static bool sinkRescaleQuantizedNode(Function *F) {
+/// Sink Rescale nodes down through \p node of \p F when possible.
+/// \returns true if \p F was changed.
+static bool sinkRescaleQuantizedNodeAt(Function *F, Node *node) {
   bool changed = false;
-  for (auto &node : F->getNodes()) {
-    // Sink Rescale below Reshape node.
-    // Reshape(Rescale(X)) -> Rescale(Reshape(X)).
-    if (auto *reshape = dyn_cast<ReshapeNode>(&node)) {
-      auto *rescale = dyn_cast<RescaleQuantizedNode>(reshape->getInput());
-      if (!rescale) {
-        continue;
-      }
-
-      auto *newReshape = F->createReshape(
-          reshape->getName(), rescale->getInput(), reshape->getResult().dims());
-      auto *newRescale = F->createRescaleQuantized(
-          rescale->getName(), newReshape, reshape->getResult().getType());
-      reshape->getResult().replaceAllUsesOfWith(newRescale);
-
-      changed = true;
-      continue;
+  // Sink Rescale below Reshape node.
+  // Reshape(Rescale(X)) -> Rescale(Reshape(X)).
+  if (auto *reshape = dyn_cast<ReshapeNode>(node)) {
+    auto *rescale = dyn_cast<RescaleQuantizedNode>(reshape->getInput());
+    if (!rescale) {
+      return changed;
     }
 
-    // Sink Rescale below Slice node.
-    // Slice(Rescale(X)) -> Rescale(Slice(X)).
-    if (auto *slice = dyn_cast<SliceNode>(&node)) {
-      auto *rescale = dyn_cast<RescaleQuantizedNode>(slice->getInput());
-      if (!rescale) {
-        continue;
-      }
+    auto *newReshape = F->createReshape(reshape->getName(), rescale->getInput(),
+                                        reshape->getResult().dims());
+    auto *newRescale = F->createRescaleQuantized(
+        rescale->getName(), newReshape, reshape->getResult().getType());
+    reshape->getResult().replaceAllUsesOfWith(newRescale);
 
-      auto sliceOutTy = F->getParent()->uniqueTypeWithNewShape(
-          rescale->getInput().getType(), slice->getResult().dims());
-      auto *newSlice = F->createSlice(slice->getName(), rescale->getInput(),
-                                      slice->getStart(), sliceOutTy);
-      auto *newRescale = F->createRescaleQuantized(
-          rescale->getName(), newSlice, slice->getResult().getType());
-      slice->getResult().replaceAllUsesOfWith(newRescale);
+    changed = true;
+    return changed;
+  }
 
-      changed = true;
-      continue;
+  // Sink Rescale below Slice node.
+  // Slice(Rescale(X)) -> Rescale(Slice(X)).
+  if (auto *slice = dyn_cast<SliceNode>(node)) {
+    auto *rescale = dyn_cast<RescaleQuantizedNode>(slice->getInput());
+    if (!rescale) {
+      return changed;
     }
 
-    // Sink Rescale below Transpose node.
-    // Transpose(Rescale(X)) -> Rescale(Transpose(X)).
-    if (auto *transpose = dyn_cast<TransposeNode>(&node)) {
-      auto *rescale = dyn_cast<RescaleQuantizedNode>(transpose->getInput());
-      if (!rescale) {
-        continue;
-      }
+    auto sliceOutTy = F->getParent()->uniqueTypeWithNewShape(
+        rescale->getInput().getType(), slice->getResult().dims());
+    auto *newSlice = F->createSlice(slice->getName(), rescale->getInput(),
+                                    slice->getStart(), sliceOutTy);
+    auto *newRescale = F->createRescaleQuantized(rescale->getName(), newSlice,
+                                                 slice->getResult().getType());
+    slice->getResult().replaceAllUsesOfWith(newRescale);
 
-      auto *newTranspose = F->createTranspose(
-          transpose->getName(), rescale->getInput(), transpose->getShuffle());
-      auto rescaleOutTy = F->getParent()->uniqueTypeWithNewShape(
-          rescale->getResult().getType(), transpose->getResult().dims());
-      auto *newRescale = F->createRescaleQuantized(rescale->getName(),
-                                                   newTranspose, rescaleOutTy);
-      transpose->getResult().replaceAllUsesOfWith(newRescale);
+    changed = true;
+    return changed;
+  }
 
-      changed = true;
-      continue;
+  // Sink Rescale below Transpose node.
+  // Transpose(Rescale(X)) -> Rescale(Transpose(X)).
+  if (auto *transpose = dyn_cast<TransposeNode>(node)) {
+    auto *rescale = dyn_cast<RescaleQuantizedNode>(transpose->getInput());
+    if (!rescale) {
+      return changed;
     }
 
-    if (auto *PN = dyn_cast<AvgPoolNode>(&node)) {
-      changed |= sinkDownRescaleToPoolingNode<AvgPoolNode>(*F, PN);
-      continue;
-    }
+    auto *newTranspose = F->createTranspose(
+        transpose->getName(), rescale->getInput(), transpose->getShuffle());
+    auto rescaleOutTy = F->getParent()->uniqueTypeWithNewShape(
+        rescale->getResult().getType(), transpose->getResult().dims());
+    auto *newRescale = F->createRescaleQuantized(rescale->getName(),
+                                                 newTranspose, rescaleOutTy);
+    transpose->getResult().replaceAllUsesOfWith(newRescale);
 
-    if (auto *PN = dyn_cast<MaxPoolNode>(&node)) {
-      changed |= sinkDownRescaleToPoolingNode<MaxPoolNode>(*F, PN);
-      continue;
-    }
+    changed = true;
+    return changed;
+  }
 
-    // Combine Rescale down with FullyConnected node.
-    // FullyConnected(Rescale(X)) -> FullyConnected(X).
-    if (auto *FC = dyn_cast<FullyConnectedNode>(&node)) {
-      auto *rescale = dyn_cast<RescaleQuantizedNode>(FC->getInput());
-      if (!rescale) {
-        continue;
-      }
+  if (auto *PN = dyn_cast<AvgPoolNode>(node)) {
+    changed |= sinkDownRescaleToPoolingNode<AvgPoolNode>(*F, PN);
+    return changed;
+  }
 
-      auto *newFC = F->createFullyConnected(FC->getName(), rescale->getInput(),
-                                            FC->getWeights(), FC->getBias(),
-                                            FC->getResult().getType());
-      FC->getResult().replaceAllUsesOfWith(newFC);
+  if (auto *PN = dyn_cast<MaxPoolNode>(node)) {
+    changed |= sinkDownRescaleToPoolingNode<MaxPoolNode>(*F, PN);
+    return changed;
+  }
 
-      changed = true;
-      continue;
+  // Combine Rescale down with FullyConnected node.
+  // FullyConnected(Rescale(X)) -> FullyConnected(X).
+  if (auto *FC = dyn_cast<FullyConnectedNode>(node)) {
+    auto *rescale = dyn_cast<RescaleQuantizedNode>(FC->getInput());
+    if (!rescale) {
+      return changed;
     }
 
-    // Combine Rescale down with Convolution node.
-    // Convolution(Rescale(X), F, B) -> Convolution(X, F, B).
-    // Convolution(X, Rescale(F), B) -> Convolution(X, F, B).
-    // Convolution(X, F, Rescale(B)) -> Convolution(X, F, B).
-    // ... and different combinations.
-    if (auto *CN = dyn_cast<ConvolutionNode>(&node)) {
-      auto *rescaleX = dyn_cast<RescaleQuantizedNode>(CN->getInput());
-      auto *rescaleF = dyn_cast<RescaleQuantizedNode>(CN->getFilter());
-      auto *rescaleB = dyn_cast<RescaleQuantizedNode>(CN->getBias());
-      auto newX = rescaleX ? rescaleX->getInput() : CN->getInput();
-      auto newF = rescaleF ? rescaleF->getInput() : CN->getFilter();
-      auto newB = rescaleB ? rescaleB->getInput() : CN->getBias();
-      if (rescaleX || rescaleF || rescaleB) {
-        auto *newCN = F->createConv(
-            CN->getName(), newX, newF, newB, CN->getResult().getType(),
-            CN->getKernels(), CN->getStrides(), CN->getPads(), CN->getGroup());
-        CN->getResult().replaceAllUsesOfWith(newCN);
-        changed = true;
-      }
-      continue;
-    }
+    auto *newFC = F->createFullyConnected(FC->getName(), rescale->getInput(),
+                                          FC->getWeights(), FC->getBias(),
+                                          FC->getResult().getType());
+    FC->getResult().replaceAllUsesOfWith(newFC);
 
-    if (auto *AN = dyn_cast<AddNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<AddNode>(*F, AN);
-      continue;
-    }
-    if (auto *AN = dyn_cast<SubNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<SubNode>(*F, AN);
-      continue;
-    }
-    if (auto *AN = dyn_cast<MulNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<MulNode>(*F, AN);
-      continue;
-    }
-    if (auto *AN = dyn_cast<DivNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<DivNode>(*F, AN);
-      continue;
-    }
-    if (auto *AN = dyn_cast<MinNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<MinNode>(*F, AN);
-      continue;
-    }
-    if (auto *AN = dyn_cast<MaxNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<MaxNode>(*F, AN);
-      continue;
+    changed = true;
+    return changed;
+  }
+
+  // Combine Rescale down with Convolution node.
+  // Convolution(Rescale(X), F, B) -> Convolution(X, F, B).
+  // Convolution(X, Rescale(F), B) -> Convolution(X, F, B).
+  // Convolution(X, F, Rescale(B)) -> Convolution(X, F, B).
+  // ... and different combinations.
+  if (auto *CN = dyn_cast<ConvolutionNode>(node)) {
+    auto *rescaleX = dyn_cast<RescaleQuantizedNode>(CN->getInput());
+    auto *rescaleF = dyn_cast<RescaleQuantizedNode>(CN->getFilter());
+    auto *rescaleB = dyn_cast<RescaleQuantizedNode>(CN->getBias());
+    auto newX = rescaleX ? rescaleX->getInput() : CN->getInput();
+    auto newF = rescaleF ? rescaleF->getInput() : CN->getFilter();
+    auto newB = rescaleB ? rescaleB->getInput() : CN->getBias();
+    if (rescaleX || rescaleF || rescaleB) {
+      auto *newCN = F->createConv(
+          CN->getName(), newX, newF, newB, CN->getResult().getType(),
+          CN->getKernels(), CN->getStrides(), CN->getPads(), CN->getGroup());
+      CN->getResult().replaceAllUsesOfWith(newCN);
+      changed = true;
     }
+    return changed;
+  }
 
-    // Combine Rescale down with Relu node.
-    //   ReluNode(Rescale(in)) -> ReluNode(in).
-    if (auto *RN = dyn_cast<ReluNode>(&node)) {
-      if (auto *rescale = dyn_cast<RescaleQuantizedNode>(RN->getInput())) {
-        auto *newRN = F->createRELU(RN->getName(), rescale->getInput(),
-                                    RN->getResult().getType());
-        RN->getResult().replaceAllUsesOfWith(newRN);
-        changed = true;
-      }
-      continue;
-    }
+  if (auto *AN = dyn_cast<AddNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<AddNode>(*F, AN);
+    return changed;
+  }
+  if (auto *AN = dyn_cast<SubNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<SubNode>(*F, AN);
+    return changed;
+  }
+  if (auto *AN = dyn_cast<MulNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<MulNode>(*F, AN);
+    return changed;
+  }
+  if (auto *AN = dyn_cast<DivNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<DivNode>(*F, AN);
+    return changed;
+  }
+  if (auto *AN = dyn_cast<MinNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<MinNode>(*F, AN);
+    return changed;
+  }
+  if (auto *AN = dyn_cast<MaxNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<MaxNode>(*F, AN);
+    return changed;
+  }
 
-    if (auto *MN = dyn_cast<MatMulNode>(&node)) {
-      changed |= combineDownRescaleToArithmeticNode<MatMulNode>(*F, MN);
-      continue;
+  // Combine Rescale down with Relu node.
+  //   ReluNode(Rescale(in)) -> ReluNode(in).
+  if (auto *RN = dyn_cast<ReluNode>(node)) {
+    if (auto *rescale = dyn_cast<RescaleQuantizedNode>(RN->getInput())) {
+      auto *newRN = F->createRELU(RN->getName(), rescale->getInput(),
+                                  RN->getResult().getType());
+      RN->getResult().replaceAllUsesOfWith(newRN);
+      changed = true;
     }
+    return changed;
+  }
+
+  if (auto *MN = dyn_cast<MatMulNode>(node)) {
+    changed |= combineDownRescaleToArithmeticNode<MatMulNode>(*F, MN);
+    return changed;
   }
 
   return changed;
@@ -2546,92 +2659,105 @@ void glow::fold(Function *F, CompilationMode mode) {
   fold(F, opts);
 }
 
-void glow::optimize(Function *F, const CompilationOptions &opts) {
+/// Optimize \p F for \p opts, and record the time of every pass in \p timers.
+static void optimize(Function *F, const CompilationOptions &opts,
+                     GraphOptTimers &timers) {
   // Optimize may be called after backend specific transformations and some
   // nodes may have become unused. It is a good idea to remove them, before
   // proceeding with any further optimizations.
-  DCE(F);
+  timers.run("DCE", [&] { DCE(F); });
 
-  // Sink transpose operations in an attempt to cancel them out.
-  // Perform code sinking until a fixed-point is reached.
-  // On big functions, the number of iterations until the fixpoint
-  // is usually at most 2 or 3 iterations.
-  while (sinkCode(F)) {
-    // Perform Dead Code Elimination between rounds of code sinking.
-    DCE(F);
-  }
+  // Sink transpose operations in an attempt to cancel them out. The nodes
+  // that each change creates are revisited until a fixed-point is reached.
+  timers.run("sinkCode", [&] {
+    if (rewriteUntilFixpoint(F, sinkCodeAt)) {
+      DCE(F);
+    }
+  });
 
   // Transposes that don't move data are optimized into Reshapes, which enables
   // further optimizations.
-  optimizeTransposeIntoReshape(F);
+  timers.run("optimizeTransposeIntoReshape",
+             [&] { optimizeTransposeIntoReshape(F); });
   // Need to remove old uses that would prohibit Reshape(Constant) optimization.
-  DCE(F);
+  timers.run("DCE", [&] { DCE(F); });
 
   // Reshapes and transposes can prevent other optimizations from triggering,
   // so try to optimize them out first.
-  optimizeReshape(F);
+  timers.run("optimizeReshape", [&] { optimizeReshape(F); });
   if (opts.mode == CompilationMode::Infer) {
-    transposeConstants(F);
+    timers.run("transposeConstants", [&] { transposeConstants(F); });
   }
 
   // Perform Common Subexpression Elimination.
-  CSE(F);
+  timers.run("CSE", [&] { CSE(F); });
 
   // Optimize Pad nodes
-  mergePadIntoConvolution(F);
+  timers.run("mergePadIntoConvolution", [&] { mergePadIntoConvolution(F); });
 
   // Perform Dead Code Elimination.
-  DCE(F);
+  timers.run("DCE", [&] { DCE(F); });
 
   // Merge multiple matmul nodes into a single large matmul.
-  mergeMatMul(F);
+  timers.run("mergeMatMul", [&] { mergeMatMul(F); });
 
   // Merge multiple batched adds into a larger batched add.
-  mergeBatchedAdd(F);
+  timers.run("mergeBatchedAdd", [&] { mergeBatchedAdd(F); });
 
   // Merge ReduceMean into AveragePool if possible.
-  optimizeReduceMean(F);
+  timers.run("optimizeReduceMean", [&] { optimizeReduceMean(F); });
 
   // Perform Dead Code Elimination.
-  DCE(F);
+  timers.run("DCE", [&] { DCE(F); });
 
   if (opts.mode == CompilationMode::Infer) {
     // Merge batch normalization operations.
     // Do after transpose constant folding, as weight transposes can prevent
     // the optimization from triggering.
-    optimizeBatchNorm(F);
+    timers.run("optimizeBatchNorm", [&] { optimizeBatchNorm(F); });
   }
 
   // Perform Common Subexpression Elimination.
-  CSE(F);
+  timers.run("CSE", [&] { CSE(F); });
 
   // Optimize Concat nodes.
-  optimizeConcatNodes(F);
+  timers.run("optimizeConcatNodes", [&] { optimizeConcatNodes(F); });
 
   // Optimize arithmetic nodes based on algebraic identities.
-  optimizeArithmeticNodes(F);
+  timers.run("optimizeArithmeticNodes", [&] { optimizeArithmeticNodes(F); });
 
   // Optimize Tensor shape transformations.
-  optimizeSliceOfSplat(F);
+  timers.run("optimizeSliceOfSplat", [&] { optimizeSliceOfSplat(F); });
 
   // Merge Transpose into MatMul/FC.
   // Run DCE to ensure correct number of node users.
-  DCE(F);
-  mergeTransposeIntoMatMulOrFC(F);
+  timers.run("DCE", [&] { DCE(F); });
+  timers.run("mergeTransposeIntoMatMulOrFC",
+             [&] { mergeTransposeIntoMatMulOrFC(F); });
 
   // Optimize away intermediate type conversions.
-  optimizeConversions(F);
+  timers.run("optimizeConversions", [&] { optimizeConversions(F); });
 
   // Optimize quantization related operators.
-  optimizeQuantization(F);
+  timers.run("optimizeQuantization", [&] { optimizeQuantization(F); });
 
-  while (sinkRescaleQuantizedNode(F)) {
-    DCE(F);
-    optimizeQuantization(F);
-  }
+  // Sink Rescales until a fixed-point is reached. The quantization
+  // optimizations need accurate use counts, so DCE runs before them.
+  timers.run("sinkRescaleQuantizedNode", [&] {
+    while (rewriteUntilFixpoint(F, sinkRescaleQuantizedNodeAt)) {
+      DCE(F);
+      optimizeQuantization(F);
+    }
+  });
 
   // Perform Dead Code Elimination.
-  DCE(F);
+  timers.run("DCE", [&] { DCE(F); });
+}
+
+void glow::optimize(Function *F, const CompilationOptions &opts) {
+  GraphOptTimers timers;
+  ::optimize(F, opts, timers);
+  timers.print(F);
 }
 
 void glow::optimize(Function *F, CompilationMode mode) {
@@ -2645,19 +2771,41 @@ void glow::optimizeFunction(Function *F, const Backend &B,
   // Verify the function pre-optimization/lowering.
   assert(F->verify() && "Function must be valid");
 
+  GraphOptTimers timers;
+
   // Optimize the graph.
-  ::glow::optimize(F, opts);
+  ::optimize(F, opts, timers);
 
   // Lower the graph into a sequence of low-level linear algebra operations.
-  ::glow::lower(F, /* loweredMap */ nullptr, &B);
+  timers.run("lower", [&] { ::glow::lower(F, /* loweredMap */ nullptr, &B); });
+
+  // Compute the subgraphs that only depend on Constants, such as weight
+  // preprocessing in imported models and the lowered parts of BatchNorms,
+  // once at compile time.
+  if (opts.enableConstantFolding && opts.constantFoldingBackend) {
+    timers.run("constantFold",
+               [&] { constantFold(F, *opts.constantFoldingBackend); });
+  }
 
   // Optimize the graph again.
-  ::glow::optimize(F, opts);
+  ::optimize(F, opts, timers);
 
   // Allow the backend to transform the graph after lowering.
-  if (B.transformPostLowering(F, opts)) {
+  bool transformed = false;
+  timers.run("transformPostLowering",
+             [&] { transformed = B.transformPostLowering(F, opts); });
+  if (transformed) {
+    // Fold the constant subgraphs that the backend created, such as filters
+    // re-laid out for its kernels.
+    if (opts.enableConstantFolding && opts.constantFoldingBackend) {
+      timers.run("constantFold",
+                 [&] { constantFold(F, *opts.constantFoldingBackend); });
+    }
+
     // Optimize the graph again after the backend transformation.
     // In particular, DCE is very likely to be useful.
-    ::glow::optimize(F, opts);
+    ::optimize(F, opts, timers);
   }
+
+  timers.print(F);
 }
@@ -24,6 +24,7 @@
 
 using namespace glow;
 using llvm::dyn_cast;
+using llvm::isa;
 
 /// Helper which replaces all uses of \p oldNV with \p newNV, and also
 /// optionally maps from \p newNV to \p oldNV in \p loweredMap. This map can be
@@ -256,23 +257,12 @@ static void lowerPadNode(Function *F, LoweredInfoMap *loweredMap,
   replaceAllUsesOfWith(loweredMap, P.getResult(), insert);
 }
 
-static void lowerSGDNode(Function *F, LoweredInfoMap *loweredMap,
-                         const SGDNode &SGD) {
-  NodeValue W = SGD.getWeight();
-  NodeValue G = SGD.getGradient();
-
-  /// Described in the paper: Alex Krizhevsky [2014]
-  // "One weird trick for parallelizing convolutional neural networks"
-
-  float momentum = SGD.getMomentum();
-
-  assert(W.dims() == G.dims() && "Invalid weight/gradient sizes for SGDNode");
-
-  float L1Decay = SGD.getL1Decay();
-  float L2Decay = SGD.getL2Decay();
-  float learningRate = SGD.getLearningRate();
-  float batchSize = SGD.getBatchSize();
-
+/// \returns the gradient \p G of the weight \p W with the L1 and L2 decay
+/// terms added, and divided by the \p batchSize. This is the gradient that
+/// the optimizers apply.
+static NodeValue createDecayedGradient(Function *F, NodeValue W, NodeValue G,
+                                       float L1Decay, float L2Decay,
+                                       float batchSize) {
   // All computations here are within the same type.
   auto type = G.getType();
 
@@ -300,29 +290,130 @@ static void lowerSGDNode(Function *F, LoweredInfoMap *loweredMap,
     auto *batchSizeSplat = F->createSplat("batchSizeSplat", type, batchSize);
     gij = F->createDiv("gij_div_batchSz", gij, batchSizeSplat);
   }
+  return gij;
+}
+
+static void lowerSGDNode(Function *F, LoweredInfoMap *loweredMap,
+                         const SGDNode &SGD) {
+  NodeValue W = SGD.getWeight();
+  NodeValue G = SGD.getGradient();
+
+  assert(W.dims() == G.dims() && "Invalid weight/gradient sizes for SGDNode");
+
+  NodeValue gij =
+      createDecayedGradient(F, W, G, SGD.getL1Decay(), SGD.getL2Decay(),
+                            SGD.getBatchSize());
+
+  auto *negLearningRateSplat = F->createSplat(
+      "learningRateSplat", G.getType(), -SGD.getLearningRate());
+  auto *dx = F->createMul("dx", negLearningRateSplat, gij);
+
+  auto *newW = F->createAdd("newW", W, dx);
+  replaceAllUsesOfWith(loweredMap, SGD.getUpdatedWeight(), newW);
+}
+
+static void lowerMomentumSGDNode(Function *F, LoweredInfoMap *loweredMap,
+                                 const MomentumSGDNode &SGD) {
+  NodeValue W = SGD.getWeight();
+  NodeValue G = SGD.getGradient();
+
+  /// Described in the paper: Alex Krizhevsky [2014]
+  // "One weird trick for parallelizing convolutional neural networks"
+
+  assert(W.dims() == G.dims() &&
+         "Invalid weight/gradient sizes for MomentumSGDNode");
+
+  auto type = G.getType();
+  NodeValue gij =
+      createDecayedGradient(F, W, G, SGD.getL1Decay(), SGD.getL2Decay(),
+                            SGD.getBatchSize());
 
   auto *negLearningRateSplat =
-      F->createSplat("learningRateSplat", type, -learningRate);
+      F->createSplat("learningRateSplat", type, -SGD.getLearningRate());
   Node *dx = F->createMul("dx", negLearningRateSplat, gij);
 
   // Use the momentum to improve the gradient descent:
   // http://ufldl.stanford.edu/tutorial/supervised/
   // OptimizationStochasticGradientDescent/
-  if (momentum > 0.0) {
-    Placeholder *Gsum =
-        F->getParent()->createPlaceholder(W.getType(), "gsum", false);
-
-    auto *momentumSplat = F->createSplat("learningRateSplat", type, momentum);
-    auto *GsumMult = F->createMul("GsumMult", momentumSplat, Gsum);
+  Placeholder *Gsum = SGD.getGsumPlaceholder();
+  auto *momentumSplat =
+      F->createSplat("momentumSplat", type, SGD.getMomentum());
+  auto *GsumMult = F->createMul("GsumMult", momentumSplat, Gsum);
 
-    dx = F->createAdd("dx_with_momentum", GsumMult, dx);
-    F->createSave("save.gsum", dx, Gsum);
-  }
+  dx = F->createAdd("dx_with_momentum", GsumMult, dx);
+  F->createSave("save.gsum", dx, Gsum);
 
   auto *newW = F->createAdd("newW", W, dx);
   replaceAllUsesOfWith(loweredMap, SGD.getUpdatedWeight(), newW);
 }
 
+static void lowerAdamNode(Function *F, LoweredInfoMap *loweredMap,
+                          const AdamNode &A) {
+  NodeValue W = A.getWeight();
+  NodeValue G = A.getGradient();
+
+  assert(W.dims() == G.dims() && "Invalid weight/gradient sizes for AdamNode");
+
+  auto type = G.getType();
+  NodeValue gij = createDecayedGradient(F, W, G, A.getL1Decay(),
+                                        A.getL2Decay(), A.getBatchSize());
+
+  // Update the biased first and second moment estimates.
+  float beta1 = A.getBeta1();
+  float beta2 = A.getBeta2();
+  auto *beta1Splat = F->createSplat("beta1Splat", type, beta1);
+  auto *oneMinusBeta1Splat =
+      F->createSplat("oneMinusBeta1Splat", type, 1 - beta1);
+  auto *beta2Splat = F->createSplat("beta2Splat", type, beta2);
+  auto *oneMinusBeta2Splat =
+      F->createSplat("oneMinusBeta2Splat", type, 1 - beta2);
+
+  Placeholder *M = A.getMPlaceholder();
+  Placeholder *V = A.getVPlaceholder();
+  auto *newM = F->createAdd("newM", F->createMul("beta1M", beta1Splat, M),
+                            F->createMul("gradM", oneMinusBeta1Splat, gij));
+  auto *gij2 = F->createMul("gij2", gij, gij);
+  auto *newV = F->createAdd("newV", F->createMul("beta2V", beta2Splat, V),
+                            F->createMul("gradV", oneMinusBeta2Splat, gij2));
+  F->createSave("save.adam_m", newM, M);
+  F->createSave("save.adam_v", newV, V);
+
+  // Count the step and compute the bias corrections 1 - beta^step.
+  Placeholder *step = A.getStepPlaceholder();
+  auto stepType = step->getType();
+  auto *newStep = F->createAdd("newStep", step,
+                               F->createSplat("oneSplat", stepType, 1));
+  F->createSave("save.adam_step", newStep, step);
+  auto *oneSplat = F->createSplat("oneSplat", stepType, 1);
+  auto *correction1 = F->createSub(
+      "correction1", oneSplat,
+      F->createPow("beta1Pow", F->createSplat("beta1Splat", stepType, beta1),
+                   newStep));
+  auto *correction2 = F->createSub(
+      "correction2", oneSplat,
+      F->createPow("beta2Pow", F->createSplat("beta2Splat", stepType, beta2),
+                   newStep));
+
+  auto *correction1B =
+      F->createBroadcast("correction1", correction1, W.dims(), 0);
+  auto *correction2B =
+      F->createBroadcast("correction2", correction2, W.dims(), 0);
+  auto *MHat = F->createDiv("MHat", newM, correction1B);
+  auto *VHat = F->createDiv("VHat", newV, correction2B);
+
+  // dx = -learningRate * MHat / (sqrt(VHat) + epsilon)
+  auto *denom =
+      F->createAdd("denom", F->createPow("sqrtVHat", VHat, 0.5),
+                   F->createSplat("epsilonSplat", type, A.getEpsilon()));
+  auto *negLearningRateSplat =
+      F->createSplat("learningRateSplat", type, -A.getLearningRate());
+  auto *dx = F->createMul("dx", negLearningRateSplat,
+                          F->createDiv("MHat_div_denom", MHat, denom));
+
+  auto *newW = F->createAdd("newW", W, dx);
+  replaceAllUsesOfWith(loweredMap, A.getUpdatedWeight(), newW);
+}
+
 static void lowerBatchNormalizationNode(Function *F, LoweredInfoMap *loweredMap,
                                         const BatchNormalizationNode &BN) {
   auto in = BN.getInput();
@@ -747,6 +838,10 @@ static void lowerNode(Function *F, Node *node, LoweredInfoMap *loweredMap) {
     lowerSigmoidGradNode(F, loweredMap, *SG);
   } else if (auto *SGD = dyn_cast<SGDNode>(node)) {
     lowerSGDNode(F, loweredMap, *SGD);
+  } else if (auto *SGD = dyn_cast<MomentumSGDNode>(node)) {
+    lowerMomentumSGDNode(F, loweredMap, *SGD);
+  } else if (auto *A = dyn_cast<AdamNode>(node)) {
+    lowerAdamNode(F, loweredMap, *A);
   } else if (auto *BN = dyn_cast<BatchNormalizationNode>(node)) {
     lowerBatchNormalizationNode(F, loweredMap, *BN);
   } else if (auto *MVN = dyn_cast<MeanVarNormalizationNode>(node)) {
@@ -780,9 +875,13 @@ void glow::lower(Function *F, LoweredInfoMap *loweredMap, const Backend *B,
     lowerNode(F, &N, loweredMap);
   }
 
+  // The optimizer nodes have side effects, so erase the lowered ones
+  // explicitly. The ones that the backend kept still update their weight.
   for (auto it = F->getNodes().begin(), e = F->getNodes().end(); it != e;) {
     auto cur = &*(it++);
-    if (dyn_cast<SGDNode>(cur)) {
+    if ((isa<SGDNode>(cur) || isa<MomentumSGDNode>(cur) ||
+         isa<AdamNode>(cur)) &&
+        !cur->hasUsers()) {
       F->eraseNode(cur);
     }
   }
@@ -15,10 +15,21 @@
  */
 
 #include "glow/Partitioner/Partitioner.h"
+#include "glow/Graph/Utils.h"
+
+#include "llvm/ADT/DenseSet.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
 
 using namespace glow;
 using llvm::isa;
 
+/// The ops that a group of nodes must compute per byte that it receives from
+/// or sends to other backends to run on a backend of its own.
+static constexpr uint64_t kMinOpsPerTransferredByte = 1;
+
 /// Check if the memory of \p node inputs is calculated already. \returns the
 /// total used memory after \p node is considered.
 static uint64_t updateUsedMem(const std::set<Storage *> &usedStorage,
@@ -77,6 +88,117 @@ Function *Partitioner::selectRepFunc(Module *parent, uint64_t &memSize) {
   return ret;
 }
 
+/// Split the 2D embedding table \p data into \p numShards Constants in \p mod.
+/// Rows are assigned cyclically: row r goes to shard (r % numShards) as its
+/// row (r / numShards). This spreads hot rows over all shards. All shards have
+/// the same number of rows, and rows past the end of the table are left zero
+/// (with default scale and offset for fused types).
+static std::vector<Constant *> createTableShards(Module *mod, Constant *data,
+                                                 size_t numShards) {
+  const size_t numRows = data->dims()[0];
+  const size_t shardRows = (numRows + numShards - 1) / numShards;
+  const size_t rowSize = data->getType()->getSizeInBytes() / numRows;
+  ShapeVector dims(data->dims().begin(), data->dims().end());
+  dims[0] = shardRows;
+  TypeRef shardTy = mod->uniqueTypeWithNewShape(data->getType(), dims);
+
+  std::vector<Constant *> shards;
+  const char *src = data->getPayload().getUnsafePtr();
+  for (size_t s = 0; s < numShards; s++) {
+    auto *shard = mod->createConstant(
+        shardTy, data->getName().str() + ".shard" + std::to_string(s));
+    char *dst = shard->getPayload().getUnsafePtr();
+    for (size_t j = 0; j < shardRows && j * numShards + s < numRows; j++) {
+      memcpy(dst + j * rowSize, src + (j * numShards + s) * rowSize, rowSize);
+    }
+    shards.push_back(shard);
+  }
+  return shards;
+}
+
+void Partitioner::shardEmbeddingTables(uint64_t availableMemory) {
+  // Leave room on each device for the rest of the partition (indices, other
+  // nodes, activations) next to a shard.
+  const uint64_t shardBudget = availableMemory / 2;
+
+  std::vector<Node *> lookups;
+  for (auto &node : F_->getNodes()) {
+    if (!isa<SparseLengthsWeightedSumNode>(&node) &&
+        !isa<FusedRowwiseQuantizedSparseLengthsWeightedSumNode>(&node)) {
+      continue;
+    }
+    // Both node kinds have the inputs Data, Weights, Indices and Lengths in
+    // the same order. The lookups are routed to the shards by
+    // SparseLengthsShard, which takes float weights.
+    auto *data = llvm::dyn_cast<Constant>(
+        node.getNthInput(SparseLengthsWeightedSumNode::DataIdx).getNode());
+    NodeValue weights =
+        node.getNthInput(SparseLengthsWeightedSumNode::WeightsIdx);
+    if (data && data->dims()[0] > 1 &&
+        data->getType()->getSizeInBytes() > shardBudget &&
+        weights.getElementType() == ElemKind::FloatTy) {
+      lookups.push_back(&node);
+    }
+  }
+
+  for (auto *node : lookups) {
+    const std::string name = node->getName();
+    auto *data = llvm::cast<Constant>(
+        node->getNthInput(SparseLengthsWeightedSumNode::DataIdx).getNode());
+    NodeValue weights =
+        node->getNthInput(SparseLengthsWeightedSumNode::WeightsIdx);
+    NodeValue indices =
+        node->getNthInput(SparseLengthsWeightedSumNode::IndicesIdx);
+    NodeValue lengths =
+        node->getNthInput(SparseLengthsWeightedSumNode::LengthsIdx);
+
+    // Use no more shards than needed to fit the table, and no more than there
+    // are devices to hold them.
+    uint64_t tableSize = data->getType()->getSizeInBytes();
+    size_t numShards = std::min<size_t>(
+        (tableSize + shardBudget - 1) / shardBudget, data->dims()[0]);
+    numShards = std::min<size_t>(numShards, deviceInfo_.size());
+    if (numShards < 2) {
+      continue;
+    }
+    std::vector<Constant *> shards =
+        createTableShards(module_, data, numShards);
+
+    // Route the indices: an index belongs to shard (index % numShards), where
+    // it addresses row (index / numShards). Each shard selects its own
+    // lookups with a SparseLengthsShard node, which packs them at the front
+    // of the indices and counts them per segment, so the lookups of all
+    // shards together cost as much as the original ones. Adding the partial
+    // sums of all shards gives the original result.
+    NodeValue sum;
+    for (size_t s = 0; s < numShards; s++) {
+      const std::string shardName = name + ".shard" + std::to_string(s);
+      auto *route =
+          F_->createSparseLengthsShard(shardName + ".route", weights, indices,
+                                       lengths, numShards, s);
+      NodeValue partial;
+      if (isa<SparseLengthsWeightedSumNode>(node)) {
+        partial = F_->createSparseLengthsWeightedSum(
+            shardName, node->getNthResult(0).getType(), shards[s],
+            route->getShardWeights(), route->getShardIndices(),
+            route->getShardLengths());
+      } else {
+        partial = F_->createFusedRowwiseQuantizedSparseLengthsWeightedSum(
+            shardName, shards[s], route->getShardWeights(),
+            route->getShardIndices(), route->getShardLengths());
+      }
+      sum = sum.getNode() ? F_->createAdd(name + ".partial_sum", sum, partial)
+                          : partial;
+    }
+
+    node->getNthResult(0).replaceAllUsesOfWith(sum);
+    F_->eraseNode(node);
+    if (data->getNumUsers() == 0) {
+      module_->eraseConstant(data);
+    }
+  }
+}
+
 /// Get the minimal memory requirement (constant) for each op in the function.
 void Partitioner::initOpMemUsage() {
   memUsage_.clear();
@@ -98,6 +220,49 @@ void Partitioner::initOpMemUsage() {
   }
 }
 
+/// \returns the number of compute ops of \p node. Currently only computed for
+/// Matmul, Conv, FC, and zero for the other nodes.
+/// TODO: think about whether this is better off computed inside a Node.
+static uint64_t getNumOps(const Node &node) {
+  uint64_t totalOps = 0;
+  switch (node.getKind()) {
+  case Kinded::Kind::MatMulNodeKind: {
+    auto *MMN = llvm::dyn_cast<MatMulNode>(&node);
+    auto lhsDims = MMN->getLHS().dims();
+    auto rhsDims = MMN->getRHS().dims();
+    totalOps = 2 * lhsDims[0] * lhsDims[1] * rhsDims[1];
+    break;
+  }
+  case Kinded::Kind::FullyConnectedNodeKind: {
+    auto *FCN = llvm::dyn_cast<FullyConnectedNode>(&node);
+    auto inputDims = FCN->getInput().dims();
+    auto wtDims = FCN->getWeights().dims();
+    totalOps = 2 * inputDims[0] * inputDims[1] * wtDims[1];
+    break;
+  }
+  case Kinded::Kind::ConvolutionNodeKind: {
+    auto *CN = llvm::dyn_cast<ConvolutionNode>(&node);
+    auto resultDims = CN->getResult().dims();
+    // Get the product of batch, output height, output dims, output channels
+    totalOps = resultDims[0];
+    for (size_t i = 1, e = resultDims.size(); i < e; i++) {
+      totalOps *= resultDims[i];
+    }
+    // Multiply in kernel height, kernel width
+    auto kernelDims = CN->getKernels();
+    totalOps *= kernelDims[0] * kernelDims[1];
+    // Multiply in input channels/groups
+    auto inputChannels = CN->getInput().dims()[1];
+    auto nGroups = CN->getGroup();
+    totalOps *= (inputChannels * 1.0 / nGroups);
+    break;
+  }
+  default:
+    break;
+  }
+  return totalOps;
+}
+
 /// Get the minimal compute time for each op in the function.
 void Partitioner::initOpComputeTime() {
   computeTime_.clear();
@@ -169,44 +334,7 @@ void Partitioner::initOpComputeTime() {
       }
     }
 
-    /// Calculate compute ops. Currently only computed for Matmul, Conv, FC
-    /// TODO: think about whether this is better off computed inside a Node.
-    uint64_t totalOps = 0;
-    switch (node.getKind()) {
-    case Kinded::Kind::MatMulNodeKind: {
-      auto *MMN = llvm::dyn_cast<MatMulNode>(&node);
-      auto lhsDims = MMN->getLHS().dims();
-      auto rhsDims = MMN->getRHS().dims();
-      totalOps = 2 * lhsDims[0] * lhsDims[1] * rhsDims[1];
-      break;
-    }
-    case Kinded::Kind::FullyConnectedNodeKind: {
-      auto *FCN = llvm::dyn_cast<FullyConnectedNode>(&node);
-      auto inputDims = FCN->getInput().dims();
-      auto wtDims = FCN->getWeights().dims();
-      totalOps = 2 * inputDims[0] * inputDims[1] * wtDims[1];
-      break;
-    }
-    case Kinded::Kind::ConvolutionNodeKind: {
-      auto *CN = llvm::dyn_cast<ConvolutionNode>(&node);
-      auto resultDims = CN->getResult().dims();
-      // Get the product of batch, output height, output dims, output channels
-      totalOps = resultDims[0];
-      for (size_t i = 1, e = resultDims.size(); i < e; i++) {
-        totalOps *= resultDims[i];
-      }
-      // Multiply in kernel height, kernel width
-      auto kernelDims = CN->getKernels();
-      totalOps *= kernelDims[0] * kernelDims[1];
-      // Multiply in input channels/groups
-      auto inputChannels = CN->getInput().dims()[1];
-      auto nGroups = CN->getGroup();
-      totalOps *= (inputChannels * 1.0 / nGroups);
-      break;
-    }
-    default:
-      break;
-    }
+    uint64_t totalOps = getNumOps(node);
 
     /// Compute compute roofline as max of flops, DRAM, SRAM BW
     /// See https://bit.ly/2UdJ3mz
@@ -481,6 +609,7 @@ void Partitioner::doPartitioning(Function *F, NodeToFunctionMap &mapping) {
       std::unique_ptr<DAGNode> subDAG = llvm::make_unique<DAGNode>();
       subDAG->name = subF->getName();
       subDAG->logicalDevices = {logicalID++};
+      subDAG->backendKind = deviceInfo_[0].backendKind;
       funcDAG[subF] = subDAG.get();
       nodes.push_back(std::move(subDAG));
     }
@@ -503,6 +632,7 @@ void Partitioner::doPartitioning(Function *F, NodeToFunctionMap &mapping) {
           std::unique_ptr<DAGNode> subDAG = llvm::make_unique<DAGNode>();
           subDAG->name = inputF->getName();
           subDAG->logicalDevices = {logicalID++};
+          subDAG->backendKind = deviceInfo_[0].backendKind;
           funcDAG[inputF] = subDAG.get();
           nodes.push_back(std::move(subDAG));
         }
@@ -557,18 +687,203 @@ void Partitioner::doPartitioning(Function *F, NodeToFunctionMap &mapping) {
       root->children.push_back(funcDAG[subF]);
     }
   }
+}
 
-  // Adjust the logicalDevice for each DAGNode.
-  if (mapping.getPartitions().size() > deviceInfo_.size()) {
-    adjustLogicalDeviceID(root, mapping.getPartitions().size());
-  } else if (saturateHost_) {
-    // Attempt to saturate the host. Passing in the count of logical devices.
-    // Since logicalId starts at 0 we add one.
-    saturateHost(logicalID + 1);
+std::vector<BackendKind> Partitioner::getBackendKinds() const {
+  std::vector<BackendKind> kinds;
+  for (const auto &info : deviceInfo_) {
+    if (std::find(kinds.begin(), kinds.end(), info.backendKind) ==
+        kinds.end()) {
+      kinds.push_back(info.backendKind);
+    }
   }
+  return kinds;
+}
+
+llvm::Error Partitioner::partitionByBackend(Function *F,
+                                            llvm::ArrayRef<BackendKind> kinds) {
+  std::vector<std::unique_ptr<Backend>> backends;
+  for (auto kind : kinds) {
+    backends.emplace_back(createBackend(kind));
+  }
+
+  // Assign every node to the first backend that supports it. The backends are
+  // in the order of the devices, so the backend of the first device is
+  // preferred, and the others only run what it does not support.
+  llvm::DenseMap<Node *, unsigned> nodeBackend;
+  std::vector<Node *> order;
+  GraphPostOrderVisitor visitor(*F);
+  for (auto *N : visitor.getPostOrder()) {
+    if (isa<Storage>(N)) {
+      continue;
+    }
+    unsigned idx = 0;
+    while (idx < backends.size() && !backends[idx]->isOpSupported(*N)) {
+      idx++;
+    }
+    RETURN_ERR_IF_NOT(idx < backends.size(),
+                      "Partition failed: no backend supports the node " +
+                          N->getName().str());
+    nodeBackend[N] = idx;
+    order.push_back(N);
+  }
+
+  // An island is a connected group of nodes on one backend. Cutting it out
+  // costs the transfers of the values that cross its boundary, so an island
+  // whose neighbors all run on another backend that supports it, like a
+  // reshape or a few cheap elementwise nodes between two fallback nodes,
+  // joins that backend unless it computes at least kMinOpsPerTransferredByte
+  // ops per byte it transfers. The ops of the nodes without a compute
+  // estimate are the elements of their result, and the nodes without a
+  // result, like saves, are free, so they follow their inputs. Every move
+  // merges the island with its neighbors, so this terminates.
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    llvm::DenseSet<Node *> visited;
+    for (auto *root : order) {
+      if (!visited.insert(root).second) {
+        continue;
+      }
+      unsigned idx = nodeBackend[root];
+      std::vector<Node *> island = {root};
+      for (size_t i = 0; i < island.size(); i++) {
+        Node *N = island[i];
+        auto addNeighbor = [&](Node *M) {
+          if (nodeBackend[M] == idx && visited.insert(M).second) {
+            island.push_back(M);
+          }
+        };
+        for (size_t j = 0, e = N->getNumInputs(); j < e; j++) {
+          Node *in = N->getNthInput(j).getNode();
+          if (!isa<Storage>(in)) {
+            addNeighbor(in);
+          }
+        }
+        for (auto &use : N->getUsers()) {
+          addNeighbor(use.getUser());
+        }
+      }
+
+      // Sum the ops of the island and collect the values it receives from
+      // and sends to the other backends.
+      int other = -1;
+      bool sameBackend = true;
+      uint64_t ops = 0;
+      std::set<std::pair<Node *, unsigned>> transfers;
+      auto addTransfer = [&](Node *M, NodeValue value) {
+        int otherIdx = nodeBackend[M];
+        sameBackend &= (other == -1 || other == otherIdx);
+        other = otherIdx;
+        transfers.insert({value.getNode(), value.getResNo()});
+      };
+      for (auto *N : island) {
+        uint64_t nodeOps = getNumOps(*N);
+        if (!nodeOps && N->getNumResults()) {
+          nodeOps = N->getType(0)->size();
+        }
+        ops += nodeOps;
+        for (size_t j = 0, e = N->getNumInputs(); j < e; j++) {
+          NodeValue in = N->getNthInput(j);
+          if (!isa<Storage>(in.getNode()) && nodeBackend[in.getNode()] != idx) {
+            addTransfer(in.getNode(), in);
+          }
+        }
+        for (auto &use : N->getUsers()) {
+          Node *user = use.getUser();
+          if (nodeBackend[user] == idx) {
+            continue;
+          }
+          for (size_t j = 0, e = user->getNumInputs(); j < e; j++) {
+            NodeValue in = user->getNthInput(j);
+            if (in.getNode() == N) {
+              addTransfer(user, in);
+            }
+          }
+        }
+      }
+      if (other == -1 || !sameBackend) {
+        continue;
+      }
+      uint64_t transferBytes = 0;
+      for (auto &T : transfers) {
+        transferBytes += T.first->getType(T.second)->getSizeInBytes();
+      }
+      if (ops >= kMinOpsPerTransferredByte * transferBytes ||
+          !std::all_of(island.begin(), island.end(), [&](Node *N) {
+            return backends[other]->isOpSupported(*N);
+          })) {
+        continue;
+      }
+      for (auto *N : island) {
+        nodeBackend[N] = other;
+      }
+      // The islands found so far may now be connected, so look for them
+      // again.
+      moved = true;
+      break;
+    }
+  }
+
+  // Cut the graph where the backend changes. The stage of a node is the
+  // largest number of backend changes on a path from the inputs of F to the
+  // node. The nodes of one stage and one backend form a sub-function, and the
+  // sub-functions can't depend on each other in a cycle.
+  NodeToFunctionMap mapping;
+  llvm::DenseMap<Node *, unsigned> stage;
+  std::map<std::pair<unsigned, unsigned>, Function *> stageFunctions;
+  llvm::DenseMap<Function *, unsigned> functionBackend;
+  for (auto *N : order) {
+    unsigned s = 0;
+    for (size_t i = 0, e = N->getNumInputs(); i < e; i++) {
+      Node *in = N->getNthInput(i).getNode();
+      if (isa<Storage>(in)) {
+        continue;
+      }
+      s = std::max(s, stage[in] + (nodeBackend[in] != nodeBackend[N]));
+    }
+    stage[N] = s;
+    Function *&subF = stageFunctions[{s, nodeBackend[N]}];
+    if (!subF) {
+      subF = module_->createFunction(F->getName().str() + "_part" +
+                                     std::to_string(stageFunctions.size()));
+      mapping.createPartition(subF);
+      functionBackend[subF] = nodeBackend[N];
+    }
+    mapping.add(N, subF);
+  }
+
+  doPartitioning(F, mapping);
+
+  // Every backend is one logical device, so the sub-functions of a backend
+  // share a device, and the Provisioner places them on a device of their
+  // backend. The Executor moves the tensors across the cuts through the
+  // Placeholders created by doPartitioning.
+  for (auto &node : partitions_.back().nodes) {
+    unsigned idx = functionBackend[module_->getFunction(node->name)];
+    node->backendKind = kinds[idx];
+    node->logicalDevices = {idx};
+  }
+  return llvm::Error::success();
 }
 
 llvm::Error Partitioner::Partition() {
+  // When the devices have different backends, split every function by the
+  // backends that support its nodes.
+  std::vector<BackendKind> kinds = getBackendKinds();
+  if (kinds.size() > 1) {
+    auto funcList = module_->getFunctions();
+    for (Function *F : funcList) {
+      RETURN_IF_ERR(partitionByBackend(F, kinds));
+      module_->eraseFunction(F);
+    }
+    for (Function *F : module_->getFunctions()) {
+      (void)F;
+      assert(F->verify() && "Conversion led to invalid function");
+    }
+    return llvm::Error::success();
+  }
+
   // Find the representative function for running partitioning algorithm.
   F_ = selectRepFunc(module_, memSize_);
   uint64_t availMem = deviceInfo_[0].availableMemory;
@@ -583,6 +898,7 @@ llvm::Error Partitioner::Partition() {
       std::unique_ptr<DAGNode> DAG1 = llvm::make_unique<DAGNode>();
       DAG1->logicalDevices = {0};
       DAG1->name = F->getName();
+      DAG1->backendKind = deviceInfo_[0].backendKind;
       DAG1->parents.push_back(DAG0.get());
       DAG0->children.push_back(DAG1.get());
       nodesDAGNodeTy nodes;
@@ -596,6 +912,9 @@ llvm::Error Partitioner::Partition() {
     return llvm::Error::success();
   }
 
+  // Prepare 0: Split the embedding tables that do not fit on one device.
+  shardEmbeddingTables(availMem);
+
   // Prepare 1: Get the min memory usage for each op.
   initOpMemUsage();
 
@@ -613,6 +932,16 @@ llvm::Error Partitioner::Partition() {
 
   doPartitioning(F_, partitionMap);
 
+  // Adjust the logicalDevice for each DAGNode.
+  size_t numPartitions = partitionMap.getPartitions().size();
+  if (numPartitions > deviceInfo_.size()) {
+    adjustLogicalDeviceID(partitions_.back().root.get(), numPartitions);
+  } else if (saturateHost_) {
+    // Attempt to saturate the host. Passing in the count of logical devices.
+    // Since logicalId starts at 0 we add one.
+    saturateHost(numPartitions + 1);
+  }
+
   // Remove the original function after partitioning.
   module_->eraseFunction(F_);
 
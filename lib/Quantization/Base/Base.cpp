@@ -371,8 +371,13 @@ void tensorFusedRowwiseQuantization(const Tensor &input, Tensor &output) {
   // extra columns for 4 bytes for float scale, and 4 bytes for int32_t offset.
   assert(input.dims().size() == 2 && output.dims().size() == 2 &&
          "Input and output must be 2 dimensional.");
-  assert(input.dims()[1] + 8 == output.dims()[1] &&
+  const bool is4Bit = output.getElementType() == ElemKind::UInt4FusedQTy;
+  assert((is4Bit || input.dims()[1] + 8 == output.dims()[1]) &&
          "Output must have 8 more columns than input.");
+  assert((!is4Bit || (input.dims()[1] % 2 == 0 &&
+                      input.dims()[1] / 2 + 8 == output.dims()[1])) &&
+         "4-bit output must have 8 more columns than half of the input.");
+  const float numLevels = is4Bit ? 15.0 : 255.0;
 
   const size_t outWidth = output.dims()[1];
   char *dataBasePtr = output.getUnsafePtr();
@@ -394,12 +399,24 @@ void tensorFusedRowwiseQuantization(const Tensor &input, Tensor &output) {
     constexpr float kEqualityThreshold = 1e-10f;
     const float scale = ((max - min) < kEqualityThreshold)
                             ? 1.0
-                            : ((double)max - (double)min) / 255.0;
+                            : ((double)max - (double)min) / numLevels;
     const float offset = min;
 
-    for (size_t j = 0, f = input.dims()[1]; j < f; j++) {
-      destH.at({i, j}) = quantization::quantizeWithFloatOffset<uint8_t>(
-          srcH.at({i, j}), scale, offset);
+    if (is4Bit) {
+      // Round to the nearest level; with only 16 levels truncation would
+      // double the quantization error.
+      for (size_t j = 0, f = input.dims()[1]; j < f; j += 2) {
+        uint8_t lo = std::min<float>(
+            15, nearbyintf((srcH.at({i, j}) - offset) / scale));
+        uint8_t hi = std::min<float>(
+            15, nearbyintf((srcH.at({i, j + 1}) - offset) / scale));
+        destH.at({i, j / 2}) = lo | (hi << 4);
+      }
+    } else {
+      for (size_t j = 0, f = input.dims()[1]; j < f; j++) {
+        destH.at({i, j}) = quantization::quantizeWithFloatOffset<uint8_t>(
+            srcH.at({i, j}), scale, offset);
+      }
     }
 
     // Now set the scale/offset at the end of each row.
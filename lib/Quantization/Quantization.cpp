@@ -812,6 +812,89 @@ public:
     cleanUp();
     assert(function_.verify() && "Conversion led to invalid function");
   }
+
+  /// Traverse all nodes to find quantized convolutions, and convert them to
+  /// ChannelwiseQuantizedConvolutions if their filter is Constant.
+  void enableChannelwise() {
+    auto nodeIt = function_.getNodes().end();
+    auto stopIt = function_.getNodes().begin();
+    do {
+      --nodeIt;
+      Node &node = *nodeIt;
+      auto *Q = llvm::dyn_cast<DequantizeNode>(&node);
+      if (!Q) {
+        continue;
+      }
+
+      // After function "convert()" is called, one ConvolutionNode is
+      // converted into:
+      // [fp32 input] [fp32 filter] [fp32 bias]
+      //      |              |           |
+      // [QuantizeNode] [QuantizeNode] [QuantizeNode]
+      //      \              |           /
+      // [            ConvolutionNode               ]
+      //                     |
+      //              [DequantizeNode]
+      // We need to find the above patern and convert it to:
+      // [fp32 input]              [fp32 filter]             [fp32 bias]
+      //      |                    /      |       \              |
+      //      |          [int8 filter] [scales] [offsets]        |
+      // [QuantizeNode]      |            |        |         [QuantizeNode]
+      //      \              |            |        |             /
+      // [         ChannelwiseQuantizedConvolutionNode           ]
+      //                              |
+      //                       [DequantizeNode]
+      auto *CN = llvm::dyn_cast<ConvolutionNode>(Q->getInput());
+      if (!CN) {
+        continue;
+      }
+      NodeValue input = CN->getInput();
+      NodeValue bias = CN->getBias();
+      NodeValue result = CN->getResult();
+      if (input.getElementType() != ElemKind::Int8QTy ||
+          bias.getElementType() != ElemKind::Int32QTy ||
+          result.getElementType() != ElemKind::Int8QTy) {
+        continue;
+      }
+
+      // For ChannelwiseQuantizedConvolution, the filter needs to be constant.
+      auto *filterQN = llvm::dyn_cast<QuantizeNode>(CN->getFilter());
+      if (!filterQN) {
+        continue;
+      }
+      auto *filterC = llvm::dyn_cast<Constant>(filterQN->getInput());
+      if (!filterC) {
+        continue;
+      }
+
+      // Only convert if the backend supports the channelwise version;
+      // otherwise keep the regular quantized convolution.
+      size_t numChannels = filterC->dims()[0];
+      TypeRef filterTy =
+          mod_.uniqueType(ElemKind::Int8QTy, filterC->dims(), 0.0, 0);
+      TypeRef scalesTy = mod_.uniqueType(ElemKind::FloatTy, {numChannels});
+      TypeRef offsetsTy = mod_.uniqueType(ElemKind::Int32ITy, {numChannels});
+      if (!B_.isOpSupported(NodeInfo(
+              Kinded::Kind::ChannelwiseQuantizedConvolutionNodeKind,
+              {input.getType(), filterTy, bias.getType(), scalesTy,
+               offsetsTy},
+              {result.getType()}))) {
+        continue;
+      }
+
+      auto *CQC = function_.createChannelwiseQuantizedConv(
+          CN->getName(), input, filterC, bias, result.getType(),
+          CN->getKernels(), CN->getStrides(), CN->getPads(), CN->getGroup(),
+          schema_);
+
+      // Replace usages of the quantized ConvolutionNode with the
+      // ChannelwiseQuantizedConvolutionNode.
+      result.replaceAllUsesOfWith(CQC->getResult());
+    } while (nodeIt != stopIt);
+
+    cleanUp();
+    assert(function_.verify() && "Conversion led to invalid function");
+  }
 };
 
 } // namespace
@@ -904,6 +987,9 @@ Function *quantizeFunction(Function *F,
   if (quantConfig.enableRowwise) {
     quantizer.enableRowwise();
   }
+  if (quantConfig.enableChannelwise) {
+    quantizer.enableChannelwise();
+  }
 
   return G;
 }
@@ -226,6 +226,12 @@ void ExecutionState::insertIntoTraceContext(std::vector<TraceEvent> &events) {
       std::back_inserter(resultCtx_->getTraceContext()->getTraceEvents()));
 }
 
+void ExecutionState::addDeviceTime(const ExecutionContext &nodeCtx) {
+  std::lock_guard<std::mutex> lock(bindingsMtx_);
+  resultCtx_->addDeviceTime(nodeCtx.getDeviceQueueWaitUs(),
+                            nodeCtx.getDeviceExecutionTimeUs());
+}
+
 std::unique_ptr<ExecutionContext> ExecutionState::getUniqueResultContextPtr() {
   // The result PlaceholderBindings should have been been created in the
   // constructor.
@@ -359,6 +365,37 @@ void ThreadPoolExecutor::propagatePlaceholdersForNode(
   }
 }
 
+DeviceIDTy ThreadPoolExecutor::selectDevice(DAGNode *node) {
+  const size_t numDevices = node->deviceIDs.size();
+  const unsigned start = node->currentDeviceIdx++;
+  DeviceIDTy bestDevice = node->deviceIDs[start % numDevices];
+  if (numDevices == 1) {
+    return bestDevice;
+  }
+
+  // Pick the device with the shortest expected latency. Until the devices
+  // have timing history, this degrades to the least outstanding requests,
+  // and with equal load to round-robin starting at currentDeviceIdx.
+  const DeviceManager *bestManager = nullptr;
+  for (size_t i = 0; i < numDevices; i++) {
+    DeviceIDTy deviceID = node->deviceIDs[(start + i) % numDevices];
+    auto it = deviceManagers_.find(deviceID);
+    if (it == deviceManagers_.end()) {
+      continue;
+    }
+    const DeviceManager *manager = it->second.get();
+    if (!bestManager ||
+        std::make_pair(manager->getExpectedLatencyUs(),
+                       manager->getOutstandingRequests()) <
+            std::make_pair(bestManager->getExpectedLatencyUs(),
+                           bestManager->getOutstandingRequests())) {
+      bestManager = manager;
+      bestDevice = deviceID;
+    }
+  }
+  return bestDevice;
+}
+
 void ThreadPoolExecutor::executeDAGNode(
     std::shared_ptr<ExecutionState> executionState, DAGNode *node) {
   // If execution has already failed due to another node, don't bother running
@@ -371,7 +408,7 @@ void ThreadPoolExecutor::executeDAGNode(
   }
 
   auto startTS = TraceEvent::now();
-  auto currentDevice = node->getNextDevice();
+  auto currentDevice = selectDevice(node);
   // Get the DeviceManager that can run the node.
   auto deviceManagerIt = deviceManagers_.find(currentDevice);
 
@@ -461,6 +498,7 @@ void ThreadPoolExecutor::handleDeviceManagerResult(
 
   // Set the result code for the run.
   executionState->getErrorContainer().set(std::move(err));
+  executionState->addDeviceTime(*ctx);
 
   // If the DeviceManager executed the node, propagate its output Placeholders
   // to its children or the result PlaceholderBindings as appropriate.
@@ -92,6 +92,10 @@ public:
   /// Move all events from the provided vector into the top level resultContxt.
   void insertIntoTraceContext(std::vector<TraceEvent> &events);
 
+  /// Add the device queue wait and execution time of the node that ran with
+  /// \p nodeCtx to the top level resultContext.
+  void addDeviceTime(const ExecutionContext &nodeCtx);
+
   /// \returns a unique pointer to the result bindings. This should not be
   /// called at the same time as getRawResultPlaceholderBindingsPtr() or
   /// insertIntoResultCtx().
@@ -176,6 +180,12 @@ private:
                                const DAGNode *node,
                                const ExecutionContext *ctx);
 
+  /// \returns the device out of the ones \p node is assigned to on which a run
+  /// of \p node is expected to complete first, based on the number of
+  /// outstanding requests and the average execution time of each
+  /// DeviceManager. Ties are broken round-robin.
+  DeviceIDTy selectDevice(DAGNode *node);
+
   /// Execute the DAG node specified by \p node within the run corresponding to
   /// \p executionState.
   void executeDAGNode(std::shared_ptr<ExecutionState> executionState,
@@ -23,6 +23,8 @@
 #include "glow/Runtime/Provisioner/Provisioner.h"
 #include "glow/Runtime/RuntimeTypes.h"
 
+#include "llvm/Support/Format.h"
+
 #include <future>
 #include <queue>
 
@@ -40,14 +42,17 @@ HostManager::init(std::vector<std::unique_ptr<DeviceConfig>> configs) {
 
   if (configs.size() > 0) {
     backend_.reset(createBackend(configs[0]->getBackendKind()));
+    constantFoldingBackend_.reset(createBackend(BackendKind::Interpreter));
   }
 
   for (auto &config : configs) {
+    auto backendKind = config->getBackendKind();
     if (!config->hasName()) {
-      config->setName(backend_->getBackendName() + std::to_string(deviceCount));
+      std::unique_ptr<Backend> deviceBackend(createBackend(backendKind));
+      config->setName(deviceBackend->getBackendName() +
+                      std::to_string(deviceCount));
     }
 
-    auto backendKind = config->getBackendKind();
     devices_[deviceCount] = std::unique_ptr<DeviceManager>(
         DeviceManager::createDeviceManager(backendKind, std::move(config)));
 
@@ -61,7 +66,10 @@ HostManager::init(std::vector<std::unique_ptr<DeviceConfig>> configs) {
   return llvm::Error::success();
 }
 
-HostManager::~HostManager() { llvm::toString(clearHost()); }
+HostManager::~HostManager() {
+  stopMetricsDump();
+  llvm::toString(clearHost());
+}
 
 llvm::Error HostManager::addNetwork(std::unique_ptr<Module> module,
                                     bool saturateHost) {
@@ -80,13 +88,17 @@ llvm::Error HostManager::addNetwork(std::unique_ptr<Module> module,
   for (auto &device : devices_) {
     DeviceInfo info = DeviceInfo();
     info.availableMemory = device.second->getAvailableMemory();
+    info.backendKind = device.second->getBackendKind();
     deviceInfo.push_back(info);
   }
-  // Optimize functions before passing to partitioner.
+  // Optimize functions before passing to partitioner. The graph optimizations
+  // update Module state that the functions share, so they run one function at
+  // a time. The Provisioner compiles the optimized functions in parallel.
   // Currently hardcoding inference.
   if (backend_) {
     CompilationOptions opts;
     opts.mode = CompilationMode::Infer;
+    opts.constantFoldingBackend = constantFoldingBackend_.get();
     for (auto F : module->getFunctions()) {
       ::glow::optimizeFunction(F, *backend_, opts);
     }
@@ -107,6 +119,7 @@ llvm::Error HostManager::addNetwork(std::unique_ptr<Module> module,
     auto &networkData = networks_[(node.root)->name];
     networkData.dag = std::move(node);
     networkData.module = sharedModule;
+    networkData.metrics = std::make_shared<NetworkMetrics>();
   }
 
   return llvm::Error::success();
@@ -172,6 +185,7 @@ RunIdentifierTy
 HostManager::runNetwork(llvm::StringRef networkName,
                         std::unique_ptr<ExecutionContext> context,
                         ResultCBTy callback) {
+  auto startTime = std::chrono::steady_clock::now();
   auto *resultTraceContext = context->getTraceContext();
 
   // Set the thread name for TraceEvents in the Runtime.
@@ -193,9 +207,11 @@ HostManager::runNetwork(llvm::StringRef networkName,
     return currentRun;
   }
 
+  auto &network = networks_[networkName];
   size_t activeRequestCount = activeRequestCount_++;
   if (activeRequestCount >= activeRequestLimit_) {
     activeRequestCount_--;
+    network.metrics->refusedRequestCount++;
     callback(
         currentRun,
         MAKE_ERR(GlowErr::ErrorCode::RUNTIME_REQUEST_REFUSED,
@@ -206,14 +222,128 @@ HostManager::runNetwork(llvm::StringRef networkName,
     return currentRun;
   }
 
+  network.metrics->requestCount++;
   executor_->run(
-      networks_[networkName].dag.root.get(), std::move(context), currentRun,
+      network.dag.root.get(), std::move(context), currentRun,
       [&activeRequest = this->activeRequestCount_, callback,
-       name = networkName.str()](RunIdentifierTy runID, llvm::Error err,
-                                 std::unique_ptr<ExecutionContext> context) {
+       name = networkName.str(), metrics = network.metrics,
+       startTime](RunIdentifierTy runID, llvm::Error err,
+                  std::unique_ptr<ExecutionContext> context) {
         --activeRequest;
+        metrics->latencyUs.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startTime)
+                .count());
+        metrics->queueWaitUs.record(context->getDeviceQueueWaitUs());
+        metrics->deviceTimeUs.record(context->getDeviceExecutionTimeUs());
+        if (err) {
+          metrics->failedRequestCount++;
+        }
         TRACE_EVENT_INSTANT(context->getTraceContext(), "finish_" + name);
         callback(runID, std::move(err), std::move(context));
       });
   return currentRun;
 }
+
+std::shared_ptr<const NetworkMetrics>
+HostManager::getNetworkMetrics(llvm::StringRef networkName) {
+  std::lock_guard<std::mutex> networkLock(networkLock_);
+  auto it = networks_.find(networkName);
+  if (it == networks_.end()) {
+    return nullptr;
+  }
+  return it->second.metrics;
+}
+
+std::map<DeviceIDTy, uint64_t> HostManager::getDeviceMemoryUsage() const {
+  std::map<DeviceIDTy, uint64_t> usage;
+  for (const auto &device : devices_) {
+    usage[device.first] = device.second->getMaximumMemory() -
+                          device.second->getAvailableMemory();
+  }
+  return usage;
+}
+
+/// Writes \p str to \p os as a JSON string, with its quotes, backslashes
+/// and control characters escaped.
+static void writeJSONString(llvm::raw_ostream &os, llvm::StringRef str) {
+  os << '"';
+  for (unsigned char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (c < 0x20) {
+      os << llvm::format("\\u%04x", c);
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+void HostManager::dumpMetrics(llvm::raw_ostream &os) {
+  os << "{\"networks\": {";
+  {
+    std::lock_guard<std::mutex> networkLock(networkLock_);
+    bool first = true;
+    for (const auto &network : networks_) {
+      const NetworkMetrics &metrics = *network.second.metrics;
+      os << (first ? "" : ", ");
+      writeJSONString(os, network.first);
+      os << ": {";
+      os << "\"requests\": " << metrics.requestCount.load()
+         << ", \"failed\": " << metrics.failedRequestCount.load()
+         << ", \"refused\": " << metrics.refusedRequestCount.load();
+      os << ", \"queue_wait_us\": ";
+      metrics.queueWaitUs.dumpJSON(os);
+      os << ", \"device_time_us\": ";
+      metrics.deviceTimeUs.dumpJSON(os);
+      os << ", \"latency_us\": ";
+      metrics.latencyUs.dumpJSON(os);
+      os << "}";
+      first = false;
+    }
+  }
+  os << "}, \"devices\": {";
+  bool first = true;
+  for (const auto &device : devices_) {
+    const DeviceManager &manager = *device.second;
+    os << (first ? "" : ", ") << "\"" << device.first << "\": {";
+    os << "\"memory_used\": "
+       << manager.getMaximumMemory() - manager.getAvailableMemory()
+       << ", \"memory_max\": " << manager.getMaximumMemory()
+       << ", \"outstanding_requests\": " << manager.getOutstandingRequests()
+       << ", \"avg_execution_time_us\": "
+       << manager.getAverageExecutionTimeUs() << "}";
+    first = false;
+  }
+  os << "}}\n";
+}
+
+void HostManager::startMetricsDump(
+    std::chrono::milliseconds interval,
+    std::function<void(llvm::StringRef)> dumpCB) {
+  stopMetricsDump();
+  stopMetricsDump_ = false;
+  metricsDumpThread_ = std::thread([this, interval, dumpCB]() {
+    std::unique_lock<std::mutex> lock(metricsDumpMtx_);
+    while (!metricsDumpCV_.wait_for(lock, interval,
+                                    [this] { return stopMetricsDump_; })) {
+      std::string dump;
+      llvm::raw_string_ostream os(dump);
+      dumpMetrics(os);
+      dumpCB(os.str());
+    }
+  });
+}
+
+void HostManager::stopMetricsDump() {
+  if (!metricsDumpThread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(metricsDumpMtx_);
+    stopMetricsDump_ = true;
+  }
+  metricsDumpCV_.notify_all();
+  metricsDumpThread_.join();
+}
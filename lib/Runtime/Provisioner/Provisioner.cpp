@@ -19,6 +19,7 @@
 #include "glow/Backends/CompiledFunction.h"
 #include "glow/Graph/Graph.h"
 
+#include <algorithm>
 #include <future>
 #include <map>
 #include <queue>
@@ -47,9 +48,11 @@ auto sortMostMemory = [](const std::pair<DeviceIDTy, uint64_t> &a,
 Provisioner::Provisioner(DeviceManagerMapTy &devices) {
   for (auto &device : devices) {
     devices_.push_back(device.second.get());
+    auto backendKind = device.second->getBackendKind();
+    if (!backends_.count(backendKind)) {
+      backends_[backendKind].reset(createBackend(backendKind));
+    }
   }
-  auto backendKind = devices[0]->getBackendKind();
-  backend_.reset(createBackend(backendKind));
 }
 
 llvm::Error Provisioner::provision(DAGListTy &networks, Module &module) {
@@ -70,31 +73,62 @@ llvm::Error Provisioner::provision(DAGListTy &networks, Module &module) {
     }
   }
 
+  // Collect the functions that haven't been compiled before, grouped by their
+  // backend. If we have previously compiled a function reuse it.
+  std::map<BackendKind, std::vector<Function *>> functionsToCompile;
+  std::map<BackendKind, std::vector<DAGNode *>> nodesToCompile;
+  for (auto &device : logicalDevices) {
+    for (auto &node : device.second) {
+      RETURN_ERR_IF_NOT(node->backendKind == device.second[0]->backendKind,
+                        "The networks of a logical device must have the "
+                        "same backend");
+      auto &nodes = nodesToCompile[node->backendKind];
+      if (functions_.count(node->name) ||
+          std::find(nodes.begin(), nodes.end(), node) != nodes.end()) {
+        continue;
+      }
+      functionsToCompile[node->backendKind].push_back(
+          module.getFunction(node->name));
+      nodes.push_back(node);
+    }
+  }
+
+  // Compile the functions of each backend in parallel.
+  CompilationOptions compileOptions;
+  // Set collectConstants to false, this is because the DeviceManager will
+  // handle moving constants to the device, this way we can eliminate one
+  // copy operation.
+  compileOptions.collectConstants = false;
+  for (auto &backendNodes : nodesToCompile) {
+    auto backendIt = backends_.find(backendNodes.first);
+    RETURN_ERR_IF_NOT(backendIt != backends_.end(),
+                      "No device for the backend of a network");
+    auto compiledFunctions = backendIt->second->compileFunctions(
+        functionsToCompile[backendNodes.first], compileOptions);
+    for (size_t i = 0, e = backendNodes.second.size(); i < e; i++) {
+      auto *node = backendNodes.second[i];
+      node->runtimeBundle = llvm::make_unique<RuntimeBundle>(
+          compiledFunctions[i]->getRuntimeBundle());
+      functions_.emplace(node->name, std::move(compiledFunctions[i]));
+    }
+  }
+
   std::vector<std::pair<DeviceIDTy, uint64_t>> logicalDeviceSize;
   std::map<DeviceIDTy, FunctionMapTy> functionMaps;
-  // Compile functions and calculate required memory for each logical device.
+  // Calculate required memory for each logical device: the constants of its
+  // functions, and the memory of the largest run, since a device runs one
+  // function at a time. The device checks the exact size when it adds them.
   for (auto &device : logicalDevices) {
     uint64_t totalMemory = 0;
+    uint64_t runMemory = 0;
     FunctionMapTy functionMap;
     for (auto &node : device.second) {
-      // Only compile if we haven't compiled before. If we have previously
-      // compiled the function reuse it.
-      auto it = functions_.find(node->name);
-      if (it == functions_.end()) {
-        Function *function = module.getFunction(node->name);
-        CompilationOptions compileOptions;
-        // Set collectConstants to false, this is because the DeviceManager will
-        // handle moving constants to the device, this way we can eliminate one
-        // copy operation.
-        compileOptions.collectConstants = false;
-        auto compiled = backend_->compile(function, compileOptions);
-        node->runtimeBundle =
-            llvm::make_unique<RuntimeBundle>(compiled->getRuntimeBundle());
-        functions_.emplace(node->name, std::move(compiled));
-      }
       functionMap.emplace(node->name, functions_[node->name].get());
       totalMemory += node->runtimeBundle->getConstantWeightSize();
+      runMemory = std::max<uint64_t>(
+          runMemory, node->runtimeBundle->getRunMemorySize());
     }
+    totalMemory += runMemory;
     logicalDeviceSize.push_back(std::make_pair(device.first, totalMemory));
     functionMaps.emplace(device.first, functionMap);
   }
@@ -110,14 +144,27 @@ llvm::Error Provisioner::provision(DAGListTy &networks, Module &module) {
   // Sort by available memory in descending order.
   std::sort(deviceMemory.begin(), deviceMemory.end(), sortMostMemory);
 
-  // Try to add functions to devices in order from largest to smallest.
+  // Try to add functions to devices in order from largest to smallest. Every
+  // logical device goes to the free device of its backend with the most
+  // memory.
+  std::vector<bool> deviceUsed(devices_.size(), false);
   for (unsigned i = 0; i < logicalDeviceSize.size(); i++) {
-    RETURN_ERR_IF_NOT(logicalDeviceSize[i].second < deviceMemory[i].second,
+    DeviceIDTy logicalID = logicalDeviceSize[i].first;
+    BackendKind backendKind = logicalDevices[logicalID][0]->backendKind;
+    auto deviceIt = std::find_if(
+        deviceMemory.begin(), deviceMemory.end(),
+        [&](const std::pair<DeviceIDTy, uint64_t> &device) {
+          return !deviceUsed[device.first] &&
+                 devices_[device.first]->getBackendKind() == backendKind;
+        });
+    RETURN_ERR_IF_NOT(deviceIt != deviceMemory.end(),
+                      "Not enough devices to provision functions onto");
+    RETURN_ERR_IF_NOT(logicalDeviceSize[i].second < deviceIt->second,
                       "Not enough memory to provision functions onto devices");
+    deviceUsed[deviceIt->first] = true;
 
     // Load functions on device.
-    DeviceIDTy logicalID = logicalDeviceSize[i].first;
-    DeviceIDTy deviceID = deviceMemory[i].first;
+    DeviceIDTy deviceID = deviceIt->first;
     llvm::Error addErr = llvm::Error::success();
     std::promise<void> addPromise;
     auto ready = addPromise.get_future();
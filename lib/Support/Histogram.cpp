@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/Histogram.h"
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace glow {
+
+constexpr unsigned Histogram::kSubBucketBits;
+constexpr unsigned Histogram::kSubBuckets;
+constexpr unsigned Histogram::kNumBuckets;
+
+unsigned Histogram::getBucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return value;
+  }
+  // The position of the top bit selects the power of two range, and the next
+  // kSubBucketBits bits select the bucket inside of it.
+  unsigned topBit = llvm::Log2_64(value);
+  unsigned shift = topBit - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+}
+
+uint64_t Histogram::getBucketMaxValue(unsigned index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  unsigned shift = index / kSubBuckets - 1;
+  uint64_t lowest = uint64_t(kSubBuckets + index % kSubBuckets) << shift;
+  return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void Histogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::getMean() const {
+  uint64_t count = getCount();
+  return count ? double(getSum()) / count : 0;
+}
+
+uint64_t Histogram::getPercentile(double percentile) const {
+  // Take the total from the buckets rather than count_, so that it is
+  // consistent with the counts being walked even if samples are recorded
+  // concurrently.
+  std::array<uint64_t, kNumBuckets> counts;
+  uint64_t total = 0;
+  for (unsigned i = 0; i < kNumBuckets; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile / 100 * total)));
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < kNumBuckets; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      // The top of the bucket may exceed any sample that was recorded.
+      return std::min(getBucketMaxValue(i), getMax());
+    }
+  }
+  return getMax();
+}
+
+void Histogram::dumpJSON(llvm::raw_ostream &os) const {
+  os << "{\"count\": " << getCount() << ", \"mean\": ";
+  os << llvm::format("%.1f", getMean());
+  os << ", \"p50\": " << getPercentile(50) << ", \"p90\": "
+     << getPercentile(90) << ", \"p99\": " << getPercentile(99)
+     << ", \"p999\": " << getPercentile(99.9) << ", \"max\": " << getMax()
+     << "}";
+}
+
+} // namespace glow
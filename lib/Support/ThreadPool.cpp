@@ -15,12 +15,31 @@
  */
 #include "glow/Support/ThreadPool.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace glow {
 
-ThreadPool::ThreadPool(unsigned numWorkers) : shouldStop_(false) {
+ThreadPool::ThreadPool(unsigned numWorkers) : ThreadPool(numWorkers, nullptr) {}
+
+ThreadPool::ThreadPool(unsigned numWorkers, std::function<void()> initWorker)
+    : shouldStop_(false) {
   // Intialize all workers and make each one run threadPoolWorkerMain.
   for (unsigned i = 0; i < numWorkers; i++) {
-    std::thread th(std::bind(&ThreadPool::threadPoolWorkerMain, this));
+    std::thread th([this, initWorker]() {
+      if (initWorker) {
+        initWorker();
+      }
+      threadPoolWorkerMain();
+    });
     workers_.push_back(std::move(th));
   }
 }
@@ -90,4 +109,72 @@ void ThreadPool::threadPoolWorkerMain() {
     workItem();
   }
 }
+
+bool pinCurrentThread(const std::vector<unsigned> &cores) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (unsigned core : cores) {
+    if (core >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(core, &set);
+  }
+  return !cores.empty() &&
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool setCurrentThreadNUMANode(unsigned node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  // MPOL_PREFERRED from <linux/mempolicy.h>: allocate on the node, and fall
+  // back to the other nodes when it is full. The mask holds one long, and the
+  // kernel reads one bit less than the number of nodes it is given.
+  constexpr int mpolPreferred = 1;
+  constexpr unsigned long maskBits = sizeof(unsigned long) * 8;
+  if (node >= maskBits) {
+    return false;
+  }
+  unsigned long mask = 1UL << node;
+  return syscall(SYS_set_mempolicy, mpolPreferred, &mask, maskBits + 1) == 0;
+#else
+  return false;
+#endif
+}
+
+std::vector<unsigned> getNUMANodeCores(unsigned node) {
+  std::vector<unsigned> cores;
+#ifdef __linux__
+  // The list is made of comma-separated ranges, like "0-7,16-23".
+  std::string path =
+      "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+  FILE *file = fopen(path.c_str(), "r");
+  if (!file) {
+    return cores;
+  }
+  char buf[4096];
+  size_t len = fread(buf, 1, sizeof(buf) - 1, file);
+  fclose(file);
+  buf[len] = '\0';
+  char *pos = buf;
+  while (*pos >= '0' && *pos <= '9') {
+    unsigned first = strtoul(pos, &pos, 10);
+    unsigned last = first;
+    if (*pos == '-') {
+      last = strtoul(pos + 1, &pos, 10);
+    }
+    for (unsigned core = first; core <= last; core++) {
+      cores.push_back(core);
+    }
+    if (*pos != ',') {
+      break;
+    }
+    pos++;
+  }
+#endif
+  return cores;
+}
+
 } // namespace glow
@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <cstdlib>
 #include <random>
 
@@ -28,8 +29,32 @@ extern void libjit_convolution_f(float *outW, const float *inW, const float *fil
                      const size_t *biasWdims, const size_t *kernelSizes, 
                      const size_t *strides, const size_t *pads, 
                      size_t group, unsigned depthUnroll);
+extern void libjit_depthwise_conv_f(float *outW, const float *inW,
+                                    const float *filterW, const float *biasW,
+                                    const size_t *outWdims,
+                                    const size_t *inWdims,
+                                    const size_t *filterWdims,
+                                    const size_t *biasWdims,
+                                    const size_t *kernelSizes,
+                                    const size_t *strides, const size_t *pads);
+extern void libjit_group_conv_f(float *outW, const float *inW,
+                                const float *filterW, const float *biasW,
+                                const size_t *outWdims, const size_t *inWdims,
+                                const size_t *filterWdims,
+                                const size_t *biasWdims,
+                                const size_t *kernelSizes,
+                                const size_t *strides, const size_t *pads,
+                                size_t group);
 }
 
+/// The libjit kernel that a ConvBench runs.
+enum class ConvKernel {
+  /// The generic libjit_convolution_f.
+  Generic,
+  /// libjit_depthwise_conv_f or libjit_group_conv_f, depending on the groups.
+  Dedicated,
+};
+
 /// Benchmark a convolution with specified parameters on square inputs.
 class ConvBench : public Benchmark {
   /// Matrices
@@ -44,6 +69,8 @@ class ConvBench : public Benchmark {
   size_t inWdims[4];
   // [outputChannels, h, w, inputChannels]
   size_t filterWdims[4];
+  // The filter dimensions after the re-layout of the dedicated kernels.
+  size_t filterTdims[5];
 
   /// Parameters
   size_t kernelSizes[2];
@@ -51,13 +78,14 @@ class ConvBench : public Benchmark {
   size_t pads[2];
   size_t group;
   unsigned depthUnroll;
-
+  ConvKernel kernel;
 
 public:
   ConvBench(size_t inputBatch, size_t inputEdgeSize, size_t inputChannels, size_t filterMultiplier, 
-            size_t kernelSize, size_t stride, size_t pad, size_t group)
+            size_t kernelSize, size_t stride, size_t pad, size_t group,
+            ConvKernel kernel)
       : kernelSizes{kernelSize, kernelSize}, strides{stride, stride}, 
-      pads{pad, pad}, group(group) {
+      pads{pad, pad}, group(group), kernel(kernel) {
 
         inWdims[0] = inputBatch;  
         inWdims[1] = inputEdgeSize;
@@ -92,10 +120,26 @@ public:
     randomize(inSize, inW.data());
     randomize(filterSize, filterW.data());
     randomize(biasSize, biasW.data());
+
+    if (kernel == ConvKernel::Dedicated) {
+      relayoutFilter();
+    }
   }
 
   virtual void run() override {
-    // biasWDims isn't used in libjit_convolution_f, so we're passing NULL.
+    // biasWDims isn't used by the kernels, so we're passing NULL.
+    if (kernel == ConvKernel::Dedicated && group == inWdims[3]) {
+      libjit_depthwise_conv_f(outW.data(), inW.data(), filterW.data(),
+                              biasW.data(), outWdims, inWdims, filterTdims,
+                              NULL, kernelSizes, strides, pads);
+      return;
+    }
+    if (kernel == ConvKernel::Dedicated) {
+      libjit_group_conv_f(outW.data(), inW.data(), filterW.data(),
+                          biasW.data(), outWdims, inWdims, filterTdims, NULL,
+                          kernelSizes, strides, pads, group);
+      return;
+    }
     libjit_convolution_f(outW.data(), inW.data(), filterW.data(), biasW.data(), 
                          outWdims, inWdims, filterWdims, NULL, 
                          kernelSizes, strides, pads, group, depthUnroll);
@@ -104,6 +148,45 @@ public:
   virtual void teardown() override {}
 
 private:
+  /// Lay the filter out the way the CPU backend does for the dedicated
+  /// kernels at compile time: [1, K, K, D] for depthwise convolutions, and
+  /// [G * B, K, K, C, 8] with zero padded blocks of 8 output channels for the
+  /// other grouped convolutions.
+  void relayoutFilter() {
+    size_t K = kernelSizes[0];
+    size_t C = filterWdims[3];
+    std::vector<float> filterT;
+    if (group == inWdims[3]) {
+      size_t D = filterWdims[0];
+      filterT.resize(D * K * K);
+      for (size_t d = 0; d < D; d++) {
+        for (size_t k = 0; k < K * K; k++) {
+          filterT[k * D + d] = filterW[d * K * K + k];
+        }
+      }
+      size_t dims[] = {1, K, K, D, 0};
+      std::copy(dims, dims + 5, filterTdims);
+    } else {
+      size_t outCperG = filterWdims[0] / group;
+      size_t blocksPerGroup = (outCperG + 7) / 8;
+      filterT.assign(group * blocksPerGroup * K * K * C * 8, 0);
+      for (size_t g = 0; g < group; g++) {
+        for (size_t j = 0; j < outCperG; j++) {
+          size_t block = g * blocksPerGroup + j / 8;
+          for (size_t k = 0; k < K * K; k++) {
+            for (size_t c = 0; c < C; c++) {
+              filterT[((block * K * K + k) * C + c) * 8 + j % 8] =
+                  filterW[((g * outCperG + j) * K * K + k) * C + c];
+            }
+          }
+        }
+      }
+      size_t dims[] = {group * blocksPerGroup, K, K, C, 8};
+      std::copy(dims, dims + 5, filterTdims);
+    }
+    filterW.swap(filterT);
+  }
+
   size_t mapMult(size_t *vec, int size) {
     size_t result = 1;
     for (int i = 0; i < size; i++) {
@@ -123,7 +206,7 @@ private:
 
 int main() {
   constexpr int reps = 10;
-  printf("inputBatch, inputEdgeSize, inputChannels, filterMultiplier, kernelSize, stride, pad, group, bestInSeconds\n");
+  printf("inputBatch, inputEdgeSize, inputChannels, filterMultiplier, kernelSize, stride, pad, group, kernel, bestInSeconds\n");
 
   for (size_t inputBatch : {1, 3}) {
     for (size_t inputEdgeSize : {7, 56, 224}) {
@@ -134,15 +217,26 @@ int main() {
               size_t pad = kernelSize / 2;
               if ((inputEdgeSize + (pad * 2)) <= kernelSize)
                 continue;
-              for (size_t group : {1, 112}) {
+              // Grouped and depthwise (group == inputChannels) convolutions
+              // are run with both the generic and the dedicated kernel.
+              for (size_t group : {size_t(1), size_t(4), inputChannels}) {
                 if (inputChannels % group != 0)
                   continue;
-                ConvBench b(inputBatch, inputEdgeSize, inputChannels,
-                            filterMultiplier, kernelSize, stride, pad, group);
-                auto time = bench(&b, reps);
-                printf("%zu, %zu, %zu, %zu, %zu, %zu, %zu, %zu, %f\n",
-                       inputBatch, inputEdgeSize, inputChannels,
-                       filterMultiplier, kernelSize, stride, pad, group, time);
+                for (ConvKernel kernel :
+                     {ConvKernel::Generic, ConvKernel::Dedicated}) {
+                  if (group == 1 && kernel == ConvKernel::Dedicated)
+                    continue;
+                  ConvBench b(inputBatch, inputEdgeSize, inputChannels,
+                              filterMultiplier, kernelSize, stride, pad, group,
+                              kernel);
+                  auto time = bench(&b, reps);
+                  const char *kernelName =
+                      kernel == ConvKernel::Generic ? "generic" : "dedicated";
+                  printf("%zu, %zu, %zu, %zu, %zu, %zu, %zu, %zu, %s, %f\n",
+                         inputBatch, inputEdgeSize, inputChannels,
+                         filterMultiplier, kernelSize, stride, pad, group,
+                         kernelName, time);
+                } // kernel
               }   // group
             }     // stride
           }       // kernelSize
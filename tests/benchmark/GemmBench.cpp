@@ -24,7 +24,8 @@ extern "C" {
 // Forward declare functions from libjit.
 extern void libjit_matmul_f(float *c, const float *a, const float *b,
                             const size_t *cDims, const size_t *aDims,
-                            const size_t *bDims);
+                            const size_t *bDims, size_t mcBlock,
+                            size_t kcBlock);
 }
 
 /// Benchmark an (m x k) * (k x n) = (m x n) matrix multiplication.
@@ -56,7 +57,8 @@ public:
   }
 
   void run() override {
-    libjit_matmul_f(c.data(), a.data(), b.data(), cDims, aDims, bDims);
+    libjit_matmul_f(c.data(), a.data(), b.data(), cDims, aDims, bDims, 0,
+                    0);
   }
 
   void teardown() override {}
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Bench.h"
+
+using namespace glow;
+
+extern "C" {
+// Forward declare functions from libjit.
+extern void libjit_fused_rowwise_quantized_sparse_lengths_weighted_sum_f(
+    float *dest, int8_t *data, float *weights, size_t *indices,
+    int32_t *lengths, size_t segments, size_t inLineSize, size_t outLineSize);
+extern void libjit_fused_4bit_rowwise_quantized_sparse_lengths_weighted_sum_f(
+    float *dest, int8_t *data, float *weights, size_t *indices,
+    int32_t *lengths, size_t segments, size_t inLineSize, size_t outLineSize);
+}
+
+/// Benchmark a FusedRowwiseQuantizedSparseLengthsWeightedSum over a table of
+/// \p numRows embeddings of width \p dim, pooling \p batch segments of \p
+/// length random rows each. Embeddings are stored with \p bits (8 or 4) bits
+/// per element, followed by the fused float scale and offset.
+class SLWSBench : public Benchmark {
+  /// Fused table, pooled output and lookup inputs.
+  std::vector<int8_t> data;
+  std::vector<float> dest;
+  std::vector<float> weights;
+  std::vector<size_t> indices;
+  std::vector<int32_t> lengths;
+
+  size_t numRows;
+  size_t dim;
+  size_t batch;
+  size_t length;
+  size_t bits;
+
+public:
+  SLWSBench(size_t numRows, size_t dim, size_t batch, size_t length,
+            size_t bits)
+      : numRows(numRows), dim(dim), batch(batch), length(length), bits(bits) {}
+
+  /// \returns the size in bytes of a row of the fused table.
+  size_t inLineSize() const { return dim * bits / 8 + 2 * sizeof(float); }
+
+  void setup() override {
+    std::mt19937 gen;
+    std::uniform_int_distribution<> byteDis(0, 255);
+    std::uniform_int_distribution<size_t> rowDis(0, numRows - 1);
+    std::uniform_real_distribution<float> dis(-1.0, 1.0);
+
+    data.resize(numRows * inLineSize());
+    for (size_t i = 0; i < numRows; i++) {
+      int8_t *row = &data[i * inLineSize()];
+      for (size_t j = 0, e = inLineSize() - 2 * sizeof(float); j < e; j++) {
+        row[j] = byteDis(gen);
+      }
+      float scale = 0.01f;
+      float offset = dis(gen);
+      memcpy(row + inLineSize() - 2 * sizeof(float), &scale, sizeof(float));
+      memcpy(row + inLineSize() - sizeof(float), &offset, sizeof(float));
+    }
+    dest.resize(batch * dim);
+    weights.resize(batch * length);
+    indices.resize(batch * length);
+    lengths.assign(batch, length);
+    for (size_t i = 0, e = batch * length; i < e; i++) {
+      weights[i] = dis(gen);
+      indices[i] = rowDis(gen);
+    }
+  }
+
+  void run() override {
+    if (bits == 4) {
+      libjit_fused_4bit_rowwise_quantized_sparse_lengths_weighted_sum_f(
+          dest.data(), data.data(), weights.data(), indices.data(),
+          lengths.data(), batch, inLineSize(), dim);
+    } else {
+      libjit_fused_rowwise_quantized_sparse_lengths_weighted_sum_f(
+          dest.data(), data.data(), weights.data(), indices.data(),
+          lengths.data(), batch, inLineSize(), dim);
+    }
+  }
+
+  void teardown() override {}
+
+  /// \returns the number of gathered bytes per run.
+  double gatheredBytes() const {
+    return (double)batch * length * inLineSize();
+  }
+
+  /// \returns the number of row lookups per run.
+  double lookups() const { return (double)batch * length; }
+};
+
+int main() {
+  constexpr int reps = 50;
+  printf("bits, rows,     dim,  batch, length, GB/s,  Mlookups/s\n");
+
+  for (size_t bits : {8, 4}) {
+    for (size_t numRows : {1000, 1000000}) {
+      for (size_t dim : {32, 64, 128}) {
+        for (size_t batch : {1, 64, 256}) {
+          for (size_t length : {20, 100}) {
+            SLWSBench b(numRows, dim, batch, length, bits);
+            auto time = bench(&b, reps);
+            printf("%4zu, %-8zu, %4zu, %5zu, %6zu, %5.2lf, %7.2lf\n", bits,
+                   numRows, dim, batch, length, b.gatheredBytes() / time / 1e9,
+                   b.lookups() / time / 1e6);
+          }
+        }
+      }
+    }
+  }
+}
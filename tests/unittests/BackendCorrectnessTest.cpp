@@ -261,6 +261,72 @@ TEST_P(CPUOnly, dataParallelStackingTest) {
   EXPECT_EQ(H.at(1), 4);
 }
 
+TEST_P(CPUOnly, dataParallelFusionAcrossInstrsTest) {
+  // Interleave data-parallel instructions with non-data-parallel transposes.
+  // The backend keeps fusing data-parallel instructions into one kernel across
+  // a transpose only if the transpose does not access the memory the kernel
+  // writes, because the transpose is then executed before the whole kernel.
+  Module mod;
+  Function *F = mod.createFunction("DataParallelFusion");
+  auto M = llvm::make_unique<IRFunction>(F);
+
+  auto *var1 =
+      mod.createPlaceholder(glow::ElemKind::FloatTy, {2, 2}, "out1", false);
+  auto *var2 =
+      mod.createPlaceholder(glow::ElemKind::FloatTy, {2, 2}, "out2", false);
+  auto ctx = llvm::make_unique<ExecutionContext>();
+  auto *out1Tensor = ctx->getPlaceholderBindings()->allocate(var1);
+  auto *out2Tensor = ctx->getPlaceholderBindings()->allocate(var2);
+  {
+    // Scope the IRBuilder so the active allocations are properly deallocated at
+    // destruction.
+    IRBuilder bb(M.get());
+
+    auto *out1 = bb.createWeightVar(glow::ElemKind::FloatTy, {2, 2}, "out1",
+                                    WeightVar::MutabilityKind::Mutable);
+    auto *out2 = bb.createWeightVar(glow::ElemKind::FloatTy, {2, 2}, "out2",
+                                    WeightVar::MutabilityKind::Mutable);
+    M->getVariableMap()[var1] = out1;
+    M->getVariableMap()[var2] = out2;
+
+    auto *ty = mod.uniqueType(glow::ElemKind::FloatTy, {2, 2});
+    auto *a = bb.createAllocActivationInst("a", ty);
+    auto *b = bb.createAllocActivationInst("b", ty);
+    auto *c = bb.createAllocActivationInst("c", ty);
+    auto *t = bb.createAllocActivationInst("t", ty);
+    auto *u = bb.createAllocActivationInst("u", ty);
+    bb.createSplatInst("a", a, 1.0);
+    bb.createSplatInst("b", b, 2.0);
+    // Reads a, which the open kernel writes, so the kernel must run first.
+    bb.createTransposeInst("t", t, a, {1, 0});
+    bb.createElementAddInst("out1", out1, t, b);
+    bb.createSplatInst("c", c, 3.0);
+    // Only reads b, which the open kernel also only reads, so this transpose
+    // runs first and the kernel keeps growing.
+    bb.createTransposeInst("u", u, b, {1, 0});
+    bb.createElementAddInst("out2", out2, u, c);
+    bb.createDeallocActivationInst("dealloc_u", u);
+    bb.createDeallocActivationInst("dealloc_t", t);
+    bb.createDeallocActivationInst("dealloc_c", c);
+    bb.createDeallocActivationInst("dealloc_b", b);
+    bb.createDeallocActivationInst("dealloc_a", a);
+  }
+
+  MockCPUBackend backend;
+  auto function = backend.compileIR(std::move(M));
+  function->setupRuns();
+  function->beforeRun(*ctx->getPlaceholderBindings());
+  function->execute(ctx.get());
+  function->afterRun(*ctx->getPlaceholderBindings());
+  function->tearDownRuns();
+  auto H1 = out1Tensor->getHandle();
+  auto H2 = out2Tensor->getHandle();
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_EQ(H1.raw(i), 3);
+    EXPECT_EQ(H2.raw(i), 5);
+  }
+}
+
 TEST_P(CPUOnly, AvgPoolGradTest) {
   PseudoRNG PRNG;
   Tensor inputs(ElemKind::FloatTy, {5, 7, 6, 3});
@@ -360,6 +426,167 @@ TEST_P(CPUOnly, groupConvTest) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
+/// Depthwise convolution, handled by the libjit depthwise kernel. The number
+/// of channels is not a multiple of the SIMD width.
+TEST_P(CPUOnly, depthwiseConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 17, 15, 20});
+  Tensor kernel(ElemKind::FloatTy, {20, 3, 3, 1});
+  Tensor bias(ElemKind::FloatTy, {20});
+  inputs.getHandle().initXavier(1, PRNG);
+  kernel.getHandle().randomize(-3.0, 3.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  Tensor out1(ElemKind::FloatTy, {2, 9, 8, 20});
+  Tensor out2(ElemKind::FloatTy, {2, 9, 8, 20});
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 20,
+                      backendKind_);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 20,
+                      BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
+/// Depthwise convolution with a channel multiplier of 3.
+TEST_P(CPUOnly, depthwiseConvMultiplierTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {1, 12, 12, 8});
+  Tensor kernel(ElemKind::FloatTy, {24, 3, 3, 1});
+  Tensor bias(ElemKind::FloatTy, {24});
+  inputs.getHandle().initXavier(1, PRNG);
+  kernel.getHandle().randomize(-3.0, 3.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  Tensor out1(ElemKind::FloatTy, {1, 6, 6, 24});
+  Tensor out2(ElemKind::FloatTy, {1, 6, 6, 24});
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 8,
+                      backendKind_);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 8,
+                      BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
+TEST_P(CPUOnly, quantizedDepthwiseConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::Int8QTy, {2, 17, 15, 20}, 0.025, -7);
+  Tensor kernel(ElemKind::Int8QTy, {20, 3, 3, 1}, 0.003, 3);
+  Tensor bias(ElemKind::Int32QTy, {20}, 0.5, -4);
+  inputs.getHandle<int8_t>().randomize(-128, 127, PRNG);
+  kernel.getHandle<int8_t>().randomize(-128, 127, PRNG);
+  bias.getHandle<int32_t>().randomize(-11, 8, PRNG);
+  Tensor out1(ElemKind::Int8QTy, {2, 9, 8, 20}, 0.05, -17);
+  Tensor out2(ElemKind::Int8QTy, {2, 9, 8, 20}, 0.05, -17);
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 20,
+                      backendKind_);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 20,
+                      BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2, 1.0));
+}
+
+/// Depthwise convolution with a Constant filter, which is re-laid out at
+/// compile time.
+TEST_P(CPUOnly, depthwiseConvConstantFilterTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 17, 15, 20});
+  Tensor kernel(ElemKind::FloatTy, {20, 3, 3, 1});
+  Tensor bias(ElemKind::FloatTy, {20});
+  inputs.getHandle().initXavier(1, PRNG);
+  kernel.getHandle().randomize(-3.0, 3.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  Tensor out1(ElemKind::FloatTy, {2, 9, 8, 20});
+  Tensor out2(ElemKind::FloatTy, {2, 9, 8, 20});
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 20,
+                      backendKind_, /* constantFilter */ true);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 20,
+                      BackendKind::Interpreter, /* constantFilter */ true);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
+/// Grouped convolution with few channels per group, handled by the libjit
+/// grouped convolution kernel rather than by DKKC8.
+TEST_P(CPUOnly, smallGroupConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 11, 13, 12});
+  Tensor kernel(ElemKind::FloatTy, {36, 3, 3, 4});
+  Tensor bias(ElemKind::FloatTy, {36});
+  inputs.getHandle().initXavier(1, PRNG);
+  kernel.getHandle().randomize(-3.0, 3.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  Tensor out1(ElemKind::FloatTy, {2, 6, 7, 36});
+  Tensor out2(ElemKind::FloatTy, {2, 6, 7, 36});
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 3,
+                      backendKind_);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 3,
+                      BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
+/// Grouped convolution with a Constant filter. The 12 output channels of
+/// every group are padded to two blocks of 8 at compile time.
+TEST_P(CPUOnly, groupConvConstantFilterTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 11, 13, 12});
+  Tensor kernel(ElemKind::FloatTy, {36, 3, 3, 4});
+  Tensor bias(ElemKind::FloatTy, {36});
+  inputs.getHandle().initXavier(1, PRNG);
+  kernel.getHandle().randomize(-3.0, 3.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  Tensor out1(ElemKind::FloatTy, {2, 6, 7, 36});
+  Tensor out2(ElemKind::FloatTy, {2, 6, 7, 36});
+
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out1, 3, 2, 1, 3,
+                      backendKind_, /* constantFilter */ true);
+  inferGroupedConvNet(&inputs, &kernel, &bias, &out2, 3, 2, 1, 3,
+                      BackendKind::Interpreter, /* constantFilter */ true);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
+/// The CPU backend re-lays out the Constant filters of depthwise and grouped
+/// convolutions at compile time, so no layout transformation is left to run
+/// on every inference.
+TEST_P(CPUOnly, groupConvFilterLayoutIsFolded) {
+  ExecutionEngine EE(backendKind_);
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input =
+      mod.createPlaceholder(ElemKind::FloatTy, {1, 8, 8, 12}, "input", false);
+  auto *depthwiseFilter =
+      mod.createConstant(ElemKind::FloatTy, {12, 3, 3, 1}, "depthwiseFilter");
+  auto *depthwiseBias =
+      mod.createConstant(ElemKind::FloatTy, {12}, "depthwiseBias");
+  auto *groupFilter =
+      mod.createConstant(ElemKind::FloatTy, {36, 3, 3, 4}, "groupFilter");
+  auto *groupBias = mod.createConstant(ElemKind::FloatTy, {36}, "groupBias");
+  for (auto *C : {depthwiseFilter, depthwiseBias, groupFilter, groupBias}) {
+    C->getPayload().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  }
+
+  auto *depthwiseTy = mod.uniqueType(ElemKind::FloatTy, {1, 8, 8, 12});
+  auto *depthwise = F->createConv("depthwise", input, depthwiseFilter,
+                                  depthwiseBias, depthwiseTy, 3, 1, 1, 12);
+  auto *groupTy = mod.uniqueType(ElemKind::FloatTy, {1, 8, 8, 36});
+  auto *group = F->createConv("group", depthwise, groupFilter, groupBias,
+                              groupTy, 3, 1, 1, 3);
+  F->createSave("save", group);
+
+  EE.compile(CompilationMode::Infer, F);
+
+  for (auto &N : F->getNodes()) {
+    EXPECT_FALSE(llvm::isa<ConvolutionNode>(&N));
+    EXPECT_FALSE(llvm::isa<TransposeNode>(&N));
+    EXPECT_FALSE(llvm::isa<ReshapeNode>(&N));
+    EXPECT_FALSE(llvm::isa<ConcatNode>(&N));
+  }
+}
+
 /// This test targets the DKKC8 optimization.
 TEST_P(CPUOnly, nonSquarePaddingConvTest) {
   Tensor out1;
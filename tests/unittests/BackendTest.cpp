@@ -24,9 +24,13 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 
 using namespace glow;
 
+extern llvm::cl::opt<unsigned> interpreterThreads;
+
 class BackendTest : public ::testing::TestWithParam<BackendKind> {
 public:
   ExecutionEngine EE_{GetParam()};
@@ -106,6 +110,43 @@ TEST(Interpreter, profileQuantizationForANetwork) {
   EXPECT_NEAR(1.6, max, 0.00001);
 }
 
+/// Check that the Interpreter computes the same results when it executes the
+/// independent instructions of a wide network concurrently.
+TEST(Interpreter, parallelExecution) {
+  ExecutionEngine EE;
+  PlaceholderBindings ctx;
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+
+  auto *A = mod.createPlaceholder(ElemKind::FloatTy, {8, 16}, "A", false);
+  ctx.allocate(A)->getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  std::vector<NodeValue> towers;
+  for (unsigned i = 0; i < 4; i++) {
+    Node *O = F->createFullyConnected(ctx, "fc1", A, 16);
+    O = F->createTanh("tanh", O);
+    O = F->createFullyConnected(ctx, "fc2", O, 16);
+    O = F->createSigmoid("sigmoid", O);
+    towers.push_back(O);
+  }
+  auto *save = F->createSave("save", F->createConcat("concat", towers, 1));
+  auto *result = ctx.allocate(save->getPlaceholder());
+
+  EE.compile(CompilationMode::Infer, F);
+
+  unsigned oldThreads = interpreterThreads;
+  interpreterThreads = 1;
+  EE.run(ctx);
+  Tensor expected = result->clone();
+
+  interpreterThreads = 4;
+  for (unsigned i = 0; i < 10; i++) {
+    result->zero();
+    EE.run(ctx);
+    EXPECT_TRUE(result->isEqual(expected, 0.0));
+  }
+  interpreterThreads = oldThreads;
+}
+
 /// Test that the symbol category for a symbol is properly set.
 TEST(RuntimeBundle, BundleSymbolInfo) {
   Module mod;
@@ -304,6 +345,75 @@ TEST_P(BackendTest, BundleSharedConstant) {
   EXPECT_TRUE(it2 != table2.end());
 }
 
+#ifdef GLOW_WITH_CPU
+extern llvm::cl::opt<bool> bundleCompressWeights;
+
+/// Test saving a bundle with compressed weights for a rowwise quantized
+/// FullyConnected with 1024 output channels. Its float scales are large enough
+/// to be compressed, but IRGen looks them up as a Constant, so they must be
+/// left alone. The weights of the float FullyConnected are compressed, and the
+/// Module is not changed by the save.
+TEST(CPUBackend, SaveCompressedBundleWithRowwiseQuantizedFC) {
+  ExecutionEngine EE{BackendKind::CPU};
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input =
+      mod.createPlaceholder(ElemKind::FloatTy, {1, 16}, "input", false);
+
+  auto *W = mod.createConstant(ElemKind::FloatTy, {16, 64}, "W");
+  auto *B = mod.createConstant(ElemKind::FloatTy, {64}, "B");
+  W->getPayloadMutable().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  B->getPayloadMutable().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  auto *FC = F->createFullyConnected("fc", input, W, B);
+  F->createSave("saveFC", FC);
+
+  auto *qW = mod.createConstant(ElemKind::FloatTy, {1024, 16}, "qW");
+  auto *qB = mod.createConstant(ElemKind::Int32QTy, {1024}, 0.01, 0, "qB");
+  qW->getPayloadMutable().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  qB->getPayloadMutable().getHandle<int32_t>().randomize(-100, 100,
+                                                          mod.getPRNG());
+  auto *qInput = F->createQuantize(
+      "quantize", input, mod.uniqueType(ElemKind::Int8QTy, {1, 16}, 0.01, 0));
+  auto *RWQFC = F->createRowwiseQuantizedFullyConnected(
+      "rwqfc", qInput, qW, qB,
+      mod.uniqueType(ElemKind::Int8QTy, {1, 1024}, 0.1, 0),
+      quantization::Schema::Asymmetric);
+  auto *DQ = F->createDequantize("dequantize", RWQFC);
+  F->createSave("saveRWQFC", DQ);
+
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("bundle", dir));
+  llvm::SmallString<128> compressedDir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("bundle", compressedDir));
+
+  CompilationOptions opts;
+  opts.mode = CompilationMode::Infer;
+  EE.save(F, opts, dir, "network");
+  size_t numNodes = F->getNodes().size();
+  size_t numConstants = mod.getConstants().size();
+  size_t numFunctions = mod.getFunctions().size();
+
+  bundleCompressWeights = true;
+  EE.save(F, opts, compressedDir, "network");
+  bundleCompressWeights = false;
+
+  EXPECT_EQ(F->getNodes().size(), numNodes);
+  EXPECT_EQ(mod.getConstants().size(), numConstants);
+  EXPECT_EQ(mod.getFunctions().size(), numFunctions);
+
+  uint64_t weightsSize;
+  uint64_t compressedWeightsSize;
+  ASSERT_FALSE(llvm::sys::fs::file_size(llvm::Twine(dir) + "/network.weights",
+                                        weightsSize));
+  ASSERT_FALSE(llvm::sys::fs::file_size(
+      llvm::Twine(compressedDir) + "/network.weights", compressedWeightsSize));
+  EXPECT_LT(compressedWeightsSize, weightsSize);
+
+  llvm::sys::fs::remove_directories(dir);
+  llvm::sys::fs::remove_directories(compressedDir);
+}
+#endif // GLOW_WITH_CPU
+
 /// Test compiling a vector of functions completes without error.
 TEST_P(BackendTest, compileVectorOfFunctions) {
   Module mod;
@@ -321,6 +431,59 @@ TEST_P(BackendTest, compileVectorOfFunctions) {
   auto function = backend->compileFunctions(functions, opts);
 }
 
+/// Test that Functions that share Constants and Placeholders compute the same
+/// results when they are compiled in parallel.
+TEST_P(BackendTest, compileFunctionsInParallel) {
+  auto &mod = EE_.getModule();
+  PlaceholderBindings bindings;
+  auto *X = mod.createPlaceholder(ElemKind::FloatTy, {4, 8}, "X", false);
+  bindings.allocate(X)->getHandle().randomize(-1, 1, mod.getPRNG());
+  auto *W = mod.createConstant(ElemKind::FloatTy, {8, 8}, "W");
+  W->getPayload().getHandle().randomize(-1, 1, mod.getPRNG());
+
+  constexpr unsigned numFunctions = 8;
+  std::vector<Function *> functions;
+  std::vector<Placeholder *> outputs;
+  for (unsigned i = 0; i < numFunctions; i++) {
+    Function *F = mod.createFunction("function" + std::to_string(i));
+    NodeValue V = X;
+    for (unsigned j = 0; j <= i; j++) {
+      V = F->createMatMul("matmul", V, W);
+      V = F->createTanh("tanh", V);
+    }
+    outputs.push_back(F->createSave("save", V)->getPlaceholder());
+    functions.push_back(F);
+  }
+  bindings.allocate(mod.getPlaceholders());
+
+  CompilationOptions opts;
+  opts.maxCompileThreads = 4;
+  EE_.compile(functions, opts);
+
+  // Function i applies i + 1 layers, so its result is the result of layer i.
+  Tensor expected(ElemKind::FloatTy, {4, 8});
+  expected.assign(bindings.get(X));
+  for (unsigned i = 0; i < numFunctions; i++) {
+    EE_.run(bindings, functions[i]->getName());
+    Tensor next(ElemKind::FloatTy, {4, 8});
+    next.getHandle().clear(0);
+    auto EH = expected.getHandle();
+    auto WH = W->getPayload().getHandle();
+    auto NH = next.getHandle();
+    for (size_t r = 0; r < 4; r++) {
+      for (size_t c = 0; c < 8; c++) {
+        float sum = 0;
+        for (size_t k = 0; k < 8; k++) {
+          sum += EH.at({r, k}) * WH.at({k, c});
+        }
+        NH.at({r, c}) = std::tanh(sum);
+      }
+    }
+    expected.assign(&next);
+    EXPECT_TRUE(bindings.get(outputs[i])->isEqual(expected, 0.001));
+  }
+}
+
 /// This test checks that we can compile a function without depending on the
 /// graph representation. We compile some function and then delete the function.
 /// Later we execute the code and check that things work.
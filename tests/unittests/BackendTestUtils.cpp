@@ -79,7 +79,8 @@ static void profileAndQuantize(PlaceholderBindings &Ibindings,
                                ElemKind interpElemKind,
                                ElemKind backendElemKind,
                                quantization::Schema schema,
-                               bool enableRowwiseQuantization) {
+                               bool enableRowwiseQuantization,
+                               bool enableChannelwiseQuantization) {
   // Lower everything for profiling in a cloned PF, keeping track of lowered
   // info in loweredMap, which is then used when generating QI.
   Function *PF = IF->clone("profile");
@@ -89,6 +90,7 @@ static void profileAndQuantize(PlaceholderBindings &Ibindings,
       profileAndGetNodeQuantizationInfo(Ibindings, IEE, PF, loweredMapForProf,
                                         schema)};
   quantConfig.enableRowwise = enableRowwiseQuantization;
+  quantConfig.enableChannelwise = enableChannelwiseQuantization;
   quantConfig.schema = schema;
   quantConfig.assertAllNodesQuantized = true;
 
@@ -117,7 +119,8 @@ void compareAgainstInterpreter(BackendKind backendKind,
                                ElemKind interpElemKind,
                                ElemKind backendElemKind, float allowedError,
                                bool enableRowwiseQuantization,
-                               quantization::Schema schema) {
+                               quantization::Schema schema,
+                               bool enableChannelwiseQuantization) {
   ExecutionEngine IEE{BackendKind::Interpreter};
   ExecutionEngine BEE{backendKind};
   PlaceholderBindings Ibindings, Bbindings;
@@ -135,7 +138,8 @@ void compareAgainstInterpreter(BackendKind backendKind,
                             isQuantizedElemKind(backendElemKind);
   if (profAndQuant) {
     profileAndQuantize(Ibindings, IEE, BEE, IF, BF, interpElemKind,
-                       backendElemKind, schema, enableRowwiseQuantization);
+                       backendElemKind, schema, enableRowwiseQuantization,
+                       enableChannelwiseQuantization);
   }
 
   if (interpElemKind == ElemKind::Float16Ty) {
@@ -186,6 +190,12 @@ void inferIntLookupTableNet(Tensor *input, Tensor *out,
 
 void inferConvNet(Tensor *inputs, Tensor *filter, Tensor *bias, Tensor *out,
                   BackendKind kind) {
+  inferGroupedConvNet(inputs, filter, bias, out, 5, 3, 4, 1, kind);
+}
+
+void inferGroupedConvNet(Tensor *inputs, Tensor *filter, Tensor *bias,
+                         Tensor *out, size_t kernel, size_t stride, size_t pad,
+                         size_t group, BackendKind kind, bool constantFilter) {
   PlaceholderBindings bindings;
   ExecutionEngine EE(kind);
   auto &mod = EE.getModule();
@@ -216,7 +226,14 @@ void inferConvNet(Tensor *inputs, Tensor *filter, Tensor *bias, Tensor *out,
     outP = createPlaceholder(mod, bindings, out, "outP");
     OT = F->getParent()->uniqueType(out->getElementType(), out->dims());
   }
-  auto *conv = F->createConv("conv", inputP, filterP, biasP, OT, 5, 3, 4, 1);
+  NodeValue filterV = filterP;
+  if (constantFilter) {
+    auto *filterC = mod.createConstant(filterP->getType(), "filterC");
+    filterC->getPayload().copyRawFrom(filter);
+    filterV = filterC;
+  }
+  auto *conv = F->createConv("conv", inputP, filterV, biasP, OT, kernel, stride,
+                             pad, group);
   auto *result = F->createSave("ret", conv, outP);
   auto *resultTensor = bindings.get(result->getPlaceholder());
 
@@ -202,16 +202,25 @@ using CreateAndInitFunction =
 /// Function it will be converted using the Converter. If
 /// \p enableRowwiseQuantization then rowwise quantization will be used for
 /// nodes that support it. \p schema represents the quantization schema to use,
-/// if applicable.
+/// if applicable. If \p enableChannelwiseQuantization then channelwise
+/// quantization will be used for convolutions.
 void compareAgainstInterpreter(
     BackendKind backendKind, CreateAndInitFunction createAndInitFunction,
     ElemKind interpElemKind, ElemKind backendElemKind,
     float allowedError = 0.0001, bool enableRowwiseQuantization = false,
-    quantization::Schema schema = quantization::Schema::Asymmetric);
+    quantization::Schema schema = quantization::Schema::Asymmetric,
+    bool enableChannelwiseQuantization = false);
 
 void inferConvNet(Tensor *inputs, Tensor *filter, Tensor *bias, Tensor *out,
                   BackendKind kind);
 
+/// Run a convolution with the given parameters on \p kind. The filter is a
+/// Constant if \p constantFilter, and otherwise a Placeholder.
+void inferGroupedConvNet(Tensor *inputs, Tensor *filter, Tensor *bias,
+                         Tensor *out, size_t kernel, size_t stride, size_t pad,
+                         size_t group, BackendKind kind,
+                         bool constantFilter = false);
+
 void trainConvNet(Tensor *inputs, Tensor *kernel1, Tensor *bias1,
                   Tensor *kernel2, Tensor *bias2, Tensor *selected,
                   llvm::ArrayRef<size_t> shape1, llvm::ArrayRef<size_t> shape2,
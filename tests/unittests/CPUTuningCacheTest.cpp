@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CPUBackend.h"
+#include "CPUTuningCache.h"
+
+#include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
+#include "glow/ExecutionEngine/ExecutionEngine.h"
+#include "glow/Graph/Graph.h"
+#include "glow/Support/Random.h"
+
+#include "gtest/gtest.h"
+
+#include "llvm/Support/FileSystem.h"
+
+#include <thread>
+
+using namespace glow;
+
+/// Check that tilings survive a round trip through a cache file, and that
+/// entries the kernels can't run are ignored.
+TEST(CPUTuningCache, saveAndLoad) {
+  CPUTuningCache cache;
+  cache.insert("convDKKC8_f_a", ConvDKKC8Tiling{0, 4, 3, 2});
+  cache.insert("matmul_f_b", MatMulTiling{128, 64});
+  cache.insert("convDKKC8_f_bad", ConvDKKC8Tiling{0, 3, 1, 1});
+  cache.insert("matmul_f_bad", MatMulTiling{1024, 1024});
+
+  llvm::SmallString<64> path;
+  llvm::sys::fs::createTemporaryFile("tuning", "txt", path);
+  ASSERT_TRUE(cache.save(path));
+  CPUTuningCache loaded;
+  ASSERT_TRUE(loaded.load(path));
+  llvm::sys::fs::remove(path);
+  EXPECT_EQ(loaded.size(), 4);
+
+  ConvDKKC8Tiling conv;
+  ASSERT_TRUE(loaded.lookup("convDKKC8_f_a", conv));
+  EXPECT_EQ(conv.pixelScanFirst, 0);
+  EXPECT_EQ(conv.numDepthRegs, 4);
+  EXPECT_EQ(conv.sizeGroupY, 3);
+  EXPECT_EQ(conv.depthStrips, 2);
+  MatMulTiling matmul;
+  ASSERT_TRUE(loaded.lookup("matmul_f_b", matmul));
+  EXPECT_EQ(matmul.mcBlock, 128);
+  EXPECT_EQ(matmul.kcBlock, 64);
+
+  EXPECT_FALSE(loaded.lookup("convDKKC8_f_bad", conv));
+  EXPECT_FALSE(loaded.lookup("matmul_f_bad", matmul));
+  EXPECT_FALSE(loaded.lookup("matmul_f_b", conv));
+  EXPECT_FALSE(loaded.lookup("matmul_f_missing", matmul));
+}
+
+/// Check that concurrent saves of different caches to one file leave one
+/// complete cache in it.
+TEST(CPUTuningCache, concurrentSaves) {
+  constexpr unsigned numCaches = 4;
+  constexpr unsigned numEntries = 100;
+  std::vector<CPUTuningCache> caches(numCaches);
+  for (unsigned c = 0; c < numCaches; c++) {
+    for (unsigned e = 0; e < numEntries; e++) {
+      caches[c].insert("matmul_f_" + std::to_string(c) + "_" +
+                           std::to_string(e),
+                       MatMulTiling{128, 64});
+    }
+  }
+
+  llvm::SmallString<64> path;
+  llvm::sys::fs::createTemporaryFile("tuning", "txt", path);
+  std::vector<std::thread> threads;
+  for (unsigned c = 0; c < numCaches; c++) {
+    threads.emplace_back([&caches, &path, c]() {
+      for (unsigned i = 0; i < 10; i++) {
+        EXPECT_TRUE(caches[c].save(path));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  CPUTuningCache loaded;
+  ASSERT_TRUE(loaded.load(path));
+  llvm::sys::fs::remove(path);
+  EXPECT_EQ(loaded.size(), numEntries);
+}
+
+/// Tune a matrix multiplication, and check that the code generated with the
+/// tuned tiling computes the same result as the Interpreter.
+TEST(CPUTuningCache, autotuneMatMul) {
+  ExecutionEngine EE(BackendKind::Interpreter);
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *lhs = mod.createPlaceholder(ElemKind::FloatTy, {40, 300}, "lhs",
+                                    /* isTrainable */ false);
+  auto *rhs = mod.createPlaceholder(ElemKind::FloatTy, {300, 1100}, "rhs",
+                                    /* isTrainable */ false);
+  auto *matmul = F->createMatMul("matmul", lhs, rhs);
+  auto *save = F->createSave("save", matmul);
+
+  CPUTuningCache cache;
+  EXPECT_EQ(autotuneCPUKernels(F, cache), 1);
+  MatMulTiling tiling;
+  EXPECT_TRUE(cache.lookup(CPUTuningCache::getKey(matmul), tiling));
+  // Shapes that are in the cache are not tuned again.
+  EXPECT_EQ(autotuneCPUKernels(F, cache), 0);
+
+  PseudoRNG PRNG;
+  ExecutionContext context;
+  auto *bindings = context.getPlaceholderBindings();
+  bindings->allocate(lhs)->getHandle().randomize(-1.0, 1.0, PRNG);
+  bindings->allocate(rhs)->getHandle().randomize(-1.0, 1.0, PRNG);
+  auto *result = bindings->allocate(save->getPlaceholder());
+
+  CPUBackend backend(&cache);
+  CompilationOptions opts;
+  auto function = backend.compile(F, opts);
+  function->setupRuns();
+  function->beforeRun(*bindings);
+  function->execute(&context);
+  function->afterRun(*bindings);
+  function->tearDownRuns();
+  Tensor tuned = result->clone();
+
+  EE.compile(CompilationMode::Infer, F);
+  EE.run(*bindings);
+  EXPECT_TRUE(tuned.isEqual(*result, 0.001));
+}
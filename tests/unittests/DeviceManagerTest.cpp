@@ -215,6 +215,11 @@ TEST_P(DeviceManagerTest, MultiRun) {
   EXPECT_TRUE(result1->isEqual(output1));
   EXPECT_TRUE(result2->isEqual(output2));
 
+  // Both requests are accounted as finished before their callbacks run.
+  EXPECT_EQ(device->getOutstandingRequests(), 0);
+  EXPECT_EQ(device->getExpectedLatencyUs(),
+            device->getAverageExecutionTimeUs());
+
   EXPECT_FALSE(errToBool(device->stop()));
   delete device;
 }
@@ -499,28 +504,185 @@ TEST_P(DeviceManagerTest, ReuseModule) {
   delete device;
 }
 
+/// Run two functions of different sizes many times, with all runs in flight
+/// at once. On OpenCL the runs share pooled command queues and staging
+/// buffers of different sizes, and every run must still get its own results.
+TEST_P(DeviceManagerTest, ManyRunsInFlight) {
+  auto module = llvm::make_unique<Module>();
+  const size_t sizes[] = {4, 256};
+  for (size_t size : sizes) {
+    std::string name = "pow_" + std::to_string(size);
+    Function *F = module->createFunction(name);
+    auto *input = module->createPlaceholder(ElemKind::FloatTy, {size},
+                                            name + "_input", false);
+    auto *output = module->createPlaceholder(ElemKind::FloatTy, {size},
+                                             name + "_output", false);
+    auto *p = F->createPow("pow2", input, 2.0f);
+    F->createSave("ret", p, output);
+  }
+
+  std::vector<std::unique_ptr<CompiledFunction>> backing;
+  FunctionMapTy functions =
+      compileFunctions(backendKind, module.get(), backing);
+  auto *device = DeviceManager::createDeviceManager(backendKind);
+  ASSERT_FALSE(errToBool(device->init()));
+
+  std::promise<const Module *> promise;
+  std::future<const Module *> future;
+  std::tie(promise, future) = getFutureHelper<const Module *>();
+  device->addNetwork(module.get(), std::move(functions),
+                     [&promise](const Module *module, llvm::Error err) {
+                       callbackHelper(promise, module, std::move(err));
+                     });
+  future.wait_for(std::chrono::seconds(2));
+  EXPECT_EQ(future.get(), module.get());
+
+  constexpr unsigned numRuns = 32;
+  std::vector<std::promise<std::unique_ptr<ExecutionContext>>> runPromises(
+      numRuns);
+  std::vector<std::future<std::unique_ptr<ExecutionContext>>> runFutures;
+  for (unsigned i = 0; i < numRuns; i++) {
+    std::string name = "pow_" + std::to_string(sizes[i % 2]);
+    auto *input = module->getPlaceholderByName(name + "_input");
+    std::unique_ptr<ExecutionContext> context =
+        llvm::make_unique<ExecutionContext>();
+    context->getPlaceholderBindings()->allocate(module->getPlaceholders());
+    Tensor inputT(ElemKind::FloatTy, input->dims());
+    inputT.getHandle().clear(i);
+    updateInputPlaceholders(*context->getPlaceholderBindings(), {input},
+                            {&inputT});
+
+    runFutures.push_back(runPromises[i].get_future());
+    device->runFunction(
+        name, std::move(context),
+        [runPromise = &runPromises[i]](
+            RunIdentifierTy, llvm::Error err,
+            std::unique_ptr<ExecutionContext> context) {
+          callbackHelper(*runPromise, std::move(context), std::move(err));
+        });
+  }
+
+  for (unsigned i = 0; i < numRuns; i++) {
+    std::string name = "pow_" + std::to_string(sizes[i % 2]);
+    auto context = runFutures[i].get();
+    ASSERT_TRUE(context);
+    Tensor *result = context->getPlaceholderBindings()->get(
+        module->getPlaceholderByName(name + "_output"));
+    ASSERT_TRUE(result);
+    Tensor expected(ElemKind::FloatTy, result->dims());
+    expected.getHandle().clear(i * i);
+    EXPECT_TRUE(result->isEqual(expected));
+  }
+
+  EXPECT_FALSE(errToBool(device->stop()));
+  delete device;
+}
+
+/// One compiled function can be added to several devices. Every device must
+/// use the constants that were collected when the function was compiled, so
+/// one device must not free them while another device still needs them.
+TEST_P(DeviceManagerTest, AddFunctionToTwoDevices) {
+  auto module = llvm::make_unique<Module>();
+  Function *F = module->createFunction("main");
+  auto *input =
+      module->createPlaceholder(ElemKind::FloatTy, {4}, "main_input", false);
+  auto *output =
+      module->createPlaceholder(ElemKind::FloatTy, {4}, "main_output", false);
+  auto *weights = module->createConstant(ElemKind::FloatTy, {4}, "weights");
+  weights->getPayload().getHandle() = {1, 2, 3, 4};
+  auto *mul = F->createMul("mul", input, weights);
+  F->createSave("ret", mul, output);
+
+  std::vector<std::unique_ptr<CompiledFunction>> backing;
+  FunctionMapTy functions =
+      compileFunctions(backendKind, module.get(), backing);
+  ASSERT_TRUE(backing[0]->getRuntimeBundle().getConstants());
+
+  // Change the copy of the weights in the module, as if it had been released
+  // after compilation. A device that collects the constants from the module
+  // again computes the wrong result.
+  weights->getPayload().getHandle().clear(0);
+
+  Tensor inputT(ElemKind::FloatTy, {4});
+  inputT.getHandle() = {2, 2, 2, 2};
+  Tensor expected(ElemKind::FloatTy, {4});
+  expected.getHandle() = {2, 4, 6, 8};
+
+  std::vector<std::unique_ptr<DeviceManager>> devices;
+  for (unsigned i = 0; i < 2; i++) {
+    devices.emplace_back(DeviceManager::createDeviceManager(backendKind));
+    auto *device = devices.back().get();
+    ASSERT_FALSE(errToBool(device->init()));
+
+    std::promise<const Module *> promise;
+    std::future<const Module *> future;
+    std::tie(promise, future) = getFutureHelper<const Module *>();
+    device->addNetwork(module.get(), functions,
+                       [&promise](const Module *module, llvm::Error err) {
+                         callbackHelper(promise, module, std::move(err));
+                       });
+    future.wait_for(std::chrono::seconds(2));
+    EXPECT_EQ(future.get(), module.get());
+  }
+
+  // Run on the devices in the reverse order in which they got the function.
+  for (auto it = devices.rbegin(); it != devices.rend(); ++it) {
+    std::unique_ptr<ExecutionContext> context =
+        llvm::make_unique<ExecutionContext>();
+    context->getPlaceholderBindings()->allocate(module->getPlaceholders());
+    updateInputPlaceholders(*context->getPlaceholderBindings(), {input},
+                            {&inputT});
+
+    std::promise<std::unique_ptr<ExecutionContext>> runPromise;
+    std::future<std::unique_ptr<ExecutionContext>> runFuture;
+    std::tie(runPromise, runFuture) =
+        getFutureHelper<std::unique_ptr<ExecutionContext>>();
+    (*it)->runFunction(
+        "main", std::move(context),
+        [&runPromise](RunIdentifierTy, llvm::Error err,
+                      std::unique_ptr<ExecutionContext> context) {
+          callbackHelper(runPromise, std::move(context), std::move(err));
+        });
+
+    runFuture.wait_for(std::chrono::seconds(2));
+    context = runFuture.get();
+    ASSERT_TRUE(context);
+    Tensor *result = context->getPlaceholderBindings()->get(output);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result->isEqual(expected));
+  }
+
+  for (auto &device : devices) {
+    EXPECT_FALSE(errToBool(device->stop()));
+  }
+}
+
 #ifdef GLOW_WITH_CPU
 
 TEST(DeviceManagerTest, AvailableMemory) {
   std::vector<std::unique_ptr<CompiledFunction>> backing;
   std::promise<const Module *> promise;
   std::future<const Module *> future;
-  CPUDeviceManager cpuCoreDevice(nullptr, 1);
+
+  // The device fits exactly the buffers of one run of the basic module.
+  auto module = makeBasicModule();
+  FunctionMapTy functions =
+      compileFunctions(BackendKind::CPU, module.get(), backing);
+  uint64_t expectedBytes = backing[0]->getRuntimeBundle().getRunMemorySize();
+  ASSERT_GT(expectedBytes, 0);
+  CPUDeviceManager cpuCoreDevice(nullptr, expectedBytes);
   ASSERT_FALSE(errToBool(cpuCoreDevice.init()));
 
-  uint64_t expectedBytes = 1;
   EXPECT_EQ(cpuCoreDevice.getMaximumMemory(), expectedBytes);
   EXPECT_EQ(cpuCoreDevice.getAvailableMemory(), expectedBytes);
   EXPECT_TRUE(cpuCoreDevice.isMemoryAvailable(expectedBytes));
   EXPECT_FALSE(cpuCoreDevice.isMemoryAvailable(expectedBytes + 1));
 
-  auto module = makeBasicModule();
   std::tie(promise, future) = getFutureHelper<const Module *>();
-  cpuCoreDevice.addNetwork(
-      module.get(), compileFunctions(BackendKind::CPU, module.get(), backing),
-      [&promise](const Module *module, llvm::Error err) {
-        callbackHelper(promise, module, std::move(err));
-      });
+  cpuCoreDevice.addNetwork(module.get(), std::move(functions),
+                           [&promise](const Module *module, llvm::Error err) {
+                             callbackHelper(promise, module, std::move(err));
+                           });
 
   future.wait_for(std::chrono::seconds(2));
   EXPECT_EQ(future.get(), module.get());
@@ -530,8 +692,13 @@ TEST(DeviceManagerTest, AvailableMemory) {
   EXPECT_FALSE(cpuCoreDevice.isMemoryAvailable(expectedBytes));
   EXPECT_FALSE(cpuCoreDevice.isMemoryAvailable(1));
 
-  // Let's try again.
-  auto module2 = makeBasicModule();
+  // Let's try again with a network that also has weights.
+  auto module2 = makeBasicModule("main2");
+  auto *weights = module2->createConstant(ElemKind::FloatTy, {1}, "weights");
+  weights->getPayload().getHandle().clear(3);
+  auto *output = module2->createPlaceholder(ElemKind::FloatTy, {1},
+                                            "main2_weights", false);
+  module2->getFunction("main2")->createSave("save_weights", weights, output);
   std::tie(promise, future) = getFutureHelper<const Module *>();
   cpuCoreDevice.addNetwork(
       module2.get(), compileFunctions(BackendKind::CPU, module2.get(), backing),
@@ -545,6 +712,7 @@ TEST(DeviceManagerTest, AvailableMemory) {
   EXPECT_NE(resultModule, module.get());
   EXPECT_EQ(resultModule, nullptr);
 
+  // The failed network left nothing on the device.
   EXPECT_EQ(cpuCoreDevice.getMaximumMemory(), expectedBytes);
   EXPECT_EQ(cpuCoreDevice.getAvailableMemory(), 0);
 
@@ -558,17 +726,19 @@ TEST(DeviceManagerTest, AvailableMemory) {
       });
   evictFuture.wait_for(std::chrono::seconds(2));
   EXPECT_EQ(evictFuture.get(), "main");
+  EXPECT_EQ(cpuCoreDevice.getAvailableMemory(), expectedBytes);
 
   // And try again, this time with available space.
+  auto module3 = makeBasicModule();
   std::tie(promise, future) = getFutureHelper<const Module *>();
   cpuCoreDevice.addNetwork(
-      module2.get(), compileFunctions(BackendKind::CPU, module2.get(), backing),
+      module3.get(), compileFunctions(BackendKind::CPU, module3.get(), backing),
       [&promise](const Module *module, llvm::Error err) {
         callbackHelper(promise, module, std::move(err));
       });
 
   future.wait_for(std::chrono::seconds(2));
-  EXPECT_EQ(future.get(), module2.get());
+  EXPECT_EQ(future.get(), module3.get());
 
   EXPECT_EQ(cpuCoreDevice.getMaximumMemory(), expectedBytes);
   EXPECT_EQ(cpuCoreDevice.getAvailableMemory(), 0);
@@ -576,6 +746,73 @@ TEST(DeviceManagerTest, AvailableMemory) {
   EXPECT_FALSE(errToBool(cpuCoreDevice.stop()));
 }
 
+/// Check that the functions that use the same weights share them on a CPU
+/// device, and that the weights are counted once.
+TEST(DeviceManagerTest, SharedConstants) {
+  auto module = llvm::make_unique<Module>();
+  auto *weights = module->createConstant(ElemKind::FloatTy, {16}, "weights");
+  weights->getPayload().getHandle().randomize(-1.0, 1.0, module->getPRNG());
+  for (const char *name : {"replica0", "replica1"}) {
+    Function *F = module->createFunction(name);
+    auto *input = module->createPlaceholder(
+        ElemKind::FloatTy, {16}, std::string(name) + "_input", false);
+    auto *output = module->createPlaceholder(
+        ElemKind::FloatTy, {16}, std::string(name) + "_output", false);
+    F->createSave("ret", F->createAdd("add", input, weights), output);
+  }
+
+  std::vector<std::unique_ptr<CompiledFunction>> backing;
+  FunctionMapTy functions =
+      compileFunctions(BackendKind::CPU, module.get(), backing);
+  ASSERT_EQ(backing.size(), 2);
+  uint64_t weightBytes = backing[0]->getRuntimeBundle().getConstantWeightSize();
+  EXPECT_GE(weightBytes, weights->getType()->getSizeInBytes());
+
+  uint64_t runBytes = backing[0]->getRuntimeBundle().getRunMemorySize();
+  EXPECT_EQ(runBytes, backing[1]->getRuntimeBundle().getRunMemorySize());
+
+  uint64_t maxBytes = 1 << 20;
+  CPUDeviceManager cpuCoreDevice(nullptr, maxBytes);
+  ASSERT_FALSE(errToBool(cpuCoreDevice.init()));
+
+  std::promise<const Module *> promise;
+  std::future<const Module *> future;
+  std::tie(promise, future) = getFutureHelper<const Module *>();
+  cpuCoreDevice.addNetwork(module.get(), std::move(functions),
+                           [&promise](const Module *module, llvm::Error err) {
+                             callbackHelper(promise, module, std::move(err));
+                           });
+  future.wait_for(std::chrono::seconds(2));
+  EXPECT_EQ(future.get(), module.get());
+
+  // Both functions point to one block of constants, counted once. They run
+  // one at a time, so they also share the memory of a run.
+  EXPECT_EQ(backing[0]->getRuntimeBundle().getConstants(),
+            backing[1]->getRuntimeBundle().getConstants());
+  EXPECT_EQ(cpuCoreDevice.getAvailableMemory(),
+            maxBytes - weightBytes - runBytes);
+
+  // The weights stay until the last function that uses them is evicted.
+  for (const char *name : {"replica0", "replica1"}) {
+    std::promise<std::string> evictPromise;
+    std::future<std::string> evictFuture;
+    std::tie(evictPromise, evictFuture) = getFutureHelper<std::string>();
+    cpuCoreDevice.evictNetwork(
+        name, [&evictPromise](std::string functionName, llvm::Error err) {
+          callbackHelper(evictPromise, functionName, std::move(err));
+        });
+    evictFuture.wait_for(std::chrono::seconds(2));
+    EXPECT_EQ(evictFuture.get(), name);
+    if (name == std::string("replica0")) {
+      EXPECT_EQ(cpuCoreDevice.getAvailableMemory(),
+                maxBytes - weightBytes - runBytes);
+    }
+  }
+  EXPECT_EQ(cpuCoreDevice.getAvailableMemory(), maxBytes);
+
+  EXPECT_FALSE(errToBool(cpuCoreDevice.stop()));
+}
+
 TEST(DeviceManagerTest, DummyDeviceManager) {
   DummyDeviceManager deviceManager(BackendKind::Interpreter);
   ASSERT_FALSE(errToBool(deviceManager.init()));
@@ -114,12 +114,24 @@ public:
     // Give the call to the thread pool to process to make the tests
     // multithreaded if needed.
     std::shared_ptr<ExecutionContext> sharedContext = std::move(context);
+    requestStarted();
     this->threadPool_.submit([this, functionName, sharedContext, resultCB]() {
-      this->doRunFunction(functionName, sharedContext, resultCB);
+      this->doRunFunction(
+          functionName, sharedContext,
+          [this, resultCB](RunIdentifierTy runId, llvm::Error err,
+                           std::unique_ptr<ExecutionContext> context) {
+            requestFinished(/*execTimeUs=*/0);
+            resultCB(runId, std::move(err), std::move(context));
+          });
     });
     return 0;
   }
 
+  /// Pretend that \p numRequests more requests are queued on the device.
+  void addOutstandingRequests(unsigned numRequests) {
+    outstandingRequests_ += numRequests;
+  }
+
   uint64_t getMaximumMemory() const override {
     return std::numeric_limits<uint64_t>::max();
   }
@@ -431,6 +443,15 @@ public:
     leaves_.insert(newNodeRawPtr);
   }
 
+  /// Let the node named \p name run on any of the devices in \p deviceIds.
+  /// Its result stays registered only with the device it was added with.
+  void setNodeDevices(llvm::StringRef name,
+                      llvm::ArrayRef<DeviceIDTy> deviceIds) {
+    auto it = nodes_.find(name);
+    assert(it != nodes_.end() && "Node not found!");
+    it->second->deviceIDs = deviceIds;
+  }
+
   /// Emit the test built so far and clear any state in the builder.
   ExecutorTest emitTest() {
     // Get the input and output symbol names for the whole DAG.
@@ -979,6 +1000,41 @@ TEST_F(ThreadPoolExecutorTest, MultiNodeMultiDevice) {
   EXPECT_TRUE(test.run());
 }
 
+/// Tests that a node with several replicas is run on the replica with the
+/// fewest outstanding requests, whichever position it has in the list of
+/// devices of the node.
+TEST_F(ThreadPoolExecutorTest, LeastLoadedReplica) {
+  constexpr RunIdentifierTy testRunId = 10;
+  constexpr DeviceIDTy busyDeviceId = 111;
+  constexpr DeviceIDTy idleDeviceId = 112;
+  constexpr unsigned deviceManagerThreads = 1;
+
+  for (DeviceIDTy deviceId : {busyDeviceId, idleDeviceId}) {
+    auto deviceManager =
+        llvm::make_unique<TestDeviceManager>(deviceManagerThreads);
+    deviceManagerMap_.emplace(deviceId, std::move(deviceManager));
+  }
+  static_cast<TestDeviceManager *>(deviceManagerMap_[busyDeviceId].get())
+      ->addOutstandingRequests(3);
+
+  // Only the idle device knows the result of the node, so running it on the
+  // busy device makes the test fail.
+  std::vector<std::vector<DeviceIDTy>> replicaOrders = {
+      {busyDeviceId, idleDeviceId}, {idleDeviceId, busyDeviceId}};
+  for (size_t i = 0; i < replicaOrders.size(); i++) {
+    std::string name = "net" + std::to_string(i);
+    testBuilder_.addNode(name, idleDeviceId,
+                         /*parents=*/{}, {name + "Input"}, {name + "Output"},
+                         testRunId, true);
+    testBuilder_.setNodeDevices(name, replicaOrders[i]);
+
+    ExecutorTest test = testBuilder_.emitTest();
+    EXPECT_TRUE(test.run());
+  }
+  EXPECT_EQ(deviceManagerMap_[busyDeviceId]->getOutstandingRequests(), 3);
+  EXPECT_EQ(deviceManagerMap_[idleDeviceId]->getOutstandingRequests(), 0);
+}
+
 /// Tests that several instances of a DAG with multiple nodes can run correctly
 /// in parallel.
 TEST_F(ThreadPoolExecutorTest, ConcurrentMultiNode) {
@@ -35,7 +35,8 @@ extern "C" {
 // Forward declare functions from libjit.
 extern void libjit_matmul_f(float *c, const float *a, const float *b,
                             const size_t *cDims, const size_t *aDims,
-                            const size_t *bDims);
+                            const size_t *bDims, size_t mcBlock,
+                            size_t kcBlock);
 }
 
 void infer(Tensor *out, Tensor *lhs, Tensor *rhs) {
@@ -79,7 +80,7 @@ TEST(Gemm, jitTest) {
         libjit_matmul_f((float *)out1.getUnsafePtr(),
                         (float *)lhs.getUnsafePtr(),
                         (float *)rhs.getUnsafePtr(), out1.dims().data(),
-                        lhs.dims().data(), rhs.dims().data());
+                        lhs.dims().data(), rhs.dims().data(), 0, 0);
 
         infer(&out2, &lhs, &rhs);
 
@@ -88,3 +89,26 @@ TEST(Gemm, jitTest) {
     }
   }
 }
+
+/// Check that non-default cache blocking of A, as picked by the CPU autotuner,
+/// computes the same product, including ragged edges of the blocks.
+TEST(Gemm, jitTiledTest) {
+  PseudoRNG PRNG;
+  size_t m = 70, n = 1100, k = 150;
+  Tensor lhs(ElemKind::FloatTy, {m, k});
+  Tensor rhs(ElemKind::FloatTy, {k, n});
+  lhs.getHandle().randomize(-1.0, 1.0, PRNG);
+  rhs.getHandle().randomize(-1.0, 1.0, PRNG);
+  Tensor out2(ElemKind::FloatTy, {m, n});
+  infer(&out2, &lhs, &rhs);
+
+  for (size_t mcBlock : {64, 512}) {
+    for (size_t kcBlock : {64, 256}) {
+      Tensor out1(ElemKind::FloatTy, {m, n});
+      libjit_matmul_f((float *)out1.getUnsafePtr(), (float *)lhs.getUnsafePtr(),
+                      (float *)rhs.getUnsafePtr(), out1.dims().data(),
+                      lhs.dims().data(), rhs.dims().data(), mcBlock, kcBlock);
+      EXPECT_TRUE(out1.isEqual(out2, 0.01));
+    }
+  }
+}
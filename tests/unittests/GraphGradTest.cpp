@@ -153,6 +153,54 @@ TEST(GraphAutoGrad, cloneAndDiff) {
   EXPECT_EQ(nbSGDB, 1);
 }
 
+/// Check that differentiate creates the optimizer nodes selected by the
+/// training configuration, with their state Placeholders.
+TEST(GraphAutoGrad, optimizerNodes) {
+  Module M;
+  auto *F = M.createFunction("main");
+  auto *A = M.createPlaceholder(ElemKind::FloatTy, {4}, "A", true);
+  auto *B = M.createPlaceholder(ElemKind::FloatTy, {4}, "B", true);
+  auto *label = M.createPlaceholder(ElemKind::FloatTy, {4}, "label", false);
+  Node *reg = F->createRegression("reg", F->createAdd("AplusB", A, B), label);
+  F->createSave("return", reg);
+
+  TrainingConfig TC;
+  TC.momentum = 0.9;
+  auto *momentumF = differentiate(F, TC, "momentum");
+  EXPECT_TRUE(momentumF->verify());
+  unsigned nbMomentumSGDs = 0;
+  for (auto &node : momentumF->getNodes()) {
+    EXPECT_FALSE(llvm::isa<SGDNode>(&node));
+    auto *SGD = llvm::dyn_cast<MomentumSGDNode>(&node);
+    if (!SGD) {
+      continue;
+    }
+    ++nbMomentumSGDs;
+    EXPECT_EQ(SGD->getGsum().getType(), SGD->getWeight().getType());
+  }
+  EXPECT_EQ(nbMomentumSGDs, 2);
+  // One gsum Placeholder per weight.
+  EXPECT_EQ(M.getPlaceholders().size(), 6);
+
+  TC.optimizer = OptimizerKind::Adam;
+  auto *adamF = differentiate(F, TC, "adam");
+  EXPECT_TRUE(adamF->verify());
+  unsigned nbAdams = 0;
+  for (auto &node : adamF->getNodes()) {
+    auto *adam = llvm::dyn_cast<AdamNode>(&node);
+    if (!adam) {
+      continue;
+    }
+    ++nbAdams;
+    EXPECT_EQ(adam->getM().getType(), adam->getWeight().getType());
+    EXPECT_EQ(adam->getV().getType(), adam->getWeight().getType());
+    EXPECT_EQ(adam->getStep().dims().vec(), std::vector<size_t>{1});
+  }
+  EXPECT_EQ(nbAdams, 2);
+  // Two moments and a step counter per weight.
+  EXPECT_EQ(M.getPlaceholders().size(), 12);
+}
+
 /// Check that we can differentiate functions that update Placeholder graphs.
 TEST(GraphAutoGrad, checkPlaceholderGradTest) {
   ExecutionEngine EE;
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "glow/Backends/Backend.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Graph/Node.h"
 #include "glow/Graph/Nodes.h"
@@ -2724,6 +2725,36 @@ TEST_F(GraphOptz, dceBeforeOptimizeTranpose) {
   EXPECT_TRUE(llvm::isa<Constant>(save1->getInput()));
 }
 
+/// Check that a Transpose is sunk through a long chain of nodes in a single
+/// optimization run, and cancels out with the Transpose at its end.
+TEST_F(GraphOptz, sinkTransposeThroughLongChain) {
+  const size_t origDims[] = {1, 5, 10, 15};
+  Node *A = mod_.createPlaceholder(ElemKind::FloatTy, origDims, "input", false);
+  Node *K = F_->createTranspose("transpose", A, NHWC2NCHW);
+  for (unsigned i = 0; i < 30; i++) {
+    switch (i % 3) {
+    case 0:
+      K = F_->createRELU("relu", K);
+      break;
+    case 1:
+      K = F_->createSigmoid("sigmoid", K);
+      break;
+    default:
+      K = F_->createTanh("tanh", K);
+      break;
+    }
+  }
+  K = F_->createTranspose("transpose", K, NCHW2NHWC);
+  SaveNode *O = F_->createSave("ret", K);
+
+  ::glow::optimize(F_, CompilationMode::Infer);
+
+  // Only the chain and the Save are left.
+  EXPECT_EQ(countNodeKind(F_, Kinded::Kind::TransposeNodeKind), 0);
+  EXPECT_EQ(F_->getNodes().size(), 31);
+  EXPECT_EQ(O->getInput().dims(), llvm::makeArrayRef(origDims));
+}
+
 /// Test that Transpose is sunk below ChannelShuffle and cancels with an
 /// inverse transpose below the ChannelShuffle. This test models a pattern
 /// that has has been observed in shufflenet during graph optimization.
@@ -2813,3 +2844,52 @@ TEST_F(GraphOptz, convertReduceMean2AvgPool) {
   auto *APN = llvm::dyn_cast<AvgPoolNode>(TN->getInput());
   ASSERT_NE(APN, nullptr);
 }
+
+/// Test that chains of nodes that only depend on Constants are evaluated and
+/// replaced by a Constant.
+TEST_F(GraphOptz, constantFoldWeightPreprocessing) {
+  auto *input =
+      mod_.createPlaceholder(ElemKind::FloatTy, {2, 3}, "input", false);
+  auto *weights = mod_.createConstant(ElemKind::FloatTy, {4, 3}, "weights");
+  weights->getPayload().getHandle() = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  auto *offset = mod_.createConstant(ElemKind::FloatTy, {3, 4}, "offset");
+  offset->getPayload().getHandle().clear(1);
+
+  auto *TN = F_->createTranspose("transpose", weights, {1, 0});
+  auto *splat = F_->createSplat("splat", TN->getResult().getType(), 2);
+  auto *MN = F_->createMul("mul", TN, splat);
+  auto *AN = F_->createAdd("add", MN, offset);
+  auto *MM = F_->createMatMul("matmul", input, AN);
+  F_->createSave("save", MM);
+
+  std::unique_ptr<Backend> backend(createBackend(BackendKind::Interpreter));
+  EXPECT_TRUE(::glow::constantFold(F_, *backend));
+
+  // Only the MatMul and the Save are left.
+  EXPECT_EQ(F_->getNodes().size(), 2);
+  auto *C = llvm::dyn_cast<Constant>(MM->getRHS().getNode());
+  ASSERT_TRUE(C);
+  auto H = C->getPayload().getHandle();
+  for (size_t i = 0; i < 3; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      EXPECT_EQ(H.at({i, j}), 2 * (j * 3 + i) + 1);
+    }
+  }
+
+  // There is nothing left to fold.
+  EXPECT_FALSE(::glow::constantFold(F_, *backend));
+}
+
+/// Test that results bigger than the limit of constant folding are not
+/// turned into Constants.
+TEST_F(GraphOptz, constantFoldSizeLimit) {
+  auto *input =
+      mod_.createPlaceholder(ElemKind::FloatTy, {1 << 21}, "input", false);
+  auto *C = mod_.createConstant(ElemKind::FloatTy, {1}, "C");
+  auto *TN = F_->createTile("tile", C, 1 << 21, 0);
+  F_->createSave("save", F_->createAdd("add", input, TN));
+
+  std::unique_ptr<Backend> backend(createBackend(BackendKind::Interpreter));
+  EXPECT_FALSE(::glow::constantFold(F_, *backend));
+  EXPECT_EQ(countNodeKind(F_, Kinded::Kind::TileNodeKind), 1);
+}
@@ -113,3 +113,61 @@ TEST(GraphScheduler, testMaxSizeLessThanResultSize) {
               std::distance(schedule.begin(), concatSmallIt));
   }
 }
+
+/// Tests that the memory-aware scheduler computes the small user of a shared
+/// tensor first, so that the shared tensor is freed before the big results of
+/// its other user are computed.
+TEST(GraphScheduler, testMemoryAwareSchedulerLowersPeak) {
+  Module MD;
+  auto *input = MD.createPlaceholder(ElemKind::FloatTy, {1, 256}, "input",
+                                     /* isTrainable */ false);
+  Function *F = MD.createFunction("F");
+  Node *shared = F->createTile("shared", input, 4, 0);
+  Node *big1 = F->createTile("big1", shared, 4, 0);
+  Node *big2 = F->createTile("big2", big1, 4, 0);
+  F->createSave("saveBig", big2);
+  Node *small = F->createSlice("small", shared, {0, 0}, {1, 256});
+  F->createSave("saveSmall", small);
+
+  // The graph created above looks like this:
+  //
+  //            input {1, 256}
+  //                 |
+  //                 v
+  //          shared {4, 256}
+  //            /          \
+  //           v            v
+  //  big1 {16, 256}    small {1, 256}
+  //          |             |
+  //          v             v
+  //  big2 {64, 256}    saveSmall
+  //          |
+  //          v
+  //       saveBig
+
+  NodesPtrList schedule;
+  MemoryAwareScheduler scheduler(*F, schedule);
+  scheduler.schedule();
+  ASSERT_EQ(schedule.size(), F->getNodes().size());
+
+  // Every node is scheduled after its inputs.
+  for (auto it = schedule.begin(), e = schedule.end(); it != e; ++it) {
+    for (size_t i = 0, n = (*it)->getNumInputs(); i < n; i++) {
+      Node *input = (*it)->getNthInput(i).getNode();
+      if (llvm::isa<Storage>(input)) {
+        continue;
+      }
+      EXPECT_NE(std::find(schedule.begin(), it, input), it);
+    }
+  }
+
+  // If big1 is computed first, shared is alive while big1 and big2 are, i.e.
+  // the peak is 4K + 16K + 64K bytes. Computing small first frees shared
+  // before big2 is computed.
+  EXPECT_EQ(scheduler.getBaselinePeakMemSize(), 86016);
+  EXPECT_EQ(scheduler.getPeakMemSize(), 81920);
+  auto smallIt = std::find(schedule.begin(), schedule.end(), small);
+  auto big1It = std::find(schedule.begin(), schedule.end(), big1);
+  EXPECT_LT(std::distance(schedule.begin(), smallIt),
+            std::distance(schedule.begin(), big1It));
+}
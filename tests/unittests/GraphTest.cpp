@@ -28,6 +28,9 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <unordered_set>
+
 using namespace glow;
 
 TEST(Graph, testVariableErasure) {
@@ -526,6 +529,43 @@ TEST(Graph, moduleTest) {
   M.dumpDAG();
 }
 
+/// Check that types, Constants and Placeholders can be created in the same
+/// Module from several threads, like parallel compilation does.
+TEST(Graph, moduleThreadSafety) {
+  Module M;
+  constexpr unsigned numThreads = 8;
+  constexpr unsigned numIters = 100;
+  std::vector<std::vector<TypeRef>> types(numThreads);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (unsigned i = 0; i < numIters; i++) {
+        types[t].push_back(M.uniqueType(ElemKind::FloatTy, {i % 16 + 1}));
+        M.createConstant(ElemKind::FloatTy, {2}, "C");
+        M.createPlaceholder(ElemKind::FloatTy, {2}, "P", false);
+        M.getConstantByName("C");
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every thread got the same uniqued types.
+  for (unsigned t = 1; t < numThreads; t++) {
+    EXPECT_EQ(types[t], types[0]);
+  }
+  EXPECT_EQ(M.getConstants().size(), numThreads * numIters);
+  EXPECT_EQ(M.getPlaceholders().size(), numThreads * numIters);
+  std::unordered_set<std::string> names;
+  for (auto *C : M.getConstants()) {
+    EXPECT_TRUE(names.insert(C->getName()).second);
+  }
+  for (auto *P : M.getPlaceholders()) {
+    EXPECT_TRUE(names.insert(P->getName()).second);
+  }
+}
+
 TEST(Graph, functionDependenciesTest) {
   Module M;
   auto *F1 = M.createFunction("one");
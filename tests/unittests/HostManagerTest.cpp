@@ -131,6 +131,120 @@ TEST_F(HostManagerTest, runNetwork) {
   EXPECT_FALSE(errToBool(std::move(runErr)));
 }
 
+/// Test that runs of a network are counted and timed in the network metrics.
+TEST_F(HostManagerTest, runNetworkMetrics) {
+  std::unique_ptr<Module> module = llvm::make_unique<Module>();
+  Function *F = module->createFunction("main");
+  auto *X = module->createPlaceholder(ElemKind::FloatTy, {3}, "X", false);
+  auto *pow = F->createPow("Pow1", X, 2.0);
+  auto *save = F->createSave("save", pow);
+  auto *saveVar = save->getPlaceholder();
+
+  auto hostManager = createHostManager(BackendKind::CPU);
+  ASSERT_FALSE(errToBool(hostManager->addNetwork(std::move(module))));
+  auto metrics = hostManager->getNetworkMetrics("main");
+  ASSERT_TRUE(metrics);
+  EXPECT_FALSE(hostManager->getNetworkMetrics("unknown"));
+
+  constexpr unsigned numRuns = 4;
+  for (unsigned i = 0; i < numRuns; i++) {
+    auto context = llvm::make_unique<ExecutionContext>();
+    context->getPlaceholderBindings()->allocate(X);
+    context->getPlaceholderBindings()->allocate(saveVar);
+    std::promise<void> runNetwork;
+    auto ready = runNetwork.get_future();
+    llvm::Error runErr = llvm::Error::success();
+    hostManager->runNetwork("main", std::move(context),
+                            [&runNetwork, &runErr](
+                                RunIdentifierTy, llvm::Error err,
+                                std::unique_ptr<ExecutionContext>) {
+                              runErr = std::move(err);
+                              runNetwork.set_value();
+                            });
+    ready.wait();
+    EXPECT_FALSE(errToBool(std::move(runErr)));
+  }
+
+  EXPECT_EQ(metrics->requestCount, numRuns);
+  EXPECT_EQ(metrics->failedRequestCount, 0);
+  EXPECT_EQ(metrics->latencyUs.getCount(), numRuns);
+  EXPECT_EQ(metrics->deviceTimeUs.getCount(), numRuns);
+  EXPECT_EQ(metrics->queueWaitUs.getCount(), numRuns);
+  // The device time is part of the end to end latency.
+  EXPECT_LE(metrics->deviceTimeUs.getMax(), metrics->latencyUs.getMax());
+
+  std::string dump;
+  llvm::raw_string_ostream os(dump);
+  hostManager->dumpMetrics(os);
+  EXPECT_NE(os.str().find("\"main\": {\"requests\": 4"), std::string::npos);
+}
+
+/// Test that the names of the networks are escaped in the metrics dump.
+TEST_F(HostManagerTest, dumpMetricsEscapesNames) {
+  std::unique_ptr<Module> module = llvm::make_unique<Module>();
+  Function *F = module->createFunction("say \"hi\"\\");
+  auto *X = module->createPlaceholder(ElemKind::FloatTy, {3}, "X", false);
+  F->createSave("save", F->createPow("Pow1", X, 2.0));
+
+  auto hostManager = createHostManager(BackendKind::CPU);
+  ASSERT_FALSE(errToBool(hostManager->addNetwork(std::move(module))));
+
+  std::string dump;
+  llvm::raw_string_ostream os(dump);
+  hostManager->dumpMetrics(os);
+  EXPECT_NE(os.str().find("\"say \\\"hi\\\"\\\\\": {"), std::string::npos);
+}
+
+/// Test that a network with nodes the CPU backend does not support runs on a
+/// host with a CPU and an Interpreter device, with those nodes on the
+/// Interpreter.
+TEST_F(HostManagerTest, runNetworkWithFallback) {
+  std::unique_ptr<Module> module = llvm::make_unique<Module>();
+  std::unique_ptr<ExecutionContext> context =
+      llvm::make_unique<ExecutionContext>();
+
+  Function *F = module->createFunction("main");
+  auto *X = module->createPlaceholder(ElemKind::FloatTy, {2, 2}, "X", false);
+  auto *lengths = module->createConstant(ElemKind::Int32ITy, {2}, "lengths");
+  auto *values = module->createConstant(ElemKind::FloatTy, {2}, "values");
+  lengths->getHandle<int32_t>() = {1, 1};
+  values->getHandle<>() = {1, 4};
+  auto *XTensor = context->getPlaceholderBindings()->allocate(X);
+  XTensor->getHandle() = {1., 2., 3., 4.};
+  auto *pow = F->createPow("Pow1", X, 2.0);
+  auto *oneHot = F->createBatchOneHot("oneHot", pow, lengths, values);
+  auto *add = F->createAdd("add", oneHot, oneHot);
+  auto *save = F->createSave("save", add);
+  auto *saveTensor =
+      context->getPlaceholderBindings()->allocate(save->getPlaceholder());
+
+  std::vector<std::unique_ptr<DeviceConfig>> configs;
+  configs.push_back(llvm::make_unique<DeviceConfig>(BackendKind::CPU));
+  configs.push_back(llvm::make_unique<DeviceConfig>(BackendKind::Interpreter));
+  auto hostManager = llvm::make_unique<HostManager>(std::move(configs));
+  ASSERT_FALSE(errToBool(hostManager->addNetwork(std::move(module))));
+
+  std::promise<void> runNetwork;
+  auto ready = runNetwork.get_future();
+  llvm::Error runErr = llvm::Error::success();
+  hostManager->runNetwork("main", std::move(context),
+                          [&runNetwork, &context, &runErr](
+                              RunIdentifierTy, llvm::Error err,
+                              std::unique_ptr<ExecutionContext> context_) {
+                            context = std::move(context_);
+                            runErr = std::move(err);
+                            runNetwork.set_value();
+                          });
+  ready.wait();
+  EXPECT_FALSE(errToBool(std::move(runErr)));
+
+  auto HX = saveTensor->getHandle();
+  EXPECT_NEAR(HX.at({0, 0}), 2, 1E-5);
+  EXPECT_NEAR(HX.at({0, 1}), 2, 1E-5);
+  EXPECT_NEAR(HX.at({1, 0}), 0, 1E-5);
+  EXPECT_NEAR(HX.at({1, 1}), 0, 1E-5);
+}
+
 /// Test that HostManager properly handles concurrent add/remove requests with
 /// unique network names.
 TEST_F(HostManagerTest, ConcurrentAddRemoveUnique) {
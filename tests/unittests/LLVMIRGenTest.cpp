@@ -15,12 +15,19 @@
  */
 
 #include "glow/LLVMIRCodeGen/LLVMIRGen.h"
+#include "CPUBackend.h"
+#include "CPULLVMIRGen.h"
 #include "glow/LLVMIRCodeGen/AllocationsInfo.h"
 
+#include "glow/Graph/Graph.h"
 #include "glow/IR/IR.h"
+#include "glow/IR/IRBuilder.h"
+#include "glow/IR/Instrs.h"
 
 #include "gtest/gtest.h"
 
+#include "llvm/ADT/STLExtras.h"
+
 using namespace glow;
 
 #ifndef GLOW_WITH_CPU
@@ -41,3 +48,94 @@ TEST(LLVMIRGen, getEntryName) {
   llvmIRGen.setMainEntryName("");
   EXPECT_EQ(llvmIRGen.getMainEntryName(), "main");
 }
+
+namespace {
+/// A CPU IR generator that records the number of instructions of every
+/// data-parallel kernel it emits.
+class KernelRecordingIRGen : public CPULLVMIRGen {
+  std::vector<size_t> &kernelSizes_;
+
+public:
+  KernelRecordingIRGen(const IRFunction *M, AllocationsInfo &allocationsInfo,
+                       llvm::StringRef libjitBC,
+                       std::vector<size_t> &kernelSizes)
+      : CPULLVMIRGen(M, allocationsInfo, "", libjitBC),
+        kernelSizes_(kernelSizes) {}
+
+protected:
+  void emitDataParallelKernel(
+      llvm::IRBuilder<> &builder,
+      llvm::ArrayRef<const Instruction *> stackedInstrs) override {
+    if (!stackedInstrs.empty()) {
+      kernelSizes_.push_back(stackedInstrs.size());
+    }
+    CPULLVMIRGen::emitDataParallelKernel(builder, stackedInstrs);
+  }
+};
+
+/// A CPU backend that generates code with KernelRecordingIRGen.
+class KernelRecordingCPUBackend : public CPUBackend {
+public:
+  /// The sizes of the kernels of the last compiled function, in the order of
+  /// emission.
+  mutable std::vector<size_t> kernelSizes;
+
+  std::unique_ptr<LLVMIRGen>
+  createIRGen(const IRFunction *IR,
+              AllocationsInfo &allocationsInfo) const override {
+    kernelSizes.clear();
+    return llvm::make_unique<KernelRecordingIRGen>(
+        IR, allocationsInfo, getLibjitBitcode(), kernelSizes);
+  }
+};
+} // namespace
+
+/// Check that the data-parallel instructions on both sides of a transpose
+/// that does not access the memory of the open kernel are fused into one
+/// loop, and that a transpose that reads memory the kernel writes closes it.
+TEST(LLVMIRGen, dataParallelFusionAcrossInstrs) {
+  Module mod;
+  Function *F = mod.createFunction("DataParallelFusion");
+  auto M = llvm::make_unique<IRFunction>(F);
+  auto *var1 =
+      mod.createPlaceholder(glow::ElemKind::FloatTy, {2, 2}, "out1", false);
+  auto *var2 =
+      mod.createPlaceholder(glow::ElemKind::FloatTy, {2, 2}, "out2", false);
+  {
+    IRBuilder bb(M.get());
+    auto *out1 = bb.createWeightVar(glow::ElemKind::FloatTy, {2, 2}, "out1",
+                                    WeightVar::MutabilityKind::Mutable);
+    auto *out2 = bb.createWeightVar(glow::ElemKind::FloatTy, {2, 2}, "out2",
+                                    WeightVar::MutabilityKind::Mutable);
+    M->getVariableMap()[var1] = out1;
+    M->getVariableMap()[var2] = out2;
+
+    auto *ty = mod.uniqueType(glow::ElemKind::FloatTy, {2, 2});
+    auto *a = bb.createAllocActivationInst("a", ty);
+    auto *b = bb.createAllocActivationInst("b", ty);
+    auto *c = bb.createAllocActivationInst("c", ty);
+    auto *t = bb.createAllocActivationInst("t", ty);
+    auto *u = bb.createAllocActivationInst("u", ty);
+    bb.createSplatInst("a", a, 1.0);
+    bb.createSplatInst("b", b, 2.0);
+    bb.createTransposeInst("t", t, a, {1, 0});
+    bb.createElementAddInst("out1", out1, t, b);
+    bb.createSplatInst("c", c, 3.0);
+    bb.createTransposeInst("u", u, b, {1, 0});
+    bb.createElementAddInst("out2", out2, u, c);
+    bb.createDeallocActivationInst("dealloc_u", u);
+    bb.createDeallocActivationInst("dealloc_t", t);
+    bb.createDeallocActivationInst("dealloc_c", c);
+    bb.createDeallocActivationInst("dealloc_b", b);
+    bb.createDeallocActivationInst("dealloc_a", a);
+  }
+
+  KernelRecordingCPUBackend backend;
+  auto function = backend.compileIR(std::move(M));
+  ASSERT_TRUE(function);
+  // The first transpose reads a, so the splats of a and b form a loop of
+  // their own. The second one only reads b and runs ahead of the second loop,
+  // which holds both adds and the splat of c. Without the fusion across
+  // instructions there would be a third loop.
+  EXPECT_EQ(backend.kernelSizes, (std::vector<size_t>{2, 3}));
+}
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "glow/ExecutionEngine/DataParallelTrainer.h"
 #include "glow/ExecutionEngine/ExecutionEngine.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Quantization/Quantization.h"
@@ -74,6 +75,42 @@ TEST_P(MLTest, learnSqrt2Placeholder) {
   EXPECT_NEAR(res, 1.4142, 0.01);
 }
 
+/// Learn the square root of two with the Adam optimizer.
+TEST_P(MLTest, learnSqrt2Adam) {
+  TrainingConfig TC;
+  PlaceholderBindings bindings;
+
+  TC.optimizer = OptimizerKind::Adam;
+  TC.learningRate = 0.01;
+
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("Square root of 2");
+
+  auto *A = mod.createPlaceholder(ElemKind::FloatTy, {1}, "A", true);
+  auto *inputTensor = bindings.allocate(A);
+  inputTensor->init(Tensor::InitKind::Broadcast, 1, mod.getPRNG());
+
+  auto *E = mod.createPlaceholder(ElemKind::FloatTy, {1}, "Ex", false);
+  bindings.allocate(E)->getHandle() = {2};
+
+  Node *M = F->createMul("Mult", A, A);
+  M = F->createRegression("reg", M, E);
+  SaveNode *SN = F->createSave("ret", M);
+
+  bindings.allocate(SN->getPlaceholder());
+
+  Function *TF = glow::differentiate(F, TC);
+  EE_.compile(CompilationMode::Train, TF);
+
+  // Train the network:
+  for (int i = 0; i < 300; i++) {
+    EE_.run(bindings);
+  }
+
+  float res = inputTensor->getHandle().at({0});
+  EXPECT_NEAR(res, 1.4142, 0.01);
+}
+
 TEST_P(MLTest, trainASimpleNetwork) {
   TrainingConfig TC;
   PlaceholderBindings bindings;
@@ -1403,6 +1440,95 @@ TEST_P(MLTest, matrixRotationRecognition) {
   EXPECT_LE(errors, 1);
 }
 
+/// Builds a small regression network with minibatches of \p batchSize in
+/// \p F, and \returns the input and expected Placeholders in \p A and \p E.
+static void createRegressionNet(PlaceholderBindings &bindings, Function *F,
+                                size_t batchSize, Placeholder *&A,
+                                Placeholder *&E) {
+  auto &mod = *F->getParent();
+  A = mod.createPlaceholder(ElemKind::FloatTy, {batchSize, 4}, "A", false);
+  E = mod.createPlaceholder(ElemKind::FloatTy, {batchSize, 4}, "E", false);
+  Node *O = F->createFullyConnected(bindings, "fc1", A, 10);
+  O = F->createSigmoid("sig1", O);
+  O = F->createFullyConnected(bindings, "fc2", O, 4);
+  O = F->createRegression("reg", O, E);
+  SaveNode *result = F->createSave("return", O);
+  bindings.allocate(A);
+  bindings.allocate(E);
+  bindings.allocate(result->getPlaceholder());
+}
+
+/// Check that training with \p TC on two devices of \p kind with minibatches
+/// of two samples updates the weights like training in \p EE on one device
+/// with minibatches of four samples.
+static void checkDataParallelTraining(BackendKind kind, ExecutionEngine &EE,
+                                      TrainingConfig TC) {
+  const size_t batchSize = 2;
+  const size_t numDevices = 2;
+
+  Tensor inputs(ElemKind::FloatTy, {16, 4});
+  Tensor expected(ElemKind::FloatTy, {16, 4});
+  PseudoRNG PRNG;
+  inputs.getHandle<>().randomize(-1.0, 1.0, PRNG);
+  expected.getHandle<>().randomize(-1.0, 1.0, PRNG);
+
+  // The reference trains on one device with the minibatches of all devices.
+  PlaceholderBindings bindings;
+  Placeholder *A, *E;
+  Function *F = EE.getModule().createFunction("reference");
+  createRegressionNet(bindings, F, batchSize * numDevices, A, E);
+  TC.batchSize = batchSize * numDevices;
+  Function *TF = glow::differentiate(F, TC);
+  EE.compile(CompilationMode::Train, TF);
+
+  Module dpMod;
+  PlaceholderBindings dpBindings;
+  Placeholder *dpA, *dpE;
+  Function *dpF = dpMod.createFunction("dataParallel");
+  createRegressionNet(dpBindings, dpF, batchSize, dpA, dpE);
+  // Start with the same weights.
+  for (auto *PH : EE.getModule().getPlaceholders()) {
+    if (PH->isTraining()) {
+      dpBindings.get(dpMod.getPlaceholderByName(PH->getName()))
+          ->assign(bindings.get(PH));
+    }
+  }
+  TC.batchSize = batchSize;
+  DataParallelTrainer trainer(kind, numDevices);
+  trainer.compile(dpF, TC, dpBindings);
+
+  size_t sampleCounter = 0;
+  size_t dpSampleCounter = 0;
+  runBatch(EE, bindings, 10, sampleCounter, {A, E}, {&inputs, &expected});
+  runBatch(trainer, 10, dpSampleCounter, {dpA, dpE}, {&inputs, &expected});
+  EXPECT_EQ(sampleCounter, dpSampleCounter);
+
+  for (auto *PH : EE.getModule().getPlaceholders()) {
+    if (PH->isTraining()) {
+      auto *dpPH = dpMod.getPlaceholderByName(PH->getName());
+      EXPECT_TRUE(bindings.get(PH)->isEqual(*dpBindings.get(dpPH), 0.001));
+    }
+  }
+}
+
+TEST_P(InterpreterAndCPU, dataParallelTraining) {
+  TrainingConfig TC;
+  TC.learningRate = 0.05;
+  TC.momentum = 0.9;
+  checkDataParallelTraining(GetParam(), EE_, TC);
+}
+
+/// The L1 and L2 decay are added once per step over the minibatches of all
+/// devices, not once per device.
+TEST_P(InterpreterAndCPU, dataParallelTrainingWithDecay) {
+  TrainingConfig TC;
+  TC.learningRate = 0.05;
+  TC.momentum = 0.9;
+  TC.L1Decay = 0.01;
+  TC.L2Decay = 0.05;
+  checkDataParallelTraining(GetParam(), EE_, TC);
+}
+
 INSTANTIATE_TEST_CASE_P(Interpreter, MLTest,
                         ::testing::Values(BackendKind::Interpreter));
 #ifdef GLOW_WITH_CPU
@@ -22,11 +22,17 @@
 #include "glow/IR/IRBuilder.h"
 #include "glow/IR/Instrs.h"
 
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
 #include "gtest/gtest.h"
 
 using namespace glow;
 using llvm::cast;
 
+extern llvm::cl::opt<std::string> clProgramCacheDir;
+
 TEST(OpenCLCorrectnessTest, convOps) {
   PseudoRNG PRNG;
   Tensor inputs(ElemKind::FloatTy, {2, 3, 16, 16});
@@ -105,3 +111,37 @@ TEST(OpenCLCorrectnessTest, tanhConcatTest) {
 
   EXPECT_TRUE(out1.isEqual(out2));
 }
+
+/// Check that the built programs are stored into the program cache, and that
+/// the programs loaded from it compute the same results.
+TEST(OpenCLCorrectnessTest, programCache) {
+  llvm::SmallString<128> cacheDir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("glow-opencl-cache", cacheDir));
+  clProgramCacheDir = cacheDir.str().str();
+
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 3, 16, 16});
+  inputs.getHandle().initXavier(1, PRNG);
+  Tensor out1;
+  Tensor out2;
+  Tensor out3;
+
+  // The first run builds the programs, the second one loads their binaries.
+  inferBasicConvNet(&inputs, &out1, BackendKind::OpenCL, 8);
+  inferBasicConvNet(&inputs, &out2, BackendKind::OpenCL, 8);
+  inferBasicConvNet(&inputs, &out3, BackendKind::Interpreter, 8);
+
+  unsigned numBinaries = 0;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator it(cacheDir, EC), end;
+       it != end && !EC; it.increment(EC)) {
+    numBinaries += llvm::sys::path::extension(it->path()) == ".clbin";
+  }
+  EXPECT_GT(numBinaries, 0);
+  EXPECT_TRUE(out1.isEqual(out3));
+  EXPECT_TRUE(out2.isEqual(out3));
+
+  clProgramCacheDir = "";
+  llvm::sys::fs::remove_directories(cacheDir);
+}
@@ -2098,6 +2098,73 @@ TEST_P(OperatorStatelessTest, FP16ConvolutionDepth8) {
                             ElemKind::FloatTy, ElemKind::Float16Ty, 0.015f);
 }
 
+/// Helper to create a convolution of depth \p convDepth with \p group groups
+/// whose filters have very different ranges for each output channel, which is
+/// the case where channelwise quantization of the filter helps.
+template <size_t convDepth, unsigned_t group>
+static FunctionTensorPair
+createAndInitChannelwiseConvTest(glow::PlaceholderBindings &bindings,
+                                 glow::ExecutionEngine &EE) {
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+
+  auto *input =
+      mod.createPlaceholder(ElemKind::FloatTy, {1, 10, 10, 4}, "in", false);
+  auto *conv =
+      F->createConv(bindings, "conv", input, convDepth, 3, 1, 1, group);
+  auto *filter = llvm::cast<Placeholder>(conv->getFilter().getNode());
+  auto *bias = llvm::cast<Placeholder>(conv->getBias().getNode());
+
+  bindings.allocate(input)->getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  bindings.get(bias)->getHandle().randomize(-2.0, 2.0, mod.getPRNG());
+  // Scale the filter of output channel d by 2^(d % 4) / 8, so that the
+  // ranges of the output channels differ a lot.
+  auto filterH = bindings.get(filter)->getHandle();
+  size_t sliceSize = filterH.size() / convDepth;
+  for (size_t i = 0, e = filterH.size(); i < e; i++) {
+    filterH.raw(i) *= float(1 << ((i / sliceSize) % 4)) / 8;
+  }
+
+  auto *res = F->createSave("save", conv);
+  ::glow::convertPlaceholdersToConstants(F, bindings,
+                                         {input, res->getPlaceholder()});
+  auto *resultTensor = bindings.allocate(res->getPlaceholder());
+
+  return std::make_pair(F, resultTensor);
+}
+
+/// Test ChannelwiseQuantizedConvolution Node.
+TEST_P(OperatorStatelessTest, ChannelwiseQuantizedConvolutionDepth8) {
+  ENABLED_BACKENDS(Interpreter, CPU);
+  compareAgainstInterpreter(GetParam(), createAndInitChannelwiseConvTest<8, 1>,
+                            ElemKind::FloatTy, ElemKind::Int8QTy, 0.05f,
+                            /* enableRowwiseQuantization */ false,
+                            quantization::Schema::Asymmetric,
+                            /* enableChannelwiseQuantization */ true);
+}
+
+/// Test ChannelwiseQuantizedConvolution Node with an output depth that does
+/// not allow blocking the output channels.
+TEST_P(OperatorStatelessTest, ChannelwiseQuantizedConvolutionDepth10) {
+  ENABLED_BACKENDS(Interpreter, CPU);
+  compareAgainstInterpreter(GetParam(), createAndInitChannelwiseConvTest<10, 1>,
+                            ElemKind::FloatTy, ElemKind::Int8QTy, 0.05f,
+                            /* enableRowwiseQuantization */ false,
+                            quantization::Schema::Asymmetric,
+                            /* enableChannelwiseQuantization */ true);
+}
+
+/// Test ChannelwiseQuantizedConvolution Node with groups and Symmetric
+/// quantization.
+TEST_P(OperatorStatelessTest, ChannelwiseQuantizedGroupConvolutionSymmetric) {
+  ENABLED_BACKENDS(Interpreter, CPU);
+  compareAgainstInterpreter(GetParam(), createAndInitChannelwiseConvTest<8, 2>,
+                            ElemKind::FloatTy, ElemKind::Int8QTy, 0.05f,
+                            /* enableRowwiseQuantization */ false,
+                            quantization::Schema::Symmetric,
+                            /* enableChannelwiseQuantization */ true);
+}
+
 static FunctionTensorPair
 createAndInitBasicConcatTest(glow::PlaceholderBindings &bindings,
                              glow::ExecutionEngine &EE) {
@@ -5078,6 +5145,66 @@ TEST_P(OperatorTest, FusedRowwiseQuantizedSparseLengthsSum) {
   EXPECT_TRUE(expected.isEqual(result, 0.03));
 }
 
+/// Test FusedRowwiseQuantizedSparseLengthsSum with 4-bit fused data. The data
+/// is chosen so that every value is exactly representable with 16 levels.
+TEST_P(OperatorTest, Fused4BitRowwiseQuantizedSparseLengthsSum) {
+  ENABLED_BACKENDS(Interpreter, CPU);
+
+  /*
+    DATA  = [
+        [1.0, 3.0],
+        [0.6, 1.5],
+        [4.5, 3.0],
+    ]
+    INDICES = [2, 0, 1, 2, 0, 0, 0, 0]
+    LENGTHS = [2, 0, 2, 1, 3]
+    OUTPUT = [
+        [5.5, 6.0],
+        [0.0, 0.0],
+        [5.1, 4.5],
+        [1.0, 3.0],
+        [3.0, 9.0],
+    ]
+  */
+  Tensor data(ElemKind::FloatTy, {3, 2});
+  data.getHandle() = {
+      1.0f, 3.0f, 0.6f, 1.5f, 4.5f, 3.0f,
+  };
+
+  Placeholder *indices = mod_.createPlaceholder(
+      ElemKind::Int64ITy, {8}, "indices", /* isTrainable */ false);
+  Placeholder *lengths = mod_.createPlaceholder(
+      ElemKind::Int32ITy, {5}, "lengths", /* isTrainable */ false);
+
+  bindings_.allocate(indices)->getHandle<int64_t>() = {
+      2, 0, 1, 2, 0, 0, 0, 0,
+  };
+  bindings_.allocate(lengths)->getHandle<int32_t>() = {
+      2, 0, 2, 1, 3,
+  };
+
+  auto *R = F_->createFusedRowwiseQuantizedSparseLengthsSum(
+      "RQSLWS", data, indices, lengths, ElemKind::UInt4FusedQTy);
+  SaveNode *S = F_->createSave("save", R);
+  bindings_.allocate(S->getPlaceholder());
+
+  // Two 4-bit values are packed in every byte, followed by scale and offset.
+  auto *dataC = llvm::cast<Constant>(R->getData());
+  EXPECT_EQ(dataC->getElementType(), ElemKind::UInt4FusedQTy);
+  EXPECT_EQ(1 + 8, dataC->dims()[1]);
+
+  EE_.compile(CompilationMode::Infer, F_);
+  EE_.run(bindings_);
+
+  Tensor &result = *bindings_.get(S->getPlaceholder());
+  Tensor expected(ElemKind::FloatTy, {5, 2});
+  expected.getHandle() = {
+      5.5f, 6.0f, 0.0f, 0.0f, 5.1f, 4.5f, 1.0f, 3.0f, 3.0f, 9.0f,
+  };
+
+  EXPECT_TRUE(expected.isEqual(result, 0.02));
+}
+
 TEST_P(OperatorTest, SparseToDense) {
   ENABLED_BACKENDS(Interpreter, CPU);
 
@@ -5880,6 +6007,55 @@ TEST_P(OperatorTest, LengthsToRanges) {
   EXPECT_TRUE(expected.isEqual(result));
 }
 
+/// Test that SparseLengthsShard keeps only the lookups of its shard, packed at
+/// the front, with their rows in the shard and their count per segment.
+TEST_P(OperatorTest, SparseLengthsShard) {
+  ENABLED_BACKENDS(Interpreter, CPU);
+
+  /*
+    WEIGHTS = [1, 2, 3, 4, 5, 6]
+    INDICES = [4, 1, 7, 2, 6, 9]
+    LENGTHS = [2, 0, 3, 1]
+    NUM_SHARDS = 3, SHARD = 1
+    SHARD_WEIGHTS = [1, 2, 3, 0, 0, 0]
+    SHARD_INDICES = [1, 0, 2, 0, 0, 0]
+    SHARD_LENGTHS = [2, 0, 1, 0]
+  */
+  auto *weights =
+      mod_.createPlaceholder(ElemKind::FloatTy, {6}, "weights", false);
+  auto *indices =
+      mod_.createPlaceholder(ElemKind::Int64ITy, {6}, "indices", false);
+  auto *lengths =
+      mod_.createPlaceholder(ElemKind::Int32ITy, {4}, "lengths", false);
+
+  bindings_.allocate(weights)->getHandle() = {1, 2, 3, 4, 5, 6};
+  bindings_.allocate(indices)->getHandle<int64_t>() = {4, 1, 7, 2, 6, 9};
+  bindings_.allocate(lengths)->getHandle<int32_t>() = {2, 0, 3, 1};
+
+  auto *SLS = F_->createSparseLengthsShard("shard", weights, indices, lengths,
+                                           /* numShards */ 3, /* shard */ 1);
+  auto *SW = F_->createSave("saveWeights", SLS->getShardWeights());
+  auto *SI = F_->createSave("saveIndices", SLS->getShardIndices());
+  auto *SL = F_->createSave("saveLengths", SLS->getShardLengths());
+  bindings_.allocate(SW->getPlaceholder());
+  bindings_.allocate(SI->getPlaceholder());
+  bindings_.allocate(SL->getPlaceholder());
+
+  EE_.compile(CompilationMode::Infer, F_);
+  EE_.run(bindings_);
+
+  Tensor expectedWeights(ElemKind::FloatTy, {6});
+  expectedWeights.getHandle() = {1, 2, 3, 0, 0, 0};
+  Tensor expectedIndices(ElemKind::Int64ITy, {6});
+  expectedIndices.getHandle<int64_t>() = {1, 0, 2, 0, 0, 0};
+  Tensor expectedLengths(ElemKind::Int32ITy, {4});
+  expectedLengths.getHandle<int32_t>() = {2, 0, 1, 0};
+
+  EXPECT_TRUE(expectedWeights.isEqual(*bindings_.get(SW->getPlaceholder())));
+  EXPECT_TRUE(expectedIndices.isEqual(*bindings_.get(SI->getPlaceholder())));
+  EXPECT_TRUE(expectedLengths.isEqual(*bindings_.get(SL->getPlaceholder())));
+}
+
 /// Helper for testing BatchOneHot with different \p DTy.
 template <typename DataType>
 void batchOneHotTest(glow::PlaceholderBindings &bindings, glow::Module &mod,
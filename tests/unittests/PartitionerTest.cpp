@@ -51,7 +51,7 @@ static void executeDAG(DAGNode *G, Module &mod, PlaceholderBindings &bindings,
     DAGNode *dag = exeList.at(curPt);
     // The root in a G is always a dummy function.
     if (curPt > 0) {
-      ExecutionEngine EE;
+      ExecutionEngine EE{dag->backendKind};
       Function *func = name2func[dag->name];
       EE.compile(CompilationMode::Infer, func);
       updateInputPlaceholders(bindings, vars, inputs);
@@ -370,3 +370,238 @@ TEST_F(PartitionerTest, Basic1Roofline) {
   ASSERT_EQ(mod_.getFunctions().size(), 3);
   ASSERT_EQ(myList.size(), 1);
 }
+
+/// Check that the embedding table of \p F that does not fit on one device of
+/// \p backendKind is sharded by rows, that every shard only looks up its own
+/// indices, and that the sum of the partial lookups run on \p backendKind
+/// gives the same result as the un-partitioned graph.
+static void testEmbeddingTableSharding(Module &mod, Function *F,
+                                       PlaceholderBindings &bindings,
+                                       BackendKind backendKind) {
+  constexpr size_t numRows = 1000;
+  constexpr size_t numIndices = 40;
+  auto *data = mod.createConstant(ElemKind::FloatTy, {numRows, 16}, "data");
+  auto *weights =
+      mod.createConstant(ElemKind::FloatTy, {numIndices}, "weights");
+  auto *indices = mod.createPlaceholder(ElemKind::Int64ITy, {numIndices},
+                                        "indices", false);
+  auto *lengths =
+      mod.createPlaceholder(ElemKind::Int32ITy, {4}, "lengths", false);
+  data->getHandle<>().randomize(-2.0, 2.0, mod.getPRNG());
+  weights->getHandle<>().randomize(-2.0, 2.0, mod.getPRNG());
+  bindings.allocate(indices);
+  bindings.allocate(lengths);
+
+  auto *SLWS = F->createSparseLengthsWeightedSum("slws", data, weights,
+                                                 indices, lengths);
+  auto *save = F->createSave("ret", SLWS);
+  auto &res = *bindings.allocate(save->getPlaceholder());
+
+  Tensor indicesT(ElemKind::Int64ITy, {numIndices});
+  Tensor lengthsT(ElemKind::Int32ITy, {4});
+  auto IH = indicesT.getHandle<int64_t>();
+  for (size_t i = 0; i < numIndices; i++) {
+    IH.raw(i) = (i * 97 + 13) % numRows;
+  }
+  lengthsT.getHandle<int32_t>() = {5, 0, 15, 20};
+
+  // Infer using the un-partitioned graph.
+  ExecutionEngine EE{backendKind};
+  EE.compile(CompilationMode::Infer, F);
+  updateInputPlaceholders(bindings, {indices, lengths}, {&indicesT, &lengthsT});
+  EE.run(bindings);
+  Tensor ref = res.clone();
+
+  // The 64000 byte table does not fit on any of the devices.
+  std::vector<DeviceInfo> devices = {{40000}, {40000}, {40000}, {40000}};
+  for (auto &device : devices) {
+    device.backendKind = backendKind;
+  }
+  Partitioner myPartitioner(&mod, devices);
+  auto err = myPartitioner.Partition();
+  EXPECT_FALSE(errToBool(std::move(err)));
+  DAGListTy myList = std::move(myPartitioner.getPartitionResult());
+  ASSERT_EQ(myList.size(), 1);
+  EXPECT_GT(mod.getFunctions().size(), 1);
+  EXPECT_EQ(mod.getConstantByName("data"), nullptr);
+  std::unique_ptr<Backend> backend(createBackend(backendKind));
+  size_t numRoutes = 0;
+  for (auto *PF : mod.getFunctions()) {
+    uint64_t constSize = 0;
+    for (auto &node : PF->getNodes()) {
+      EXPECT_TRUE(backend->isOpSupported(node));
+      numRoutes += llvm::isa<SparseLengthsShardNode>(&node);
+      for (size_t i = 0, e = node.getNumInputs(); i < e; i++) {
+        if (auto *C = llvm::dyn_cast<Constant>(node.getNthInput(i))) {
+          constSize += C->getType()->getSizeInBytes();
+        }
+      }
+      // Every shard looks up only the indices routed to it.
+      auto *shardSLWS = llvm::dyn_cast<SparseLengthsWeightedSumNode>(&node);
+      if (shardSLWS) {
+        EXPECT_NE(shardSLWS->getIndices().getNode(), indices);
+      }
+    }
+    EXPECT_LE(constSize, 40000);
+  }
+  // The table is split into 4 shards of 16000 bytes, and each one gets the
+  // indices it owns from a SparseLengthsShard.
+  EXPECT_EQ(numRoutes, 4);
+
+  // Run the paritioned graph and compare the results.
+  bindings.allocate(mod.getPlaceholders());
+  for (auto it = myList.begin(); it != myList.end(); ++it) {
+    executeDAG((*it).root.get(), mod, bindings, {indices, lengths},
+               {&indicesT, &lengthsT});
+    Tensor test = res.clone();
+    EXPECT_TRUE(ref.isEqual(test));
+  }
+}
+
+/// This one tests that an embedding table that does not fit on one device is
+/// sharded by rows on Interpreter devices.
+TEST_F(PartitionerTest, EmbeddingTableSharding) {
+  testEmbeddingTableSharding(mod_, F_, bindings_, BackendKind::Interpreter);
+}
+
+#ifdef GLOW_WITH_CPU
+/// This one tests that an embedding table that does not fit on one device is
+/// sharded by rows on CPU devices, which run the routing of the indices.
+TEST_F(PartitionerTest, EmbeddingTableShardingOnCPU) {
+  testEmbeddingTableSharding(mod_, F_, bindings_, BackendKind::CPU);
+}
+#endif // GLOW_WITH_CPU
+
+#ifdef GLOW_WITH_CPU
+/// Test that with CPU and Interpreter devices, the nodes that the CPU backend
+/// does not support run on the Interpreter, the reshape between two such
+/// nodes joins them to save transfers, and the FCs, which compute much more
+/// than they transfer, stay on the CPU.
+TEST_F(PartitionerTest, BackendFallback) {
+  auto *input =
+      mod_.createPlaceholder(ElemKind::FloatTy, {2, 64}, "input", false);
+  auto *weights1 = mod_.createConstant(ElemKind::FloatTy, {64, 2}, "weights1");
+  auto *bias1 = mod_.createConstant(ElemKind::FloatTy, {2}, "bias1");
+  auto *weights2 = mod_.createConstant(ElemKind::FloatTy, {4, 64}, "weights2");
+  auto *bias2 = mod_.createConstant(ElemKind::FloatTy, {64}, "bias2");
+  auto *lengths1 = mod_.createConstant(ElemKind::Int32ITy, {2}, "lengths1");
+  auto *values1 = mod_.createConstant(ElemKind::FloatTy, {2}, "values1");
+  auto *lengths2 = mod_.createConstant(ElemKind::Int32ITy, {4}, "lengths2");
+  auto *values2 = mod_.createConstant(ElemKind::FloatTy, {4}, "values2");
+  // The first FC picks the first two columns of the input, the second one
+  // doubles its input into the first four columns of the result.
+  weights1->getPayload().zero();
+  weights1->getHandle<>().at({0, 0}) = 1;
+  weights1->getHandle<>().at({1, 1}) = 1;
+  bias1->getPayload().zero();
+  weights2->getPayload().zero();
+  for (size_t i = 0; i < 4; i++) {
+    weights2->getHandle<>().at({i, i}) = 2;
+  }
+  bias2->getPayload().zero();
+  lengths1->getHandle<int32_t>() = {1, 1};
+  values1->getHandle<>() = {1, 4};
+  lengths2->getHandle<int32_t>() = {1, 1, 1, 1};
+  values2->getHandle<>() = {1, 1, 0, 1};
+
+  Node *N = F_->createFullyConnected("fc1", input, weights1, bias1);
+  N = F_->createBatchOneHot("onehot1", N, lengths1, values1);
+  N = F_->createReshape("reshape", N, {1, 4});
+  N = F_->createBatchOneHot("onehot2", N, lengths2, values2);
+  N = F_->createFullyConnected("fc2", N, weights2, bias2);
+  auto *save = F_->createSave("ret", N);
+  auto &res = *bindings_.allocate(save->getPlaceholder());
+
+  std::vector<DeviceInfo> devices = {{3072}, {3072}};
+  devices[0].backendKind = BackendKind::CPU;
+  devices[1].backendKind = BackendKind::Interpreter;
+  Partitioner myPartitioner(&mod_, devices);
+  auto err = myPartitioner.Partition();
+  EXPECT_FALSE(errToBool(std::move(err)));
+  DAGListTy myList = std::move(myPartitioner.getPartitionResult());
+  ASSERT_EQ(myList.size(), 1);
+
+  // The first FC runs on the CPU, the one-hot encodings and the reshape on
+  // the Interpreter, and the second FC on the CPU again. All the CPU
+  // partitions share a logical device.
+  ASSERT_EQ(mod_.getFunctions().size(), 3);
+  for (auto &node : myList[0].nodes) {
+    Function *F = mod_.getFunction(node->name);
+    ASSERT_TRUE(F);
+    bool onInterpreter = node->name == "main_part2";
+    EXPECT_EQ(node->backendKind,
+              onInterpreter ? BackendKind::Interpreter : BackendKind::CPU);
+    EXPECT_EQ(node->logicalDevices,
+              std::vector<DeviceIDTy>{onInterpreter ? 1u : 0u});
+    size_t numReshapes = 0;
+    size_t numFCs = 0;
+    for (auto &FN : F->getNodes()) {
+      numReshapes += llvm::isa<ReshapeNode>(&FN);
+      numFCs += llvm::isa<FullyConnectedNode>(&FN);
+    }
+    EXPECT_EQ(numReshapes, onInterpreter ? 1 : 0);
+    EXPECT_EQ(numFCs, onInterpreter ? 0 : 1);
+  }
+
+  // Run the paritioned graph and check the result.
+  Tensor in(ElemKind::FloatTy, {2, 64});
+  in.zero();
+  in.getHandle<>().at({0, 0}) = 1;
+  in.getHandle<>().at({0, 1}) = 4;
+  in.getHandle<>().at({1, 0}) = 9;
+  in.getHandle<>().at({1, 1}) = 16;
+  bindings_.allocate(mod_.getPlaceholders());
+  executeDAG(myList[0].root.get(), mod_, bindings_, {input}, {&in});
+  Tensor ref(ElemKind::FloatTy, {1, 64});
+  ref.zero();
+  ref.getHandle<>().at({0, 0}) = 2;
+  ref.getHandle<>().at({0, 1}) = 2;
+  ref.getHandle<>().at({0, 2}) = 2;
+  EXPECT_TRUE(ref.isEqual(res));
+}
+
+/// Test that with CPU and Interpreter devices, an elementwise node that the
+/// CPU backend supports between two nodes that it does not support runs on
+/// the Interpreter, because it computes less than it would transfer.
+TEST_F(PartitionerTest, BackendFallbackCheapIsland) {
+  auto *input =
+      mod_.createPlaceholder(ElemKind::FloatTy, {2, 2}, "input", false);
+  auto *lengths1 = mod_.createConstant(ElemKind::Int32ITy, {2}, "lengths1");
+  auto *values1 = mod_.createConstant(ElemKind::FloatTy, {2}, "values1");
+  auto *lengths2 = mod_.createConstant(ElemKind::Int32ITy, {4}, "lengths2");
+  auto *values2 = mod_.createConstant(ElemKind::FloatTy, {4}, "values2");
+  lengths1->getHandle<int32_t>() = {1, 1};
+  values1->getHandle<>() = {1, 4};
+  lengths2->getHandle<int32_t>() = {1, 1, 1, 1};
+  values2->getHandle<>() = {2, 2, 0, 0};
+
+  Node *N = F_->createBatchOneHot("onehot1", input, lengths1, values1);
+  N = F_->createAdd("add", N, N);
+  N = F_->createReshape("reshape", N, {1, 4});
+  N = F_->createBatchOneHot("onehot2", N, lengths2, values2);
+  auto *save = F_->createSave("ret", N);
+  auto &res = *bindings_.allocate(save->getPlaceholder());
+
+  std::vector<DeviceInfo> devices = {{3072}, {3072}};
+  devices[0].backendKind = BackendKind::CPU;
+  devices[1].backendKind = BackendKind::Interpreter;
+  Partitioner myPartitioner(&mod_, devices);
+  auto err = myPartitioner.Partition();
+  EXPECT_FALSE(errToBool(std::move(err)));
+  DAGListTy myList = std::move(myPartitioner.getPartitionResult());
+  ASSERT_EQ(myList.size(), 1);
+
+  // The whole graph runs on the Interpreter.
+  ASSERT_EQ(mod_.getFunctions().size(), 1);
+  ASSERT_EQ(myList[0].nodes.size(), 1);
+  EXPECT_EQ(myList[0].nodes[0]->backendKind, BackendKind::Interpreter);
+
+  Tensor in(ElemKind::FloatTy, {2, 2});
+  in.getHandle<>() = {1, 2, 3, 4};
+  bindings_.allocate(mod_.getPlaceholders());
+  executeDAG(myList[0].root.get(), mod_, bindings_, {input}, {&in});
+  Tensor ref(ElemKind::FloatTy, {1, 4});
+  ref.getHandle<>() = {1, 0, 1, 0};
+  EXPECT_TRUE(ref.isEqual(res));
+}
+#endif // GLOW_WITH_CPU
@@ -45,11 +45,13 @@ DAGListTy setupDAG(unsigned rootCount, unsigned childCount) {
     rootNode->children.push_back(firstNode.get());
     firstNode->name = "function" + std::to_string(currentFunction);
     firstNode->logicalDevices = {0, 1};
+    firstNode->backendKind = BackendKind::CPU;
     currentFunction++;
     for (unsigned int child = 0; child < childCount; child++) {
       auto newChild = llvm::make_unique<DAGNode>();
       newChild->name = "function" + std::to_string(currentFunction);
       newChild->logicalDevices = {0};
+      newChild->backendKind = BackendKind::CPU;
       currentFunction++;
       firstNode->children.push_back(newChild.get());
       nodes.push_back(std::move(newChild));
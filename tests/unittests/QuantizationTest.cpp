@@ -407,6 +407,73 @@ TEST(Quantization, enableRowwiseQuantizedFullyConnected) {
   EE.run(bindings);
 }
 
+/// Test enabling ChannelwiseQuantizedConvolution in Glow quantization
+/// procedure. A Convolution can be quantized and converted to a
+/// ChannelwiseQuantizedConvolution if:
+/// 1. The filter of the Convolution is constant;
+/// 2. Use -enable-channelwise option or set enableChannelwise param in
+/// quantization::quantizeFunction to true. In unittest, the later one is used.
+TEST(Quantization, enableChannelwiseQuantizedConv) {
+  ExecutionEngine EE;
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+
+  auto *input =
+      mod.createPlaceholder(ElemKind::FloatTy, {1, 5, 5, 2}, "input", true);
+  auto *B = mod.createPlaceholder(ElemKind::FloatTy, {4}, "bias", true);
+  PlaceholderBindings bindings;
+  bindings.allocate(input)->getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  bindings.allocate(B)->init(Tensor::InitKind::Broadcast, 0.1, mod.getPRNG());
+
+  auto *filter = mod.createConstant(ElemKind::FloatTy, {4, 3, 3, 2}, "filter");
+  filter->getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  auto outTy = mod.uniqueType(ElemKind::FloatTy, {1, 5, 5, 4});
+  auto *CN = F->createConv("conv", input, filter, B, outTy, 3, 1, 1, 1);
+  auto *S = F->createSave("ret", CN);
+  bindings.allocate(S->getPlaceholder());
+
+  quantization::QuantizationConfiguration quantConfig{{
+      {NodeQuantizationInfo::generateNodeOutputName(input->getName()),
+       {0.2f, 0}},
+      {NodeQuantizationInfo::generateNodeOutputName(filter->getName()),
+       {0.3f, 0}},
+      {NodeQuantizationInfo::generateNodeOutputName(B->getName()), {0.4f, 0}},
+      {NodeQuantizationInfo::generateNodeOutputName(CN->getName()), {0.6f, 0}},
+  }};
+
+  quantConfig.enableChannelwise = true;
+  quantConfig.assertAllNodesQuantized = true;
+  F = quantization::quantizeFunction(F, quantConfig, *EE.getBackend());
+
+  // Check the graph structure after quantization.
+  auto *saveNode = llvm::dyn_cast<SaveNode>(F->getNodeByName("ret"));
+  ASSERT_TRUE(saveNode);
+  auto *deqNode =
+      llvm::dyn_cast<DequantizeNode>(saveNode->getInput().getNode());
+  ASSERT_TRUE(deqNode);
+  auto *cwNode = llvm::dyn_cast<ChannelwiseQuantizedConvolutionNode>(
+      deqNode->getInput().getNode());
+  ASSERT_TRUE(cwNode);
+  auto *inNode = llvm::dyn_cast<QuantizeNode>(cwNode->getInput().getNode());
+  ASSERT_TRUE(inNode);
+  auto *biasNode = llvm::dyn_cast<QuantizeNode>(cwNode->getBias().getNode());
+  ASSERT_TRUE(biasNode);
+  auto *filterNode = llvm::dyn_cast<Constant>(cwNode->getFilter().getNode());
+  ASSERT_TRUE(filterNode);
+  auto *scalesNode = llvm::dyn_cast<Constant>(cwNode->getScales().getNode());
+  ASSERT_TRUE(scalesNode);
+  EXPECT_EQ(scalesNode->dims()[0], 4);
+  auto *offsetsNode = llvm::dyn_cast<Constant>(cwNode->getOffsets().getNode());
+  ASSERT_TRUE(offsetsNode);
+  EXPECT_EQ(offsetsNode->dims()[0], 4);
+
+  // Make sure that graph can be compiled and run. We check the correctness of
+  // ChannelwiseQuantizedConvolution in operatorTests.cpp.
+  EE.compile(CompilationMode::Infer, F);
+
+  EE.run(bindings);
+}
+
 /// Test enabling RowwiseQuantizedFullyConnected with Symmetric quantization.
 TEST(Quantization, enableRowwiseQuantizedFullyConnectedSymmetric) {
   ExecutionEngine EE;
@@ -1443,7 +1510,11 @@ TEST(Quantization, quantizeGraphPartially) {
 
   // Make sure that graph can be compiled and run.
   ::glow::convertPlaceholdersToConstants(F, bindings, {result});
-  EE.compile(CompilationMode::Infer, F);
+  // All inputs are Constants now, so keep the graph from being folded into a
+  // single Constant.
+  CompilationOptions opts;
+  opts.enableConstantFolding = false;
+  EE.compile(F, opts);
 
   EE.run(bindings);
 
@@ -1526,7 +1597,11 @@ TEST(Quantization, quantizeGraphPartiallyMultipleNodes) {
 
   // Make sure that graph can be compiled and run.
   ::glow::convertPlaceholdersToConstants(F, bindings, {result});
-  EE.compile(CompilationMode::Infer, F);
+  // All inputs are Constants now, so keep the graph from being folded into a
+  // single Constant.
+  CompilationOptions opts;
+  opts.enableConstantFolding = false;
+  EE.compile(F, opts);
 
   EE.run(bindings);
 
@@ -1619,7 +1694,11 @@ TEST(Quantization, quantizeGraphPartiallyMultipleKinds) {
 
   // Make sure that graph can be compiled and run.
   ::glow::convertPlaceholdersToConstants(F, bindings, {result});
-  EE.compile(CompilationMode::Infer, F);
+  // All inputs are Constants now, so keep the graph from being folded into a
+  // single Constant.
+  CompilationOptions opts;
+  opts.enableConstantFolding = false;
+  EE.compile(F, opts);
 
   EE.run(bindings);
 
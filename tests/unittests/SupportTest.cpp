@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "glow/Support/Histogram.h"
 #include "glow/Support/Support.h"
 #include "glow/Testing/StrCheck.h"
 #include "gtest/gtest.h"
@@ -46,3 +47,42 @@ TEST(Support, legalizeName) {
   std::string str3 = legalizeName("abc_1aBc");
   EXPECT_TRUE(str3.compare("abc_1aBc") == 0);
 }
+
+TEST(Support, histogram) {
+  Histogram H;
+  EXPECT_EQ(H.getCount(), 0);
+  EXPECT_EQ(H.getPercentile(50), 0);
+
+  // Small values are counted exactly.
+  for (uint64_t i = 1; i <= 10; i++) {
+    H.record(i);
+  }
+  EXPECT_EQ(H.getCount(), 10);
+  EXPECT_EQ(H.getSum(), 55);
+  EXPECT_EQ(H.getMax(), 10);
+  EXPECT_EQ(H.getPercentile(50), 5);
+  EXPECT_EQ(H.getPercentile(100), 10);
+
+  // Large values are within the bucket precision.
+  H.reset();
+  for (uint64_t i = 1; i <= 100000; i++) {
+    H.record(i);
+  }
+  for (double p : {50.0, 90.0, 99.0, 99.9}) {
+    double expected = p * 1000;
+    EXPECT_NEAR(H.getPercentile(p), expected,
+                expected / Histogram::kSubBuckets);
+  }
+  EXPECT_EQ(H.getPercentile(100), 100000);
+
+  // Every value falls into the bucket it is the maximum of or below.
+  for (uint64_t v : {uint64_t(15), uint64_t(16), uint64_t(1000),
+                     uint64_t(123456789), ~uint64_t(0)}) {
+    unsigned idx = Histogram::getBucketIndex(v);
+    ASSERT_LT(idx, Histogram::kNumBuckets);
+    EXPECT_LE(v, Histogram::getBucketMaxValue(idx));
+    if (idx > 0) {
+      EXPECT_GT(v, Histogram::getBucketMaxValue(idx - 1));
+    }
+  }
+}
@@ -19,8 +19,13 @@
 #include "llvm/ADT/STLExtras.h"
 
 #include <future>
+#include <set>
 #include <vector>
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 using namespace glow;
 
 TEST(ThreadPool, BasicTest) {
@@ -77,3 +82,44 @@ TEST(ThreadPool, completionFutureTest) {
   done.wait();
   EXPECT_EQ(output, 126);
 }
+
+TEST(ThreadPool, initWorkerTest) {
+  const unsigned numWorkers = 4;
+  std::mutex mtx;
+  std::set<std::thread::id> initialized;
+  ThreadPool tp(numWorkers, [&]() {
+    std::lock_guard<std::mutex> lock(mtx);
+    initialized.insert(std::this_thread::get_id());
+  });
+
+  // Every work item runs on a worker that was initialized.
+  std::vector<std::future<void>> futures;
+  for (unsigned i = 0; i < 100; ++i) {
+    futures.push_back(tp.submit([&]() {
+      std::lock_guard<std::mutex> lock(mtx);
+      EXPECT_TRUE(initialized.count(std::this_thread::get_id()));
+    }));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  tp.stop(true);
+  EXPECT_EQ(initialized.size(), numWorkers);
+}
+
+#ifdef __linux__
+TEST(ThreadPool, pinnedWorkerTest) {
+  // Pick a core that this process may run on.
+  cpu_set_t allowed;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  unsigned core = 0;
+  while (!CPU_ISSET(core, &allowed)) {
+    core++;
+  }
+
+  ThreadPool tp(1, [core]() { EXPECT_TRUE(pinCurrentThread({core})); });
+  int runningOn = -1;
+  tp.submit([&runningOn]() { runningOn = sched_getcpu(); }).wait();
+  EXPECT_EQ(runningOn, int(core));
+}
+#endif
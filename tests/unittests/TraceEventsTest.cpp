@@ -568,6 +568,72 @@ TEST_P(TraceEventsTest, deviceManagerEvents) {
   checkEventTimestamps(traceEvents);
 }
 
+/// Test that events logged concurrently from several threads are all kept.
+TEST(TraceContextTest, concurrentEvents) {
+  TraceContext context(TraceLevel::STANDARD, 0);
+  constexpr unsigned numThreads = 4;
+  constexpr unsigned numEvents = 100;
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < numThreads; t++) {
+    threads.emplace_back([&context, t]() {
+      std::string name = "thread" + std::to_string(t);
+      for (unsigned i = 0; i < numEvents; i++) {
+        context.logTraceEvent(name, TraceEvent::InstantType);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto &events = context.getTraceEvents();
+  ASSERT_EQ(events.size(), numThreads * numEvents);
+  EXPECT_EQ(context.getDroppedEvents(), 0u);
+  std::map<std::string, unsigned> counts;
+  for (auto &event : events) {
+    EXPECT_EQ(event.type, std::string(TraceEvent::InstantType));
+    counts[event.name]++;
+  }
+  for (unsigned t = 0; t < numThreads; t++) {
+    EXPECT_EQ(counts["thread" + std::to_string(t)], numEvents);
+  }
+}
+
+/// Test that events overwritten in the ring buffer before being read are
+/// counted as dropped.
+TEST(TraceContextTest, droppedEvents) {
+  TraceContext context(TraceLevel::STANDARD, 0);
+  size_t numEvents = TraceContext::kRingSize + 10;
+  for (size_t i = 0; i < numEvents; i++) {
+    context.logTraceEvent("event", TraceEvent::InstantType);
+  }
+  EXPECT_EQ(context.getTraceEvents().size(), TraceContext::kRingSize);
+  EXPECT_EQ(context.getDroppedEvents(), 10u);
+}
+
+/// Test that events with attributes and ring buffer events keep their order
+/// and timestamps.
+TEST(TraceContextTest, attributesKeepOrder) {
+  TraceContext context(TraceLevel::STANDARD, 3);
+  uint64_t start = TraceEvent::now();
+  context.logTraceEvent("first", TraceEvent::BeginType, start);
+  context.logTraceEvent("second", TraceEvent::InstantType, start + 1,
+                        {{"key", "value"}});
+  context.logTraceEvent("first", TraceEvent::EndType, start + 2);
+
+  auto &events = context.getTraceEvents();
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].name, "first");
+  EXPECT_EQ(events[0].type, std::string(TraceEvent::BeginType));
+  EXPECT_EQ(events[0].timestamp, start);
+  EXPECT_EQ(events[0].tid, 3);
+  EXPECT_EQ(events[1].name, "second");
+  EXPECT_EQ(events[1].args["key"], "value");
+  EXPECT_EQ(events[2].name, "first");
+  EXPECT_EQ(events[2].type, std::string(TraceEvent::EndType));
+  EXPECT_EQ(events[2].timestamp, start + 2);
+}
+
 INSTANTIATE_TEST_CASE_P(Interpreter, TraceEventsTest,
                         ::testing::Values(BackendKind::Interpreter));
 
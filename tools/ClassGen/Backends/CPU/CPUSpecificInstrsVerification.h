@@ -33,4 +33,30 @@ void CPUConvDKKC8Inst::verify() const {
          "Invalid Element Type");
 }
 
+void CPUDepthwiseConvInst::verify() const {
+  assert(getDest()->dims()[3] % getSrc()->dims()[3] == 0 &&
+         "Output channels must be a multiple of the input channels.");
+  assert(getFilter()->dims()[3] == getDest()->dims()[3] &&
+         "Invalid filter layout");
+  assert(getDest()->getElementType() == getSrc()->getElementType() &&
+         "Invalid Element Type");
+  assert(getDest()->getElementType() == getFilter()->getElementType() &&
+         "Invalid Element Type");
+}
+
+void CPUGroupConvInst::verify() const {
+  assert(getSrc()->dims()[3] % getGroup() == 0 &&
+         "Input channels must be divisible by group.");
+  assert(getDest()->dims()[3] % getGroup() == 0 &&
+         "Output channels must be divisible by group.");
+  assert(getFilter()->dims()[0] % getGroup() == 0 &&
+         "Filter blocks must be divisible by group.");
+  assert(getDest()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getDest()->getElementType() == getFilter()->getElementType() &&
+         "Invalid Element Type");
+  assert(getDest()->getElementType() == getBias()->getElementType() &&
+         "Invalid Element Type");
+}
+
 #endif // GLOW_WITH_CPU
@@ -33,6 +33,33 @@ BB.newNode("CPUConvDKKC8")
     .setDocstring("This is a cpu-specific convolution implementation where the "
                   "filter is transposed to the shape [D/8, K, K, C, 8]");
 
+BB.newNode("CPUDepthwiseConv")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::VectorUnsigned, "Kernels")
+    .addMember(MemberType::VectorUnsigned, "Strides")
+    .addMember(MemberType::VectorUnsigned, "Pads")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific depthwise convolution, where every "
+                  "group has a single input channel. The filter is "
+                  "transposed to the shape [1, K, K, D]");
+
+BB.newNode("CPUGroupConv")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::VectorUnsigned, "Kernels")
+    .addMember(MemberType::VectorUnsigned, "Strides")
+    .addMember(MemberType::VectorUnsigned, "Pads")
+    .addMember(MemberType::Unsigned, "Group")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific grouped convolution. The output "
+                  "channels of every group are padded with zero filters to a "
+                  "multiple of 8 and the filter is transposed to the shape "
+                  "[G * B, K, K, C/G, 8], where B is the number of blocks of 8 "
+                  "output channels of a group");
+
 BB.includeBackendSpecificVerification("glow/CPUSpecificNodesVerification.h");
 
 #endif // GLOW_WITH_CPU
@@ -30,4 +30,35 @@ bool CPUConvDKKC8Node::verify() const {
   return expectCompareTrue("Invalid output dimensions", exp, odim, this);
 }
 
+bool CPUDepthwiseConvNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, getKernels(),
+                                           getStrides(), getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  bool isValid =
+      expectCompareTrue("Invalid output dimensions", exp, odim, this);
+  ShapeNHWC expFilter(1, getKernels()[0], getKernels()[1], odim.c);
+  ShapeNHWC fdim(getFilter().getType()->dims());
+  isValid &=
+      expectCompareTrue("Invalid filter dimensions", expFilter, fdim, this);
+  return isValid;
+}
+
+bool CPUGroupConvNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, getKernels(),
+                                           getStrides(), getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  bool isValid =
+      expectCompareTrue("Invalid output dimensions", exp, odim, this);
+  auto fdims = getFilter().dims();
+  isValid &= expectCompareTrue("Invalid filter dimensions", fdims.size(),
+                               size_t(5), this);
+  isValid &= expectCompareTrue("Filter blocks must have 8 channels",
+                               fdims.back(), size_t(8), this);
+  return isValid;
+}
+
 #endif // GLOW_WITH_CPU
@@ -89,6 +89,21 @@ int main(int argc, char **argv) {
       .autoVerify(VerifyKind::SameElementType, {"Dest", "Src", "Filter"})
       .addGradientInstr({"Src", "Filter"}, {"Dest", "Src", "Filter", "Bias"});
 
+  BB.newInstr("ChannelwiseQuantizedConvolution")
+      .addOperand("Dest", OperandKind::Out)
+      .addOperand("Src", OperandKind::In)
+      .addOperand("Filter", OperandKind::In)
+      .addOperand("Bias", OperandKind::In)
+      .addOperand("Scales", OperandKind::In)
+      .addOperand("Offsets", OperandKind::In)
+      .addMember(MemberType::VectorUnsigned, "Kernels")
+      .addMember(MemberType::VectorUnsigned, "Strides")
+      .addMember(MemberType::VectorUnsigned, "Pads")
+      .addMember(MemberType::Unsigned, "Group")
+      .autoIRGen()
+      .autoVerify(VerifyKind::SameElementType,
+                  {"Dest", "Src", "Filter", "ElemKind::Int8QTy"});
+
   BB.newInstr("Convolution3D")
       .addOperand("Dest", OperandKind::Out)
       .addOperand("Src", OperandKind::In)
@@ -266,8 +281,6 @@ int main(int argc, char **argv) {
       .addOperand("Lengths", OperandKind::In)
       .autoIRGen()
       .autoVerify(VerifyKind::SameElementType, {"Dest", "ElemKind::FloatTy"})
-      .autoVerify(VerifyKind::SameElementType,
-                  {"Data", "ElemKind::UInt8FusedQTy"})
       .autoVerify(VerifyKind::SameElementType, {"Weights", "ElemKind::FloatTy"})
       .autoVerify(VerifyKind::SameElementType,
                   {"Indices", "ElemKind::Int64ITy"})
@@ -283,6 +296,24 @@ int main(int argc, char **argv) {
       .autoVerify(VerifyKind::SameElementType,
                   {"Lengths", "ElemKind::Int32ITy"});
 
+  BB.newInstr("SparseLengthsShard")
+      .addOperand("ShardWeights", OperandKind::Out)
+      .addOperand("ShardIndices", OperandKind::Out)
+      .addOperand("ShardLengths", OperandKind::Out)
+      .addOperand("Weights", OperandKind::In)
+      .addOperand("Indices", OperandKind::In)
+      .addOperand("Lengths", OperandKind::In)
+      .addMember(MemberType::Unsigned, "NumShards")
+      .addMember(MemberType::Unsigned, "Shard")
+      .autoVerify(VerifyKind::SameType, {"ShardWeights", "Weights"})
+      .autoVerify(VerifyKind::SameType, {"ShardIndices", "Indices"})
+      .autoVerify(VerifyKind::SameType, {"ShardLengths", "Lengths"})
+      .autoVerify(VerifyKind::SameElementType,
+                  {"Indices", "ElemKind::Int64ITy"})
+      .autoVerify(VerifyKind::SameElementType,
+                  {"Lengths", "ElemKind::Int32ITy"})
+      .autoVerify(VerifyKind::SameShape, {"Weights", "Indices"});
+
   /// Converts the given sparse representation into a dense one.
   BB.newInstr("SparseToDense")
       .addOperand("Dest", OperandKind::Out)
@@ -535,6 +566,55 @@ int main(int argc, char **argv) {
                   {"Lengths", "ElemKind::Int32ITy"})
       .autoIRGen();
 
+  //===--------------------------------------------------------------------===//
+  //                Instructions used for network training
+  //===--------------------------------------------------------------------===//
+
+  // The optimizer instructions update every element of the weight in a single
+  // pass. Dest may share the buffer of Weight.
+  BB.newInstr("SGD")
+      .addOperand("Dest", OperandKind::Out)
+      .addOperand("Weight", OperandKind::In)
+      .addOperand("Gradient", OperandKind::In)
+      .addMember(MemberType::Float, "L1Decay")
+      .addMember(MemberType::Float, "L2Decay")
+      .addMember(MemberType::Float, "LearningRate")
+      .addMember(MemberType::Unsigned, "BatchSize")
+      .inplaceOperand({"Dest", "Weight"})
+      .autoVerify(VerifyKind::SameType, {"Dest", "Weight", "Gradient"});
+
+  BB.newInstr("MomentumSGD")
+      .addOperand("Dest", OperandKind::Out)
+      .addOperand("Weight", OperandKind::In)
+      .addOperand("Gradient", OperandKind::In)
+      .addOperand("Gsum", OperandKind::InOut)
+      .addMember(MemberType::Float, "L1Decay")
+      .addMember(MemberType::Float, "L2Decay")
+      .addMember(MemberType::Float, "LearningRate")
+      .addMember(MemberType::Float, "Momentum")
+      .addMember(MemberType::Unsigned, "BatchSize")
+      .inplaceOperand({"Dest", "Weight"})
+      .autoVerify(VerifyKind::SameType, {"Dest", "Weight", "Gradient", "Gsum"});
+
+  BB.newInstr("Adam")
+      .addOperand("Dest", OperandKind::Out)
+      .addOperand("Weight", OperandKind::In)
+      .addOperand("Gradient", OperandKind::In)
+      .addOperand("M", OperandKind::InOut)
+      .addOperand("V", OperandKind::InOut)
+      .addOperand("Step", OperandKind::InOut)
+      .addMember(MemberType::Float, "L1Decay")
+      .addMember(MemberType::Float, "L2Decay")
+      .addMember(MemberType::Float, "LearningRate")
+      .addMember(MemberType::Float, "Beta1")
+      .addMember(MemberType::Float, "Beta2")
+      .addMember(MemberType::Float, "Epsilon")
+      .addMember(MemberType::Unsigned, "BatchSize")
+      .inplaceOperand({"Dest", "Weight"})
+      .autoVerify(VerifyKind::SameType,
+                  {"Dest", "Weight", "Gradient", "M", "V"})
+      .autoVerify(VerifyKind::SameElementType, {"Step", "ElemKind::FloatTy"});
+
   //===--------------------------------------------------------------------===//
   //             Instructions used for debugging/profiling/printing
   //===--------------------------------------------------------------------===//
@@ -87,6 +87,23 @@ int main(int argc, char **argv) {
                     "Bias tensors, as well as provided Kernels, Strides, Pads, "
                     "and Group.");
 
+  BB.newNode("ChannelwiseQuantizedConvolution")
+      .addInput("Input")
+      .addInput("Filter")
+      .addInput("Bias")
+      .addInput("Scales")
+      .addInput("Offsets")
+      .addMember(MemberType::VectorUnsigned, "Kernels")
+      .addMember(MemberType::VectorUnsigned, "Strides")
+      .addMember(MemberType::VectorUnsigned, "Pads")
+      .addMember(MemberType::Unsigned, "Group")
+      .addResultFromCtorArg()
+      .setDocstring("Performs 2D Convolution using a given Input, Filter, and "
+                    "Bias tensors, as well as provided Kernels, Strides, Pads, "
+                    "and Group. Input, Bias and Result are regularly "
+                    "quantized, while Filter is quantized per output channel "
+                    "using the provided Scales and Offsets.");
+
   BB.newNode("Convolution3D")
       .addInput("Input")
       .addInput("Filter")
@@ -400,7 +417,9 @@ int main(int argc, char **argv) {
                     "It implies that len(Weights) == len(Indices). The input "
                     "data is fused rowwise-quantized, where the Scales and "
                     "Offsets are appended to the end of each row. Thus, Data "
-                    "must be a two-dimensional tensor.");
+                    "must be a two-dimensional tensor. Data is either "
+                    "UInt8FusedQTy or UInt4FusedQTy; the latter packs two "
+                    "4-bit values in every byte.");
 
   BB.newNode("LengthsToRanges")
       .addInput("Lengths")
@@ -410,6 +429,25 @@ int main(int argc, char **argv) {
                     "input vector of length N the output is a Nx2 matrix with "
                     "(offset, lengths) packaged for each segment.");
 
+  BB.newNode("SparseLengthsShard")
+      .addInput("Weights")
+      .addInput("Indices")
+      .addInput("Lengths")
+      .addMember(MemberType::Unsigned, "NumShards")
+      .addMember(MemberType::Unsigned, "Shard")
+      .addResultFromCtorArg("ShardWeights")
+      .addResultFromCtorArg("ShardIndices")
+      .addResultFromCtorArg("ShardLengths")
+      .setDocstring("Selects the lookups of a SparseLengthsWeightedSum that "
+                    "go to shard Shard of a table whose rows are spread over "
+                    "NumShards shards: row R is row R / NumShards of shard "
+                    "R % NumShards. The (weight, index) pairs of each segment "
+                    "that go to the shard are packed at the front of "
+                    "ShardWeights and ShardIndices, with the index of the row "
+                    "in the shard, and ShardLengths counts them per segment. "
+                    "The rest of ShardWeights and ShardIndices is zero, so "
+                    "sum(ShardLengths) may be less than len(ShardIndices).");
+
   BB.newNode("SparseToDense")
       .addInput("Indices")
       .addInput("Values")
@@ -605,7 +643,6 @@ int main(int argc, char **argv) {
       .addMember(MemberType::Float, "L1Decay")
       .addMember(MemberType::Float, "L2Decay")
       .addMember(MemberType::Float, "LearningRate")
-      .addMember(MemberType::Float, "Momentum")
       .addMember(MemberType::Unsigned, "BatchSize")
       .addResult("Weight.getType()", "UpdatedWeight")
       .setHasSideEffects(true)
@@ -613,6 +650,63 @@ int main(int argc, char **argv) {
                     "Produces the updated weight that needs to be used "
                     "instead of Weight for the next iteration.");
 
+  BB.newNode("MomentumSGD")
+      .addInput("Gradient")
+      .addInput("Weight")
+      .addInput("Gsum")
+      .addMember(MemberType::Float, "L1Decay")
+      .addMember(MemberType::Float, "L2Decay")
+      .addMember(MemberType::Float, "LearningRate")
+      .addMember(MemberType::Float, "Momentum")
+      .addMember(MemberType::Unsigned, "BatchSize")
+      .addResult("Weight.getType()", "UpdatedWeight")
+      .addExtraMethod("Placeholder *getGsumPlaceholder() const;\n",
+                      "Placeholder *MomentumSGDNode::getGsumPlaceholder() "
+                      "const { return "
+                      "llvm::cast<Placeholder>(Gsum_.getNode()); };\n")
+      .addOverwrittenInput("Gsum")
+      .setHasSideEffects(true)
+      .setDocstring("Stochastic Gradient Descent with momentum node used "
+                    "during training. Gsum is the Placeholder that holds the "
+                    "accumulated update, which is updated in place. Produces "
+                    "the updated weight that needs to be used instead of "
+                    "Weight for the next iteration.");
+
+  BB.newNode("Adam")
+      .addInput("Gradient")
+      .addInput("Weight")
+      .addInput("M")
+      .addInput("V")
+      .addInput("Step")
+      .addMember(MemberType::Float, "L1Decay")
+      .addMember(MemberType::Float, "L2Decay")
+      .addMember(MemberType::Float, "LearningRate")
+      .addMember(MemberType::Float, "Beta1")
+      .addMember(MemberType::Float, "Beta2")
+      .addMember(MemberType::Float, "Epsilon")
+      .addMember(MemberType::Unsigned, "BatchSize")
+      .addResult("Weight.getType()", "UpdatedWeight")
+      .addExtraMethod(
+          "Placeholder *getMPlaceholder() const;\n"
+          "Placeholder *getVPlaceholder() const;\n"
+          "Placeholder *getStepPlaceholder() const;\n",
+          "Placeholder *AdamNode::getMPlaceholder() const { return "
+          "llvm::cast<Placeholder>(M_.getNode()); };\n"
+          "Placeholder *AdamNode::getVPlaceholder() const { return "
+          "llvm::cast<Placeholder>(V_.getNode()); };\n"
+          "Placeholder *AdamNode::getStepPlaceholder() const { return "
+          "llvm::cast<Placeholder>(Step_.getNode()); };\n")
+      .addOverwrittenInput("M")
+      .addOverwrittenInput("V")
+      .addOverwrittenInput("Step")
+      .setHasSideEffects(true)
+      .setDocstring("Adam optimizer node used during training. M and V are "
+                    "the Placeholders that hold the first and second moment "
+                    "estimates of the gradient, and Step is a single element "
+                    "Placeholder that counts the updates. They are updated in "
+                    "place. Produces the updated weight that needs to be used "
+                    "instead of Weight for the next iteration.");
+
   //===--------------------------------------------------------------------===//
   //             Nodes used for debugging/profiling/printing
   //===--------------------------------------------------------------------===//
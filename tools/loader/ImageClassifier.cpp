@@ -21,13 +21,17 @@
 #include "glow/Graph/Nodes.h"
 #include "glow/Importer/Caffe2ModelLoader.h"
 #include "glow/Importer/ONNXModelLoader.h"
+#include "glow/Support/ThreadPool.h"
 
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <queue>
@@ -92,6 +96,15 @@ llvm::cl::opt<bool> convertInAndOutToFp16(
         "Convert the input and output tensors of the network to fp16"),
     llvm::cl::cat(imageLoaderCat));
 
+llvm::cl::opt<unsigned> preprocessThreads(
+    "preprocess-threads",
+    llvm::cl::desc(
+        "Number of threads used to decode and preprocess the input images. "
+        "In mini-batch mode the next mini-batch is preprocessed while the "
+        "current one runs. By default, the number of hardware threads is "
+        "used; 1 preprocesses the images serially."),
+    llvm::cl::Optional, llvm::cl::init(0), llvm::cl::cat(imageLoaderCat));
+
 llvm::cl::list<unsigned> expectedMatchingLabels(
     "expected-labels",
     llvm::cl::desc("The comma delimited list of the matching lables"),
@@ -421,6 +434,21 @@ int main(int argc, char **argv) {
 
   size_t minibatchIndex = 0;
   Tensor inputImageData;
+
+  // Images are decoded and preprocessed on this pool. In mini-batch mode the
+  // next mini-batch is loaded into nextImageData while the current one runs.
+  unsigned numPreprocessThreads = preprocessThreads;
+  if (numPreprocessThreads == 0) {
+    numPreprocessThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::unique_ptr<ThreadPool> preprocessPool;
+  if (numPreprocessThreads > 1) {
+    preprocessPool = llvm::make_unique<ThreadPool>(numPreprocessThreads);
+  }
+  Tensor nextImageData;
+  std::vector<std::string> nextImageBatchFilenames;
+  std::future<void> nextImageDataReady;
+
   std::vector<std::string> inputImageBatchFilenames;
   if ((!miniBatchMode) && (!streamInputFilenamesMode)) {
     inputImageBatchFilenames = inputImageFilenames;
@@ -430,19 +458,32 @@ int main(int argc, char **argv) {
   llvm::outs() << "Model: " << loader.getFunction()->getName() << "\n";
 
   int numErrors = 0;
+  size_t numImagesProcessed = 0;
+  auto startTime = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration compileTime{0};
   while ((streamInputFilenamesMode &&
           getNextImageFilenames(&inputImageBatchFilenames)) ||
          (miniBatchMode &&
           getNextMiniBatch(inputImageBatchFilenames, inputImageFilenames,
                            minibatchIndex, miniBatch)) ||
          isFirstRun) {
-    // Load and process the image data into the inputImageData Tensor.
-    loadImagesAndPreprocess(inputImageBatchFilenames, &inputImageData,
-                            imageNormMode, imageChannelOrder, imageLayout);
+    // Load and process the image data into the inputImageData Tensor, unless
+    // it was already prefetched during the previous iteration.
+    if (nextImageDataReady.valid()) {
+      nextImageDataReady.get();
+      assert(nextImageBatchFilenames == inputImageBatchFilenames &&
+             "Prefetched the wrong mini-batch.");
+      std::swap(inputImageData, nextImageData);
+    } else {
+      loadImagesAndPreprocess(inputImageBatchFilenames, &inputImageData,
+                              imageNormMode, imageChannelOrder, imageLayout,
+                              preprocessPool.get());
+    }
 
     // If this is the first run, then we need to build and compile the model.
     if (isFirstRun) {
       isFirstRun = false;
+      auto compileStartTime = std::chrono::steady_clock::now();
 
       // Build and compile the graph, and then get back the input Placeholder
       // and output Softmax Tensor.
@@ -458,11 +499,28 @@ int main(int argc, char **argv) {
 
       inputImagePH = inputOutputPair.first;
       SMT = inputOutputPair.second;
+      compileTime = std::chrono::steady_clock::now() - compileStartTime;
     }
     assert(inputImagePH && SMT && "Input and output must be valid.");
     GLOW_ASSERT(inputImagePH->dims() == inputImageData.dims() &&
                 "New input shape does not match the compiled function.");
 
+    // Start preprocessing the next mini-batch so that it overlaps with the
+    // inference of the current one.
+    if (miniBatchMode && preprocessPool &&
+        minibatchIndex < inputImageFilenames.size()) {
+      nextImageBatchFilenames.assign(
+          inputImageFilenames.begin() + minibatchIndex,
+          inputImageFilenames.begin() + minibatchIndex + miniBatch);
+      nextImageDataReady =
+          std::async(std::launch::async, [&nextImageBatchFilenames,
+                                          &nextImageData, &preprocessPool]() {
+            loadImagesAndPreprocess(nextImageBatchFilenames, &nextImageData,
+                                    imageNormMode, imageChannelOrder,
+                                    imageLayout, preprocessPool.get());
+          });
+    }
+
     // Convert the raw input to fp16. This must be done every time we get new
     // image data.
     if (convertInAndOutToFp16) {
@@ -479,6 +537,19 @@ int main(int argc, char **argv) {
 
     // Print the top-k results from the output Softmax tensor.
     numErrors += processAndPrintResults(SMT, inputImageBatchFilenames);
+    numImagesProcessed += batchSize;
+  }
+
+  // Report the end-to-end throughput, including image preprocessing but not
+  // the compilation of the model.
+  std::chrono::duration<double> totalTime =
+      std::chrono::steady_clock::now() - startTime - compileTime;
+  if (timingEnabled() && numImagesProcessed > 0 && totalTime.count() > 0) {
+    llvm::outs() << "Processed " << numImagesProcessed << " images in "
+                 << llvm::format("%0.3f", totalTime.count()) << "s ("
+                 << llvm::format("%0.2f",
+                                 numImagesProcessed / totalTime.count())
+                 << " images/sec)\n";
   }
 
   // If profiling, generate and serialize the quantization infos now that we
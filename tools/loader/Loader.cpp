@@ -40,6 +40,14 @@ static llvm::cl::opt<bool, true>
                    llvm::cl::desc("Enable rowwise quantized fully connected."),
                    llvm::cl::location(enableRowwiseOpt), llvm::cl::init(false));
 
+/// -enable-channelwise : Command line option to enable channelwise quantized
+/// convolution in quantization producure.
+bool enableChannelwiseOpt;
+static llvm::cl::opt<bool, true> enableChannelwiseF(
+    "enable-channelwise",
+    llvm::cl::desc("Enable channelwise quantized convolution."),
+    llvm::cl::location(enableChannelwiseOpt), llvm::cl::init(false));
+
 namespace {
 llvm::cl::OptionCategory loaderCat("Loader Options");
 
@@ -199,6 +207,8 @@ bool glow::emittingBundle() { return !emitBundle.empty(); }
 
 bool glow::profilingGraph() { return !dumpProfileFileOpt.empty(); }
 
+bool glow::timingEnabled() { return timeOpt; }
+
 static bool commandLineIsInvalid() {
   if (!dumpProfileFileOpt.empty() && !loadProfileFileOpt.empty()) {
     llvm::errs() << "Loader: the -" << dumpProfileFileOpt.ArgStr << " and -"
@@ -331,6 +341,7 @@ void Loader::compile(PlaceholderBindings &bindings) {
     quantConfig.precision = quantizationPrecision;
     quantConfig.schema = quantizationSchema;
     quantConfig.enableRowwise = enableRowwiseOpt;
+    quantConfig.enableChannelwise = enableChannelwiseOpt;
     quantConfig.assertAllNodesQuantized = assertAllNodesQuantizedOpt;
 
     auto *Q = quantization::quantizeFunction(F_, quantConfig, *EE_.getBackend(),
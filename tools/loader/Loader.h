@@ -28,6 +28,9 @@ bool emittingBundle();
 /// \return true if profiling the graph.
 bool profilingGraph();
 
+/// \return true if the timer output is enabled.
+bool timingEnabled();
+
 /// Driver class for loading, compiling, and running inference for ONNX and
 /// Caffe2 models.
 class Loader {